@@ -43,6 +43,7 @@ macro (configure_ogrekit ROOT OGREPATH OGRE_BACKEND)
 	option(OGREKIT_USE_STATIC_FREEIMAGE		"Compile and link statically FreeImage and all its plugins" ON)	
 	option(OGREKIT_MINIMAL_FREEIMAGE_CODEC	"Compile minimal FreeImage Codec(PNG/JPEG/TGA)" OFF)
 	option(OGREKIT_ENABLE_UNITTESTS			"Enable / Disable UnitTests" OFF)
+	option(OGREKIT_ENABLE_BENCHMARKS		"Enable / Disable Benchmarks (needs UnitTests)" OFF)
 	#option(OGREKIT_USE_FILETOOLS			"Compile FBT file format utilities" ON)
 	# CAUTION: As of the blender 2.63-update bparse do not work for the moment! So set FBT as default for now
 	option(OGREKIT_USE_BPARSE				"Compile bParse file format utilities" OFF) #FBT alternative 
@@ -0,0 +1,294 @@
+/*
+-------------------------------------------------------------------------------
+    General Purpose Utility Library, should be kept dependency free.
+    Unless the dependency can be compiled along with this library.
+
+    Copyright (c) 2009-2010 Charlie C.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "utMemoryPool.h"
+#include <stdlib.h>
+
+
+static UTsize utPoolAlignUp(UTsize v, UTsize align)
+{
+	return (v + (align - 1)) & ~(align - 1);
+}
+
+static void* utPoolAlignPtr(void* p, UTsize align)
+{
+	UTuintPtr v = (UTuintPtr)p;
+	return (void*)((v + (align - 1)) & ~(UTuintPtr)(align - 1));
+}
+
+
+
+utSlabAllocator::utSlabAllocator(UTsize blockSize, UTsize blocksPerChunk, UTsize maxBlocks)
+	:	m_blockSize(utPoolAlignUp(blockSize > 0 ? blockSize : 1, UT_POOL_ALIGN)),
+	    m_blocksPerChunk(blocksPerChunk > 0 ? blocksPerChunk : 1),
+	    m_maxBlocks(maxBlocks),
+	    m_capacity(0),
+	    m_used(0),
+	    m_free(0)
+{
+}
+
+
+utSlabAllocator::~utSlabAllocator()
+{
+	for (UTsize i = 0; i < m_chunks.size(); ++i)
+		free(m_chunks[i]);
+}
+
+
+bool utSlabAllocator::addChunk(void)
+{
+	UTsize nr = m_blocksPerChunk;
+	if (m_maxBlocks != 0)
+	{
+		if (m_capacity >= m_maxBlocks)
+			return false;
+		if (m_capacity + nr > m_maxBlocks)
+			nr = m_maxBlocks - m_capacity;
+	}
+
+	UTsize bytes = m_blockSize * nr + UT_POOL_ALIGN;
+	void* chunk = malloc(bytes);
+	if (!chunk)
+		return false;
+
+	m_chunks.push_back(chunk);
+	m_capacity += nr;
+	m_stats.reserved += bytes;
+
+	// thread the new blocks in address order
+	char* base = (char*)utPoolAlignPtr(chunk, UT_POOL_ALIGN);
+	for (UTsize i = nr; i > 0; --i)
+	{
+		FreeBlock* block = (FreeBlock*)(base + (i - 1) * m_blockSize);
+		block->next = m_free;
+		m_free = block;
+	}
+	return true;
+}
+
+
+void utSlabAllocator::reserve(UTsize nr)
+{
+	while (m_capacity < nr)
+	{
+		if (!addChunk())
+			break;
+	}
+}
+
+
+void* utSlabAllocator::alloc(void)
+{
+	if (!m_free && !addChunk())
+		return 0;
+
+	FreeBlock* block = m_free;
+	m_free = block->next;
+
+	++m_used;
+	++m_stats.allocs;
+	m_stats.used = m_used * m_blockSize;
+	if (m_stats.used > m_stats.highWater)
+		m_stats.highWater = m_stats.used;
+	return block;
+}
+
+
+void utSlabAllocator::dealloc(void* p)
+{
+	if (!p)
+		return;
+
+	UT_ASSERT(m_used > 0);
+
+	FreeBlock* block = (FreeBlock*)p;
+	block->next = m_free;
+	m_free = block;
+
+	--m_used;
+	m_stats.used = m_used * m_blockSize;
+}
+
+
+
+utSmallObjectAllocator::utSmallObjectAllocator(UTsize blocksPerChunk)
+	:	m_blocksPerChunk(blocksPerChunk)
+{
+	for (int i = 0; i < NR_CLASSES; ++i)
+		m_classes[i] = 0;
+}
+
+
+utSmallObjectAllocator::~utSmallObjectAllocator()
+{
+	for (int i = 0; i < NR_CLASSES; ++i)
+		delete m_classes[i];
+}
+
+
+void* utSmallObjectAllocator::alloc(UTsize size)
+{
+	if (size == 0)
+		size = 1;
+
+	if (size > MAX_SMALL)
+	{
+		++m_large.allocs;
+		m_large.used += size;
+		m_large.reserved += size;
+		if (m_large.used > m_large.highWater)
+			m_large.highWater = m_large.used;
+		return malloc(size);
+	}
+
+	UTsize idx = (size - 1) / GRANULARITY;
+	if (!m_classes[idx])
+		m_classes[idx] = new utSlabAllocator((idx + 1) * GRANULARITY, m_blocksPerChunk);
+	return m_classes[idx]->alloc();
+}
+
+
+void utSmallObjectAllocator::dealloc(void* p, UTsize size)
+{
+	if (!p)
+		return;
+
+	if (size == 0)
+		size = 1;
+
+	if (size > MAX_SMALL)
+	{
+		m_large.used -= size;
+		m_large.reserved -= size;
+		free(p);
+		return;
+	}
+
+	UTsize idx = (size - 1) / GRANULARITY;
+	UT_ASSERT(m_classes[idx]);
+	m_classes[idx]->dealloc(p);
+}
+
+
+utAllocStats utSmallObjectAllocator::getStats(void) const
+{
+	utAllocStats stats = m_large;
+	for (int i = 0; i < NR_CLASSES; ++i)
+	{
+		if (m_classes[i])
+			stats.add(m_classes[i]->getStats());
+	}
+	return stats;
+}
+
+
+
+utFrameArena::utFrameArena(UTsize chunkSize)
+	:	m_chunk(0),
+	    m_chunkSize(chunkSize > 0 ? chunkSize : 1024)
+{
+}
+
+
+utFrameArena::~utFrameArena()
+{
+	freeChunks();
+}
+
+
+utFrameArena::Chunk* utFrameArena::addChunk(UTsize size)
+{
+	Chunk* chunk = (Chunk*)malloc(sizeof(Chunk) + size);
+	if (!chunk)
+		return 0;
+
+	chunk->next   = m_chunk;
+	chunk->size   = size;
+	chunk->offset = 0;
+	m_chunk = chunk;
+
+	m_stats.reserved += size;
+	return chunk;
+}
+
+
+void utFrameArena::freeChunks(void)
+{
+	while (m_chunk)
+	{
+		Chunk* next = m_chunk->next;
+		free(m_chunk);
+		m_chunk = next;
+	}
+	m_stats.reserved = 0;
+}
+
+
+void* utFrameArena::alloc(UTsize size, UTsize align)
+{
+	UT_ASSERT(align > 0 && (align & (align - 1)) == 0);
+
+	if (m_chunk)
+	{
+		char* data = (char*)(m_chunk + 1);
+		char* p    = (char*)utPoolAlignPtr(data + m_chunk->offset, align);
+		UTsize end = (UTsize)(p - data) + size;
+
+		if (end <= m_chunk->size)
+		{
+			m_stats.used += end - m_chunk->offset;
+			m_chunk->offset = end;
+			++m_stats.allocs;
+			if (m_stats.used > m_stats.highWater)
+				m_stats.highWater = m_stats.used;
+			return p;
+		}
+	}
+
+	UTsize need = size + align;
+	if (!addChunk(need > m_chunkSize ? need : m_chunkSize))
+		return 0;
+	return alloc(size, align);
+}
+
+
+void utFrameArena::reset(void)
+{
+	if (m_chunk && m_chunk->next)
+	{
+		// the frame spilled over, replace the chunks with one that holds the peak
+		UTsize size = utPoolAlignUp(m_stats.highWater + UT_POOL_ALIGN, UT_POOL_ALIGN);
+		if (size < m_chunkSize)
+			size = m_chunkSize;
+
+		freeChunks();
+		addChunk(size);
+	}
+	else if (m_chunk)
+		m_chunk->offset = 0;
+
+	m_stats.used   = 0;
+	m_stats.allocs = 0;
+}
@@ -27,84 +27,213 @@
 
 #include "utCommon.h"
 #include "utTypes.h"
+#include <new>
+#include <stdio.h>
 
-// MemoryPool adapted from PocoC++
 
-template <typename T, UTsize maxAlloc>
-class utMemoryPool
+// Alignment of slab blocks and default alignment of arena allocations.
+#define UT_POOL_ALIGN 16
+
+
+struct utAllocStats
+{
+	UTsize reserved;   // bytes requested from the system
+	UTsize used;       // bytes handed out
+	UTsize highWater;  // peak of used
+	UTsize allocs;     // number of alloc calls
+
+	utAllocStats() : reserved(0), used(0), highWater(0), allocs(0) {}
+
+	void add(const utAllocStats& o)
+	{
+		reserved  += o.reserved;
+		used      += o.used;
+		highWater += o.highWater;
+		allocs    += o.allocs;
+	}
+};
+
+
+// Fixed size blocks carved out of contiguous chunks. Free blocks are kept
+// in an intrusive list threaded through the blocks themselves, so alloc
+// and dealloc are a pointer swap. Chunks are released on destruction only.
+class utSlabAllocator
+{
+public:
+	utSlabAllocator(UTsize blockSize, UTsize blocksPerChunk = 64, UTsize maxBlocks = 0);
+	~utSlabAllocator();
+
+	// returns 0 once maxBlocks are in use
+	void* alloc(void);
+	void  dealloc(void* p);
+
+	// makes sure nr blocks can be handed out without growing
+	void reserve(UTsize nr);
+
+	UT_INLINE UTsize              getBlockSize(void) const  { return m_blockSize; }
+	UT_INLINE UTsize              getUsedCount(void) const  { return m_used; }
+	UT_INLINE UTsize              getCapacity(void) const   { return m_capacity; }
+	UT_INLINE const utAllocStats& getStats(void) const      { return m_stats; }
+
+private:
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	utSlabAllocator(const utSlabAllocator&);
+	utSlabAllocator& operator= (const utSlabAllocator&);
+
+	bool addChunk(void);
+
+	UTsize          m_blockSize, m_blocksPerChunk, m_maxBlocks;
+	UTsize          m_capacity, m_used;
+	FreeBlock*      m_free;
+	utArray<void*>  m_chunks;
+	utAllocStats    m_stats;
+};
+
+
+// Routes small requests to one slab per 16 byte size class, larger ones
+// go to malloc. Meant to back class operator new/delete, so dealloc needs
+// the size the block was allocated with.
+class utSmallObjectAllocator
 {
 public:
-	typedef utArray<T *> BlockAlloc;
+	enum
+	{
+		GRANULARITY = UT_POOL_ALIGN,
+		MAX_SMALL   = 512,
+		NR_CLASSES  = MAX_SMALL / GRANULARITY
+	};
+
+public:
+	utSmallObjectAllocator(UTsize blocksPerChunk = 64);
+	~utSmallObjectAllocator();
+
+	void* alloc(UTsize size);
+	void  dealloc(void* p, UTsize size);
+
+	// sum over all size classes and large allocations
+	utAllocStats getStats(void) const;
+
+private:
+	utSmallObjectAllocator(const utSmallObjectAllocator&);
+	utSmallObjectAllocator& operator= (const utSmallObjectAllocator&);
+
+	utSlabAllocator* m_classes[NR_CLASSES];
+	UTsize           m_blocksPerChunk;
+	utAllocStats     m_large;
+};
+
 
+// Bump allocator for per frame temporaries. Nothing is freed individually,
+// reset() drops everything at once. When a frame overflows the current
+// chunk, reset() merges the chunks into one that fits the peak so later
+// frames stay in a single block. Not thread safe.
+class utFrameArena
+{
 public:
+	utFrameArena(UTsize chunkSize = 64 * 1024);
+	~utFrameArena();
+
+	void* alloc(UTsize size, UTsize align = UT_POOL_ALIGN);
+
+	// uninitialized storage, only for types without constructors
+	template <typename T>
+	T* allocArray(UTsize nr)
+	{
+		return static_cast<T*>(alloc(sizeof(T) * nr));
+	}
+
+	void reset(void);
+
+	UT_INLINE UTsize              getUsed(void) const   { return m_stats.used; }
+	UT_INLINE const utAllocStats& getStats(void) const  { return m_stats; }
+
+private:
+	struct Chunk
+	{
+		Chunk* next;
+		UTsize size;
+		UTsize offset;
+	};
 
+	utFrameArena(const utFrameArena&);
+	utFrameArena& operator= (const utFrameArena&);
+
+	Chunk* addChunk(UTsize size);
+	void   freeChunks(void);
+
+	Chunk*       m_chunk;
+	UTsize       m_chunkSize;
+	utAllocStats m_stats;
+};
+
+
+
+// Typed pool on top of utSlabAllocator, objects are constructed on alloc
+// and destructed on dealloc. A maxAlloc of 0 means unbounded. The slab does
+// not know which blocks are in use, so every object has to be returned
+// before the pool goes away.
+template <typename T, UTsize maxAlloc>
+class utMemoryPool
+{
+public:
 
 	utMemoryPool(UTsize nrAlloc)
+		:	m_slab(sizeof(T), (nrAlloc == 0 || nrAlloc == UT_NPOS) ? 32 : nrAlloc, maxAlloc),
+			m_total(nrAlloc == UT_NPOS ? 0 : nrAlloc)
 	{
-		initializePool(nrAlloc);
+		if (nrAlloc != UT_NPOS)
+			m_slab.reserve(nrAlloc);
 	}
 
 	~utMemoryPool()
 	{
-		for (UTsize i=0; i<m_usedBlocks.capacity(); i++)
-			delete m_usedBlocks.at(i);
+		UT_ASSERT(m_slab.getUsedCount() == 0 && "objects still allocated from the pool");
 	}
 
-	T *alloc(void)
+	T* alloc(void)
 	{
-		if (m_usedBlocks.empty())
-		{
-			if (maxAlloc ==0 || m_total < maxAlloc)
-			{
-				m_total += 1;
-				T *ptr = new T();
-				return ptr;
-			}
-		}
-		else
+		void* p = m_slab.alloc();
+		if (p != 0)
 		{
-			T *r = m_usedBlocks.back();
-			m_usedBlocks.pop_back();
-			return r;
+			if (m_slab.getUsedCount() > m_total)
+				m_total = m_slab.getUsedCount();
+			return new (p) T();
 		}
 
 		printf("Maximum nr of allocs exceeded");
 		return 0;
 	}
 
-	void dealloc(T *p)
+	void dealloc(T* p)
 	{
 		if (p != 0)
-			m_usedBlocks.push_back(p);
+		{
+			p->~T();
+			m_slab.dealloc(p);
+		}
 	}
 
 
-	UT_INLINE UTsize        getAllocatedCount(void)     { return m_total; }
-	UT_INLINE const UTsize  getMaxAlloc(void)           { return maxAlloc; }
-	UT_INLINE UTsize        getBlockSize(void)          { return sizeof (T); }
-	UT_INLINE UTsize        getPoolSize(void)           { return sizeof (T) * m_total; }
+	// objects the pool holds, in use or free: the preallocated ones, and
+	// more when that many were in use at once
+	UT_INLINE UTsize              getAllocatedCount(void)     { return m_total; }
+	UT_INLINE const UTsize        getMaxAlloc(void)           { return maxAlloc; }
+	UT_INLINE UTsize              getBlockSize(void)          { return sizeof (T); }
+	UT_INLINE UTsize              getPoolSize(void)           { return sizeof (T) * m_total; }
 
+	// objects handed out and not returned yet
+	UT_INLINE UTsize              getUsedCount(void)          { return m_slab.getUsedCount(); }
 
-protected:
-
-	void initializePool(UTsize nr)
-	{
-		if (nr == 0 || nr == UT_NPOS)
-			return;
-
-		m_total = nr;
-
-		m_usedBlocks.reserve(m_total);
-		for (UTsize i=0; i<nr; i++)
-		{
-			T *ptr = new T();
-			m_usedBlocks.push_back(ptr);
-		}
-	}
-
-	BlockAlloc  m_usedBlocks;
-	UTsize      m_total;
+	// bytes of the slab, blocks are rounded up to UT_POOL_ALIGN
+	UT_INLINE const utAllocStats& getStats(void)              { return m_slab.getStats(); }
 
+protected:
+	utSlabAllocator m_slab;
+	UTsize          m_total;
 };
 
 #endif//_utMemoryPool_h_
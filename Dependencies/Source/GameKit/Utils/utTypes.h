@@ -1595,6 +1595,376 @@ private:
 };
 
 
+// Open addressing variant of utHashTable with the same Key contract and
+// interface. Entries stay packed in insertion order (so iteration and
+// at(i) work the same way) while lookups probe a flat array of
+// {hash, index} slots using Robin Hood hashing. As with utHashTable keys
+// are equal when their hashes are, so a probe never leaves the slot array.
+#define _UT_FLATHASHTABLE_INIT     32
+#define _UT_FLATHASHTABLE_EXPANSE  (m_size * 2)
+#define _UT_FLATHASHTABLE_SLOTS(x) ((x) * 2)  // keeps the slot load factor at or below 0.5
+
+// Bijective finalizer, spreads keys like (i * 16) over the low bits
+UT_INLINE UThash utFlatHashMix(UThash h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	return h;
+}
+
+
+template < typename Key, typename Value>
+class utFlatHashTable
+{
+public:
+	typedef utHashEntry<Key, Value>        Entry;
+	typedef const utHashEntry<Key, Value>  ConstEntry;
+
+	typedef Entry  *EntryArray;
+
+	struct Slot
+	{
+		UThash hash;  // mixed key hash
+		UTsize index; // into the entry array, UT_NPOS if free
+	};
+	typedef Slot *SlotArray;
+
+
+	typedef Key            KeyType;
+	typedef Value          ValueType;
+
+	typedef const Key      ConstKeyType;
+	typedef const Value    ConstValueType;
+
+	typedef Value          &ReferenceValueType;
+	typedef const Value    &ConstReferenceValueType;
+
+	typedef Key            &ReferenceKeyType;
+	typedef const Key      &ConstReferenceKeyType;
+
+	typedef EntryArray Pointer;
+	typedef const Entry *ConstPointer;
+
+
+	typedef utHashTableIterator<utFlatHashTable<Key, Value> > Iterator;
+	typedef const utHashTableIterator<utFlatHashTable<Key, Value> > ConstIterator;
+
+
+public:
+
+	utFlatHashTable()
+		:    m_size(0), m_capacity(0), m_mask(0),
+		     m_sptr(0), m_bptr(0), m_cache(0)
+	{
+	}
+
+	utFlatHashTable(UTsize capacity)
+		:    m_size(0), m_capacity(0), m_mask(0),
+		     m_sptr(0), m_bptr(0), m_cache(0)
+	{
+		reserve(capacity);
+	}
+
+	utFlatHashTable(const utFlatHashTable &rhs)
+		:    m_size(0), m_capacity(0), m_mask(0),
+		     m_sptr(0), m_bptr(0), m_cache(0)
+	{
+		doCopy(rhs);
+	}
+
+	~utFlatHashTable() { clear(); }
+
+	utFlatHashTable<Key, Value> &operator = (const utFlatHashTable<Key, Value> &rhs)
+	{
+		if (this != &rhs)
+			doCopy(rhs);
+		return *this;
+	}
+
+	void clear(bool useCache = false)
+	{
+		if (!useCache)
+		{
+			m_size = m_capacity = m_mask = 0;
+			m_cache = 0;
+
+			delete [] m_bptr;
+			delete [] m_sptr;
+			m_bptr = 0; m_sptr = 0;
+		}
+		else
+		{
+			++m_cache;
+			if (m_cache > _UT_CACHE_LIMIT)
+				clear(false);
+			else
+			{
+				m_size = 0;
+				clearSlots();
+			}
+		}
+	}
+
+	Value              &at(UTsize i)                    { UT_ASSERT(m_bptr && i >= 0 && i < m_size); return m_bptr[i].second; }
+	Value              &operator [](UTsize i)           { UT_ASSERT(m_bptr && i >= 0 && i < m_size); return m_bptr[i].second; }
+	const Value        &at(UTsize i)const               { UT_ASSERT(m_bptr && i >= 0 && i < m_size); return m_bptr[i].second; }
+	const Value        &operator [](UTsize i) const     { UT_ASSERT(m_bptr && i >= 0 && i < m_size); return m_bptr[i].second; }
+	Key                &keyAt(UTsize i)                 { UT_ASSERT(m_bptr && i >= 0 && i < m_size); return m_bptr[i].first; }
+	const Key          &keyAt(UTsize i)const            { UT_ASSERT(m_bptr && i >= 0 && i < m_size); return m_bptr[i].first; }
+
+
+	Value* get(const Key &key)
+	{
+		UTsize i = find(key);
+		return i != UT_NPOS ? &m_bptr[i].second : (Value*)0;
+	}
+
+	const Value* get(const Key &key) const
+	{
+		UTsize i = find(key);
+		return i != UT_NPOS ? &m_bptr[i].second : (const Value*)0;
+	}
+
+
+	Value*         operator [](const Key &key)       { return get(key); }
+	const Value*   operator [](const Key &key) const { return get(key); }
+
+
+	UTsize find(const Key &key) const
+	{
+		UTsize s = findSlot(key);
+		return s != UT_NPOS ? m_sptr[s].index : UT_NPOS;
+	}
+
+
+	void erase(const Key &key) {remove(key);}
+
+	void remove(const Key &key)
+	{
+		UTsize s = findSlot(key);
+		if (s == UT_NPOS)
+			return;
+
+		UTsize findex = m_sptr[s].index;
+		eraseSlot(s);
+
+		// keep the entries packed, the last one fills the hole
+		UTsize lindex = m_size - 1;
+		if (findex != lindex)
+		{
+			UThash lh = utFlatHashMix(m_bptr[lindex].first.hash());
+
+			UTsize ls = lh & m_mask;
+			while (m_sptr[ls].index != lindex)
+				ls = (ls + 1) & m_mask;
+
+			m_sptr[ls].index = findex;
+			m_bptr[findex] = m_bptr[lindex];
+		}
+
+		--m_size;
+	}
+
+	bool insert(const Key &key, const Value &val)
+	{
+		if (find(key) != UT_NPOS)
+			return false;
+
+		if (m_size == m_capacity)
+			reserve(m_size == 0 ? _UT_FLATHASHTABLE_INIT : _UT_FLATHASHTABLE_EXPANSE);
+
+		UT_ASSERT(m_bptr && m_sptr);
+		m_bptr[m_size] = Entry(key, val);
+		insertSlot(utFlatHashMix(key.hash()), m_size);
+
+		++m_size;
+		return true;
+	}
+
+
+	UT_INLINE Pointer ptr(void)             { return m_bptr; }
+	UT_INLINE ConstPointer ptr(void) const  { return m_bptr; }
+	UT_INLINE bool valid(void) const        { return m_bptr != 0;}
+
+
+	UT_INLINE UTsize size(void) const       { return m_size; }
+	UT_INLINE UTsize capacity(void) const   { return m_capacity; }
+	UT_INLINE bool empty(void) const        { return m_size == 0; }
+
+
+	Iterator        iterator(void)       { return m_bptr && m_size > 0 ? Iterator(m_bptr, m_size) : Iterator(); }
+	ConstIterator   iterator(void) const { return m_bptr && m_size > 0 ? ConstIterator(m_bptr, m_size) : ConstIterator(); }
+
+
+	void reserve(UTsize nr)
+	{
+		if (m_capacity < nr && nr != UT_NPOS)
+			rehash(nr);
+	}
+
+	/// Longest probe sequence, 0 means every key sits in its home slot.
+	UTsize maxProbeLength(void) const
+	{
+		UTsize i, d, r = 0;
+		for (i = 0; m_sptr && i <= m_mask; ++i)
+		{
+			if (m_sptr[i].index != UT_NPOS)
+			{
+				d = probeLength(i);
+				if (d > r) r = d;
+			}
+		}
+		return r;
+	}
+
+
+private:
+
+	UT_INLINE UTsize probeLength(UTsize slot) const
+	{
+		return (slot - (m_sptr[slot].hash & m_mask)) & m_mask;
+	}
+
+
+	UTsize findSlot(const Key &key) const
+	{
+		if (m_size == 0)
+			return UT_NPOS;
+
+		UT_ASSERT(m_bptr && m_sptr);
+
+		const UThash hk = utFlatHashMix(key.hash());
+		UTsize s = hk & m_mask, d = 0;
+
+		for (;;)
+		{
+			const Slot &slot = m_sptr[s];
+
+			// Robin Hood invariant, the key would have displaced this slot
+			if (slot.index == UT_NPOS || probeLength(s) < d)
+				return UT_NPOS;
+
+			if (slot.hash == hk)
+				return s;
+
+			s = (s + 1) & m_mask;
+			++d;
+		}
+	}
+
+
+	void insertSlot(UThash hk, UTsize index)
+	{
+		Slot ins;
+		ins.hash  = hk;
+		ins.index = index;
+
+		UTsize s = hk & m_mask, d = 0, sd;
+		for (;;)
+		{
+			Slot &slot = m_sptr[s];
+			if (slot.index == UT_NPOS)
+			{
+				slot = ins;
+				return;
+			}
+
+			// take from the rich, give to the poor
+			sd = probeLength(s);
+			if (sd < d)
+			{
+				utSwap(slot, ins);
+				d = sd;
+			}
+
+			s = (s + 1) & m_mask;
+			++d;
+		}
+	}
+
+
+	void eraseSlot(UTsize s)
+	{
+		// backward shift, no tombstones
+		UTsize n = (s + 1) & m_mask;
+		while (m_sptr[n].index != UT_NPOS && probeLength(n) != 0)
+		{
+			m_sptr[s] = m_sptr[n];
+			s = n;
+			n = (n + 1) & m_mask;
+		}
+		m_sptr[s].index = UT_NPOS;
+	}
+
+
+	void clearSlots(void)
+	{
+		UTsize i;
+		for (i = 0; m_sptr && i <= m_mask; ++i)
+			m_sptr[i].index = UT_NPOS;
+	}
+
+
+	void doCopy(const utFlatHashTable<Key, Value> &rhs)
+	{
+		if (rhs.empty())
+			clear();
+		else if (rhs.valid())
+		{
+			if (m_capacity != rhs.m_capacity)
+			{
+				clear();
+				rehash(rhs.m_capacity);
+			}
+
+			UTsize i;
+			m_size = rhs.m_size;
+			for (i = 0; i < m_size; ++i)
+				m_bptr[i] = rhs.m_bptr[i];
+			for (i = 0; i <= m_mask; ++i)
+				m_sptr[i] = rhs.m_sptr[i];
+		}
+	}
+
+
+	void rehash(UTsize nr)
+	{
+		if (!_UT_UTHASHTABLE_IS_POW2(nr))
+		{
+			_UT_UTHASHTABLE_POW2(nr);
+		}
+
+		UT_ASSERT(_UT_UTHASHTABLE_IS_POW2(nr));
+
+		UTsize i, ns = _UT_FLATHASHTABLE_SLOTS(nr);
+
+		EntryArray nb = new Entry[nr];
+		for (i = 0; i < m_size; ++i)
+			nb[i] = m_bptr[i];
+
+		delete [] m_bptr;
+		delete [] m_sptr;
+
+		m_bptr = nb;
+		m_sptr = new Slot[ns];
+		m_capacity = nr;
+		m_mask = ns - 1;
+
+		clearSlots();
+		for (i = 0; i < m_size; ++i)
+			insertSlot(utFlatHashMix(m_bptr[i].first.hash()), i);
+	}
+
+
+	UTsize m_size, m_capacity, m_mask;
+
+	SlotArray  m_sptr;
+	EntryArray m_bptr;
+	UTsize m_cache;
+};
+
+
 
 
 UT_INLINE UThash utHash(int v)
@@ -43,12 +43,25 @@ struct gkMeshData : public gkReferences, gkNonCopyable
 
 	NORMALS normals;
 
+	// convex area marked with a path finding flag, see gkGameObjectProperties::m_findPathFlag
+	struct Area
+	{
+		int firstVert;
+		int vertCount;
+		float hmin, hmax;
+		unsigned char flag;
+	};
+
+	typedef std::vector<Area> AREAS;
+
+	AREAS areas;
+
 	GK_INLINE const float* getVerts() const { return &verts.at(0).x; }
 	GK_INLINE const float* getNormals() const { return &normals.at(0).x; }
 	GK_INLINE const int* getTris() const { return &tris.at(0); }
 	GK_INLINE int getVertCount() const { return verts.size(); }
 	GK_INLINE int getTriCount() const { return tris.size() / 3; }
-	GK_INLINE void copy(const gkMeshData& obj) {verts = obj.verts; tris = obj.tris; normals = obj.normals; }
+	GK_INLINE void copy(const gkMeshData& obj) {verts = obj.verts; tris = obj.tris; normals = obj.normals; areas = obj.areas; }
 };
 
 typedef gkPtrRef<gkMeshData> PMESHDATA;
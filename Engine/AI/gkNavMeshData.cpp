@@ -37,8 +37,12 @@
 
 typedef gkGameObject::NavMeshData NavMeshData;
 
+// free vertices are only compacted once there is a fair amount of them
+#define GK_NAVMESH_COMPACT_MIN 4096
+
+
 gkNavMeshData::gkNavMeshData(gkScene* scene)
-	: m_object(0), m_scene(scene), m_hasChanged(false)
+	: m_scene(scene), m_usedVerts(0), m_freeVerts(0), m_hasChanged(false), m_staticOnly(false)
 {
 	GK_ASSERT(m_scene);
 }
@@ -50,66 +54,62 @@ gkNavMeshData::~gkNavMeshData()
 
 void gkNavMeshData::destroyInstance(gkGameObject* pObj)
 {
-	if (!isValid(pObj)) return;
-
-	{
-		gkCriticalSection::Lock guard(m_cs);
-
-		if (m_data.tris.empty()) return;
-	}
-
-	GK_ASSERT(!pObj->getNavData().isEmpty());
-
-	int indexBase = pObj->getNavData().triangleBaseIndex;
-	size_t vertexBaseIndex = indexBase / 2;
-	size_t normalBaseIndex = indexBase / 6;
-
-	int nIndex = pObj->getNavData().nIndex;
-	size_t nVertex = nIndex / 2;
-	size_t nNormal = nIndex / 3;
-
-	int indexValue = nIndex / 2;
-
 	{
 		gkCriticalSection::Lock guard(m_cs);
 
-		gkMeshData::TRIANGLES::iterator it = m_data.tris.erase(m_data.tris.begin() + indexBase, m_data.tris.begin() + indexBase + nIndex);
-		m_data.verts.erase(m_data.verts.begin() + vertexBaseIndex, m_data.verts.begin() + vertexBaseIndex + nVertex);
-		m_data.normals.erase(m_data.normals.begin() + normalBaseIndex, m_data.normals.begin() + normalBaseIndex + nNormal);
+		UTsize pos = m_objectSlots.find(pObj);
+		if (pos == UT_NPOS) return;
 
-		while (it != m_data.tris.end())
-		{
-			if (*it > indexBase)
-			{
-				*it -= indexValue;
-			}
+		UTsize index = m_objectSlots.at(pos);
+		m_objectSlots.erase(pObj);
 
-			++it;
-		}
+		// the range stays free for other objects, nothing else moves
+		Slot& slot = m_slots[index];
+		freeVerts(slot);
+		slot.object = 0;
+		slot.pending = false;
+		m_freeSlots.push_back(index);
 	}
 
 	pObj->resetNavData();
 
-	gkGameObjectSet& objs = m_scene->getInstancedObjects();
-	gkGameObjectSet::Iterator it = objs.iterator();
-	while (it.hasMoreElements())
-	{
-		gkGameObject* p = it.getNext();
-		p->recalcNavData(indexBase, nIndex);
-	}
-
 	m_hasChanged = true;
 }
 
 void gkNavMeshData::updateOrCreate(gkGameObject* pObj)
 {
-	if (!isValid(pObj)) return;
+	if (!pObj->isInstanced() || !isValid(pObj)) return;
 
-	m_object = pObj;
+	gkCriticalSection::Lock guard(m_cs);
 
-	if (m_object && m_object->isInstanced())
+	UTsize index;
+	UTsize pos = m_objectSlots.find(pObj);
+	if (pos == UT_NPOS)
 	{
-		AddCollisionObj();
+		Slot slot = {pObj, 0, 0, 0, 0.f, 0.f, false};
+
+		if (!m_freeSlots.empty())
+		{
+			index = m_freeSlots.back();
+			m_freeSlots.pop_back();
+			m_slots[index] = slot;
+		}
+		else
+		{
+			index = m_slots.size();
+			m_slots.push_back(slot);
+		}
+
+		m_objectSlots.insert(pObj, index);
+	}
+	else
+		index = m_objectSlots.at(pos);
+
+	// moves within a tick and between navigation mesh builds collapse into one collection
+	if (!m_slots[index].pending)
+	{
+		m_slots[index].pending = true;
+		m_pending.push_back(index);
 	}
 
 	m_hasChanged = true;
@@ -117,19 +117,23 @@ void gkNavMeshData::updateOrCreate(gkGameObject* pObj)
 
 void gkNavMeshData::destroyInstances()
 {
-	gkGameObjectSet& objs = m_scene->getInstancedObjects();
-	gkGameObjectSet::Iterator it = objs.iterator();
-	while (it.hasMoreElements())
+	gkCriticalSection::Lock guard(m_cs);
+
+	for (UTsize i = 0; i < m_slots.size(); ++i)
 	{
-		gkGameObject* pObj = it.getNext();
-		pObj->resetNavData();
+		if (m_slots[i].object)
+			m_slots[i].object->resetNavData();
 	}
 
-	gkCriticalSection::Lock guard(m_cs);
+	m_slots.clear();
+	m_freeSlots.clear();
+	m_pending.clear();
+	m_objectSlots.clear();
+	m_freeRanges.clear();
 
-	m_data.verts.clear();
-	m_data.tris.clear();
-	m_data.normals.clear();
+	m_verts.clear();
+	m_usedVerts = 0;
+	m_freeVerts = 0;
 
 	m_hasChanged = true;
 }
@@ -147,81 +151,97 @@ void gkNavMeshData::createInstances()
 	m_hasChanged = true;
 }
 
-void gkNavMeshData::processTriangle(btVector3* triangle, int partId, int triangleIndex)
+gkMeshData* gkNavMeshData::cloneData()
 {
-	btVector3 v1 = m * triangle[0];
-	btVector3 v2 = m * triangle[1];
-	btVector3 v3 = m * triangle[2];
+	gkCriticalSection::Lock guard(m_cs);
 
-	gkVector3 vv1(v1.x(), v1.z(), v1.y());
-	gkVector3 vv2(v2.x(), v2.z(), v2.y());
-	gkVector3 vv3(v3.x(), v3.z(), v3.y());
+	collectPending();
 
-	addTriangle(vv1, vv2, vv3, triangleIndex);
+	gkMeshData* p = new gkMeshData;
 
-//    m_debug->drawLine(v1, v2, btVector3(1,1,0));
-//    m_debug->drawLine(v2, v3, btVector3(1,1,0));
-//    m_debug->drawLine(v3, v1, btVector3(1,1,0));
-}
+	p->verts.reserve(m_usedVerts);
+	p->tris.reserve(m_usedVerts * 2);
+	p->normals.reserve(m_usedVerts * 2 / 3);
 
-void gkNavMeshData::addTriangle(const gkVector3& v1, const gkVector3& v2, const gkVector3& v3, int triangleIndex)
-{
-	if (m_object->getNavData().isEmpty())
+	for (UTsize i = 0; i < m_slots.size(); ++i)
 	{
-		size_t n = m_data.verts.size();
+		const Slot& slot = m_slots[i];
+		if (!slot.object) continue;
 
-		int a = n;
-		int b = n + 1;
-		int c = n + 2;
+		if (!slot.count)
+		{
+			slot.object->resetNavData();
+			continue;
+		}
+
+		// both windings of every triangle, see gkRecast
+		slot.object->setNavData(NavMeshData(p->tris.size(), slot.count * 2, slot.hmin, slot.hmax));
 
-		m_data.verts.push_back(v1);
-		m_data.verts.push_back(v2);
-		m_data.verts.push_back(v3);
+		// snapshot of the area, gkRecast does not touch the objects
+		gkMeshData::Area area;
+		area.firstVert = p->verts.size();
+		area.vertCount = slot.count * 2 / 3;
+		area.hmin = slot.hmin;
+		area.hmax = slot.hmax;
+		area.flag = slot.object->getProperties().m_findPathFlag;
+		p->areas.push_back(area);
+
+		for (UTsize v = slot.first; v < slot.first + slot.count; v += 3)
+		{
+			const gkVector3& v1 = m_verts[v];
+			const gkVector3& v2 = m_verts[v+1];
+			const gkVector3& v3 = m_verts[v+2];
 
-		m_data.tris.push_back(a);
-		m_data.tris.push_back(b);
-		m_data.tris.push_back(c);
+			int a = p->verts.size();
+			int b = a + 1;
+			int c = a + 2;
 
-		gkVector3 normal((v3 - v1).crossProduct(v2 - v1));
-		normal.normalise();
+			p->verts.push_back(v1);
+			p->verts.push_back(v2);
+			p->verts.push_back(v3);
 
-		m_data.normals.push_back(normal);
+			p->tris.push_back(a);
+			p->tris.push_back(b);
+			p->tris.push_back(c);
 
-		m_data.tris.push_back(c);
-		m_data.tris.push_back(b);
-		m_data.tris.push_back(a);
+			gkVector3 normal((v3 - v1).crossProduct(v2 - v1));
+			normal.normalise();
 
-		m_data.normals.push_back(-normal);
-		/*
-		    os << "v " << v1.x << " " << v1.y << " " << v1.z << "\n";
-		    os << "v " << v2.x << " " << v2.y << " " << v2.z << "\n";
-		    os << "v " << v3.x << " " << v3.y << " " << v3.z << "\n";
+			p->normals.push_back(normal);
 
-		    a++; b++; c++;
-		    os << "f " << a  << " " << b << " " << c << "\n";
-		    os << "f " << c  << " " << b << " " << a << "\n";
-		*/
+			p->tris.push_back(c);
+			p->tris.push_back(b);
+			p->tris.push_back(a);
+
+			p->normals.push_back(-normal);
+		}
 	}
-	else
-	{
-		size_t tBaseIndex = m_object->getNavData().triangleBaseIndex + triangleIndex;
-		size_t vBaseIndex = tBaseIndex / 2;
-		size_t nBaseIndex = tBaseIndex / 6;
 
-		gkVector3& ov1 = m_data.verts[vBaseIndex];
-		gkVector3& ov2 = m_data.verts[vBaseIndex+1];
-		gkVector3& ov3 = m_data.verts[vBaseIndex+2];
+	return p;
+}
 
-		ov1 = v1;
-		ov2 = v2;
-		ov3 = v3;
+void gkNavMeshData::processTriangle(btVector3* triangle, int partId, int triangleIndex)
+{
+	btVector3 v1 = m * triangle[0];
+	btVector3 v2 = m * triangle[1];
+	btVector3 v3 = m * triangle[2];
 
-		gkVector3 normal((v3 - v1).crossProduct(v2 - v1));
-		normal.normalise();
+	gkVector3 vv1(v1.x(), v1.z(), v1.y());
+	gkVector3 vv2(v2.x(), v2.z(), v2.y());
+	gkVector3 vv3(v3.x(), v3.z(), v3.y());
 
-		m_data.normals[nBaseIndex] = normal;
-		m_data.normals[nBaseIndex+1] = -normal;
-	}
+	addTriangle(vv1, vv2, vv3);
+
+//    m_debug->drawLine(v1, v2, btVector3(1,1,0));
+//    m_debug->drawLine(v2, v3, btVector3(1,1,0));
+//    m_debug->drawLine(v3, v1, btVector3(1,1,0));
+}
+
+void gkNavMeshData::addTriangle(const gkVector3& v1, const gkVector3& v2, const gkVector3& v3)
+{
+	m_collect.push_back(v1);
+	m_collect.push_back(v2);
+	m_collect.push_back(v3);
 }
 
 struct minH : public std::binary_function<gkVector3, gkVector3, bool>
@@ -229,108 +249,190 @@ struct minH : public std::binary_function<gkVector3, gkVector3, bool>
 	bool operator()(const gkVector3& a, const gkVector3& b) const  { return a.y < b.y; }
 };
 
-void gkNavMeshData::AddCollisionObj()
+void gkNavMeshData::collectPending()
 {
-	gkCriticalSection::Lock guard(m_cs);
+	for (UTsize i = 0; i < m_pending.size(); ++i)
+	{
+		Slot& slot = m_slots[m_pending[i]];
 
-	size_t vIndex = m_data.verts.size();
-	size_t tIndex = m_data.tris.size();
+		if (slot.pending && slot.object)
+		{
+			slot.pending = false;
+			collect(slot);
+		}
+	}
 
-	gkScene* pScene = m_object->getOwner();
+	m_pending.clear(true);
+}
 
-	GK_ASSERT(pScene);
+void gkNavMeshData::collect(Slot& slot)
+{
+	gkGameObject* pObj = slot.object;
+	m_collect.clear();
 
-	btVector3 aabbMin, aabbMax;
-	pScene->getDynamicsWorld()->getBulletWorld()->getBroadphase()->getBroadphaseAabb(aabbMin, aabbMax);
+	btCollisionObject* colObj = pObj->isInstanced() ? pObj->getCollisionObject() : 0;
+	if (colObj)
+	{
+		gkScene* pScene = pObj->getOwner();
 
-	aabbMin -= btVector3(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
-	aabbMax += btVector3(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+		GK_ASSERT(pScene);
 
-	btCollisionObject* colObj = m_object->getPhysicsController()->getCollisionObject();
+		btVector3 aabbMin, aabbMax;
+		pScene->getDynamicsWorld()->getBulletWorld()->getBroadphase()->getBroadphaseAabb(aabbMin, aabbMax);
 
-	const btCollisionShape* shape = colObj->getCollisionShape();
+		aabbMin -= btVector3(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+		aabbMax += btVector3(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
 
-	m = colObj->getWorldTransform();
+		const btCollisionShape* shape = colObj->getCollisionShape();
 
-	int shapetype = shape->getShapeType();
+		m = colObj->getWorldTransform();
 
-	switch (shapetype)
-	{
-	case SPHERE_SHAPE_PROXYTYPE:
-		{
-			break;
-		}
+		int shapetype = shape->getShapeType();
 
-	case BOX_SHAPE_PROXYTYPE:
+		switch (shapetype)
 		{
-			const btBoxShape* boxShape = static_cast<const btBoxShape*>(shape);
-			btVector3 halfExtent = boxShape->getHalfExtentsWithMargin();
-
-			static int indices[36] =
+		case SPHERE_SHAPE_PROXYTYPE:
 			{
-				0, 1, 2,
-				3, 2, 1,
-				4, 0, 6,
-				6, 0, 2,
-				5, 1, 4,
-				4, 1, 0,
-				7, 3, 1,
-				7, 1, 5,
-				5, 4, 7,
-				7, 4, 6,
-				7, 2, 3,
-				7, 6, 2
-			};
-
-			static btVector3 vertices[8] = {    btVector3(1, 1, 1), btVector3(-1, 1, 1),    btVector3(1, -1, 1),    btVector3(-1, -1, 1),    btVector3(1, 1, -1),    btVector3(-1, 1, -1),    btVector3(1, -1, -1),    btVector3(-1, -1, -1)};
-			int si = 36;
-			for (int i = 0; i < si; i += 3)
+				break;
+			}
+
+		case BOX_SHAPE_PROXYTYPE:
 			{
-				btVector3 v1 = m * (vertices[indices[i]] * halfExtent);
-				btVector3 v2 = m * (vertices[indices[i+1]] * halfExtent);
-				btVector3 v3 = m * (vertices[indices[i+2]] * halfExtent);
+				const btBoxShape* boxShape = static_cast<const btBoxShape*>(shape);
+				btVector3 halfExtent = boxShape->getHalfExtentsWithMargin();
+
+				static int indices[36] =
+				{
+					0, 1, 2,
+					3, 2, 1,
+					4, 0, 6,
+					6, 0, 2,
+					5, 1, 4,
+					4, 1, 0,
+					7, 3, 1,
+					7, 1, 5,
+					5, 4, 7,
+					7, 4, 6,
+					7, 2, 3,
+					7, 6, 2
+				};
+
+				static btVector3 vertices[8] = {    btVector3(1, 1, 1), btVector3(-1, 1, 1),    btVector3(1, -1, 1),    btVector3(-1, -1, 1),    btVector3(1, 1, -1),    btVector3(-1, 1, -1),    btVector3(1, -1, -1),    btVector3(-1, -1, -1)};
+				int si = 36;
+				for (int i = 0; i < si; i += 3)
+				{
+					btVector3 v1 = m * (vertices[indices[i]] * halfExtent);
+					btVector3 v2 = m * (vertices[indices[i+1]] * halfExtent);
+					btVector3 v3 = m * (vertices[indices[i+2]] * halfExtent);
+
+					gkVector3 vv1(v1.x(), v1.z(), v1.y());
+					gkVector3 vv2(v2.x(), v2.z(), v2.y());
+					gkVector3 vv3(v3.x(), v3.z(), v3.y());
+
+					addTriangle(vv1, vv2, vv3);
+				}
+
+				break;
+			}
 
-				gkVector3 vv1(v1.x(), v1.z(), v1.y());
-				gkVector3 vv2(v2.x(), v2.z(), v2.y());
-				gkVector3 vv3(v3.x(), v3.z(), v3.y());
+		default:
 
-				addTriangle(vv1, vv2, vv3, i / 3);
+			if (shape->isConcave() && !shape->isInfinite())
+			{
+				btConcaveShape* concaveMesh = (btConcaveShape*) shape;
 
-				//m_debug->drawLine(v1, v2, btVector3(1,1,0));
-				//m_debug->drawLine(v2, v3, btVector3(1,1,0));
-				//m_debug->drawLine(v3, v1, btVector3(1,1,0));
+				concaveMesh->processAllTriangles(this, aabbMin, aabbMax);
 			}
 
 			break;
 		}
+	}
 
-	default:
+	UTsize n = m_collect.size();
 
-		if (shape->isConcave() && !shape->isInfinite())
-		{
-			btConcaveShape* concaveMesh = (btConcaveShape*) shape;
+	// rewritten in place unless the shape grew
+	if (n > slot.capacity)
+	{
+		freeVerts(slot);
+		slot.first = allocVerts(n);
+		slot.capacity = n;
+	}
 
-			concaveMesh->processAllTriangles(this, aabbMin, aabbMax);
-		}
+	m_usedVerts = m_usedVerts - slot.count + n;
+	slot.count = n;
+
+	if (n > 0)
+	{
+		std::copy(m_collect.begin(), m_collect.end(), m_verts.begin() + slot.first);
 
-		break;
+		slot.hmin = std::min_element(m_collect.begin(), m_collect.end(), minH())->y;
+		slot.hmax = std::max_element(m_collect.begin(), m_collect.end(), minH())->y;
 	}
+}
 
-	if (m_object->getNavData().isEmpty())
+UTsize gkNavMeshData::allocVerts(UTsize count)
+{
+	// first fit into ranges left by destroyed or grown objects
+	for (UTsize i = 0; i < m_freeRanges.size(); ++i)
 	{
-		size_t n = m_data.tris.size() - tIndex;
+		Range& range = m_freeRanges[i];
+		if (range.count >= count)
+		{
+			UTsize first = range.first;
+			range.first += count;
+			range.count -= count;
+			m_freeVerts -= count;
+
+			if (!range.count)
+				m_freeRanges.erase(i);
+			return first;
+		}
+	}
 
-		GK_ASSERT(n >= 6); // minimum 2 triangles
+	if (m_freeVerts > GK_NAVMESH_COMPACT_MIN && m_freeVerts > m_usedVerts)
+		compact();
 
-		gkMeshData::VERTS::iterator it0 = m_data.verts.begin() + vIndex;
-		gkMeshData::VERTS::iterator it1 = m_data.verts.end();
+	UTsize first = m_verts.size();
+	m_verts.resize(first + count);
+	return first;
+}
 
-		float hMin = std::min_element(it0, it1, minH())->y;
+void gkNavMeshData::freeVerts(Slot& slot)
+{
+	if (slot.capacity)
+	{
+		Range range = {slot.first, slot.capacity};
+		m_freeRanges.push_back(range);
+		m_freeVerts += slot.capacity;
+	}
 
-		float hMax = std::max_element(it0, it1, minH())->y;
+	m_usedVerts -= slot.count;
+	slot.first = 0;
+	slot.count = 0;
+	slot.capacity = 0;
+}
 
-		m_object->setNavData(NavMeshData(tIndex, n, hMin, hMax));
+void gkNavMeshData::compact()
+{
+	gkMeshData::VERTS verts;
+	verts.reserve(m_usedVerts);
+
+	for (UTsize i = 0; i < m_slots.size(); ++i)
+	{
+		Slot& slot = m_slots[i];
+
+		if (slot.capacity)
+		{
+			UTsize first = verts.size();
+			verts.insert(verts.end(), m_verts.begin() + slot.first, m_verts.begin() + slot.first + slot.count);
+			slot.first = first;
+			slot.capacity = slot.count;
+		}
 	}
+
+	m_verts.swap(verts);
+	m_freeRanges.clear();
+	m_freeVerts = 0;
 }
 
 bool gkNavMeshData::isValid(gkGameObject* pObj)
@@ -343,7 +445,8 @@ bool gkNavMeshData::isValid(gkGameObject* pObj)
 
 	if (physicsState.isRigid())
 	{
-		GK_ASSERT(pColObj);
+		if (!pColObj || m_staticOnly)
+			return false;
 
 		int current_state = pColObj->getActivationState();
 
@@ -353,9 +456,7 @@ bool gkNavMeshData::isValid(gkGameObject* pObj)
 	}
 	else if (physicsState.isStatic())
 	{
-		// Sanity checks with parent / child physics controllers.
-		GK_ASSERT(pColObj);
-
+		// the collision object may not exist yet, it is looked up on collection
 		active = true;
 	}
 
@@ -43,6 +43,11 @@ class gkNavMeshData;
 
 typedef gkPtrRef<gkNavMeshData> PNAVMESHDATA;
 
+// Collects the collision geometry of static objects and resting rigid bodies
+// for gkRecast. Every object owns a slot, a stable range of vertices that is
+// rewritten in place when the object moves. Updates only flag the slot, the
+// geometry is collected once in cloneData, so objects moving every tick cost
+// a lookup until a navigation mesh is built.
 class gkNavMeshData : public btTriangleCallback, public gkReferences
 {
 public:
@@ -55,27 +60,53 @@ public:
 	void destroyInstances();
 	void createInstances();
 
-	gkMeshData* cloneData() const
-	{
-		gkCriticalSection::Lock guard(m_cs);
-
-		gkMeshData* p = new gkMeshData;
-
-		p->copy(m_data);
-
-		return p;
-	}
+	// Collects pending objects and returns the compacted geometry. The nav
+	// data of every collected object is set to its range in the returned mesh.
+	gkMeshData* cloneData();
 
 	GK_INLINE bool hasChanged() const { return m_hasChanged; }
 	GK_INLINE void resetHasChanged() { m_hasChanged = false; }
 
+	// Ignore rigid bodies, only static objects shape the navigation mesh.
+	GK_INLINE void setStaticOnly(bool v)    { m_staticOnly = v; }
+	GK_INLINE bool isStaticOnly(void) const { return m_staticOnly; }
+
+	GK_INLINE UTsize getVertexCount(void) const     { return m_usedVerts; }
+	GK_INLINE UTsize getFreeVertexCount(void) const { return m_freeVerts; }
+
 private:
 
+	struct Slot
+	{
+		gkGameObject* object;       // 0 when the slot is free
+		UTsize        first;        // first vertex in m_verts
+		UTsize        count;        // vertices in use, three per triangle
+		UTsize        capacity;     // vertices reserved
+		float         hmin;
+		float         hmax;
+		bool          pending;      // geometry has to be collected
+	};
+
+	struct Range
+	{
+		UTsize first;
+		UTsize count;
+	};
+
+	typedef utArray<Slot>                          Slots;
+	typedef utArray<Range>                         Ranges;
+	typedef utHashTable<utPointerHashKey, UTsize>  SlotMap;
+
 	void processTriangle(btVector3* triangle, int partId, int triangleIndex);
 
-	void addTriangle(const gkVector3& v1, const gkVector3& v2, const gkVector3& v3, int triangleIndex);
+	void addTriangle(const gkVector3& v1, const gkVector3& v2, const gkVector3& v3);
 
-	void AddCollisionObj();
+	void collectPending(void);
+	void collect(Slot& slot);
+
+	UTsize allocVerts(UTsize count);
+	void   freeVerts(Slot& slot);
+	void   compact(void);
 
 	bool isValid(gkGameObject* pObj);
 
@@ -83,15 +114,23 @@ private:
 
 	mutable gkCriticalSection m_cs;
 
-	gkGameObject* m_object;
+	gkScene* m_scene;
 
-	gkMeshData m_data;
+	Slots m_slots;
+	utArray<UTsize> m_freeSlots;
+	utArray<UTsize> m_pending;
+	SlotMap m_objectSlots;
 
-	btTransform m;
+	gkMeshData::VERTS m_verts;      // triangle soup of all slots
+	gkMeshData::VERTS m_collect;    // triangles of the object being collected
+	Ranges m_freeRanges;
+	UTsize m_usedVerts;
+	UTsize m_freeVerts;
 
-	gkScene* m_scene;
+	btTransform m;
 
 	bool m_hasChanged;
+	bool m_staticOnly;
 };
 
 
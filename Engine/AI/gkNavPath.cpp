@@ -49,11 +49,7 @@ bool gkNavPath::create(PDT_NAV_MESH navMesh, const gkVector3& from, const gkVect
 {
 	if (gkRecast::findPath(navMesh, from, to, polyPickExt, maxPathPolys, m_path))
 	{
-		m_pathRadius = PATH_RADIUS(m_path.size(), pathRadius);
-
-		GK_ASSERT(sizeof(OpenSteer::Vec3) == sizeof(gkVector3));
-
-		setPathway(m_path.size(), (OpenSteer::Vec3*)&(m_path[0]), &(m_pathRadius[0]), false);
+		updatePathway(pathRadius);
 
 		return true;
 	}
@@ -61,6 +57,27 @@ bool gkNavPath::create(PDT_NAV_MESH navMesh, const gkVector3& from, const gkVect
 	return false;
 }
 
+bool gkNavPath::create(const gkVector3* points, int nrPoints, gkScalar pathRadius)
+{
+	if (!points || nrPoints <= 0)
+		return false;
+
+	m_path.assign(points, points + nrPoints);
+
+	updatePathway(pathRadius);
+
+	return true;
+}
+
+void gkNavPath::updatePathway(gkScalar pathRadius)
+{
+	m_pathRadius.assign(m_path.size(), pathRadius);
+
+	GK_ASSERT(sizeof(OpenSteer::Vec3) == sizeof(gkVector3));
+
+	setPathway(m_path.size(), (OpenSteer::Vec3*)&(m_path[0]), &(m_pathRadius[0]), false);
+}
+
 void gkNavPath::showPath()
 {
 	gkPhysicsDebug* debug = m_scene->getDynamicsWorld()->getDebug();
@@ -45,6 +45,9 @@ public:
 
 	bool create(PDT_NAV_MESH navMesh, const gkVector3& from, const gkVector3& to, const gkVector3& polyPickExt, int maxPathPolys, gkScalar pathRadius);
 
+	// from a path found by gkNavPathQueue
+	bool create(const gkVector3* points, int nrPoints, gkScalar pathRadius);
+
 	void showPath();
 
 	bool empty() const { return m_path.empty(); }
@@ -57,6 +60,8 @@ public:
 
 private:
 
+	void updatePathway(gkScalar pathRadius);
+
 	PATH_POINTS m_path;
 
 	typedef std::vector<gkScalar> PATH_RADIUS;
@@ -0,0 +1,196 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Nestor Silveira.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "gkNavPathQueue.h"
+#include "RecastTimer.h"
+
+#define GK_NAVPATH_INDEX_BITS 16
+#define GK_NAVPATH_INDEX_MASK ((1 << GK_NAVPATH_INDEX_BITS) - 1)
+
+
+gkNavPathQueue::gkNavPathQueue()
+	: m_queueHead(0), m_maxQueries(32), m_budgetMs(1), m_lastQueries(0)
+{
+}
+
+gkNavPathQueue::~gkNavPathQueue()
+{
+	for (UTsize i = 0; i < m_requests.size(); ++i)
+		delete m_requests[i];
+}
+
+gkNavPathQueue::Handle gkNavPathQueue::request(PDT_NAV_MESH navMesh, const gkVector3& from, const gkVector3& to, const gkVector3& polyPickExt, int maxPathPolys, unsigned short includeFlags, unsigned short excludeFlags)
+{
+	GK_ASSERT(!(includeFlags & excludeFlags) && "includeFlags with excludeFlags cannot overlap");
+
+	UTsize index;
+	if (!m_free.empty())
+	{
+		index = m_free.back();
+		m_free.pop_back();
+	}
+	else
+	{
+		index = m_requests.size();
+		if (index > GK_NAVPATH_INDEX_MASK)
+			return 0;
+
+		Request* req = new Request;
+		req->generation = 0;
+		req->status = PS_INVALID;
+		m_requests.push_back(req);
+	}
+
+	Request* req = m_requests[index];
+
+	// the generation keeps stale handles of released requests from matching
+	if (++req->generation > (0xFFFFFFFF >> GK_NAVPATH_INDEX_BITS))
+		req->generation = 1;
+
+	req->navMesh = navMesh;
+	req->from = from;
+	req->to = to;
+	req->polyPickExt = polyPickExt;
+	req->maxPathPolys = gkMax(maxPathPolys, 1);
+	req->includeFlags = includeFlags;
+	req->excludeFlags = excludeFlags;
+	req->nrPoints = 0;
+	req->status = PS_QUEUED;
+
+	// only grows, the buffer is kept with the slot
+	if ((int)req->points.size() < req->maxPathPolys)
+		req->points.resize(req->maxPathPolys);
+
+	Handle handle = (req->generation << GK_NAVPATH_INDEX_BITS) | (Handle)index;
+	m_queue.push_back(handle);
+	return handle;
+}
+
+gkNavPathQueue::Request* gkNavPathQueue::getRequest(Handle handle) const
+{
+	UTsize index = handle & GK_NAVPATH_INDEX_MASK;
+	if (index >= m_requests.size())
+		return 0;
+
+	Request* req = m_requests[index];
+	if (req->status == PS_INVALID || req->generation != (handle >> GK_NAVPATH_INDEX_BITS))
+		return 0;
+
+	return req;
+}
+
+void gkNavPathQueue::release(Handle handle)
+{
+	Request* req = getRequest(handle);
+	if (!req)
+		return;
+
+	// a queued entry is skipped by update() as its handle no longer matches
+	req->status = PS_INVALID;
+	req->navMesh = PDT_NAV_MESH();
+	m_free.push_back(handle & GK_NAVPATH_INDEX_MASK);
+}
+
+void gkNavPathQueue::clear(void)
+{
+	for (UTsize i = 0; i < m_requests.size(); ++i)
+	{
+		Request* req = m_requests[i];
+		if (req->status != PS_INVALID)
+		{
+			req->status = PS_INVALID;
+			req->navMesh = PDT_NAV_MESH();
+			m_free.push_back(i);
+		}
+	}
+
+	m_queue.clear(true);
+	m_queueHead = 0;
+}
+
+gkNavPathQueue::Status gkNavPathQueue::getStatus(Handle handle) const
+{
+	Request* req = getRequest(handle);
+	return req ? req->status : PS_INVALID;
+}
+
+int gkNavPathQueue::getPath(Handle handle, const gkVector3*& points) const
+{
+	Request* req = getRequest(handle);
+	if (!req || req->status != PS_FOUND)
+	{
+		points = 0;
+		return 0;
+	}
+
+	points = req->points.ptr();
+	return req->nrPoints;
+}
+
+void gkNavPathQueue::update(void)
+{
+	m_lastQueries = 0;
+
+	rcTimeVal start = rcGetPerformanceTimer();
+
+	while (m_queueHead < m_queue.size() && m_lastQueries < m_maxQueries)
+	{
+		Handle handle = m_queue[m_queueHead++];
+
+		Request* req = getRequest(handle);
+		if (!req || req->status != PS_QUEUED)
+			continue;
+
+		req->nrPoints = gkRecast::findPath(req->navMesh, req->from, req->to, req->polyPickExt, req->maxPathPolys,
+		                                   m_query, req->points.ptr(), req->maxPathPolys, req->includeFlags, req->excludeFlags);
+
+		req->status = req->nrPoints ? PS_FOUND : PS_FAILED;
+
+		// the mesh may be replaced meanwhile, do not keep it alive
+		req->navMesh = PDT_NAV_MESH();
+
+		++m_lastQueries;
+
+		if (rcGetDeltaTimeUsec(start, rcGetPerformanceTimer()) >= m_budgetMs * 1000.0f)
+			break;
+	}
+
+	if (m_queueHead == m_queue.size())
+	{
+		m_queue.clear(true);
+		m_queueHead = 0;
+	}
+	else if (m_queueHead > m_queue.size() / 2)
+	{
+		// drop the answered front once it outweighs the waiting requests
+		UTsize n = m_queue.size() - m_queueHead;
+		for (UTsize i = 0; i < n; ++i)
+			m_queue[i] = m_queue[m_queueHead + i];
+
+		m_queue.resize(n);
+		m_queueHead = 0;
+	}
+}
@@ -0,0 +1,126 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Nestor Silveira.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkNavPathQueue_h_
+#define _gkNavPathQueue_h_
+
+#include "gkCommon.h"
+#include "gkMathUtils.h"
+#include "gkRecast.h"
+
+// Path requests of many agents, answered in submission order by update()
+// under a per call query and time budget, so that a crowd re-pathing in
+// the same tick is spread over the following ones. Request slots and their
+// point buffers are reused, steady state requests do not allocate.
+class gkNavPathQueue
+{
+public:
+
+	// zero is never a valid handle
+	typedef UTuint32 Handle;
+
+	enum Status
+	{
+		PS_INVALID,
+		PS_QUEUED,
+		PS_FOUND,
+		PS_FAILED
+	};
+
+	gkNavPathQueue();
+
+	~gkNavPathQueue();
+
+	// points of the path are limited to maxPathPolys
+	Handle request(
+	    PDT_NAV_MESH navMesh,
+	    const gkVector3& from,
+	    const gkVector3& to,
+	    const gkVector3& polyPickExt,
+	    int maxPathPolys,
+	    unsigned short includeFlags = 0xffff,
+	    unsigned short excludeFlags = 0
+	);
+
+	// frees the slot, the handle becomes invalid
+	void release(Handle handle);
+
+	// releases every request
+	void clear(void);
+
+	Status getStatus(Handle handle) const;
+
+	// points stay valid until the handle is released
+	int getPath(Handle handle, const gkVector3*& points) const;
+
+	// answers queued requests until one of the budgets is spent
+	void update(void);
+
+	GK_INLINE void setMaxQueriesPerUpdate(int nr) { m_maxQueries = gkMax(nr, 1); }
+	GK_INLINE void setUpdateBudget(gkScalar ms)   { m_budgetMs = ms; }
+
+	GK_INLINE int      getMaxQueriesPerUpdate(void) const { return m_maxQueries; }
+	GK_INLINE gkScalar getUpdateBudget(void) const        { return m_budgetMs; }
+
+	GK_INLINE UTsize getQueuedCount(void) const { return m_queue.size() - m_queueHead; }
+	GK_INLINE int    getLastQueryCount(void) const { return m_lastQueries; }
+
+private:
+
+	struct Request
+	{
+		PDT_NAV_MESH navMesh;
+		gkVector3 from, to, polyPickExt;
+		int maxPathPolys;
+		unsigned short includeFlags, excludeFlags;
+
+		utArray<gkVector3> points;
+		int nrPoints;
+
+		UTuint32 generation;
+		Status status;
+	};
+
+	typedef utArray<Request*> Requests;
+	typedef utArray<UTsize>   Indices;
+
+	Request* getRequest(Handle handle) const;
+
+	Requests m_requests;
+	Indices  m_free;
+
+	// FIFO of request handles, consumed from m_queueHead
+	utArray<Handle> m_queue;
+	UTsize m_queueHead;
+
+	gkRecast::PathQuery m_query;
+
+	int m_maxQueries;
+	gkScalar m_budgetMs;
+	int m_lastQueries;
+};
+
+#endif//_gkNavPathQueue_h_
@@ -28,10 +28,8 @@
 #include "gkRecast.h"
 #include "gkMeshData.h"
 #include "gkEngine.h"
-#include "gkScene.h"
 #include "gkLogger.h"
-#include "gkActiveObject.h"
-#include "gkGameObject.h"
+#include "Thread/gkJobSystem.h"
 
 #include "Recast.h"
 #include "RecastLog.h"
@@ -45,17 +43,67 @@ gkDetourNavMesh::~gkDetourNavMesh()
 	if (m_p) delete m_p;
 }
 
-PDT_NAV_MESH gkRecast::createNavMesh(PMESHDATA meshData, const Config& config)
+namespace
 {
-	if (!meshData.get())
-		return PDT_NAV_MESH(0);
 
-	rcConfig cfg;
+// input and output of one tile build
+struct TileBuild
+{
+	int x, y;
+	gkScalar bmin[3], bmax[3];      // tile bounds without the border
+
+	std::vector<int> tris;          // triangles overlapping the tile and its border
+	std::vector<int> areas;
+	UThash hash;
+
+	unsigned char* data;
+	int size;
+	int polys;
+	int thread;                     // job system index of the thread that built it
+
+	gkRecast::BuildStats stats;
+
+	TileBuild() : x(0), y(0), hash(0), data(0), size(0), polys(0), thread(-1) {}
+};
+
+typedef std::vector<TileBuild> TileBuilds;
+
+
+GK_INLINE int tileKey(int x, int y)
+{
+	return (int)(((unsigned int)y << 16) | (x & 0xFFFF));
+}
+
+
+// FNV-1a over the tile input
+GK_INLINE void hashBytes(UThash& hash, const void* p, UTsize len)
+{
+	const unsigned char* b = static_cast<const unsigned char*>(p);
+	for (UTsize i = 0; i < len; ++i)
+	{
+		hash ^= b[i];
+		hash *= 16777619U;
+	}
+}
+
+
+gkScalar lapMs(rcTimeVal& start)
+{
+	rcTimeVal now = rcGetPerformanceTimer();
+	gkScalar ms = rcGetDeltaTimeUsec(start, now) / 1000.0f;
+	start = now;
+	return ms;
+}
+
+
+void initConfig(rcConfig& cfg, const gkRecast::Config& config)
+{
+	memset(&cfg, 0, sizeof(rcConfig));
 
 	cfg.cs = config.CELL_SIZE;
 	cfg.ch = config.CELL_HEIGHT;
 
-	GK_ASSERT(cfg.ch && "cfg.ch cannot be zero");
+	GK_ASSERT(cfg.cs && "cfg.cs cannot be zero");
 	GK_ASSERT(cfg.ch && "cfg.ch cannot be zero");
 
 	cfg.walkableSlopeAngle = config.AGENT_MAX_SLOPE;
@@ -67,46 +115,40 @@ PDT_NAV_MESH gkRecast::createNavMesh(PMESHDATA meshData, const Config& config)
 	cfg.minRegionSize = (int)rcSqr(config.REGION_MIN_SIZE);
 	cfg.mergeRegionSize = (int)rcSqr(config.REGION_MERGE_SIZE);
 	cfg.maxVertsPerPoly = gkMin(config.VERTS_PER_POLY, DT_VERTS_PER_POLYGON);
-	cfg.tileSize = config.TILE_SIZE;
+	cfg.tileSize = gkMax(config.TILE_SIZE, 8);
 	cfg.borderSize = cfg.walkableRadius + 4; // Reserve enough padding.
+	cfg.width = cfg.tileSize + cfg.borderSize * 2;
+	cfg.height = cfg.tileSize + cfg.borderSize * 2;
 	cfg.detailSampleDist = config.DETAIL_SAMPLE_DIST < 0.9f ? 0 : cfg.cs * config.DETAIL_SAMPLE_DIST;
 	cfg.detailSampleMaxError = cfg.ch * config.DETAIL_SAMPLE_ERROR;
+}
 
-	if (!meshData->getVertCount())
-		return PDT_NAV_MESH(0);
 
-	gkScalar bmin[3], bmax[3];
+bool buildTile(const rcConfig& tileCfg, const gkMeshData& meshData, TileBuild& tile)
+{
+	rcConfig cfg = tileCfg;
 
-	const gkScalar* verts = meshData->getVerts();
-	int nverts = meshData->getVertCount();
-	const int* tris = meshData->getTris();
-	const gkScalar* trinorms = meshData->getNormals();
-	int ntris = meshData->getTriCount();
+	const gkScalar* verts = meshData.getVerts();
+	int nverts = meshData.getVertCount();
+	const int* tris = meshData.getTris();
+	int ntris = tile.tris.size();
 
-	rcCalcBounds(verts, nverts, bmin, bmax);
+	gkScalar border = cfg.borderSize * cfg.cs;
 
 	//
 	// Step 1. Initialize build config.
 	//
 
-	// Set the area where the navigation will be build.
-	// Here the bounds of the input mesh are used, but the
-	// area could be specified by an user defined box, etc.
-	rcVcopy(cfg.bmin, bmin);
-	rcVcopy(cfg.bmax, bmax);
-	rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
+	// The tile is built with a border so that the regions of neighbour
+	// tiles match, the border is cut off again from the poly mesh.
+	cfg.bmin[0] = tile.bmin[0] - border;
+	cfg.bmin[1] = tile.bmin[1];
+	cfg.bmin[2] = tile.bmin[2] - border;
+	cfg.bmax[0] = tile.bmax[0] + border;
+	cfg.bmax[1] = tile.bmax[1];
+	cfg.bmax[2] = tile.bmax[2] + border;
 
-	rcBuildTimes m_buildTimes;
-	// Reset build times gathering.
-	memset(&m_buildTimes, 0, sizeof(m_buildTimes));
-	rcSetBuildTimes(&m_buildTimes);
-
-	// Start the build process.
-	rcTimeVal totStartTime = rcGetPerformanceTimer();
-
-	//gkPrintf("Building navigation:");
-	//gkPrintf(" - %d x %d cells", cfg.width, cfg.height);
-	//gkPrintf(" - %.1fK verts, %.1fK tris", nverts/1000.0f, ntris/1000.0f);
+	rcTimeVal lap = rcGetPerformanceTimer();
 
 	//
 	// Step 2. Rasterize input polygon soup.
@@ -118,25 +160,32 @@ PDT_NAV_MESH gkRecast::createNavMesh(PMESHDATA meshData, const Config& config)
 	if (!rcCreateHeightfield(heightField, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch))
 	{
 		gkPrintf("buildNavigation: Could not create solid heightfield.");
-		return PDT_NAV_MESH(0);
+		return false;
 	}
 
 	{
-		// Allocate array that can hold triangle flags.
-		// If you have multiple meshes you need to process, allocate
-		// and array which can hold the max number of triangles you need to process.
+		utArray<int> tileTris;
+		tileTris.resize(ntris * 3);
+
+		for (int i = 0; i < ntris; ++i)
+		{
+			const int* t = tris + tile.tris[i] * 3;
+			tileTris[i*3]   = t[0];
+			tileTris[i*3+1] = t[1];
+			tileTris[i*3+2] = t[2];
+		}
 
 		utArray<unsigned char> triflags;
 		triflags.resize(ntris);
 
 		// Find triangles which are walkable based on their slope and rasterize them.
-		// If your input data is multiple meshes, you can transform them here, calculate
-		// the flags for each of the meshes and rasterize them.
 		memset(triflags.ptr(), 0, ntris * sizeof(unsigned char));
-		rcMarkWalkableTriangles(cfg.walkableSlopeAngle, verts, nverts, tris, ntris, triflags.ptr());
-		rcRasterizeTriangles(verts, nverts, tris, triflags.ptr(), ntris, heightField);
+		rcMarkWalkableTriangles(cfg.walkableSlopeAngle, verts, nverts, tileTris.ptr(), ntris, triflags.ptr());
+		rcRasterizeTriangles(verts, nverts, tileTris.ptr(), triflags.ptr(), ntris, heightField);
 	}
 
+	tile.stats.rasterizeMs += lapMs(lap);
+
 	//
 	// Step 3. Filter walkables surfaces.
 	//
@@ -147,6 +196,8 @@ PDT_NAV_MESH gkRecast::createNavMesh(PMESHDATA meshData, const Config& config)
 	rcFilterLedgeSpans(cfg.walkableHeight, cfg.walkableClimb, heightField);
 	rcFilterWalkableLowHeightSpans(cfg.walkableHeight, heightField);
 
+	tile.stats.filterMs += lapMs(lap);
+
 	//
 	// Step 4. Partition walkable surface to simple regions.
 	//
@@ -158,55 +209,46 @@ PDT_NAV_MESH gkRecast::createNavMesh(PMESHDATA meshData, const Config& config)
 	if (!rcBuildCompactHeightfield(cfg.walkableHeight, cfg.walkableClimb, RC_WALKABLE, heightField, chf))
 	{
 		gkPrintf("buildNavigation: Could not build compact data.");
-		return PDT_NAV_MESH(0);
+		return false;
 	}
 
 	// Erode the walkable area by agent radius.
 	if (!rcErodeArea(RC_WALKABLE_AREA, cfg.walkableRadius, chf))
 	{
 		gkPrintf("buildNavigation: Could not erode.");
-		return PDT_NAV_MESH(0);
+		return false;
 	}
 
 	//
 	// Mark areas from objects
 	//
 
-	gkScene* scene = gkEngine::getSingleton().getActiveScene();
-	gkGameObjectSet& objects = scene->getInstancedObjects();
-	gkGameObjectSet::Iterator it = objects.iterator();
-	while (it.hasMoreElements())
+	for (UTsize i = 0; i < tile.areas.size(); ++i)
 	{
-		gkGameObject* obj = it.getNext();
-
-		if (!obj->getNavData().isEmpty())
-		{
-			size_t tBaseIndex = obj->getNavData().triangleBaseIndex;
-			size_t vBaseIndex = tBaseIndex / 2;
-
-			const float* v = verts + vBaseIndex;
-			const int nVerts = obj->getNavData().nIndex / 3;
+		const gkMeshData::Area& area = meshData.areas[tile.areas[i]];
 
-			const gkGameObjectProperties& prop = obj->getProperties();
+		const float* v = verts + area.firstVert * 3;
 
-			rcMarkConvexPolyArea(v, nVerts, obj->getNavData().hmin, obj->getNavData().hmax, prop.m_findPathFlag, chf);
-		}
+		rcMarkConvexPolyArea(v, area.vertCount, area.hmin, area.hmax, area.flag, chf);
 	}
 
+	tile.stats.compactMs += lapMs(lap);
+
 	// Prepare for region partitioning, by calculating distance field along the walkable surface.
 	if (!rcBuildDistanceField(chf))
 	{
 		gkPrintf("buildNavigation: Could not build distance field.");
-		return PDT_NAV_MESH(0);
+		return false;
 	}
 
 	// Partition the walkable surface into simple regions without holes.
 	if (!rcBuildRegions(chf, cfg.borderSize, cfg.minRegionSize, cfg.mergeRegionSize))
 	{
 		gkPrintf("buildNavigation: Could not build regions.");
-		return PDT_NAV_MESH(0);
+		return false;
 	}
 
+	tile.stats.regionsMs += lapMs(lap);
 
 	//
 	// Step 5. Trace and simplify region contours.
@@ -218,9 +260,14 @@ PDT_NAV_MESH gkRecast::createNavMesh(PMESHDATA meshData, const Config& config)
 	if (!rcBuildContours(chf, cfg.maxSimplificationError, cfg.maxEdgeLen, cset))
 	{
 		gkPrintf("buildNavigation: Could not create contours.");
-		return PDT_NAV_MESH(0);
+		return false;
 	}
 
+	tile.stats.contoursMs += lapMs(lap);
+
+	// nothing walkable in this tile
+	if (!cset.nconts)
+		return true;
 
 	//
 	// Step 6. Build polygons mesh from contours.
@@ -231,9 +278,13 @@ PDT_NAV_MESH gkRecast::createNavMesh(PMESHDATA meshData, const Config& config)
 	if (!rcBuildPolyMesh(cset, cfg.maxVertsPerPoly, pmesh))
 	{
 		gkPrintf("buildNavigation: Could not triangulate contours.");
-		return PDT_NAV_MESH(0);
+		return false;
 	}
 
+	tile.stats.polyMeshMs += lapMs(lap);
+
+	if (!pmesh.npolys)
+		return true;
 
 	//
 	// Step 7. Create detail mesh which allows to access approximate height on each polygon.
@@ -244,17 +295,22 @@ PDT_NAV_MESH gkRecast::createNavMesh(PMESHDATA meshData, const Config& config)
 	if (!rcBuildPolyMeshDetail(pmesh, chf, cfg.detailSampleDist, cfg.detailSampleMaxError, dmesh))
 	{
 		gkPrintf("buildNavigation: Could not build detail mesh.");
-		return PDT_NAV_MESH(0);
+		return false;
 	}
 
-	// At this point the navigation mesh data is ready, you can access it from pmesh.
-	// See rcDebugDrawPolyMesh or dtCreateNavMeshData as examples how to access the data.
+	tile.stats.detailMeshMs += lapMs(lap);
 
 	//
 	// Step 8. Create Detour data from Recast poly mesh.
 	//
 
-	PDT_NAV_MESH navMesh;
+	// Remove the border, Detour finds the tile portals on the tile edges.
+	for (int i = 0; i < pmesh.nverts; ++i)
+	{
+		unsigned short* v = &pmesh.verts[i*3];
+		v[0] -= (unsigned short)cfg.borderSize;
+		v[2] -= (unsigned short)cfg.borderSize;
+	}
 
 	// Update poly flags from areas.
 	for (int i = 0; i < pmesh.npolys; ++i)
@@ -274,100 +330,478 @@ PDT_NAV_MESH gkRecast::createNavMesh(PMESHDATA meshData, const Config& config)
 	params.detailVertsCount = dmesh.nverts;
 	params.detailTris = dmesh.tris;
 	params.detailTriCount = dmesh.ntris;
-	/*        params.offMeshConVerts = m_geom->getOffMeshConnectionVerts();
-	    params.offMeshConRad = m_geom->getOffMeshConnectionRads();
-	    params.offMeshConDir = m_geom->getOffMeshConnectionDirs();
-	    params.offMeshConAreas = m_geom->getOffMeshConnectionAreas();
-	    params.offMeshConFlags = m_geom->getOffMeshConnectionFlags();
-	    params.offMeshConCount = m_geom->getOffMeshConnectionCount();
-	    */
 	params.walkableHeight = cfg.walkableHeight * cfg.ch;
-	params.walkableRadius = cfg.walkableRadius * cfg.cs;;
+	params.walkableRadius = cfg.walkableRadius * cfg.cs;
 	params.walkableClimb = cfg.walkableClimb * cfg.ch;
-	rcVcopy(params.bmin, pmesh.bmin);
-	rcVcopy(params.bmax, pmesh.bmax);
+	params.tileX = tile.x;
+	params.tileY = tile.y;
+	params.tileSize = cfg.tileSize;
+	rcVcopy(params.bmin, tile.bmin);
+	rcVcopy(params.bmax, tile.bmax);
 	params.cs = cfg.cs;
 	params.ch = cfg.ch;
 
-	unsigned char* navData = 0;
-	int navDataSize = 0;
-
-	if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
+	if (!dtCreateNavMeshData(&params, &tile.data, &tile.size))
 	{
 		gkPrintf("Could not build Detour navmesh.");
-		return PDT_NAV_MESH(0);
+		return false;
 	}
 
-	navMesh = PDT_NAV_MESH(new gkDetourNavMesh(new dtNavMesh));
+	tile.polys = pmesh.npolys;
+
+	tile.stats.detourMs += lapMs(lap);
+
+	return true;
+}
 
-	if (!navMesh->m_p->init(navData, navDataSize, DT_TILE_FREE_DATA, 2048))
+
+class gkRecastTileJob : public gkJob
+{
+public:
+	gkRecastTileJob(const rcConfig& cfg, const gkMeshData& meshData, TileBuild& tile)
+		:	m_cfg(cfg), m_meshData(meshData), m_tile(tile)
 	{
-		delete [] navData;
-		gkPrintf("Could not init Detour navmesh");
-		return PDT_NAV_MESH(0);
 	}
 
-	rcTimeVal totEndTime = rcGetPerformanceTimer();
+	void run(void)
+	{
+		m_tile.thread = gkJobSystem::getSingleton().getThreadIndex();
+		buildTile(m_cfg, m_meshData, m_tile);
+	}
 
-	gkPrintf("Navigation mesh created: %.1fms", rcGetDeltaTimeUsec(totStartTime, totEndTime) / 1000.0f);
+private:
+	const rcConfig& m_cfg;
+	const gkMeshData& m_meshData;
+	TileBuild& m_tile;
+};
 
-	return navMesh;
 }
 
-bool gkRecast::findPath(PDT_NAV_MESH navMesh, const gkVector3& from, const gkVector3& to, const gkVector3& polyPickExt, int maxPathPolys, PATH_POINTS& path, unsigned short includeFlags, unsigned short excludeFlags)
+
+PDT_NAV_MESH gkRecast::createNavMesh(PMESHDATA meshData, const Config& config)
 {
-	GK_ASSERT(!(includeFlags & excludeFlags) && "includeFlags with excludeFlags cannot overlap");
+	return createNavMesh(meshData, config, PRECAST_TILE_CACHE(new gkRecastTileCache));
+}
+
+PDT_NAV_MESH gkRecast::createNavMesh(PMESHDATA meshData, const Config& config, PRECAST_TILE_CACHE cache)
+{
+	if (!meshData.get() || !cache.get())
+		return PDT_NAV_MESH(0);
+
+	if (!meshData->getVertCount())
+		return PDT_NAV_MESH(0);
+
+	gkCriticalSection::Lock guard(cache->m_buildCs);
+
+	// tiles built with other settings are useless
+	if (!cache->m_hasConfig || memcmp(&cache->m_config, &config, sizeof(Config)) != 0)
+	{
+		cache->clearTiles();
+		cache->m_config = config;
+		cache->m_hasConfig = true;
+	}
 
-	if (navMesh.get() && navMesh->m_p)
+	rcConfig cfg;
+	initConfig(cfg, config);
+
+	BuildStats stats;
+
+	// Start the build process.
+	rcTimeVal totStartTime = rcGetPerformanceTimer();
+
+	const gkScalar* verts = meshData->getVerts();
+	int nverts = meshData->getVertCount();
+	const int* tris = meshData->getTris();
+	int ntris = meshData->getTriCount();
+
+	gkScalar bmin[3], bmax[3];
+	rcCalcBounds(verts, nverts, bmin, bmax);
+
+	// Tiles are laid out from the world origin, so a tile keeps its
+	// location and cached data when the bounds of the input change.
+	const gkScalar tileWidth = cfg.tileSize * cfg.cs;
+	const gkScalar border = cfg.borderSize * cfg.cs;
+
+	const int tx0 = (int)floorf((bmin[0] - border) / tileWidth);
+	const int ty0 = (int)floorf((bmin[2] - border) / tileWidth);
+	const int tx1 = (int)floorf((bmax[0] + border) / tileWidth);
+	const int ty1 = (int)floorf((bmax[2] + border) / tileWidth);
+	const int tw = tx1 - tx0 + 1;
+	const int th = ty1 - ty0 + 1;
+
+	if (tw > 0xFFFF || th > 0xFFFF || (double)tw * th > 1 << 20)
 	{
-		gkVector3 startPos(from);
-		gkVector3 endPos(to);
+		gkPrintf("buildNavigation: Too many tiles (%d x %d), increase the tile size.", tw, th);
+		return PDT_NAV_MESH(0);
+	}
 
-		std::swap(startPos.y, startPos.z);
-		std::swap(endPos.y, endPos.z);
+	//
+	// Assign the triangles and areas to the tiles they overlap, border included.
+	//
 
-		dtQueryFilter filter;
-		filter.includeFlags = includeFlags;
-		filter.excludeFlags = excludeFlags;
+	std::vector< std::vector<int> > triBuckets(tw * th), areaBuckets(tw * th);
 
-		dtPolyRef startRef = navMesh->m_p->findNearestPoly(startPos.ptr(), polyPickExt.ptr(), &filter, 0);
+	for (int i = 0; i < ntris; ++i)
+	{
+		const int* t = tris + i * 3;
+
+		gkScalar tmin[3], tmax[3];
+		rcVcopy(tmin, verts + t[0] * 3);
+		rcVcopy(tmax, tmin);
+		rcVmin(tmin, verts + t[1] * 3);
+		rcVmax(tmax, verts + t[1] * 3);
+		rcVmin(tmin, verts + t[2] * 3);
+		rcVmax(tmax, verts + t[2] * 3);
+
+		int x0 = (int)floorf((tmin[0] - border) / tileWidth) - tx0;
+		int y0 = (int)floorf((tmin[2] - border) / tileWidth) - ty0;
+		int x1 = (int)floorf((tmax[0] + border) / tileWidth) - tx0;
+		int y1 = (int)floorf((tmax[2] + border) / tileWidth) - ty0;
+
+		for (int y = gkMax(y0, 0); y <= gkMin(y1, th - 1); ++y)
+			for (int x = gkMax(x0, 0); x <= gkMin(x1, tw - 1); ++x)
+				triBuckets[y * tw + x].push_back(i);
+	}
 
-		dtPolyRef endRef = navMesh->m_p->findNearestPoly(endPos.ptr(), polyPickExt.ptr(), &filter, 0);
+	for (UTsize i = 0; i < meshData->areas.size(); ++i)
+	{
+		const gkMeshData::Area& area = meshData->areas[i];
+		if (area.vertCount < 3)
+			continue;
+
+		gkScalar amin[3], amax[3];
+		rcCalcBounds(verts + area.firstVert * 3, area.vertCount, amin, amax);
+
+		int x0 = (int)floorf((amin[0] - border) / tileWidth) - tx0;
+		int y0 = (int)floorf((amin[2] - border) / tileWidth) - ty0;
+		int x1 = (int)floorf((amax[0] + border) / tileWidth) - tx0;
+		int y1 = (int)floorf((amax[2] + border) / tileWidth) - ty0;
+
+		for (int y = gkMax(y0, 0); y <= gkMin(y1, th - 1); ++y)
+			for (int x = gkMax(x0, 0); x <= gkMin(x1, tw - 1); ++x)
+				areaBuckets[y * tw + x].push_back(i);
+	}
+
+	//
+	// Compare the tile input with the cache, only changed tiles are built.
+	//
 
-		if (startRef && endRef)
+	gkRecastTileCache::Tiles& cached = cache->m_tiles;
+
+	for (UTsize i = 0; i < cached.size(); ++i)
+		cached.at(i).used = false;
+
+	TileBuilds builds;
+
+	for (int y = 0; y < th; ++y)
+	{
+		for (int x = 0; x < tw; ++x)
 		{
-			utArray<dtPolyRef> polys;
-			polys.resize(maxPathPolys);
+			std::vector<int>& bucket = triBuckets[y * tw + x];
+			if (bucket.empty())
+				continue;
 
-			int npolys = navMesh->m_p->findPath(startRef, endRef, startPos.ptr(), endPos.ptr(), &filter, polys.ptr(), maxPathPolys);
+			++stats.tiles;
 
-			if (npolys > 1)
+			int tileX = tx0 + x, tileY = ty0 + y;
+
+			UThash hash = 2166136261U;
+			hashBytes(hash, &tileX, sizeof(int));
+			hashBytes(hash, &tileY, sizeof(int));
+
+			gkScalar ymin = BT_LARGE_FLOAT, ymax = -BT_LARGE_FLOAT;
+			for (UTsize i = 0; i < bucket.size(); ++i)
 			{
-				path.clear();
+				const int* t = tris + bucket[i] * 3;
+				for (int k = 0; k < 3; ++k)
+				{
+					const gkScalar* v = verts + t[k] * 3;
+					hashBytes(hash, v, sizeof(gkScalar) * 3);
+					ymin = gkMin(ymin, v[1]);
+					ymax = gkMax(ymax, v[1]);
+				}
+			}
+
+			const std::vector<int>& areas = areaBuckets[y * tw + x];
+			for (UTsize i = 0; i < areas.size(); ++i)
+			{
+				const gkMeshData::Area& area = meshData->areas[areas[i]];
+				hashBytes(hash, verts + area.firstVert * 3, sizeof(gkScalar) * 3 * area.vertCount);
+				hashBytes(hash, &area.hmin, sizeof(gkScalar));
+				hashBytes(hash, &area.hmax, sizeof(gkScalar));
+				hashBytes(hash, &area.flag, sizeof(unsigned char));
+			}
+
+			int key = tileKey(tileX, tileY);
+			UTsize pos = cached.find(key);
+			if (pos != UT_NPOS && cached.at(pos).hash == hash)
+			{
+				cached.at(pos).used = true;
+				continue;
+			}
 
-				utArray<gkScalar> straightPath;
-				straightPath.resize(maxPathPolys * 3);
+			TileBuild tile;
+			tile.x = tileX;
+			tile.y = tileY;
+			tile.hash = hash;
+			tile.bmin[0] = tileX * tileWidth;
+			tile.bmin[2] = tileY * tileWidth;
+			tile.bmax[0] = tile.bmin[0] + tileWidth;
+			tile.bmax[2] = tile.bmin[2] + tileWidth;
+
+			// on the global voxel grid, neighbour tiles quantize heights alike
+			tile.bmin[1] = floorf(ymin / cfg.ch) * cfg.ch;
+			tile.bmax[1] = ymax;
+
+			builds.push_back(tile);
+			builds.back().tris.swap(bucket);
+			builds.back().areas = areas;
+		}
+	}
 
-				int nstraightPath = navMesh->m_p->findStraightPath(startPos.ptr(), endPos.ptr(), polys.ptr(), npolys, straightPath.ptr(), 0, 0, maxPathPolys);
+	//
+	// Build the changed tiles, in parallel when there are workers.
+	//
 
-				std::swap(startPos.y, startPos.z);
-				std::swap(endPos.y, endPos.z);
+	gkJobSystem* jobs = gkJobSystem::getSingletonPtr();
+	if (jobs && jobs->getNumThreads() > 0 && builds.size() > 1)
+	{
+		gkJobCounter counter;
 
-				gkVector3 point;
+		for (UTsize i = 0; i < builds.size(); ++i)
+			jobs->submit(new gkRecastTileJob(cfg, *meshData.get(), builds[i]), &counter);
 
-				for (int i = 0; i < nstraightPath * 3; i += 3)
-				{
-					point.x = straightPath[i];
-					point.y = straightPath[i+2];
-					point.z = straightPath[i+1];
+		jobs->wait(counter);
 
-					path.push_back(point);
-				}
+		// the threads that took a tile, the caller may be a worker itself
+		utArray<int> used;
+		for (UTsize i = 0; i < builds.size(); ++i)
+		{
+			if (used.find(builds[i].thread) == UT_NPOS)
+				used.push_back(builds[i].thread);
+		}
+
+		stats.threads = (int)used.size();
+	}
+	else
+	{
+		for (UTsize i = 0; i < builds.size(); ++i)
+			buildTile(cfg, *meshData.get(), builds[i]);
+
+		stats.threads = 1;
+	}
+
+	for (UTsize i = 0; i < builds.size(); ++i)
+	{
+		TileBuild& tile = builds[i];
+
+		int key = tileKey(tile.x, tile.y);
+		UTsize pos = cached.find(key);
+		if (pos != UT_NPOS)
+		{
+			delete [] cached.at(pos).data;
+			cached.erase(key);
+		}
+
+		gkRecastTileCache::Tile entry = {tile.hash, tile.data, tile.size, tile.polys, true};
+		cached.insert(key, entry);
+
+		++stats.builtTiles;
+		stats.rasterizeMs  += tile.stats.rasterizeMs;
+		stats.filterMs     += tile.stats.filterMs;
+		stats.compactMs    += tile.stats.compactMs;
+		stats.regionsMs    += tile.stats.regionsMs;
+		stats.contoursMs   += tile.stats.contoursMs;
+		stats.polyMeshMs   += tile.stats.polyMeshMs;
+		stats.detailMeshMs += tile.stats.detailMeshMs;
+		stats.detourMs     += tile.stats.detourMs;
+	}
+
+	// drop the tiles which lost their geometry
+	utArray<int> unused;
+	for (UTsize i = 0; i < cached.size(); ++i)
+	{
+		if (!cached.at(i).used)
+			unused.push_back(cached.keyAt(i).key());
+	}
+
+	for (UTsize i = 0; i < unused.size(); ++i)
+	{
+		delete [] cached.get(unused[i])->data;
+		cached.erase(unused[i]);
+	}
+
+	//
+	// Assemble a new navigation mesh, the one in use is left untouched.
+	//
+
+	int nrTiles = 0, maxPolys = 1;
+	for (UTsize i = 0; i < cached.size(); ++i)
+	{
+		const gkRecastTileCache::Tile& tile = cached.at(i);
+		if (tile.data)
+		{
+			++nrTiles;
+			maxPolys = gkMax(maxPolys, tile.polys);
+			stats.polys += tile.polys;
+		}
+	}
+
+	PDT_NAV_MESH navMesh;
+
+	if (nrTiles)
+	{
+		dtNavMeshParams params;
+		memset(&params, 0, sizeof(params));
+		params.tileWidth = tileWidth;
+		params.tileHeight = tileWidth;
+		params.maxTiles = nrTiles;
+		params.maxPolys = maxPolys;
+		params.maxNodes = 2048;
+
+		navMesh = PDT_NAV_MESH(new gkDetourNavMesh(new dtNavMesh));
+
+		if (!navMesh->m_p->init(&params))
+		{
+			gkPrintf("Could not init Detour navmesh");
+			navMesh = PDT_NAV_MESH(0);
+		}
+		else
+		{
+			for (UTsize i = 0; i < cached.size(); ++i)
+			{
+				const gkRecastTileCache::Tile& tile = cached.at(i);
+				if (!tile.data)
+					continue;
 
-				return true;
+				// Detour links the tiles inside their data
+				unsigned char* data = new unsigned char[tile.size];
+				memcpy(data, tile.data, tile.size);
+
+				if (!navMesh->m_p->addTile(data, tile.size, DT_TILE_FREE_DATA))
+				{
+					delete [] data;
+					gkPrintf("Could not add Detour navmesh tile");
+				}
 			}
 		}
 	}
+	else
+		gkPrintf("buildNavigation: No walkable tiles.");
+
+	rcTimeVal totEndTime = rcGetPerformanceTimer();
+	stats.totalMs = rcGetDeltaTimeUsec(totStartTime, totEndTime) / 1000.0f;
+
+	{
+		gkCriticalSection::Lock statsGuard(cache->m_cs);
+		cache->m_stats = stats;
+	}
+
+	gkPrintf("Navigation mesh created: %.1fms, %d of %d tiles built on %d threads",
+	         stats.totalMs, stats.builtTiles, stats.tiles, stats.threads);
+
+	return navMesh;
+}
+
+
+gkRecastTileCache::gkRecastTileCache()
+	:	m_hasConfig(false)
+{
+}
+
+gkRecastTileCache::~gkRecastTileCache()
+{
+	clearTiles();
+}
+
+void gkRecastTileCache::clear(void)
+{
+	gkCriticalSection::Lock guard(m_buildCs);
+
+	clearTiles();
+	m_hasConfig = false;
+}
+
+void gkRecastTileCache::clearTiles(void)
+{
+	for (UTsize i = 0; i < m_tiles.size(); ++i)
+		delete [] m_tiles.at(i).data;
+
+	m_tiles.clear();
+}
+
+gkRecast::BuildStats gkRecastTileCache::getStats(void) const
+{
+	gkCriticalSection::Lock guard(m_cs);
+
+	return m_stats;
+}
+
+int gkRecast::findPath(PDT_NAV_MESH navMesh, const gkVector3& from, const gkVector3& to, const gkVector3& polyPickExt, int maxPathPolys, PathQuery& query, gkVector3* points, int maxPoints, unsigned short includeFlags, unsigned short excludeFlags)
+{
+	GK_ASSERT(!(includeFlags & excludeFlags) && "includeFlags with excludeFlags cannot overlap");
+	GK_ASSERT(points);
+
+	if (!navMesh.get() || !navMesh->m_p || maxPathPolys <= 0 || maxPoints <= 0)
+		return 0;
+
+	gkVector3 startPos(from);
+	gkVector3 endPos(to);
+
+	std::swap(startPos.y, startPos.z);
+	std::swap(endPos.y, endPos.z);
+
+	dtQueryFilter filter;
+	filter.includeFlags = includeFlags;
+	filter.excludeFlags = excludeFlags;
+
+	dtPolyRef startRef = navMesh->m_p->findNearestPoly(startPos.ptr(), polyPickExt.ptr(), &filter, 0);
+
+	dtPolyRef endRef = navMesh->m_p->findNearestPoly(endPos.ptr(), polyPickExt.ptr(), &filter, 0);
+
+	if (!startRef || !endRef)
+		return 0;
+
+	// only grows, so a reused query does not allocate
+	if ((int)query.polys.size() < maxPathPolys)
+		query.polys.resize(maxPathPolys);
+	if ((int)query.straightPath.size() < maxPoints * 3)
+		query.straightPath.resize(maxPoints * 3);
+
+	int npolys = navMesh->m_p->findPath(startRef, endRef, startPos.ptr(), endPos.ptr(), &filter, query.polys.ptr(), maxPathPolys);
+
+	if (npolys <= 1)
+		return 0;
+
+	int nstraightPath = navMesh->m_p->findStraightPath(startPos.ptr(), endPos.ptr(), query.polys.ptr(), npolys, query.straightPath.ptr(), 0, 0, maxPoints);
+
+	const gkScalar* straightPath = query.straightPath.ptr();
+
+	for (int i = 0; i < nstraightPath; ++i)
+	{
+		points[i].x = straightPath[i*3];
+		points[i].y = straightPath[i*3+2];
+		points[i].z = straightPath[i*3+1];
+	}
+
+	return nstraightPath;
+}
+
+bool gkRecast::findPath(PDT_NAV_MESH navMesh, const gkVector3& from, const gkVector3& to, const gkVector3& polyPickExt, int maxPathPolys, PATH_POINTS& path, unsigned short includeFlags, unsigned short excludeFlags)
+{
+	PathQuery query;
+
+	utArray<gkVector3> points;
+	points.resize(gkMax(maxPathPolys, 1));
+
+	int n = findPath(navMesh, from, to, polyPickExt, maxPathPolys, query, points.ptr(), maxPathPolys, includeFlags, excludeFlags);
+
+	if (n)
+	{
+		path.assign(points.ptr(), points.ptr() + n);
+
+		return true;
+	}
 
 	return false;
 }
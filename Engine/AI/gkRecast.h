@@ -29,8 +29,10 @@
 
 #include "gkCommon.h"
 #include "gkMeshData.h"
+#include "Thread/gkCriticalSection.h"
 
 class dtNavMesh;
+class gkRecastTileCache;
 
 struct gkDetourNavMesh : public gkReferences
 {
@@ -43,6 +45,7 @@ struct gkDetourNavMesh : public gkReferences
 
 typedef gkPtrRef<gkDetourNavMesh> PDT_NAV_MESH;
 typedef std::vector<gkVector3> PATH_POINTS;
+typedef gkPtrRef<gkRecastTileCache> PRECAST_TILE_CACHE;
 
 struct gkRecast
 {
@@ -82,11 +85,62 @@ struct gkRecast
 		}
 	};
 
+	struct BuildStats
+	{
+		int tiles;          // tiles holding input geometry
+		int builtTiles;     // rebuilt, the others came from the tile cache
+		int polys;
+		int threads;        // threads the tiles were built on
+
+		gkScalar totalMs;
+
+		// summed over the built tiles
+		gkScalar rasterizeMs;
+		gkScalar filterMs;
+		gkScalar compactMs;
+		gkScalar regionsMs;
+		gkScalar contoursMs;
+		gkScalar polyMeshMs;
+		gkScalar detailMeshMs;
+		gkScalar detourMs;
+
+		BuildStats() { memset(this, 0, sizeof(BuildStats)); }
+	};
+
+	// builds every tile
 	static PDT_NAV_MESH createNavMesh(
 	    PMESHDATA meshData,
 	    const Config& config
 	);
 
+	// only rebuilds the tiles whose input differs from the cached one
+	static PDT_NAV_MESH createNavMesh(
+	    PMESHDATA meshData,
+	    const Config& config,
+	    PRECAST_TILE_CACHE cache
+	);
+
+	// scratch buffers of path queries, kept from query to query
+	struct PathQuery
+	{
+		utArray<unsigned int> polys;
+		utArray<gkScalar> straightPath;
+	};
+
+	// writes at most maxPoints points, returns their number or zero without a path
+	static int findPath(
+	    PDT_NAV_MESH navMesh,
+	    const gkVector3& from,
+	    const gkVector3& to,
+	    const gkVector3& polyPickExt,
+	    int maxPathPolys,
+	    PathQuery& query,
+	    gkVector3* points,
+	    int maxPoints,
+	    unsigned short includeFlags = 0xffff,
+	    unsigned short excludeFlags = 0
+	);
+
 	static bool findPath(
 	    PDT_NAV_MESH navMesh,
 	    const gkVector3& from,
@@ -100,4 +154,41 @@ struct gkRecast
 
 };
 
+// Detour data of the tiles from the last build. Each navigation mesh
+// gets its own copy of the tiles, meshes handed out earlier stay valid.
+class gkRecastTileCache : public gkReferences, gkNonCopyable
+{
+public:
+	gkRecastTileCache();
+	~gkRecastTileCache();
+
+	void clear(void);
+
+	// of the last build, does not wait for a running one
+	gkRecast::BuildStats getStats(void) const;
+
+private:
+	friend struct gkRecast;
+
+	struct Tile
+	{
+		UThash hash;
+		unsigned char* data;
+		int size;
+		int polys;
+		bool used;
+	};
+
+	typedef utHashTable<utIntHashKey, Tile> Tiles;
+
+	void clearTiles(void);
+
+	gkCriticalSection m_buildCs;
+	mutable gkCriticalSection m_cs;
+	Tiles m_tiles;
+	gkRecast::Config m_config;
+	bool m_hasConfig;
+	gkRecast::BuildStats m_stats;
+};
+
 #endif//_gkRecast_h_
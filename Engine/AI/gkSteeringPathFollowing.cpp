@@ -28,6 +28,7 @@
 #include "gkSteeringPathFollowing.h"
 #include "OgreRoot.h"
 #include "gkGameObject.h"
+#include "gkScene.h"
 #include "gkNavMeshData.h"
 #include "gkLogger.h"
 
@@ -37,6 +38,8 @@ gkSteeringPathFollowing::gkSteeringPathFollowing(gkGameObject* obj, gkScalar max
 	: gkSteeringObject(obj, maxSpeed, forward, up, side),
 	  m_goalPosition(gkVector3::ZERO),
 	  m_goalRadius(0),
+	  m_pathQueue(0),
+	  m_pathRequest(0),
 	  m_polyPickExt(polyPickExt),
 	  m_maxPathPolys(maxPathPolys),
 	  m_minimumTurningRadius(minimumTurningRadius)
@@ -45,6 +48,7 @@ gkSteeringPathFollowing::gkSteeringPathFollowing(gkGameObject* obj, gkScalar max
 
 gkSteeringPathFollowing::~gkSteeringPathFollowing()
 {
+	releasePathRequest();
 }
 
 bool gkSteeringPathFollowing::inGoal() const
@@ -56,9 +60,56 @@ bool gkSteeringPathFollowing::inGoal() const
 
 bool gkSteeringPathFollowing::createPath()
 {
-	gkSteeringObject::reset();
+	gkScene* scene = m_obj->getOwner();
+
+	if (!scene)
+	{
+		gkSteeringObject::reset();
+
+		return m_navPath.create(m_navMesh, m_obj->getPosition(), m_goalPosition, m_polyPickExt, m_maxPathPolys, radius());
+	}
+
+	if (!m_pathRequest)
+	{
+		if (!m_navMesh.get())
+			return false;
+
+		gkSteeringObject::reset();
+
+		// answered by the scene in this or one of the next ticks
+		m_pathQueue = scene->getNavPathQueue();
+		m_pathRequest = m_pathQueue->request(m_navMesh, m_obj->getPosition(), m_goalPosition, m_polyPickExt, m_maxPathPolys);
+
+		return m_pathRequest != 0;
+	}
+
+	gkNavPathQueue::Status status = m_pathQueue->getStatus(m_pathRequest);
 
-	return m_navPath.create(m_navMesh, m_obj->getPosition(), m_goalPosition, m_polyPickExt, m_maxPathPolys, radius());
+	if (status == gkNavPathQueue::PS_QUEUED)
+		return true;
+
+	bool created = false;
+
+	if (status == gkNavPathQueue::PS_FOUND)
+	{
+		const gkVector3* points = 0;
+		int nrPoints = m_pathQueue->getPath(m_pathRequest, points);
+
+		created = m_navPath.create(points, nrPoints, radius());
+	}
+
+	releasePathRequest();
+
+	return created;
+}
+
+void gkSteeringPathFollowing::releasePathRequest()
+{
+	if (m_pathRequest)
+	{
+		m_pathQueue->release(m_pathRequest);
+		m_pathRequest = 0;
+	}
 }
 
 bool gkSteeringPathFollowing::steering(STATE& newState, const float elapsedTime)
@@ -117,6 +168,8 @@ bool gkSteeringPathFollowing::steering(STATE& newState, const float elapsedTime)
 
 void gkSteeringPathFollowing::reset()
 {
+	releasePathRequest();
+
 	m_navPath.clear();
 
 	gkSteeringObject::reset();
@@ -29,6 +29,7 @@
 
 #include "gkSteeringObject.h"
 #include "gkNavPath.h"
+#include "gkNavPathQueue.h"
 
 class gkSceneObstacle;
 class dtNavMesh;
@@ -66,6 +67,8 @@ private:
 
 	bool createPath();
 
+	void releasePathRequest();
+
 private:
 
 	PDT_NAV_MESH m_navMesh;
@@ -76,6 +79,11 @@ private:
 
 	gkNavPath m_navPath;
 
+	// pending request on the scene queue, the object must not outlive the scene
+	gkNavPathQueue* m_pathQueue;
+
+	gkNavPathQueue::Handle m_pathRequest;
+
 	gkVector3 m_polyPickExt;
 
 	int m_maxPathPolys;
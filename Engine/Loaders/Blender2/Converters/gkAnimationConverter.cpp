@@ -29,6 +29,7 @@
 #include "gkSkeletonManager.h"
 #include "gkBlenderDefines.h"
 #include "gkLoaderCommon.h"
+#include "Loaders/Blender2/gkBlendCache.h"
 
 
 #include "gkAnimation.h"
@@ -249,6 +250,9 @@ gkAnimation* gkAnimationLoader::convertObjectIpoToAnimation(Blender::Ipo* bipo,
 	if(!act)
 		return 0;
 	
+	if (m_cache && m_cache->loadAnimation(act, GKB_IDNAME(bipo)))
+		return act;
+	
 	gkObjectChannel* chan = new gkObjectChannel(GKB_IDNAME(bipo), act);
 	act->addChannel(chan);
 	
@@ -262,6 +266,9 @@ gkAnimation* gkAnimationLoader::convertObjectIpoToAnimation(Blender::Ipo* bipo,
 	// apply time range
 	act->setLength( (end-start)/animfps);
 	
+	if (m_cache)
+		m_cache->addAnimation(act, GKB_IDNAME(bipo));
+	
 	return act;
 }
 
@@ -298,6 +305,9 @@ void gkAnimationLoader::convertAction24(Blender::bAction* action, gkScalar animf
 	if(!act)
 		return;
 	
+	if (m_cache && m_cache->loadAnimation(act, GKB_IDNAME(action)))
+		return;
+	
 	// min/max
 	gkScalar start, end;
 	get24ActionStartEnd(action, start, end);
@@ -317,6 +327,9 @@ void gkAnimationLoader::convertAction24(Blender::bAction* action, gkScalar animf
 	
 	// apply time range
 	act->setLength( (end-start)/animfps);
+	
+	if (m_cache)
+		m_cache->addAnimation(act, GKB_IDNAME(action));
 }
 
 
@@ -327,6 +340,9 @@ void gkAnimationLoader::convertAction25(Blender::bAction* action, gkScalar animf
 	if(!act)
 		return;
 	
+	if (m_cache && m_cache->loadAnimation(act, GKB_IDNAME(action)))
+		return;
+	
 	// min/max
 	gkScalar start, end;
 	get25ActionStartEnd(action, start, end);
@@ -418,6 +434,9 @@ void gkAnimationLoader::convertAction25(Blender::bAction* action, gkScalar animf
 	
 	// apply time range
 	act->setLength( (end-start)/animfps);
+	
+	if (m_cache)
+		m_cache->addAnimation(act, GKB_IDNAME(action));
 }
 
 
@@ -30,9 +30,12 @@
 #include "Loaders/Blender2/gkBlendInternalFile.h"
 #include "gkMathUtils.h"
 
+class gkBlendCache;
+
 class gkAnimationLoader
 {
 	const gkResourceNameString	m_groupName;
+	gkBlendCache*				m_cache;
 
 	gkAnimation* convertObjectIpoToAnimation(Blender::Ipo* bipo, gkScalar animfps);
 	void convertAction24(Blender::bAction* action, gkScalar animfps);
@@ -41,7 +44,7 @@ class gkAnimationLoader
 
 public:
 
-	gkAnimationLoader(const gkResourceNameString& groupName="") : m_groupName(groupName) {}
+	gkAnimationLoader(const gkResourceNameString& groupName="", gkBlendCache* cache=0) : m_groupName(groupName), m_cache(cache) {}
 	~gkAnimationLoader() {}
 
 	void convertAction(Blender::bAction* action, bool pre25compat, gkScalar animfps);
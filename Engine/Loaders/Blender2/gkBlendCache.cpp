@@ -0,0 +1,1044 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "gkCommon.h"
+#include "gkBlendCache.h"
+#include "gkBlendInternalFile.h"
+#include "gkMesh.h"
+#include "gkSkeletonResource.h"
+#include "Animation/gkAnimation.h"
+#include "gkPath.h"
+#include "gkLogger.h"
+#include "gkEngine.h"
+#include "gkUserDefs.h"
+#include "utStreams.h"
+
+#if OGREKIT_USE_BPARSE == 0
+#include "fbtStreams.h"
+#endif
+
+#include <stdio.h>
+
+
+#define GK_BLEND_CACHE_MAGIC    UT_ID('G', 'K', 'B', 'C')
+#define GK_BLEND_CACHE_FORMAT   2
+#define GK_BLEND_CACHE_ALIGN    16
+
+
+enum gkBlendCacheOptions
+{
+	BCO_SORT_BY_MATERIAL    = (1 << 0),
+	BCO_GL_VERTEX_COLOR     = (1 << 1),
+};
+
+
+// On disk layout. Every offset is relative to the start of the file and
+// points to a 16 byte aligned block, strings are zero terminated.
+
+struct gkBlendCacheHeader
+{
+	UTuint32 m_magic;
+	UTuint32 m_format;
+	UTuint32 m_engine;          // GK_VERSION
+	UTuint32 m_layout;          // vertex, triangle, deform vertex and scalar sizes
+	UTuint32 m_options;         // gkBlendCacheOptions
+	UTuint32 m_keyLayout;       // bezier vertex size
+	UTuint32 m_nrMeshes;
+	UTuint32 m_nrAnimations;
+	UTuint32 m_nrSkeletons;
+	UTuint32 m_pad;
+	UTuint64 m_blendTime;
+	UTuint64 m_blendSize;
+	UTuint64 m_blendFile;       // string
+	UTuint64 m_meshes;          // gkBlendCacheMesh[m_nrMeshes]
+	UTuint64 m_animations;      // gkBlendCacheAnimation[m_nrAnimations]
+	UTuint64 m_skeletons;       // gkBlendCacheSkeleton[m_nrSkeletons]
+};
+
+
+struct gkBlendCacheMesh
+{
+	UTuint64 m_name;            // string
+	UTuint64 m_object;          // string, object the mesh was converted for
+	UTuint64 m_groups;          // string[m_nrGroups]
+	UTuint64 m_subMeshes;       // gkBlendCacheSubMesh[m_nrSubMeshes]
+	UTuint32 m_nrGroups;
+	UTuint32 m_nrSubMeshes;
+};
+
+
+struct gkBlendCacheSubMesh
+{
+	UTuint64 m_verts;           // gkVertex[m_nrVerts]
+	UTuint64 m_tris;            // gkTriangle[m_nrTris]
+	UTuint64 m_defVerts;        // gkDeformVertex[m_nrDefVerts]
+	UTuint64 m_material;        // gkBlendCacheMaterial
+	UTuint32 m_nrVerts;
+	UTuint32 m_nrTris;
+	UTuint32 m_nrDefVerts;
+	UTint32  m_uvLayers;
+	UTuint32 m_vertexColors;
+	UTuint32 m_pad;
+};
+
+
+struct gkBlendCacheTexture
+{
+	UTuint64 m_name;            // string
+	UTuint64 m_image;           // string
+	float    m_color[4];
+	UTint32  m_layer;
+	UTint32  m_type;
+	UTint32  m_blend;
+	UTint32  m_mode;
+	UTint32  m_texmode;
+	UTint32  m_pad;
+	gkScalar m_mix;
+	gkScalar m_normalFactor;
+	gkScalar m_diffuseColorFactor;
+	gkScalar m_diffuseAlpahFactor;
+	gkScalar m_speculaColorFactor;
+	gkScalar m_speculaHardFactor;
+	gkScalar m_scale[3];
+};
+
+
+struct gkBlendCacheMaterial
+{
+	UTuint64 m_name;            // string
+	UTuint64 m_textures;        // gkBlendCacheTexture[m_totaltex]
+	UTuint32 m_mode;
+	UTint32  m_rblend;
+	UTint32  m_totaltex;
+	UTint32  m_tangentLayer;
+	float    m_diffuse[4];
+	float    m_specular[4];
+	gkScalar m_hardness;
+	gkScalar m_refraction;
+	gkScalar m_emissive;
+	gkScalar m_ambient;
+	gkScalar m_spec;
+	gkScalar m_alpha;
+	gkScalar m_depthOffset;
+};
+
+
+enum gkBlendCacheChannelType
+{
+	BCC_OBJECT,
+	BCC_BONE,
+};
+
+
+struct gkBlendCacheSpline
+{
+	UTuint64 m_verts;           // akBezierVertex[m_nrVerts]
+	UTuint32 m_nrVerts;
+	UTint32  m_code;
+	UTint32  m_interpolation;
+	UTuint32 m_pad;
+};
+
+
+struct gkBlendCacheChannel
+{
+	UTuint64 m_name;            // string
+	UTuint64 m_splines;         // gkBlendCacheSpline[m_nrSplines]
+	UTuint32 m_nrSplines;
+	UTuint32 m_type;            // gkBlendCacheChannelType
+	UTuint32 m_euler;
+	UTuint32 m_pad;
+};
+
+
+struct gkBlendCacheAnimation
+{
+	UTuint64 m_name;            // string
+	UTuint64 m_channels;        // gkBlendCacheChannel[m_nrChannels]
+	UTuint32 m_nrChannels;
+	gkScalar m_length;
+};
+
+
+struct gkBlendCacheBone
+{
+	UTuint64 m_name;            // string
+	UTint32  m_parent;          // index of an earlier bone, -1 for roots
+	gkScalar m_loc[3];
+	gkScalar m_rot[4];          // w, x, y, z
+	gkScalar m_scl[3];
+};
+
+
+struct gkBlendCacheSkeleton
+{
+	UTuint64 m_name;            // string
+	UTuint64 m_bones;           // gkBlendCacheBone[m_nrBones], parents first
+	UTuint32 m_nrBones;
+	UTuint32 m_pad;
+};
+
+
+static UTuint32 gkBlendCacheLayout(void)
+{
+	// buffers are copied as is, so any change to these classes drops the cache
+	return  (UTuint32)sizeof(gkVertex)
+	        | (UTuint32)sizeof(gkTriangle) << 12
+	        | (UTuint32)sizeof(gkDeformVertex) << 20
+	        | (UTuint32)sizeof(gkScalar) << 28;
+}
+
+
+static void gkBlendCacheColor(float* dest, const gkColor& col)
+{
+	dest[0] = col.r;
+	dest[1] = col.g;
+	dest[2] = col.b;
+	dest[3] = col.a;
+}
+
+
+
+// Builds the cache file in memory, blocks are addressed by offset since
+// the buffer moves while it grows.
+class gkBlendCacheWriter
+{
+public:
+	utArray<char> m_buffer;
+
+	UTuint64 alloc(UTsize len)
+	{
+		UTsize size = m_buffer.size();
+		UTsize offs = (size + GK_BLEND_CACHE_ALIGN - 1) & ~(GK_BLEND_CACHE_ALIGN - 1);
+		UTsize end  = offs + len;
+
+		if (end > m_buffer.capacity())
+			m_buffer.reserve(gkMax<UTsize>(end, m_buffer.capacity() * 2));
+
+		m_buffer.resize(end);
+		memset(m_buffer.ptr() + size, 0, end - size);
+		return offs;
+	}
+
+	UTuint64 write(const void* src, UTsize len)
+	{
+		UTuint64 offs = alloc(len);
+		if (len > 0)
+			memcpy(m_buffer.ptr() + offs, src, len);
+		return offs;
+	}
+
+	UTuint64 writeString(const gkString& str)
+	{
+		return write(str.c_str(), (UTsize)str.size() + 1);
+	}
+
+	template<typename T>
+	T* at(UTuint64 offs)
+	{
+		return reinterpret_cast<T*>(m_buffer.ptr() + offs);
+	}
+
+
+	UTuint64 writeMaterial(const gkMaterialProperties& mat)
+	{
+		int i, totaltex = gkClamp<int>(mat.m_totaltex, 0, GK_MAX_TEXTURE);
+
+		UTuint64 textures = alloc(totaltex * sizeof(gkBlendCacheTexture));
+		for (i = 0; i < totaltex; ++i)
+		{
+			const gkTextureProperties& tex = mat.m_textures[i];
+
+			UTuint64 name  = writeString(tex.m_name);
+			UTuint64 image = writeString(tex.m_image);
+
+			gkBlendCacheTexture* dt = at<gkBlendCacheTexture>(textures) + i;
+			dt->m_name                  = name;
+			dt->m_image                 = image;
+			dt->m_layer                 = tex.m_layer;
+			dt->m_type                  = tex.m_type;
+			dt->m_blend                 = tex.m_blend;
+			dt->m_mode                  = tex.m_mode;
+			dt->m_texmode               = tex.m_texmode;
+			dt->m_mix                   = tex.m_mix;
+			dt->m_normalFactor          = tex.m_normalFactor;
+			dt->m_diffuseColorFactor    = tex.m_diffuseColorFactor;
+			dt->m_diffuseAlpahFactor    = tex.m_diffuseAlpahFactor;
+			dt->m_speculaColorFactor    = tex.m_speculaColorFactor;
+			dt->m_speculaHardFactor     = tex.m_speculaHardFactor;
+			dt->m_scale[0]              = tex.m_scale.x;
+			dt->m_scale[1]              = tex.m_scale.y;
+			dt->m_scale[2]              = tex.m_scale.z;
+			gkBlendCacheColor(dt->m_color, tex.m_color);
+		}
+
+		UTuint64 name = writeString(mat.m_name);
+		UTuint64 offs = alloc(sizeof(gkBlendCacheMaterial));
+
+		gkBlendCacheMaterial* dm = at<gkBlendCacheMaterial>(offs);
+		dm->m_name          = name;
+		dm->m_textures      = textures;
+		dm->m_mode          = mat.m_mode;
+		dm->m_rblend        = mat.m_rblend;
+		dm->m_totaltex      = totaltex;
+		dm->m_tangentLayer  = mat.m_tangentLayer;
+		dm->m_hardness      = mat.m_hardness;
+		dm->m_refraction    = mat.m_refraction;
+		dm->m_emissive      = mat.m_emissive;
+		dm->m_ambient       = mat.m_ambient;
+		dm->m_spec          = mat.m_spec;
+		dm->m_alpha         = mat.m_alpha;
+		dm->m_depthOffset   = mat.m_depthOffset;
+		gkBlendCacheColor(dm->m_diffuse, mat.m_diffuse);
+		gkBlendCacheColor(dm->m_specular, mat.m_specular);
+		return offs;
+	}
+
+
+	void writeMesh(UTuint64 dest, gkMesh* mesh, const gkString& meshName, const gkString& object)
+	{
+		UTsize i;
+
+		gkMesh::VertexGroups& groups = mesh->getGroups();
+		UTuint64 groupNames = alloc(groups.size() * sizeof(UTuint64));
+		for (i = 0; i < groups.size(); ++i)
+		{
+			UTuint64 name = writeString(groups[i]->getName());
+			at<UTuint64>(groupNames)[i] = name;
+		}
+
+		gkMesh::SubMeshArray& subMeshes = mesh->m_submeshes;
+		UTuint64 subs = alloc(subMeshes.size() * sizeof(gkBlendCacheSubMesh));
+		for (i = 0; i < subMeshes.size(); ++i)
+		{
+			gkSubMesh* sub = subMeshes[i];
+
+			gkSubMesh::Verticies&   verts    = sub->getVertexBuffer();
+			gkSubMesh::Triangles&   tris     = sub->getIndexBuffer();
+			gkSubMesh::DeformVerts& defVerts = sub->getDeformVertexBuffer();
+
+			UTuint64 vo = write(verts.ptr(),    verts.size() * sizeof(gkVertex));
+			UTuint64 to = write(tris.ptr(),     tris.size() * sizeof(gkTriangle));
+			UTuint64 dv = write(defVerts.ptr(), defVerts.size() * sizeof(gkDeformVertex));
+			UTuint64 mo = writeMaterial(sub->getMaterial());
+
+			gkBlendCacheSubMesh* ds = at<gkBlendCacheSubMesh>(subs) + i;
+			ds->m_verts         = vo;
+			ds->m_tris          = to;
+			ds->m_defVerts      = dv;
+			ds->m_material      = mo;
+			ds->m_nrVerts       = verts.size();
+			ds->m_nrTris        = tris.size();
+			ds->m_nrDefVerts    = defVerts.size();
+			ds->m_uvLayers      = sub->getUvLayerCount();
+			ds->m_vertexColors  = sub->hasVertexColors() ? 1 : 0;
+		}
+
+		UTuint64 name = writeString(meshName);
+		UTuint64 obj  = writeString(object);
+
+		gkBlendCacheMesh* dm = at<gkBlendCacheMesh>(dest);
+		dm->m_name          = name;
+		dm->m_object        = obj;
+		dm->m_groups        = groupNames;
+		dm->m_subMeshes     = subs;
+		dm->m_nrGroups      = groups.size();
+		dm->m_nrSubMeshes   = subMeshes.size();
+	}
+
+
+	void writeAnimation(UTuint64 dest, gkKeyedAnimation* act, const gkString& actName)
+	{
+		int i, s, nrChannels = act->getNumChannels();
+		akAnimationChannel* const* channels = act->getChannels();
+
+		UTuint64 chans = alloc(nrChannels * sizeof(gkBlendCacheChannel));
+		for (i = 0; i < nrChannels; ++i)
+		{
+			akAnimationChannel* chan = channels[i];
+			const akBezierSpline** splines = chan->getSplines();
+			int nrSplines = chan->getNumSplines();
+
+			UTuint64 spls = alloc(nrSplines * sizeof(gkBlendCacheSpline));
+			for (s = 0; s < nrSplines; ++s)
+			{
+				const akBezierSpline* spline = splines[s];
+				UTuint64 verts = write(spline->getVerts(), spline->getNumVerts() * sizeof(akBezierVertex));
+
+				gkBlendCacheSpline* ds = at<gkBlendCacheSpline>(spls) + s;
+				ds->m_verts         = verts;
+				ds->m_nrVerts       = spline->getNumVerts();
+				ds->m_code          = spline->getCode();
+				ds->m_interpolation = spline->getInterpolationMethod();
+			}
+
+			UTuint64 name = writeString(chan->getName());
+
+			gkTransformChannel* tchan = static_cast<gkTransformChannel*>(chan);
+			gkBlendCacheChannel* dc = at<gkBlendCacheChannel>(chans) + i;
+			dc->m_name      = name;
+			dc->m_splines   = spls;
+			dc->m_nrSplines = nrSplines;
+			dc->m_type      = dynamic_cast<gkBoneChannel*>(chan) ? BCC_BONE : BCC_OBJECT;
+			dc->m_euler     = tchan->isEulerRotation() ? 1 : 0;
+		}
+
+		UTuint64 name = writeString(actName);
+
+		gkBlendCacheAnimation* da = at<gkBlendCacheAnimation>(dest);
+		da->m_name          = name;
+		da->m_channels      = chans;
+		da->m_nrChannels    = nrChannels;
+		da->m_length        = act->getLength();
+	}
+
+
+	void writeSkeleton(UTuint64 dest, gkSkeletonResource* skel, const gkString& skelName)
+	{
+		gkBone::BoneList& bones = skel->getBoneList();
+
+		UTuint64 bo = alloc(bones.size() * sizeof(gkBlendCacheBone));
+		for (UTsize i = 0; i < bones.size(); ++i)
+		{
+			gkBone* bone = bones[i];
+			UTuint64 name = writeString(bone->getName());
+
+			// bones are created parents first, so the parent is always found before i
+			UTsize parent = bone->getParent() ? bones.find(bone->getParent()) : UT_NPOS;
+			const gkTransformState& rest = bone->getRest();
+
+			gkBlendCacheBone* db = at<gkBlendCacheBone>(bo) + i;
+			db->m_name      = name;
+			db->m_parent    = parent < i ? (UTint32)parent : -1;
+			db->m_loc[0]    = rest.loc.x;
+			db->m_loc[1]    = rest.loc.y;
+			db->m_loc[2]    = rest.loc.z;
+			db->m_rot[0]    = rest.rot.w;
+			db->m_rot[1]    = rest.rot.x;
+			db->m_rot[2]    = rest.rot.y;
+			db->m_rot[3]    = rest.rot.z;
+			db->m_scl[0]    = rest.scl.x;
+			db->m_scl[1]    = rest.scl.y;
+			db->m_scl[2]    = rest.scl.z;
+		}
+
+		UTuint64 name = writeString(skelName);
+
+		gkBlendCacheSkeleton* ds = at<gkBlendCacheSkeleton>(dest);
+		ds->m_name      = name;
+		ds->m_bones     = bo;
+		ds->m_nrBones   = bones.size();
+	}
+};
+
+
+
+gkBlendCache::gkBlendCache(const gkString& blendFile, const gkString& cacheDir)
+	:	m_blendFile(blendFile),
+		m_blendTime(0),
+		m_blendSize(0),
+		m_options(getConverterOptions()),
+		m_stream(0),
+		m_data(0),
+		m_dataSize(0),
+		m_dirty(false)
+{
+	for (int i = 0; i < BC_MAX; ++i)
+		m_hits[i] = m_misses[i] = 0;
+
+	gkPath blend(blendFile);
+	m_blendTime = blend.getModificationTime();
+	m_blendSize = (UTuint64)gkMax<int>(blend.getFileSize(), 0);
+
+	// one cache file per .blend path, the name keeps it readable
+	char hash[16];
+	sprintf(hash, ".%08x", (unsigned int)gkHashedString(blendFile).hash());
+
+	gkPath path(cacheDir);
+	path.append(blend.base() + hash + ".gkcache");
+	m_cacheFile = path.getPath();
+
+	gkPath image(cacheDir);
+	image.append(blend.base() + hash + ".gkimage");
+	m_imageFile = image.getPath();
+}
+
+
+gkBlendCache::~gkBlendCache()
+{
+	close();
+}
+
+
+UTuint32 gkBlendCache::getConverterOptions(void)
+{
+	gkUserDefs& defs = gkEngine::getSingleton().getUserDefs();
+
+	UTuint32 options = 0;
+	if (defs.blendermat)
+		options |= BCO_SORT_BY_MATERIAL;
+	if (defs.rendersystem == OGRE_RS_GL)
+		options |= BCO_GL_VERTEX_COLOR;
+	return options;
+}
+
+
+void gkBlendCache::close(void)
+{
+	delete m_stream;
+	m_stream = 0;
+	m_data = 0;
+	m_dataSize = 0;
+	for (int i = 0; i < BC_MAX; ++i)
+		m_index[i].clear();
+}
+
+
+bool gkBlendCache::findRecord(int kind, const gkString& name, UTuint64& offs)
+{
+	UTsize pos = m_data ? m_index[kind].find(name) : UT_NPOS;
+	if (pos == UT_NPOS)
+	{
+		++m_misses[kind];
+		return false;
+	}
+
+	offs = m_index[kind].at(pos);
+	return true;
+}
+
+
+void gkBlendCache::damaged(int kind)
+{
+	gkLogMessage("BlendCache: " << m_cacheFile << " is damaged, converting.");
+	close();
+	++m_misses[kind];
+}
+
+
+const void* gkBlendCache::getBlock(UTuint64 offs, UTuint64 nr, UTuint64 elemSize) const
+{
+	if (!m_data || (offs & (GK_BLEND_CACHE_ALIGN - 1)) != 0 || offs > m_dataSize)
+		return 0;
+	if (elemSize > 0 && nr > (m_dataSize - offs) / elemSize)
+		return 0;
+	return m_data + offs;
+}
+
+
+const char* gkBlendCache::getString(UTuint64 offs) const
+{
+	const char* str = (const char*)getBlock(offs, 1, 1);
+	if (!str || !memchr(str, 0, (size_t)(m_dataSize - offs)))
+		return 0;
+	return str;
+}
+
+
+bool gkBlendCache::load(void)
+{
+	close();
+
+	if (!gkPath(m_cacheFile).isFile())
+		return false;
+
+	m_stream = new gkBlendCacheStream();
+#if OGREKIT_USE_BPARSE
+	m_stream->open(m_cacheFile.c_str(), utStream::SM_READ);
+#else
+	m_stream->open(m_cacheFile.c_str(), fbtStream::SM_READ);
+#endif
+
+	if (!m_stream->isOpen() || m_stream->size() < sizeof(gkBlendCacheHeader))
+	{
+		close();
+		return false;
+	}
+
+	m_data     = (const char*)m_stream->ptr();
+	m_dataSize = (UTuint64)m_stream->size();
+
+	const gkBlendCacheHeader* hdr = (const gkBlendCacheHeader*)m_data;
+	const char* blendFile = getString(hdr->m_blendFile);
+
+	if (hdr->m_magic     != GK_BLEND_CACHE_MAGIC  ||
+	    hdr->m_format    != GK_BLEND_CACHE_FORMAT ||
+	    hdr->m_engine    != GK_VERSION            ||
+	    hdr->m_layout    != gkBlendCacheLayout()  ||
+	    hdr->m_keyLayout != sizeof(akBezierVertex) ||
+	    hdr->m_options   != m_options             ||
+	    hdr->m_blendTime != m_blendTime           ||
+	    hdr->m_blendSize != m_blendSize           ||
+	    !blendFile || m_blendFile != blendFile)
+	{
+		gkLogMessage("BlendCache: " << m_cacheFile << " is out of date.");
+		close();
+		return false;
+	}
+
+	const gkBlendCacheMesh* meshes = (const gkBlendCacheMesh*)getBlock(hdr->m_meshes, hdr->m_nrMeshes, sizeof(gkBlendCacheMesh));
+	const gkBlendCacheAnimation* anims = (const gkBlendCacheAnimation*)getBlock(hdr->m_animations, hdr->m_nrAnimations, sizeof(gkBlendCacheAnimation));
+	const gkBlendCacheSkeleton* skels = (const gkBlendCacheSkeleton*)getBlock(hdr->m_skeletons, hdr->m_nrSkeletons, sizeof(gkBlendCacheSkeleton));
+	if (!meshes || !anims || !skels)
+	{
+		close();
+		return false;
+	}
+
+	UTuint32 i;
+	const char* name;
+
+	for (i = 0; i < hdr->m_nrMeshes; ++i)
+	{
+		if ((name = getString(meshes[i].m_name)) != 0)
+			m_index[BC_MESH].insert(name, (UTsize)(hdr->m_meshes + i * sizeof(gkBlendCacheMesh)));
+	}
+
+	for (i = 0; i < hdr->m_nrAnimations; ++i)
+	{
+		if ((name = getString(anims[i].m_name)) != 0)
+			m_index[BC_ANIMATION].insert(name, (UTsize)(hdr->m_animations + i * sizeof(gkBlendCacheAnimation)));
+	}
+
+	for (i = 0; i < hdr->m_nrSkeletons; ++i)
+	{
+		if ((name = getString(skels[i].m_name)) != 0)
+			m_index[BC_SKELETON].insert(name, (UTsize)(hdr->m_skeletons + i * sizeof(gkBlendCacheSkeleton)));
+	}
+	return true;
+}
+
+
+gkString gkBlendCache::getImageKey(void) const
+{
+	// the image holds Blender data only, the converter options do not matter
+	char buf[64];
+	sprintf(buf, "|%u|%llu|%llu", (unsigned int)GK_VERSION, (unsigned long long)m_blendTime, (unsigned long long)m_blendSize);
+	return m_blendFile + buf;
+}
+
+
+bool gkBlendCache::loadImage(gkBlendInternalFile* file)
+{
+	if (gkPath(m_imageFile).isFile() && file->parseImage(m_imageFile, getImageKey()))
+	{
+		m_hits[BC_IMAGE]++;
+		return true;
+	}
+
+	m_misses[BC_IMAGE]++;
+	return false;
+}
+
+
+bool gkBlendCache::saveImage(gkBlendInternalFile* file)
+{
+#if OGREKIT_USE_BPARSE
+	// bParse files have no image
+	return false;
+#endif
+
+	// write aside and swap, like save
+	gkString temp = m_imageFile + ".tmp";
+
+	bool ok = file->writeImage(temp, getImageKey());
+
+	remove(m_imageFile.c_str());
+	if (!ok || rename(temp.c_str(), m_imageFile.c_str()) != 0)
+	{
+		remove(temp.c_str());
+		gkLogMessage("BlendCache: Unable to write " << m_imageFile << ".");
+		return false;
+	}
+	return true;
+}
+
+
+bool gkBlendCache::loadMesh(gkMesh* mesh, const gkString& name, const gkString& object)
+{
+	GK_ASSERT(mesh && mesh->m_submeshes.empty());
+
+	UTuint64 offs;
+	if (!findRecord(BC_MESH, name, offs))
+		return false;
+
+	const gkBlendCacheMesh* rec = (const gkBlendCacheMesh*)(m_data + offs);
+
+	// deform groups and materials come from the object the mesh was first converted for
+	const char* cachedObject = getString(rec->m_object);
+	if (!cachedObject || object != cachedObject)
+	{
+		++m_misses[BC_MESH];
+		return false;
+	}
+
+	const UTuint64* groups = (const UTuint64*)getBlock(rec->m_groups, rec->m_nrGroups, sizeof(UTuint64));
+	const gkBlendCacheSubMesh* subs = (const gkBlendCacheSubMesh*)getBlock(rec->m_subMeshes, rec->m_nrSubMeshes, sizeof(gkBlendCacheSubMesh));
+
+	bool valid = groups && subs;
+	UTuint32 i;
+	int t;
+
+	// validate everything first, so a damaged file never leaves a half filled mesh
+	for (i = 0; valid && i < rec->m_nrGroups; ++i)
+		valid = getString(groups[i]) != 0;
+
+	for (i = 0; valid && i < rec->m_nrSubMeshes; ++i)
+	{
+		const gkBlendCacheSubMesh& sub = subs[i];
+		const gkBlendCacheMaterial* mat = (const gkBlendCacheMaterial*)getBlock(sub.m_material, 1, sizeof(gkBlendCacheMaterial));
+
+		valid = getBlock(sub.m_verts, sub.m_nrVerts, sizeof(gkVertex)) &&
+		        getBlock(sub.m_tris, sub.m_nrTris, sizeof(gkTriangle)) &&
+		        getBlock(sub.m_defVerts, sub.m_nrDefVerts, sizeof(gkDeformVertex)) &&
+		        mat && getString(mat->m_name) &&
+		        mat->m_totaltex >= 0 && mat->m_totaltex <= GK_MAX_TEXTURE;
+
+		const gkBlendCacheTexture* texs = valid ? (const gkBlendCacheTexture*)getBlock(mat->m_textures, mat->m_totaltex, sizeof(gkBlendCacheTexture)) : 0;
+		valid = valid && texs;
+
+		for (t = 0; valid && t < mat->m_totaltex; ++t)
+			valid = getString(texs[t].m_name) && getString(texs[t].m_image);
+	}
+
+	if (!valid)
+	{
+		damaged(BC_MESH);
+		return false;
+	}
+
+
+	for (i = 0; i < rec->m_nrGroups; ++i)
+		mesh->createVertexGroup(getString(groups[i]));
+
+	for (i = 0; i < rec->m_nrSubMeshes; ++i)
+	{
+		const gkBlendCacheSubMesh& src = subs[i];
+		gkSubMesh* sub = new gkSubMesh();
+
+		gkSubMesh::Verticies&   verts    = sub->getVertexBuffer();
+		gkSubMesh::Triangles&   tris     = sub->getIndexBuffer();
+		gkSubMesh::DeformVerts& defVerts = sub->getDeformVertexBuffer();
+
+		verts.resize(src.m_nrVerts);
+		tris.resize(src.m_nrTris);
+		defVerts.resize(src.m_nrDefVerts);
+
+		if (src.m_nrVerts > 0)
+			memcpy(verts.ptr(), m_data + src.m_verts, src.m_nrVerts * sizeof(gkVertex));
+		if (src.m_nrTris > 0)
+			memcpy(tris.ptr(), m_data + src.m_tris, src.m_nrTris * sizeof(gkTriangle));
+		if (src.m_nrDefVerts > 0)
+			memcpy(defVerts.ptr(), m_data + src.m_defVerts, src.m_nrDefVerts * sizeof(gkDeformVertex));
+
+		sub->setTotalLayers(src.m_uvLayers);
+		sub->setVertexColors(src.m_vertexColors != 0);
+
+
+		const gkBlendCacheMaterial* sm = (const gkBlendCacheMaterial*)(m_data + src.m_material);
+		const gkBlendCacheTexture* texs = (const gkBlendCacheTexture*)(m_data + sm->m_textures);
+		gkMaterialProperties& mat = sub->getMaterial();
+
+		mat.m_name          = getString(sm->m_name);
+		mat.m_mode          = sm->m_mode;
+		mat.m_rblend        = sm->m_rblend;
+		mat.m_totaltex      = sm->m_totaltex;
+		mat.m_tangentLayer  = sm->m_tangentLayer;
+		mat.m_hardness      = sm->m_hardness;
+		mat.m_refraction    = sm->m_refraction;
+		mat.m_emissive      = sm->m_emissive;
+		mat.m_ambient       = sm->m_ambient;
+		mat.m_spec          = sm->m_spec;
+		mat.m_alpha         = sm->m_alpha;
+		mat.m_depthOffset   = sm->m_depthOffset;
+		mat.m_diffuse       = gkColor(sm->m_diffuse[0], sm->m_diffuse[1], sm->m_diffuse[2], sm->m_diffuse[3]);
+		mat.m_specular      = gkColor(sm->m_specular[0], sm->m_specular[1], sm->m_specular[2], sm->m_specular[3]);
+
+		for (t = 0; t < sm->m_totaltex; ++t)
+		{
+			const gkBlendCacheTexture& st = texs[t];
+			gkTextureProperties& tex = mat.m_textures[t];
+
+			tex.m_name                  = getString(st.m_name);
+			tex.m_image                 = getString(st.m_image);
+			tex.m_color                 = gkColor(st.m_color[0], st.m_color[1], st.m_color[2], st.m_color[3]);
+			tex.m_layer                 = st.m_layer;
+			tex.m_type                  = st.m_type;
+			tex.m_blend                 = st.m_blend;
+			tex.m_mode                  = st.m_mode;
+			tex.m_texmode               = st.m_texmode;
+			tex.m_mix                   = st.m_mix;
+			tex.m_normalFactor          = st.m_normalFactor;
+			tex.m_diffuseColorFactor    = st.m_diffuseColorFactor;
+			tex.m_diffuseAlpahFactor    = st.m_diffuseAlpahFactor;
+			tex.m_speculaColorFactor    = st.m_speculaColorFactor;
+			tex.m_speculaHardFactor     = st.m_speculaHardFactor;
+			tex.m_scale                 = gkVector3(st.m_scale[0], st.m_scale[1], st.m_scale[2]);
+		}
+
+		mesh->addSubMesh(sub);
+	}
+
+	Entry entry = {mesh, name, object};
+	m_meshes.push_back(entry);
+	++m_hits[BC_MESH];
+	return true;
+}
+
+
+void gkBlendCache::addMesh(gkMesh* mesh, const gkString& name, const gkString& object)
+{
+	Entry entry = {mesh, name, object};
+	m_meshes.push_back(entry);
+	m_dirty = true;
+}
+
+
+bool gkBlendCache::loadAnimation(gkKeyedAnimation* act, const gkString& name)
+{
+	GK_ASSERT(act && act->getNumChannels() == 0);
+
+	UTuint64 offs;
+	if (!findRecord(BC_ANIMATION, name, offs))
+		return false;
+
+	const gkBlendCacheAnimation* rec = (const gkBlendCacheAnimation*)(m_data + offs);
+	const gkBlendCacheChannel* chans = (const gkBlendCacheChannel*)getBlock(rec->m_channels, rec->m_nrChannels, sizeof(gkBlendCacheChannel));
+
+	bool valid = chans != 0;
+	UTuint32 i, s;
+
+	for (i = 0; valid && i < rec->m_nrChannels; ++i)
+	{
+		const gkBlendCacheChannel& chan = chans[i];
+		const gkBlendCacheSpline* spls = (const gkBlendCacheSpline*)getBlock(chan.m_splines, chan.m_nrSplines, sizeof(gkBlendCacheSpline));
+
+		valid = spls && getString(chan.m_name) && chan.m_type <= BCC_BONE;
+
+		for (s = 0; valid && s < chan.m_nrSplines; ++s)
+		{
+			valid = getBlock(spls[s].m_verts, spls[s].m_nrVerts, sizeof(akBezierVertex)) &&
+			        spls[s].m_interpolation >= akBezierSpline::BEZ_LINEAR &&
+			        spls[s].m_interpolation <= akBezierSpline::BEZ_CUBIC;
+		}
+	}
+
+	if (!valid)
+	{
+		damaged(BC_ANIMATION);
+		return false;
+	}
+
+
+	for (i = 0; i < rec->m_nrChannels; ++i)
+	{
+		const gkBlendCacheChannel& src = chans[i];
+		const gkBlendCacheSpline* spls = (const gkBlendCacheSpline*)(m_data + src.m_splines);
+
+		gkTransformChannel* chan;
+		if (src.m_type == BCC_BONE)
+			chan = new gkBoneChannel(getString(src.m_name), act);
+		else
+			chan = new gkObjectChannel(getString(src.m_name), act);
+
+		chan->setEulerRotation(src.m_euler != 0);
+		act->addChannel(chan);
+
+		for (s = 0; s < src.m_nrSplines; ++s)
+		{
+			akBezierSpline* spline = new akBezierSpline(spls[s].m_code);
+			spline->setInterpolationMethod((akBezierSpline::BezierInterpolation)spls[s].m_interpolation);
+
+			const akBezierVertex* verts = (const akBezierVertex*)(m_data + spls[s].m_verts);
+			for (UTuint32 v = 0; v < spls[s].m_nrVerts; ++v)
+				spline->addVertex(verts[v]);
+
+			chan->addSpline(spline);
+		}
+	}
+
+	act->setLength(rec->m_length);
+
+	AnimationEntry entry = {act, name};
+	m_animations.push_back(entry);
+	++m_hits[BC_ANIMATION];
+	return true;
+}
+
+
+void gkBlendCache::addAnimation(gkKeyedAnimation* act, const gkString& name)
+{
+	akAnimationChannel* const* channels = act->getChannels();
+	for (int i = 0; i < act->getNumChannels(); ++i)
+	{
+		if (!dynamic_cast<gkBoneChannel*>(channels[i]) && !dynamic_cast<gkObjectChannel*>(channels[i]))
+			return;
+	}
+
+	AnimationEntry entry = {act, name};
+	m_animations.push_back(entry);
+	m_dirty = true;
+}
+
+
+bool gkBlendCache::loadSkeleton(gkSkeletonResource* skel, const gkString& name)
+{
+	GK_ASSERT(skel && skel->getBoneList().empty());
+
+	UTuint64 offs;
+	if (!findRecord(BC_SKELETON, name, offs))
+		return false;
+
+	const gkBlendCacheSkeleton* rec = (const gkBlendCacheSkeleton*)(m_data + offs);
+	const gkBlendCacheBone* bones = (const gkBlendCacheBone*)getBlock(rec->m_bones, rec->m_nrBones, sizeof(gkBlendCacheBone));
+
+	bool valid = bones != 0;
+	UTuint32 i;
+
+	for (i = 0; valid && i < rec->m_nrBones; ++i)
+		valid = getString(bones[i].m_name) && bones[i].m_parent < (UTint32)i;
+
+	if (!valid)
+	{
+		damaged(BC_SKELETON);
+		return false;
+	}
+
+
+	gkBone::BoneList created;
+	created.resize(rec->m_nrBones);
+
+	for (i = 0; i < rec->m_nrBones; ++i)
+	{
+		const gkBlendCacheBone& src = bones[i];
+
+		// zero for a name used twice
+		gkBone* bone = created[i] = skel->createBone(getString(src.m_name));
+		if (!bone)
+			continue;
+
+		if (src.m_parent >= 0 && created[src.m_parent])
+			bone->setParent(created[src.m_parent]);
+
+		bone->setRestPosition(gkTransformState(
+		                          gkVector3(src.m_loc[0], src.m_loc[1], src.m_loc[2]),
+		                          gkQuaternion(src.m_rot[0], src.m_rot[1], src.m_rot[2], src.m_rot[3]),
+		                          gkVector3(src.m_scl[0], src.m_scl[1], src.m_scl[2])));
+	}
+
+	SkeletonEntry entry = {skel, name};
+	m_skeletons.push_back(entry);
+	++m_hits[BC_SKELETON];
+	return true;
+}
+
+
+void gkBlendCache::addSkeleton(gkSkeletonResource* skel, const gkString& name)
+{
+	SkeletonEntry entry = {skel, name};
+	m_skeletons.push_back(entry);
+	m_dirty = true;
+}
+
+
+bool gkBlendCache::save(void)
+{
+	if (!m_dirty)
+		return true;
+
+	gkBlendCacheWriter writer;
+
+	UTuint64 header    = writer.alloc(sizeof(gkBlendCacheHeader));
+	UTuint64 blendFile = writer.writeString(m_blendFile);
+	UTuint64 meshes    = writer.alloc(m_meshes.size() * sizeof(gkBlendCacheMesh));
+	UTuint64 anims     = writer.alloc(m_animations.size() * sizeof(gkBlendCacheAnimation));
+	UTuint64 skels     = writer.alloc(m_skeletons.size() * sizeof(gkBlendCacheSkeleton));
+
+	UTsize i;
+	for (i = 0; i < m_meshes.size(); ++i)
+	{
+		const Entry& entry = m_meshes[i];
+		writer.writeMesh(meshes + i * sizeof(gkBlendCacheMesh), entry.m_mesh, entry.m_name, entry.m_object);
+	}
+
+	for (i = 0; i < m_animations.size(); ++i)
+	{
+		const AnimationEntry& entry = m_animations[i];
+		writer.writeAnimation(anims + i * sizeof(gkBlendCacheAnimation), entry.m_animation, entry.m_name);
+	}
+
+	for (i = 0; i < m_skeletons.size(); ++i)
+	{
+		const SkeletonEntry& entry = m_skeletons[i];
+		writer.writeSkeleton(skels + i * sizeof(gkBlendCacheSkeleton), entry.m_skeleton, entry.m_name);
+	}
+
+	gkBlendCacheHeader* hdr = writer.at<gkBlendCacheHeader>(header);
+	hdr->m_magic        = GK_BLEND_CACHE_MAGIC;
+	hdr->m_format       = GK_BLEND_CACHE_FORMAT;
+	hdr->m_engine       = GK_VERSION;
+	hdr->m_layout       = gkBlendCacheLayout();
+	hdr->m_keyLayout    = sizeof(akBezierVertex);
+	hdr->m_options      = m_options;
+	hdr->m_nrMeshes     = m_meshes.size();
+	hdr->m_nrAnimations = m_animations.size();
+	hdr->m_nrSkeletons  = m_skeletons.size();
+	hdr->m_blendTime    = m_blendTime;
+	hdr->m_blendSize    = m_blendSize;
+	hdr->m_blendFile    = blendFile;
+	hdr->m_meshes       = meshes;
+	hdr->m_animations   = anims;
+	hdr->m_skeletons    = skels;
+
+	// the mapping has to go before the file is replaced
+	close();
+
+	// write aside and swap, so a crash never leaves a truncated cache behind
+	gkString temp = m_cacheFile + ".tmp";
+
+	utFileStream fs;
+	fs.open(temp.c_str(), utStream::SM_WRITE);
+	if (!fs.isOpen())
+	{
+		gkLogMessage("BlendCache: Unable to write " << temp << ".");
+		return false;
+	}
+
+	UTsize size = writer.m_buffer.size();
+	bool ok = fs.write(writer.m_buffer.ptr(), size) == size;
+	fs.close();
+
+	remove(m_cacheFile.c_str());
+	if (!ok || rename(temp.c_str(), m_cacheFile.c_str()) != 0)
+	{
+		remove(temp.c_str());
+		gkLogMessage("BlendCache: Unable to write " << m_cacheFile << ".");
+		return false;
+	}
+
+	m_dirty = false;
+	return true;
+}
@@ -0,0 +1,160 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkBlendCache_h_
+#define _gkBlendCache_h_
+
+#include "gkLoaderCommon.h"
+#include "gkHashedString.h"
+
+#if OGREKIT_USE_BPARSE
+class utMemoryStream;
+typedef utMemoryStream  gkBlendCacheStream;
+#else
+class fbtMappedStream;
+typedef fbtMappedStream gkBlendCacheStream;
+#endif
+
+
+// Cooked mesh, animation and skeleton cache for one .blend file.
+//
+// The linked Blender data goes in a second file, an image fbtFile maps back
+// without the DNA pass, so a hit skips fbtBlend::parse. The scene, logic
+// brick and material conversions then run on the mapped data as usual.
+//
+// Converted vertex, index and deform buffers plus the sub mesh materials,
+// the bezier splines of keyed animations and the rest poses of skeletons are
+// stored as 16 byte aligned, offset indexed blocks, so a later load maps the
+// file and copies the buffers straight into gkSubMesh, akBezierSpline and
+// gkBone. The cache is dropped when the .blend path, size, modification time,
+// engine version or any converter option the meshes depend on changes.
+class gkBlendCache
+{
+public:
+	enum Kind
+	{
+		BC_MESH,
+		BC_ANIMATION,
+		BC_SKELETON,
+		BC_IMAGE,
+		BC_MAX,
+	};
+
+public:
+	gkBlendCache(const gkString& blendFile, const gkString& cacheDir);
+	~gkBlendCache();
+
+	// Maps the cache file, false when there is none or it is stale.
+	bool load(void);
+
+	// Rewrites the cache when anything was converted since load.
+	bool save(void);
+
+	// Parses the .blend from its data image, false when it has to be parsed.
+	bool loadImage(gkBlendInternalFile* file);
+
+	// Writes the data image of a freshly parsed .blend.
+	bool saveImage(gkBlendInternalFile* file);
+
+	// Fills an empty mesh from the cache, false when it has to be converted.
+	bool loadMesh(gkMesh* mesh, const gkString& name, const gkString& object);
+
+	// Records a freshly converted mesh for the next save.
+	void addMesh(gkMesh* mesh, const gkString& name, const gkString& object);
+
+	// Fills an animation without channels, false when it has to be converted.
+	bool loadAnimation(gkKeyedAnimation* act, const gkString& name);
+
+	// Records a freshly converted animation for the next save, animations
+	// with other than bone or object channels are left out.
+	void addAnimation(gkKeyedAnimation* act, const gkString& name);
+
+	// Fills a skeleton without bones, false when it has to be converted.
+	bool loadSkeleton(gkSkeletonResource* skel, const gkString& name);
+
+	// Records a freshly converted skeleton for the next save.
+	void addSkeleton(gkSkeletonResource* skel, const gkString& name);
+
+	GK_INLINE const gkString& getCacheFile(void) const      {return m_cacheFile;}
+	GK_INLINE const gkString& getImageFile(void) const      {return m_imageFile;}
+	GK_INLINE UTsize          getHits(int kind) const       {return m_hits[kind];}
+	GK_INLINE UTsize          getMisses(int kind) const     {return m_misses[kind];}
+
+	static UTuint32 getConverterOptions(void);
+
+private:
+
+	struct Entry
+	{
+		gkMesh*  m_mesh;
+		gkString m_name;
+		gkString m_object;
+	};
+
+	struct AnimationEntry
+	{
+		gkKeyedAnimation* m_animation;
+		gkString          m_name;
+	};
+
+	struct SkeletonEntry
+	{
+		gkSkeletonResource* m_skeleton;
+		gkString            m_name;
+	};
+
+	typedef utArray<Entry>                      Entries;
+	typedef utArray<AnimationEntry>             AnimationEntries;
+	typedef utArray<SkeletonEntry>              SkeletonEntries;
+	typedef utHashTable<gkHashedString, UTsize> Index;
+
+	void        close(void);
+	gkString    getImageKey(void) const;
+	bool        findRecord(int kind, const gkString& name, UTuint64& offs);
+	void        damaged(int kind);
+	const char* getString(UTuint64 offs) const;
+	const void* getBlock(UTuint64 offs, UTuint64 nr, UTuint64 elemSize) const;
+
+	gkString            m_blendFile;
+	gkString            m_cacheFile;
+	gkString            m_imageFile;
+	UTuint64            m_blendTime;
+	UTuint64            m_blendSize;
+	UTuint32            m_options;
+
+	gkBlendCacheStream* m_stream;
+	const char*         m_data;
+	UTuint64            m_dataSize;
+	Index               m_index[BC_MAX];    // name to record offset
+
+	Entries             m_meshes;
+	AnimationEntries    m_animations;
+	SkeletonEntries     m_skeletons;
+	bool                m_dirty;
+	UTsize              m_hits[BC_MAX], m_misses[BC_MAX];
+};
+
+#endif//_gkBlendCache_h_
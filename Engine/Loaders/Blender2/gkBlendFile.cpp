@@ -34,6 +34,7 @@
 
 #include "gkBlendInternalFile.h"
 #include "gkBlendFile.h"
+#include "gkBlendCache.h"
 #include "gkBlendLoader.h"
 #include "gkSceneManager.h"
 #include "gkScene.h"
@@ -75,6 +76,7 @@ gkBlendFile::gkBlendFile(const gkString& blendToLoad, const gkString& group)
 		m_findScene(""),
 		m_hasBFont(false),
 		m_file(0),
+		m_cache(0),
 		m_memoryBlend(0),
 		m_memoryBlendSize(0)
 {
@@ -88,6 +90,7 @@ gkBlendFile::gkBlendFile(const void* mem, int size, const gkString& group)
 		m_findScene(""),
 		m_hasBFont(false),
 		m_file(0),
+		m_cache(0),
 		m_memoryBlend(mem),
 		m_memoryBlendSize(size)
 
@@ -110,13 +113,29 @@ bool gkBlendFile::parse(int opts, const gkString& scene)
 {	
 	m_file = new gkBlendInternalFile();
 
+	gkUserDefs& defs = gkEngine::getSingleton().getUserDefs();
+	if (!m_name.empty() && !defs.blendCachePath.empty())
+	{
+		m_cache = new gkBlendCache(m_name, defs.blendCachePath);
+		m_cache->load();
+	}
+
 	if (!m_name.empty())
 	{
-		if (!m_file->parse(m_name))
+		// the data image skips the DNA pass, it is taken before any conversion
+		if (!m_cache || !m_cache->loadImage(m_file))
 		{
-			delete m_file;
-			m_file = 0;
-			return false;
+			if (!m_file->parse(m_name))
+			{
+				delete m_cache;
+				m_cache = 0;
+				delete m_file;
+				m_file = 0;
+				return false;
+			}
+
+			if (m_cache)
+				m_cache->saveImage(m_file);
 		}
 	}
 	else
@@ -138,6 +157,20 @@ bool gkBlendFile::parse(int opts, const gkString& scene)
 	else
 		createInstances();
 
+	if (m_cache)
+	{
+		gkLogMessage("BlendCache: data " << (m_cache->getHits(gkBlendCache::BC_IMAGE) ? "mapped" : "parsed") << ", meshes "
+		             << m_cache->getHits(gkBlendCache::BC_MESH) << " cached, "
+		             << m_cache->getMisses(gkBlendCache::BC_MESH) << " converted, animations "
+		             << m_cache->getHits(gkBlendCache::BC_ANIMATION) << " cached, "
+		             << m_cache->getMisses(gkBlendCache::BC_ANIMATION) << " converted, skeletons "
+		             << m_cache->getHits(gkBlendCache::BC_SKELETON) << " cached, "
+		             << m_cache->getMisses(gkBlendCache::BC_SKELETON) << " converted.");
+		m_cache->save();
+		delete m_cache;
+		m_cache = 0;
+	}
+
 	delete m_file;
 	m_file = 0;
 	return true;
@@ -497,7 +530,7 @@ void gkBlendFile::buildAllFonts(void)
 
 void gkBlendFile::buildAllActions(void)
 {
-	gkAnimationLoader anims(m_group);
+	gkAnimationLoader anims(m_group, m_cache);
 		
     gkBlendListIterator iter = m_file->getActionList();
 	anims.convertActions(iter, m_file->getVersion() <= 249, m_animFps);
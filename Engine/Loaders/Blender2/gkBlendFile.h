@@ -34,6 +34,7 @@
 
 //class fbtBlend;
 class gkBlendInternalFile;
+class gkBlendCache;
 
 class gkBlendFile
 {
@@ -63,6 +64,9 @@ public:
 
 	gkBlendInternalFile* _getInternalFile(void) {GK_ASSERT(m_file); return m_file;}
 
+	///Cooked mesh, animation and skeleton cache, only set during parse when gkUserDefs::blendCachePath is set.
+	gkBlendCache* _getCache(void) {return m_cache;}
+
 	///Access to the original group name. Used for placing created resources in the same group.
 	GK_INLINE const gkString& getResourceGroup(void) {return m_group;}
 
@@ -89,6 +93,7 @@ protected:
 	const gkString				m_group;			// resource group
 	float						m_animFps;				
 	gkBlendInternalFile*		m_file;
+	gkBlendCache*				m_cache;
 	Scenes						m_scenes;			// All Scenes
 	gkScene*					m_activeScene;		// Main scene found during parse.
 	ImageTextureHashMap			m_imageLookup;
@@ -28,6 +28,7 @@
 
 #include "gkBlenderDefines.h"
 #include "gkBlenderSceneConverter.h"
+#include "gkBlendCache.h"
 #include "Converters/gkAnimationConverter.h"
 #include "Converters/gkLogicBrickConverter.h"
 #include "Converters/gkMeshConverter.h"
@@ -787,7 +788,7 @@ void gkBlenderSceneConverter::convertObjectLogic(gkGameObject* gobj, Blender::Ob
 
 void gkBlenderSceneConverter::convertObjectAnimations(gkGameObject* gobj, Blender::Object* bobj, gkScalar animfps)
 {
-	gkAnimationLoader anims(m_groupName);
+	gkAnimationLoader anims(m_groupName, m_file->_getCache());
 	int version = m_file->_getInternalFile()->getVersion();
 
 	anims.convertObject(gobj, bobj, version <= 249, animfps);
@@ -874,8 +875,15 @@ void gkBlenderSceneConverter::convertObjectMesh(gkGameObject* gobj, Blender::Obj
 	{
 		props.m_mesh = m_gscene->createMesh(GKB_IDNAME(me));
 
-		gkBlenderMeshConverter meconv(props.m_mesh, bobj, me);
-		meconv.convert();
+		gkBlendCache* cache = m_file->_getCache();
+		if (!cache || !cache->loadMesh(props.m_mesh, GKB_IDNAME(me), GKB_IDNAME(bobj)))
+		{
+			gkBlenderMeshConverter meconv(props.m_mesh, bobj, me);
+			meconv.convert();
+
+			if (cache)
+				cache->addMesh(props.m_mesh, GKB_IDNAME(me), GKB_IDNAME(bobj));
+		}
 	}
 	else
 		props.m_mesh = m_gscene->getMesh(GKB_IDNAME(me));
@@ -941,7 +949,15 @@ void gkBlenderSceneConverter::convertObjectArmature(gkGameObject* gobj, Blender:
 	else
 	{
 		gkSkeletonResource* resource = gkSkeletonManager::getSingleton().create<gkSkeletonResource>(skelName);
-		convertObjectSkeleton(resource, bobj);
+
+		gkBlendCache* cache = m_file->_getCache();
+		if (!cache || !cache->loadSkeleton(resource, GKB_IDNAME(bobj)))
+		{
+			convertObjectSkeleton(resource, bobj);
+
+			if (cache)
+				cache->addSkeleton(resource, GKB_IDNAME(bobj));
+		}
 		static_cast<gkSkeleton*>(gobj)->_setInternalSkeleton(resource);
 	}
 }
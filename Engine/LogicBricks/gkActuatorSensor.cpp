@@ -34,7 +34,7 @@
 
 
 gkActuatorSensor::gkActuatorSensor(gkGameObject* object, gkLogicLink* link, const gkString& name)
-	:    gkLogicSensor(object, link, name), m_actuatorName("")
+	:    gkLogicSensor(object, link, name), m_actuatorName(""), m_actuator(0)
 {
 	m_dispatchType = DIS_CONSTANT;
 	connect();
@@ -44,6 +44,7 @@ gkActuatorSensor::gkActuatorSensor(gkGameObject* object, gkLogicLink* link, cons
 gkLogicBrick* gkActuatorSensor::clone(gkLogicLink* link, gkGameObject* dest)
 {
 	gkActuatorSensor* sens = new gkActuatorSensor(*this);
+	sens->m_actuator = 0;
 	sens->cloneImpl(link, dest);
 	return sens;
 }
@@ -51,6 +52,13 @@ gkLogicBrick* gkActuatorSensor::clone(gkLogicLink* link, gkGameObject* dest)
 
 bool gkActuatorSensor::query(void)
 {
-	gkLogicActuator* act = m_object->getLogicBricks()->findActuator(m_actuatorName);
-	return act->isPulseOn();
+	if (!m_actuator)
+		m_actuator = m_object->getLogicBricks()->findActuator(m_actuatorName);
+	return m_actuator->isPulseOn();
+}
+
+
+bool gkActuatorSensor::isQueryUnchanged(void)
+{
+	return m_actuator && m_actuator->isPulseOn() == m_positive;
 }
@@ -34,6 +34,10 @@ class gkActuatorSensor : public gkLogicSensor
 {
 private:
 	gkString m_actuatorName;
+	gkLogicActuator* m_actuator;
+
+protected:
+	bool isQueryUnchanged(void);
 
 public:
 	gkActuatorSensor(gkGameObject* object, gkLogicLink* link, const gkString& name);
@@ -32,6 +32,10 @@
 
 class gkAlwaysSensor : public gkLogicSensor
 {
+protected:
+
+	GK_INLINE bool isQueryUnchanged(void) {return true;}
+
 public:
 
 	gkAlwaysSensor(gkGameObject* object, gkLogicLink* link, const gkString& name);
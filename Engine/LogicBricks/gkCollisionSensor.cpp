@@ -50,7 +50,7 @@ void gkCollisionDispatch::dispatch(void)
 
 
 gkCollisionSensor::gkCollisionSensor(gkGameObject* object, gkLogicLink* link, const gkString& name)
-	:       gkLogicSensor(object, link, name), m_material(""), m_prop("")
+	:       gkLogicSensor(object, link, name)
 {
 	m_dispatchType = DIS_COLLISION;
 	connect();
@@ -73,7 +73,7 @@ bool gkCollisionSensor::query(void)
 		return false;
 
 	bool isTouchSensorTODO = false;
-	return object->sensorCollides(m_prop, m_material, isTouchSensorTODO, isTouchSensorTODO,&m_colObjList);
+	return object->sensorCollides(m_filter, isTouchSensorTODO, isTouchSensorTODO,&m_colObjList);
 	//OLD-CALL: Just query if there is a collision! What objects collide is not registered
-	//return object->sensorCollides(m_prop, m_material, isTouchSensorTODO, isTouchSensorTODO);
+	//return object->sensorCollides(m_filter, isTouchSensorTODO, isTouchSensorTODO);
 }
@@ -30,6 +30,7 @@
 #include "gkLogicSensor.h"
 #include "gkLogicDispatcher.h"
 #include "Physics/gkDynamicsWorld.h"
+#include "Physics/gkSensorFilter.h"
 
 
 class gkCollisionDispatch : public gkAbstractDispatcher
@@ -46,7 +47,7 @@ class gkCollisionSensor : public gkLogicSensor
 {
 protected:
 	utArray<gkGameObject*> m_colObjList;
-	gkString m_material, m_prop;
+	gkSensorFilter m_filter;
 
 
 public:
@@ -58,10 +59,10 @@ public:
 
 	bool query(void);
 
-	GK_INLINE void            setMaterial(const gkString& material)       {m_material = material;}
-	GK_INLINE void            setProperty(const gkString& prop)           {m_prop = prop;}
-	GK_INLINE const gkString& getMaterial(void)                     const {return m_material;}
-	GK_INLINE const gkString& getProperty(void)                     const {return m_prop;}
+	GK_INLINE void            setMaterial(const gkString& material)       {m_filter.setMaterial(material);}
+	GK_INLINE void            setProperty(const gkString& prop)           {m_filter.setProperty(prop);}
+	GK_INLINE const gkString& getMaterial(void)                     const {return m_filter.getMaterial();}
+	GK_INLINE const gkString& getProperty(void)                     const {return m_filter.getProperty();}
 	GK_INLINE const int 	  getHitObjectCount(void)               const {return m_colObjList.size();}
 	GK_INLINE const utArray<gkGameObject*> getHitObjects(void)      const {return m_colObjList;}
 	GK_INLINE  gkGameObject*  getHitObject(int nr)                        {return (nr<(int)m_colObjList.size()) ? m_colObjList[nr] : NULL;}
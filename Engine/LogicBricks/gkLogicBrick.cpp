@@ -31,7 +31,8 @@
 
 gkLogicBrick::gkLogicBrick(gkGameObject* object, gkLogicLink* link, const gkString& name)
 	:       m_object(object), m_name(name), m_link(link), m_stateMask(0), m_pulseState(BM_IDLE),
-	        m_debugMask(0), m_isActive(false), m_priority(0), m_listener(0)
+	        m_debugMask(0), m_isActive(false), m_priority(0), m_listener(0),
+	        m_activeIndex(UT_NPOS), m_tickStamp(0)
 {
 	GK_ASSERT(m_object);
 	m_scene = m_object->getOwner();
@@ -42,6 +43,18 @@ gkLogicBrick::~gkLogicBrick()
 {
 }
 
+
+void* gkLogicBrick::operator new(size_t size)
+{
+	return gkLogicManager::allocBrick(size);
+}
+
+
+void gkLogicBrick::operator delete(void* p, size_t size)
+{
+	gkLogicManager::freeBrick(p, size);
+}
+
 void gkLogicBrick::cloneImpl(gkLogicLink* link, gkGameObject* dest)
 {
 	m_object        = dest;
@@ -49,6 +62,8 @@ void gkLogicBrick::cloneImpl(gkLogicLink* link, gkGameObject* dest)
 	m_pulseState    = BM_IDLE;
 	m_isActive      = false;
 	m_link          = link;
+	m_activeIndex   = UT_NPOS;
+	m_tickStamp     = 0;
 
 	m_link->getLogicManager()->notifySort();
 }
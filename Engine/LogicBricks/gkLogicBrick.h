@@ -93,6 +93,11 @@ protected:
 	int                 m_priority;
 	Listener*           m_listener;
 
+	// gkLogicManager bookkeeping, position in the active controller/actuator
+	// array and the last tick the pulse was set, both O(1) to test
+	UTsize              m_activeIndex;
+	UTuint32            m_tickStamp;
+
 	virtual void        cloneImpl(gkLogicLink* link, gkGameObject* dest);
 	virtual void        notifyActiveStatus(void) {}
 
@@ -101,6 +106,10 @@ public:
 	gkLogicBrick(gkGameObject* object, gkLogicLink* link, const gkString& name);
 	virtual ~gkLogicBrick();
 
+	// bricks live in gkLogicManager's slabs instead of the general heap
+	static void* operator new(size_t size);
+	static void  operator delete(void* p, size_t size);
+
 	bool inActiveState(void) const;
 
 	bool wantsDebug(void) const;
@@ -133,6 +142,11 @@ public:
 	GK_INLINE gkLogicLink*      getLink(void)             { return m_link; }
 	GK_INLINE int               getPriority(void)   const { return m_priority;}
 
+	GK_INLINE UTsize            _getActiveIndex(void) const { return m_activeIndex; }
+	GK_INLINE void              _setActiveIndex(UTsize v)   { m_activeIndex = v; }
+	GK_INLINE UTuint32          _getTickStamp(void)   const { return m_tickStamp; }
+	GK_INLINE void              _setTickStamp(UTuint32 v)   { m_tickStamp = v; }
+
 	void setPriority(bool v);
 	void setPriority(int v);
 
@@ -34,6 +34,8 @@
 
 void gkAbstractDispatcher::doDispatch(SensorList& senslist)
 {
+	m_evaluated = 0;
+
 	if (!senslist.empty())
 	{
 		SensorList::Iterator it = senslist.iterator();
@@ -42,8 +44,11 @@ void gkAbstractDispatcher::doDispatch(SensorList& senslist)
 			gkLogicSensor*   sens = it.getNext();
 			gkGameObject*    obj = sens->getObject();
 
-			if (obj && obj->isInstanced())
+			if (obj && obj->isInstanced() && !sens->isSleeping())
+			{
 				sens->execute();
+				++m_evaluated;
+			}
 		}
 	}
 }
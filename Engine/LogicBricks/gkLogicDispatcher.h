@@ -42,11 +42,12 @@ public:
 
 protected:
 	SensorList m_sensors;
+	UTsize     m_evaluated;
 
 	void doDispatch(SensorList& senslist);
 
 public:
-	gkAbstractDispatcher() {}
+	gkAbstractDispatcher() : m_evaluated(0) {}
 	virtual ~gkAbstractDispatcher() {}
 
 	virtual void dispatch(void) = 0;
@@ -58,6 +59,10 @@ public:
 	GK_INLINE void disconnect(gkLogicSensor* sens)   {GK_ASSERT(sens); m_sensors.erase(sens); }
 	GK_INLINE void clear(void)                       {m_sensors.clear(); }
 
+	GK_INLINE UTsize getNumSensors(void)       const {return m_sensors.size(); }
+	///Number of sensors executed by the last dispatch, sleeping sensors are skipped.
+	GK_INLINE UTsize getNumEvaluated(void)     const {return m_evaluated; }
+
 };
 
 
@@ -60,6 +60,20 @@ gkLogicLink::~gkLogicLink()
 	}
 }
 
+
+
+void* gkLogicLink::operator new(size_t size)
+{
+	return gkLogicManager::allocBrick(size);
+}
+
+
+void gkLogicLink::operator delete(void* p, size_t size)
+{
+	gkLogicManager::freeBrick(p, size);
+}
+
+
 gkLogicLink* gkLogicLink::cloneToScene(gkGameObject* dest, gkScene* scene) {
 	m_cloneScene = scene;
 	gkLogicLink* clone = this->clone(dest);
@@ -64,6 +64,10 @@ public:
 	gkLogicLink(gkLogicManager* lmgr);
 	~gkLogicLink();
 
+	// shares the logic brick slabs, see gkLogicManager::allocBrick
+	static void* operator new(size_t size);
+	static void  operator delete(void* p, size_t size);
+
 	gkLogicLink*     clone(gkGameObject* dest);
 	gkLogicLink* 	 cloneToScene(gkGameObject* dest,gkScene* scene);
 	void            destroyInstance(void);
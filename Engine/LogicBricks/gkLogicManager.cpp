@@ -36,6 +36,8 @@
 #include "gkLogger.h"
 #include "gkDebugScreen.h"
 #include "gkEngine.h"
+#include "Thread/gkCriticalSection.h"
+#include "utMemoryPool.h"
 
 
 
@@ -43,6 +45,7 @@
 gkLogicManager::gkLogicManager()
 {
 	m_sort = true;
+	m_tick = 1;
 	m_dispatchers = new gkAbstractDispatcherPtr[DIS_MAX];
 	m_dispatchers[DIS_CONSTANT]     = new gkConstantDispatch;
 	m_dispatchers[DIS_KEY]          = new gkKeyDispatch;
@@ -131,8 +134,7 @@ void gkLogicManager::clearActive(gkLogicLink* link)
 			cont->notifyLinkDestroyed();
 
 
-			if ((fnd = m_cin.find(cont)) != UT_NPOS)
-				m_cin.erase(fnd);
+			eraseActive(cont, m_cin);
 		}
 
 		iter = utListIterator<gkLogicLink::BrickList>(link->getActuators());
@@ -145,8 +147,7 @@ void gkLogicManager::clearActive(gkLogicLink* link)
 			act->setPulse(BM_OFF);
 			act->notifyLinkDestroyed();
 
-			if ((fnd = m_ain.find(act)) != UT_NPOS)
-				m_ain.erase(fnd);
+			eraseActive(act, m_ain);
 			if (( fnd = m_aout.find(act)) != UT_NPOS)
 				m_aout.erase(fnd);
 		}
@@ -205,9 +206,9 @@ void gkLogicManager::push(gkLogicController* ctrl, gkLogicActuator* act, bool st
 #endif
 
 
-		if (!m_tickActuators.find(act))
+		if (act->_getTickStamp() != m_tick)
 		{
-			m_tickActuators.push_back(act);
+			act->_setTickStamp(m_tick);
 			act->setPulse(stateValue ? BM_ON : BM_OFF);
 		}
 		else if (stateValue)
@@ -218,7 +219,7 @@ void gkLogicManager::push(gkLogicController* ctrl, gkLogicActuator* act, bool st
 		if (!act->isActive())
 		{
 			act->setActive(true);
-			m_ain.push_back(act);
+			pushActive(act, m_ain);
 		}
 
 	}
@@ -232,11 +233,36 @@ void gkLogicManager::push(gkLogicBrick* a, gkLogicBrick* b, Bricks& in, bool sta
 	if (!a->isActive())
 	{
 		a->setActive(true);
-		in.push_back(a);
+		pushActive(a, in);
 	}
 }
 
 
+void gkLogicManager::pushActive(gkLogicBrick* b, Bricks& in)
+{
+	GK_ASSERT(b->_getActiveIndex() == UT_NPOS);
+	b->_setActiveIndex(in.size());
+	in.push_back(b);
+}
+
+
+void gkLogicManager::eraseActive(gkLogicBrick* b, Bricks& in)
+{
+	UTsize pos = b->_getActiveIndex();
+	if (pos == UT_NPOS)
+		return;
+
+	GK_ASSERT(pos < in.size() && in[pos] == b);
+
+	// utArray::erase swaps with the last element, keep its index in sync
+	UTsize last = in.size() - 1;
+	if (pos != last)
+		in[last]->_setActiveIndex(pos);
+	in.erase(pos);
+	b->_setActiveIndex(UT_NPOS);
+}
+
+
 void gkLogicManager::notifyState(unsigned int state, gkLogicLink* link)
 {
 	if (!m_ain.empty())
@@ -325,7 +351,7 @@ void gkLogicManager::clearActuators(void)
 				dsPrintf("Pop:  Actuator %s\n", b[i]->getName().c_str());
 #endif
 			b[i]->setActive(false);
-			m_ain.erase(b[i]);
+			eraseActive(b[i], m_ain);
 			++i;
 		}
 		m_aout.clear(true);
@@ -333,9 +359,30 @@ void gkLogicManager::clearActuators(void)
 		if (m_ain.empty())
 			m_ain.clear(true);
 	}
-	m_tickActuators.clear();
+
+	// invalidates every actuator stamp, 0 is reserved for unstamped bricks
+	if (++m_tick == 0)
+		m_tick = 1;
+}
+
+UTsize gkLogicManager::getNumSensors(void) const
+{
+	UTsize i = 0, s = 0;
+	while (i < DIS_MAX)
+		s += m_dispatchers[i++]->getNumSensors();
+	return s;
+}
+
+
+UTsize gkLogicManager::getNumEvaluatedSensors(void) const
+{
+	UTsize i = 0, s = 0;
+	while (i < DIS_MAX)
+		s += m_dispatchers[i++]->getNumEvaluated();
+	return s;
 }
 
+
 void gkLogicManager::sort(void)
 {
 	if (m_dispatchers)
@@ -372,6 +419,7 @@ void gkLogicManager::update(gkScalar delta)
 		{
 			static_cast<gkLogicController*>(b[i])->_execute();
 			b[i]->setActive(false);
+			b[i]->_setActiveIndex(UT_NPOS);
 			++i;
 		}
 		m_cin.clear(true);
@@ -413,3 +461,29 @@ gkLogicManager* gkLogicManager::getSingletonPtr(void){
 }
 
 gkLogicManager::LogicManagerList* gkLogicManager::m_logicManagers = new LogicManagerList();
+
+
+
+static gkCriticalSection gBrickAllocLock;
+
+
+utSmallObjectAllocator& gkLogicManager::getBrickAllocator(void)
+{
+	// constructed on first use, bricks can be created before any manager
+	static utSmallObjectAllocator allocator(128);
+	return allocator;
+}
+
+
+void* gkLogicManager::allocBrick(size_t size)
+{
+	gkCriticalSection::Lock guard(gBrickAllocLock);
+	return getBrickAllocator().alloc((UTsize)size);
+}
+
+
+void gkLogicManager::freeBrick(void* p, size_t size)
+{
+	gkCriticalSection::Lock guard(gBrickAllocLock);
+	getBrickAllocator().dealloc(p, (UTsize)size);
+}
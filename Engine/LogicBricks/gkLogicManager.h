@@ -37,6 +37,7 @@ class gkLogicController;
 class gkLogicActuator;
 class gkLogicLink;
 class gkAbstractDispatcher;
+class utSmallObjectAllocator;
 
 
 enum gkDispatchedTypes
@@ -61,7 +62,6 @@ public:
 	typedef gkAbstractDispatcher*    gkAbstractDispatcherPtr;
 	typedef utArray<gkLogicBrick*>   Bricks;
 	typedef utHashSet<gkLogicBrick*> BrickSet;
-	typedef utList<gkLogicActuator*> TickActuators;
 	typedef utList<gkLogicManager*>	LogicManagerList;
 protected:
 
@@ -74,11 +74,15 @@ protected:
 	bool                        m_sort;
 
 	BrickSet					m_updateBricks;
-	TickActuators 				m_tickActuators; // actuators that get processed by the controller.
-											//  This list makes it possible to set the actuator-state to false and only change to true if needed
+	UTuint32					m_tick; // stamped on actuators processed by a controller this tick.
+											//  This makes it possible to set the actuator-state to false and only change to true if needed
 
 	void push(gkLogicBrick* a, gkLogicBrick* b, Bricks& in, bool stateValue);
 
+	// O(1) membership of m_cin / m_ain, bricks keep their own index
+	void pushActive(gkLogicBrick* b, Bricks& in);
+	void eraseActive(gkLogicBrick* b, Bricks& in);
+
 	void clearActuators(void);
 	void clearActive(gkLogicLink* link);
 
@@ -115,6 +119,12 @@ public:
 
 	GK_INLINE gkAbstractDispatcher& getDispatcher(int dt) { GK_ASSERT(m_dispatchers && dt >= 0 && dt <= DIS_MAX); return *m_dispatchers[dt]; }
 
+	///Number of sensors connected to the dispatchers.
+	UTsize getNumSensors(void) const;
+
+	///Number of sensors executed by the last update, the rest were sleeping.
+	UTsize getNumEvaluatedSensors(void) const;
+
 
 	///Tells the manager a link from a sensor to controller has been opened or closed.
 	void push(gkLogicSensor* s, gkLogicController* v, bool stateValue);
@@ -127,6 +137,11 @@ public:
 
 	static void deleteManagers(void);
 
+	///Slab storage shared by all logic bricks and links, see their operator new.
+	static void* allocBrick(size_t size);
+	static void  freeBrick(void* p, size_t size);
+	static utSmallObjectAllocator& getBrickAllocator(void);
+
 	UT_DECLARE_SINGLETON(gkLogicManager)
 };
 
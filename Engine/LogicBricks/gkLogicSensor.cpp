@@ -132,6 +132,35 @@ bool gkLogicSensor::isPositive(void) const
 
 
 
+bool gkLogicSensor::isSleeping(void)
+{
+	// mirrors the early outs of execute()
+	if (!inActiveState())
+		return m_oldState == m_link->getState();
+
+	if (m_suspend || m_controllers.empty())
+		return true;
+
+	if (m_firstExec || m_tap || m_listener || m_oldState != m_link->getState())
+		return false;
+
+	if (m_pulse != PM_IDLE)
+	{
+		// keep the pulse frequency in phase
+		if (m_freq > 0)
+			return false;
+
+		// an unchanged result still fires in pulse mode
+		bool pos = m_invert ? !m_positive : m_positive;
+		if ((m_pulse & PM_FALSE) ? !pos : ((m_pulse & PM_TRUE) && pos))
+			return false;
+	}
+
+	return isQueryUnchanged();
+}
+
+
+
 void gkLogicSensor::execute(void)
 {
 	if (!inActiveState())
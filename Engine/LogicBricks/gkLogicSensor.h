@@ -62,6 +62,10 @@ protected:
 
 	void cloneImpl(gkLogicLink* link, gkGameObject* dest);
 
+	///Event driven sensors return true while the input read by query() did not
+	///change since the last call, so the result of query() can not change either.
+	virtual bool isQueryUnchanged(void) {return false;}
+
 
 public:
 
@@ -75,6 +79,9 @@ public:
 
 	void execute(void);
 
+	///Returns true if execute() would neither query nor dispatch this tick.
+	bool isSleeping(void);
+
 	virtual bool query(void) = 0;
 
 	void sort(void);
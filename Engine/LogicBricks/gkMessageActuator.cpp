@@ -31,7 +31,8 @@
 #include "gkVariable.h"
 
 gkMessageActuator::gkMessageActuator(gkGameObject* object, gkLogicLink* link, const gkString& name)
-	:    gkLogicActuator(object, link, name), m_to(""), m_subject(""), m_bodyType(BT_TEXT), m_bodyText(""), m_bodyProp("")
+	:    gkLogicActuator(object, link, name), m_to(""), m_subject(""), m_bodyType(BT_TEXT), m_bodyText(""), m_bodyProp(""),
+	     m_fromId(0), m_toId(0), m_subjectId(0), m_interned(false)
 {
 
 }
@@ -41,6 +42,7 @@ gkLogicBrick* gkMessageActuator::clone(gkLogicLink* link, gkGameObject* dest)
 {
 	gkMessageActuator* act = new gkMessageActuator(*this);
 	act->cloneImpl(link, dest);
+	act->m_interned = false;
 	return act;
 }
 
@@ -50,20 +52,33 @@ void gkMessageActuator::execute(void)
 	if (isPulseOff())
 		return;
 
-	gkString from, body;
+	gkMessageManager& mgr = gkMessageManager::getSingleton();
 
-	from = m_object->getName();
+	if (!m_interned)
+	{
+		m_fromId    = mgr.intern(m_object->getName());
+		m_toId      = mgr.intern(m_to);
+		m_subjectId = mgr.intern(m_subject);
+		m_interned  = m_fromId != gkMessageManager::UNKNOWN_ID && m_toId != gkMessageManager::UNKNOWN_ID &&
+		              m_subjectId != gkMessageManager::UNKNOWN_ID;
+	}
 
-	if (m_bodyType == BT_TEXT)
+	if (m_bodyType == BT_PROP && m_object->hasVariable(m_bodyProp))
 	{
-		body = m_bodyText;
+		gkString body = m_object->getVariable(m_bodyProp)->getValueString();
+		if (m_interned)
+			mgr.sendMessage(m_fromId, m_toId, m_subjectId, body);
+		else
+			mgr.sendMessage(m_object->getName(), m_to, m_subject, body);
 	}
-	else if (m_bodyType == BT_PROP && m_object->hasVariable(m_bodyProp))
+	else
 	{
-		body = m_object->getVariable(m_bodyProp)->getValueString();
+		const gkString& body = m_bodyType == BT_TEXT ? m_bodyText : gkString();
+		if (m_interned)
+			mgr.sendMessage(m_fromId, m_toId, m_subjectId, body);
+		else
+			mgr.sendMessage(m_object->getName(), m_to, m_subject, body);
 	}
 
-	gkMessageManager::getSingleton().sendMessage(from, m_to, m_subject, body);
-
 	setPulse(BM_OFF);
 }
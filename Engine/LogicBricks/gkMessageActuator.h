@@ -43,6 +43,10 @@ private:
 	gkString m_to, m_subject, m_bodyText, m_bodyProp;
 	int m_bodyType;
 
+	// Interned ids of the sender, receiver and subject, looked up on the first send
+	UTuint32 m_fromId, m_toId, m_subjectId;
+	bool m_interned;
+
 public:
 	gkMessageActuator(gkGameObject* object, gkLogicLink* link, const gkString& name);
 	virtual ~gkMessageActuator() {}
@@ -51,8 +55,8 @@ public:
 
 	void execute(void);
 
-	GK_INLINE void setTo(gkString v)                  {m_to = v;}
-	GK_INLINE void setSubject(const gkString& v)      {m_subject = v;}
+	GK_INLINE void setTo(gkString v)                  {m_to = v; m_interned = false;}
+	GK_INLINE void setSubject(const gkString& v)      {m_subject = v; m_interned = false;}
 	GK_INLINE void setBodyType(int v)                 {m_bodyType = v;}
 	GK_INLINE void setBodyText(const gkString& v)     {m_bodyText = v;}
 	GK_INLINE void setBodyProperty(const gkString& v) {m_bodyProp = v;}
@@ -31,7 +31,7 @@
 
 
 gkMessageSensor::gkMessageSensor(gkGameObject* object, gkLogicLink* link, const gkString& name)
-	:       gkLogicSensor(object, link, name)
+	:       gkLogicSensor(object, link, name), m_queryTick(0)
 {
 	m_listener = new gkMessageManager::GenericMessageListener("",object->getName(),"");
 	m_listener->setAcceptEmptyTo(true);
@@ -55,7 +55,9 @@ gkLogicBrick* gkMessageSensor::clone(gkLogicLink* link, gkGameObject* dest)
 {
 	gkMessageSensor* sens = new gkMessageSensor(*this);
 	sens->cloneImpl(link, dest);
-	sens->m_listener = new gkMessageManager::GenericMessageListener("", "", m_listener->m_subjectFilter);
+	sens->m_listener = new gkMessageManager::GenericMessageListener("", dest->getName(), m_listener->m_subjectFilter);
+	sens->m_listener->setAcceptEmptyTo(true);
+	sens->m_messages.clear();
 	gkMessageManager::getSingleton().addListener(sens->m_listener);
 	return sens;
 }
@@ -65,24 +67,17 @@ bool gkMessageSensor::query(void)
 {
 	bool ret = false;
 
-	m_messages.clear();
+	m_messages.clear(true);
+	m_queryTick = gkMessageManager::getSingleton().getTick();
 
 	if (m_listener->m_messages.size() > 0 )
 	{
 		ret = true;
 
-		// We copy the massages so that Logic scripts can retrieve messages recieved between each logic step
-		utArrayIterator<utArray<gkMessageManager::Message> > iter(m_listener->m_messages);
-		while (iter.hasMoreElements())
-		{
-			gkMessageManager::Message m = iter.peekNext();
-			if (m.m_to==""
-					|| m.m_to == m_object->getName())
-			{
-				m_messages.push_back(m);
-			}
-			iter.getNext();
-		}
+		// The listener only takes messages to this object or to everyone. Keep
+		// references so that Logic scripts can retrieve them during this tick
+		for (UTsize i = 0; i < m_listener->m_messages.size(); ++i)
+			m_messages.push_back(m_listener->m_messages[i]);
 	}
 
 	m_listener->emptyMessages();
@@ -36,8 +36,12 @@ class gkMessageSensor : public gkLogicSensor
 {
 private:
 	gkMessageManager::GenericMessageListener* m_listener;
-	utArray<gkMessageManager::Message>       m_messages;
+	// Received by the last query, valid during the tick of that query
+	utArray<const gkMessageManager::Message*> m_messages;
+	UTuint32                                  m_queryTick;
 
+protected:
+	GK_INLINE bool isQueryUnchanged(void) {return !m_positive && m_listener->m_messages.empty();}
 
 
 public:
@@ -47,10 +51,15 @@ public:
 	gkLogicBrick* clone(gkLogicLink* link, gkGameObject* dest);
 
 	bool query(void);
-	GK_INLINE void            setSubject(const gkString& v)       {m_listener->m_subjectFilter = v;}
+	GK_INLINE void            setSubject(const gkString& v)       {m_listener->setSubjectFilter(v);}
 	GK_INLINE const gkString& getSubject(void)              const {return m_listener->m_subjectFilter;}
-	GK_INLINE int getMessageCount() { return m_messages.size();}
-	GK_INLINE gkMessageManager::Message getMessage(int nr) { return m_messages.at(nr);}
+
+	// Messages of the last query, none once the tick of the query is over
+	GK_INLINE int getMessageCount()
+	{
+		return m_queryTick == gkMessageManager::getSingleton().getTick() ? (int)m_messages.size() : 0;
+	}
+	GK_INLINE const gkMessageManager::Message& getMessage(int nr) { return *m_messages.at(nr);}
 
 };
 
@@ -31,13 +31,14 @@
 #include "gkGameObject.h"
 #include "gkPhysicsController.h"
 #include "gkScene.h"
-#include "gkContactTest.h"
+#include "gkSensorGhost.h"
 #include "btBulletDynamicsCommon.h"
 #include "btBulletCollisionCommon.h"
 
 
 gkNearSensor::gkNearSensor(gkGameObject* object, gkLogicLink* link, const gkString& name)
-	:        gkLogicSensor(object, link, name), m_range(0.01), m_resetrange(0.01), m_previous(false), m_material(""), m_prop("")
+	:        gkLogicSensor(object, link, name), m_range(0.01), m_resetrange(0.01), m_previous(false),
+	         m_ghostId(gkDynamicsWorld::createSensorId())
 {
 	m_dispatchType = DIS_CONSTANT;
 	connect();
@@ -47,6 +48,7 @@ gkNearSensor::gkNearSensor(gkGameObject* object, gkLogicLink* link, const gkStri
 gkLogicBrick* gkNearSensor::clone(gkLogicLink* link, gkGameObject* dest)
 {
 	gkNearSensor* sens = new gkNearSensor(*this);
+	sens->m_ghostId = gkDynamicsWorld::createSensorId();
 	sens->cloneImpl(link, dest);
 	return sens;
 }
@@ -56,54 +58,36 @@ gkLogicBrick* gkNearSensor::clone(gkLogicLink* link, gkGameObject* dest)
 bool gkNearSensor::query(void)
 {
 	m_nearObjList.clear();
+
 	gkScene* scene = m_object->getOwner();
 	gkDynamicsWorld* dyn = scene->getDynamicsWorld();
 
-	btDynamicsWorld* btw = dyn->getBulletWorld();
-
 	gkVector3 vec = m_object->getWorldPosition();
 
-	gkAllContactResultCallback exec;
-
 	btTransform btt;
 	btt.setIdentity();
 	btt.setOrigin(btVector3(vec.x, vec.y, vec.z));
 
-	btSphereShape btss(m_range);
-	if (m_previous)
-		btss.setUnscaledRadius(m_resetrange);
-
-	btCollisionObject btco = btCollisionObject();
-	btco.setCollisionShape(&btss);
-	btco.setWorldTransform(btt);
-
-	btw->contactTest( &btco, exec);
+	gkSensorGhost* ghost = dyn->getSensorGhost(m_ghostId);
+	ghost->setSphere(m_previous ? m_resetrange : m_range);
+	ghost->setTransform(btt);
+	ghost->debugDraw(btVector3(0, 1, 0));
 
-	if (btw->getDebugDrawer())
-		btw->debugDrawObject(btt, &btss, btVector3(0, 1, 0));
-
-	if (!exec.hasHit())
-		return m_previous = false;
-	if (exec.m_contactObjects.empty())
+	if (!ghost->collides(m_contacts, m_object->getCollisionObject()))
 		return m_previous = false;
 
-//	if (m_material.empty() && m_prop.empty())
+//	if (m_filter.isEmpty())
 //		return m_previous = true;
 
-	utArray<const btCollisionObject*> contacts = exec.m_contactObjects;
-	utArrayIterator< utArray<const btCollisionObject*> > iter(contacts);
-
+	utArrayIterator< utArray<const btCollisionObject*> > iter(m_contacts);
 	while (iter.hasMoreElements())
 	{
 		gkGameObject* ob = gkPhysicsController::castObject(iter.peekNext());
-		if (ob!=m_object && gkPhysicsController::sensorTest(ob, m_prop, m_material)){
-			if (m_nearObjList.find(ob)==UT_NPOS){
-				m_nearObjList.push_back(ob);
-			}
-		}
-
+		if (ob!=m_object && m_filter.test(ob))
+			m_nearObjList.push_back(ob);
 		iter.getNext();
 	}
+
 	if (m_nearObjList.empty())
 		return m_previous = false;
 	else
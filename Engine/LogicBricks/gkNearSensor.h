@@ -28,15 +28,22 @@
 #define GKNEARSENSOR_H
 
 #include "gkLogicSensor.h"
+#include "gkSensorFilter.h"
+
+class btCollisionObject;
 
 class gkNearSensor : public gkLogicSensor
 {
 
 private:
 	gkScalar    m_range, m_resetrange;
-	gkString    m_material, m_prop;
+	gkSensorFilter m_filter;
 	bool        m_previous;
 	utArray<gkGameObject*> m_nearObjList;
+	utArray<const btCollisionObject*> m_contacts;
+
+	// key of the sensor's volume in the dynamics world
+	UTuint32 m_ghostId;
 
 public:
 
@@ -49,13 +56,13 @@ public:
 
 	GK_INLINE void setRange(gkScalar v)             {m_range = v;}
 	GK_INLINE void setResetRange(gkScalar v)        {m_resetrange = v;}
-	GK_INLINE void setMaterial(const gkString& v)   {m_material = v; m_prop = "";}
-	GK_INLINE void setProperty(const gkString& v)   {m_prop = v; m_material = "";}
+	GK_INLINE void setMaterial(const gkString& v)   {m_filter.setMaterial(v); m_filter.setProperty("");}
+	GK_INLINE void setProperty(const gkString& v)   {m_filter.setProperty(v); m_filter.setMaterial("");}
 
 	GK_INLINE gkScalar getRange(void)               const {return m_range;}
 	GK_INLINE gkScalar getResetRange(void)          const {return m_resetrange;}
-	GK_INLINE const gkString& getMaterial(void)     const {return m_material;}
-	GK_INLINE const gkString& getProperty(void)     const {return m_prop;}
+	GK_INLINE const gkString& getMaterial(void)     const {return m_filter.getMaterial();}
+	GK_INLINE const gkString& getProperty(void)     const {return m_filter.getProperty();}
 	GK_INLINE const utArray<gkGameObject*> getNearObjects(void) const {return m_nearObjList;}
 	GK_INLINE const int getNearObjectCount(void) 	    const {return m_nearObjList.size();}
 	GK_INLINE const gkGameObject* getNearObject(int nr)  {return m_nearObjList[nr];}
@@ -33,7 +33,7 @@
 
 gkPropertySensor::gkPropertySensor(gkGameObject* object, gkLogicLink* link, const gkString& name)
 	:   gkLogicSensor(object, link, name), m_old(), m_cur(0), m_type(-1), m_propName(""), m_propVal(), m_propMax(),
-	    m_init(false), m_change(false)
+	    m_init(false), m_change(false), m_version(0)
 
 {
 	m_dispatchType = DIS_CONSTANT;
@@ -77,6 +77,8 @@ bool gkPropertySensor::query(void)
 
 	if (m_cur)
 	{
+		m_version = m_cur->getVersion();
+
 		switch (m_type)
 		{
 		case PS_EQUAL:
@@ -97,3 +99,13 @@ bool gkPropertySensor::query(void)
 	}
 	return false;
 }
+
+
+bool gkPropertySensor::isQueryUnchanged(void)
+{
+	if (!m_cur || m_cur->getVersion() != m_version)
+		return false;
+
+	// a detected change is reported again on the next query
+	return m_type != PS_CHANGED || !m_positive;
+}
@@ -52,6 +52,9 @@ protected:
 	int         m_type;
 	gkString    m_propName;
 	bool        m_init, m_change;
+	UTuint32    m_version;
+
+	bool isQueryUnchanged(void);
 
 public:
 
@@ -31,12 +31,13 @@
 #include "gkGameObject.h"
 #include "gkPhysicsController.h"
 #include "gkScene.h"
-#include "gkContactTest.h"
+#include "gkSensorGhost.h"
 #include "btBulletDynamicsCommon.h"
 
 
 gkRadarSensor::gkRadarSensor(gkGameObject* object, gkLogicLink* link, const gkString& name)
-	:        gkRaySensor(object, link, name), m_angle(0.1)
+	:        gkRaySensor(object, link, name), m_angle(0.1),
+	         m_ghostId(gkDynamicsWorld::createSensorId())
 {
 }
 
@@ -44,6 +45,7 @@ gkRadarSensor::gkRadarSensor(gkGameObject* object, gkLogicLink* link, const gkSt
 gkLogicBrick* gkRadarSensor::clone(gkLogicLink* link, gkGameObject* dest)
 {
 	gkRadarSensor* sens = new gkRadarSensor(*this);
+	sens->m_ghostId = gkDynamicsWorld::createSensorId();
 	sens->cloneImpl(link, dest);
 	return sens;
 }
@@ -54,7 +56,6 @@ bool gkRadarSensor::query(void)
 	gkScene* scene = m_object->getOwner();
 	gkDynamicsWorld* dyn = scene->getDynamicsWorld();
 
-	btDynamicsWorld* btw = dyn->getBulletWorld();
 
 	const gkScalar offs = m_range / 2.f;
 	gkEuler ori;
@@ -85,53 +86,31 @@ bool gkRadarSensor::query(void)
 	dir = m_object->getWorldOrientation() * dir;
 	btQuaternion btr = gkMathUtils::get(m_object->getWorldOrientation() * ori.toQuaternion());
 
-	gkAllContactResultCallback exec;
-
 	btTransform  btt;
 	btt.setIdentity();
 	btt.setOrigin(btVector3(vec.x + dir.x, vec.y + dir.y, vec.z + dir.z));
 	btt.setRotation(btr);
 
-	btConeShapeZ btcs(m_range * tan(m_angle / 2), m_range);
-
-	btCollisionObject btco = btCollisionObject();
-	btco.setCollisionShape(&btcs);
-	btco.setWorldTransform(btt);
-
-	btw->contactTest( &btco, exec);
-
-	if (btw->getDebugDrawer())
-		btw->debugDrawObject(btt, &btcs, btVector3(0, 1, 0));
+	gkSensorGhost* ghost = dyn->getSensorGhost(m_ghostId);
+	ghost->setCone(m_range * tan(m_angle / 2), m_range);
+	ghost->setTransform(btt);
+	ghost->debugDraw(btVector3(0, 1, 0));
 
-
-	if (!exec.hasHit())
+	// don't collide with self ?
+	// See: momo_ogre.blend sensor(Not Ray.Down) state 2
+	if (!ghost->collides(m_contacts, m_object->getCollisionObject()))
 		return false;
 
-
-	if (m_object->getCollisionObject())
-	{
-		// don't collide with self ?
-		// See: momo_ogre.blend sensor(Not Ray.Down) state 2
-		if (!exec.m_contactObjects.empty())
-			exec.m_contactObjects.erase(m_object->getCollisionObject());
-	}
-
-
-	if (exec.m_contactObjects.empty())
-		return false;
-
-	if (m_material.empty() && m_prop.empty())
+	if (m_filter.isEmpty())
 		return true;
 
-	utArray<const btCollisionObject*> contacts = exec.m_contactObjects;
-
-	utArrayIterator< utArray<const btCollisionObject*> > iter(contacts);
+	utArrayIterator< utArray<const btCollisionObject*> > iter(m_contacts);
 
 	while (iter.hasMoreElements())
 	{
 		gkGameObject* ob = gkPhysicsController::castObject(iter.peekNext());
 
-		if (gkPhysicsController::sensorTest(ob, m_prop, m_material))
+		if (m_filter.test(ob))
 			return true;
 
 		iter.getNext();
@@ -29,10 +29,16 @@
 
 #include "gkRaySensor.h"
 
+class btCollisionObject;
+
 class gkRadarSensor : public gkRaySensor
 {
 private:
 	gkScalar m_angle;
+	utArray<const btCollisionObject*> m_contacts;
+
+	// key of the sensor's volume in the dynamics world
+	UTuint32 m_ghostId;
 
 
 public:
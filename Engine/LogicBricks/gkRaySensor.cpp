@@ -34,10 +34,28 @@
 
 
 
+// xrayFilter with the sensor's interned filter
+struct gkRaySensorXrayFilter : gkRayTest::gkRayTestFilter
+{
+	gkRaySensorXrayFilter(gkGameObject* self, const gkSensorFilter& filter)
+		:	m_self(self), m_filter(filter) {}
+
+	gkGameObject*         m_self;
+	const gkSensorFilter& m_filter;
+
+	bool filterFunc(btCollisionObject* ob) const
+	{
+		gkGameObject* other = gkPhysicsController::castObject(ob);
+		return other != m_self && m_filter.test(other);
+	}
+};
+
+
+
 
 gkRaySensor::gkRaySensor(gkGameObject* object, gkLogicLink* link, const gkString& name)
 	:       gkLogicSensor(object, link, name), m_range(0.01), m_axis(-1),
-                m_material(""), m_prop(""), m_xray(false)
+                m_xray(false)
 {
 	m_dispatchType = DIS_CONSTANT;
 	connect();
@@ -77,7 +95,7 @@ bool gkRaySensor::query(void)
 	to = from + dir;
 	
 	if(m_xray){
-		xrayFilter xrf(m_object, m_prop, m_material);
+		gkRaySensorXrayFilter xrf(m_object, m_filter);
 		result = test.collides(from, to, xrf);
 	}
 	else
@@ -87,10 +105,10 @@ bool gkRaySensor::query(void)
 	}
 	
 	bool onlyActorTODO = false;
-	// if x-ray, m_prop and m_material were already tested
+	// if x-ray, the filter was already tested
 	if (!m_xray && result){
 		gkGameObject* hit = gkPhysicsController::castObject(test.getCollisionObject());
-		result = hit && gkPhysicsController::sensorTest(hit, m_prop, m_material, onlyActorTODO);
+		result = hit && m_filter.test(hit, onlyActorTODO);
 	}
 	
 	return result;
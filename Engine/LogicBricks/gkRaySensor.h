@@ -28,6 +28,7 @@
 #define _gkRaySensor_h_
 
 #include "gkLogicSensor.h"
+#include "gkSensorFilter.h"
 
 
 class gkRaySensor : public gkLogicSensor
@@ -47,7 +48,7 @@ public:
 protected:
 	gkScalar    m_range;
 	int         m_axis;
-	gkString    m_material, m_prop;
+	gkSensorFilter m_filter;
         bool        m_xray;
 
 public:
@@ -61,15 +62,15 @@ public:
 
 	GK_INLINE void setRange(gkScalar v)             {m_range = v;}
 	GK_INLINE void setAxis(int v)                   {m_axis = v;}
-	GK_INLINE void setMaterial(const gkString& v)   {m_material = v; m_prop = "";}
-	GK_INLINE void setProperty(const gkString& v)   {m_prop = v; m_material = "";}
+	GK_INLINE void setMaterial(const gkString& v)   {m_filter.setMaterial(v); m_filter.setProperty("");}
+	GK_INLINE void setProperty(const gkString& v)   {m_filter.setProperty(v); m_filter.setMaterial("");}
 	GK_INLINE void setXray(bool v)   {m_xray = v;}
 
 
 	GK_INLINE gkScalar        getRange(void)        const {return m_range;}
 	GK_INLINE int             getAxis(void)         const {return m_axis;}
-	GK_INLINE const gkString& getMaterial(void)     const {return m_material;}
-	GK_INLINE const gkString& getProperty(void)     const {return m_prop;}
+	GK_INLINE const gkString& getMaterial(void)     const {return m_filter.getMaterial();}
+	GK_INLINE const gkString& getProperty(void)     const {return m_filter.getProperty();}
 	GK_INLINE bool            getXray(void)         const {return m_xray;}
 };
 
@@ -29,11 +29,30 @@
 #include "gkEngine.h"
 #include "gkMessageManager.h"
 #include "gkLogger.h"
+#include "gkNetworkReplication.h"
+
+// Milliseconds the network thread waits for an event before sending the next batch
+#define GK_NET_SERVICE_TIMEOUT 5
+
+// Batches this large are flushed without waiting for the end of the tick
+#define GK_NET_MAX_BATCH_SIZE (64 * 1024)
+
+// Received packets the game tick can fall behind by before they wait in the backlog
+#define GK_NET_INBOUND_PACKETS 256
+
+// Flushed batches the network thread can fall behind by
+#define GK_NET_OUTBOUND_BATCHES 16
 
 gkNetworkInstance::gkNetworkInstance(const gkString & pName)
-	:   mName(pName),
+	:   mPort(0),
+	mName(pName),
+	mHost(NULL),
 	mThread(0),
-	mStop(true)
+	mStop(true),
+	mCompress(false),
+	mInbound(GK_NET_INBOUND_PACKETS),
+	mOutbound(GK_NET_OUTBOUND_BATCHES),
+	mReplicator(NULL)
 {
 }  // gkNetworkInstance::gkNetworkInstance
 
@@ -77,6 +96,12 @@ void gkNetworkInstance::start(void)
 		if (!mThread)
 		{
 			mStop = !initialize();
+
+			if (!mStop && mCompress)
+			{
+				enet_host_compress_with_range_coder(mHost);
+			}  // if
+
 			mThread = new gkThread(this);
 		}  // if
 		else
@@ -111,83 +136,150 @@ void gkNetworkInstance::setPort(const int & pPort)
 	mPort = pPort;
 }  // void gkNetworkInstance::setPort
 
-void gkNetworkInstance::receiveMessage(const ENetPacket * pPacket)
+bool gkNetworkInstance::receiveMessage(const ENetPacket * pPacket)
 {
-	gkString lTempString;
+	gkNetworkPacketWriter * lSlot = mInbound.beginPush();
+	if (lSlot == NULL)
+	{
+		return false;
+	}  // if
 
-	size_t lLength = pPacket -> dataLength;
-	size_t lIndex = 0;
+	// The slot keeps its memory, so copying does not allocate once warm
+	lSlot ->clear();
+	lSlot ->writeBytes(pPacket -> data, pPacket -> dataLength);
+	mInbound.endPush();
 
-	int lCurrentStringType = 0;
+	return true;
+}  // bool gkNetworkInstace::receiveMessage
 
-	gkString lFrom;
-	gkString lTo;
-	gkString lSubject;
-	gkString lBody;
+void gkNetworkInstance::dispatchMessage(const gkNetworkPacketWriter & pPacket)
+{
+	gkNetworkPacketReader lReader(pPacket.ptr(), pPacket.size());
 
-	// Loop through the entire string, and for every ; symbol save it into one part of message
-	for(lIndex = 0; lIndex < lLength; lIndex++)
+	// A packet carries the batch of one tick, decode its frames in order
+	while (!lReader.atEnd())
 	{
-		char lTempChar = (char)pPacket -> data[lIndex];
-		if(lTempChar != ';')
+		UTuint8 lType = 0;
+		lReader.readU8(lType);
+
+		if (lType == GK_NET_FRAME_MESSAGE &&
+			lReader.readMessage(mReceivedSender, mReceivedReceiver, mReceivedSubject, mReceivedBody))
 		{
-			lTempString = lTempString + lTempChar;
+			gkMessageManager::getSingletonPtr() ->sendMessage(mReceivedSender, mReceivedReceiver, mReceivedSubject, mReceivedBody);
+			continue;
 		}  // if
-		else
+
+		UTuint32 lLength;
+		const UTuint8 * lSnapshot;
+		if (lType == GK_NET_FRAME_SNAPSHOT && lReader.readU32(lLength) && lReader.readBlock(lSnapshot, lLength))
 		{
-			switch(lCurrentStringType)
-			{
-			case 0:
-				lFrom = lTempString;
-				break;
-			case 1:
-				lTo = lTempString;
-				break;
-			case 2:
-				lSubject = lTempString;
-				break;
-			case 3:
-				lBody = lTempString;
-				break;
-			}   // switch
-
-			if(lCurrentStringType == 3)
+			if (mReplicator != NULL)
 			{
-				break;
+				mReplicator ->receiveSnapshot(lSnapshot, lLength);
 			}  // if
 
-			lCurrentStringType++;
-			lTempString = "";
-		}  // else
-	}  // for
+			continue;
+		}  // if
 
-	gkMessageManager::getSingletonPtr() ->sendMessage(lFrom, lTo, lSubject, lBody);
-}  // gkNetworkInstace::receiveMessage
+		gkLogger::write("Dropping malformed network packet.\n");
+		break;
+	}  // while
+}  // void gkNetworkInstance::dispatchMessage
+
+void gkNetworkInstance::dispatchMessages(void)
+{
+	gkNetworkPacketWriter * lPacket;
+	while ((lPacket = mInbound.front()) != NULL)
+	{
+		dispatchMessage(* lPacket);
+		mInbound.pop();
+	}  // while
+}  // void gkNetworkInstance::dispatchMessages
 
 void gkNetworkInstance::sendMessage(const gkString & pSender, const gkString & pReceiver, const gkString & pSubject, const gkString & pBody)
 {
-	// Concating messages into a single string
-	gkString lPacketMessage = "";
-	lPacketMessage.append(pSender);
-	lPacketMessage.append(";");
-	lPacketMessage.append(pReceiver);
-	lPacketMessage.append(";");
-	lPacketMessage.append(pSubject);
-	lPacketMessage.append(";");
-	lPacketMessage.append("pBody");
-	lPacketMessage.append(";");
-
-	// Create the packet according to the message size
-	ENetPacket * lPacket = enet_packet_create (lPacketMessage.c_str(), 
-		lPacketMessage.length(), 
-		ENET_PACKET_FLAG_RELIABLE);
-
-	enet_host_broadcast (mHost, 0, lPacket);
-
-	// Flush out packet
-	enet_host_flush (mHost);
+	if (!mBatch.writeMessage(pSender, pReceiver, pSubject, pBody))
+	{
+		gkLogger::write("Network message dropped, its names are too long.\n");
+		return;
+	}  // if
+
+	if (mBatch.size() >= GK_NET_MAX_BATCH_SIZE)
+	{
+		flush();
+	}  // if
 }  // void gkNetworkInstance::sendMessage
 
+void gkNetworkInstance::flush(void)
+{
+	if (mBatch.empty())
+	{
+		return;
+	}  // if
+
+	// When the network thread is behind, the batch keeps growing until the next flush
+	gkNetworkPacketWriter * lSlot = mOutbound.beginPush();
+	if (lSlot != NULL)
+	{
+		// The emptied buffer of an earlier batch collects the next one
+		lSlot ->swap(mBatch);
+		mOutbound.endPush();
+	}  // if
+}  // void gkNetworkInstance::flush
+
+void gkNetworkInstance::sendFrames(const gkNetworkPacketWriter & pFrames)
+{
+	mBatch.writeBytes(pFrames.ptr(), pFrames.size());
+
+	if (mBatch.size() >= GK_NET_MAX_BATCH_SIZE)
+	{
+		flush();
+	}  // if
+}  // void gkNetworkInstance::sendFrames
+
+void gkNetworkInstance::setReplicator(gkNetworkReplicator * pReplicator)
+{
+	mReplicator = pReplicator;
+}  // void gkNetworkInstance::setReplicator
+
+int gkNetworkInstance::getConnectCount(void) const
+{
+	return mConnectCount.get();
+}  // int gkNetworkInstance::getConnectCount
+
+void gkNetworkInstance::setCompression(bool pCompress)
+{
+	gkCriticalSection::Lock lock(mCriticalSelection);
+
+	mCompress = pCompress;
+}  // void gkNetworkInstance::setCompression
+
+void gkNetworkInstance::sendBatch(void)
+{
+	gkNetworkPacketWriter * lBatch;
+	bool lSent = false;
+
+	while ((lBatch = mOutbound.front()) != NULL)
+	{
+		// One packet for the whole batch, its messages are framed inside
+		ENetPacket * lPacket = enet_packet_create (lBatch -> ptr(),
+			lBatch -> size(),
+			ENET_PACKET_FLAG_RELIABLE);
+
+		enet_host_broadcast (mHost, 0, lPacket);
+
+		lBatch -> clear();
+		mOutbound.pop();
+		lSent = true;
+	}  // while
+
+	if (lSent)
+	{
+		// Flush out packet
+		enet_host_flush (mHost);
+	}  // if
+}  // void gkNetworkInstance::sendBatch
+
 void gkNetworkInstance::run(void)
 {	
 	/// Main network workload.
@@ -198,29 +290,59 @@ void gkNetworkInstance::run(void)
 		// catch any exceptions
 		try
 		{
+			// Packets the main thread had no room for go first, in order
+			UTsize lQueued = 0;
+			while (lQueued < mBacklog.size() && receiveMessage(mBacklog[lQueued]))
+			{
+				enet_packet_destroy (mBacklog[lQueued]);
+				++lQueued;
+			}  // while
+
+			if (lQueued > 0)
+			{
+				for (UTsize i = lQueued; i < mBacklog.size(); ++i)
+				{
+					mBacklog[i - lQueued] = mBacklog[i];
+				}  // for
+
+				mBacklog.resize(mBacklog.size() - lQueued);
+			}  // if
+
 			ENetEvent lEvent;
-			// Wait up to 1000 milliseconds for an event
-			while (enet_host_service (mHost, & lEvent, 1000) > 0)
+			// Wait a little for an event, then take the ones already received
+			int lResult = enet_host_service (mHost, & lEvent, GK_NET_SERVICE_TIMEOUT);
+			while (lResult > 0)
 			{
 				switch (lEvent.type)
 				{
 				case ENET_EVENT_TYPE_CONNECT:
+					mConnectCount.increment();
 
 					break;
 
 				case ENET_EVENT_TYPE_RECEIVE:
-					receiveMessage(lEvent.packet);
-
-					// Clean up the packet now that we're done using it.
-					enet_packet_destroy (lEvent.packet);
+					if (mBacklog.empty() && receiveMessage(lEvent.packet))
+					{
+						// Clean up the packet now that we're done using it.
+						enet_packet_destroy (lEvent.packet);
+					}  // if
+					else
+					{
+						// Kept until the main thread catches up
+						mBacklog.push_back(lEvent.packet);
+					}  // else
 
 					break;
 
 				case ENET_EVENT_TYPE_DISCONNECT:
 					lEvent.peer -> data = NULL;
 				}  // switch
+
+				lResult = enet_host_check_events (mHost, & lEvent);
 			}  // while
 
+			sendBatch();
+
 			if(!mStop)
 			{
 				mSync.signal();
@@ -240,5 +362,13 @@ void gkNetworkInstance::deinitialize(void)
 	if(mHost != NULL)
 	{
 		enet_host_destroy(mHost);
+		mHost = NULL;
 	} // if
+
+	for (UTsize i = 0; i < mBacklog.size(); ++i)
+	{
+		enet_packet_destroy(mBacklog[i]);
+	}  // for
+
+	mBacklog.clear();
 }  // void gkNetworkInstance::deinitialize
@@ -34,6 +34,12 @@
 
 #include "Thread/gkCriticalSection.h"
 #include "Thread/gkThread.h"
+#include "Thread/gkSpscQueue.h"
+#include "Thread/gkAtomic.h"
+
+#include "gkNetworkPacket.h"
+
+class gkNetworkReplicator;
 
 // Network system instance
 class gkNetworkInstance : public gkCall
@@ -52,6 +58,29 @@ protected:
 	gkSyncObj			mSync;
 	bool                mStop;
 
+	// Frames of the messages sent since the last flush, main thread only
+	gkNetworkPacketWriter mBatch;
+	bool                mCompress;
+
+	// Received packets, filled by the network thread and drained on the game tick
+	gkSpscQueue<gkNetworkPacketWriter> mInbound;
+	// Flushed batches, filled on the game tick and sent by the network thread
+	gkSpscQueue<gkNetworkPacketWriter> mOutbound;
+	// Received packets waiting for a free inbound slot, network thread only
+	utArray<ENetPacket *> mBacklog;
+
+	// Connections made so far, counted by the network thread
+	gkAtomicInt         mConnectCount;
+
+	// Receives the snapshot frames
+	gkNetworkReplicator * mReplicator;
+
+	// Reused while decoding received frames on the main thread
+	gkString            mReceivedSender;
+	gkString            mReceivedReceiver;
+	gkString            mReceivedSubject;
+	gkString            mReceivedBody;
+
 	// initialize
 	// Input: None
 	// Return: bool to indicate whether the instance inititailze successfully
@@ -65,11 +94,22 @@ protected:
 	void deinitialize(void);
 
 	// receiveMessage
-	// Input: pPacket The packet pointer to packet object that contains 
-	//                the information sent in from connections
+	// Input: pPacket The packet received from a connection
+	// Return: bool False if the inbound queue is full
+	// Copy the packet into the inbound queue, called by the network thread
+	bool receiveMessage(const ENetPacket * pPacket);
+
+	// dispatchMessage
+	// Input: pPacket The bytes of a received packet
 	// Return: None
 	// To analyze packet information and send message through MessageManager
-	void receiveMessage(const ENetPacket * pPacket);
+	void dispatchMessage(const gkNetworkPacketWriter & pPacket);
+
+	// sendBatch
+	// Input: None
+	// Return: None
+	// Broadcast the flushed batches, one packet each, called by the network thread
+	void sendBatch(void);
 
 public:
 	// Constructor
@@ -142,11 +182,47 @@ public:
 	//        pSubject The subject of the message
 	//        pBody The body of the message
 	// Return: None
-	// Send Message through network to every connection
+	// Queue Message for every connection, it is sent with the batch of the next flush
 	void sendMessage(
 		const gkString & pSender, const gkString & pReceiver, 
 		const gkString & pSubject, const gkString & pBody
 		);
+
+	// flush
+	// Input: None
+	// Return: None
+	// Hand the messages queued so far to the network thread as one packet,
+	// the engine flushes once per tick
+	void flush(void);
+
+	// dispatchMessages
+	// Input: None
+	// Return: None
+	// Send the received messages through MessageManager, the engine dispatches
+	// once per tick on the main thread
+	void dispatchMessages(void);
+
+	// sendFrames
+	// Input: pFrames Frames written by a gkNetworkPacketWriter
+	// Return: None
+	// Queue the frames for every connection, they are sent with the next flush
+	void sendFrames(const gkNetworkPacketWriter & pFrames);
+
+	// setReplicator
+	// Input: pReplicator The replicator received snapshots are handed to, or NULL
+	// Return: None
+	void setReplicator(gkNetworkReplicator * pReplicator);
+
+	// getConnectCount
+	// Input: None
+	// Return: int The number of connections made since the instance was created
+	int getConnectCount(void) const;
+
+	// setCompression
+	// Input: pCompress Whether to range code the packets
+	// Return: None
+	// Takes effect when the host is created by start, both ends need the same setting
+	void setCompression(bool pCompress);
 };  // gkNetworkInstancegk
 
 #endif  // _gkNetworkInstance_h_
\ No newline at end of file
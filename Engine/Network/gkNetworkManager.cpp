@@ -36,6 +36,8 @@
 gkNetworkManager::gkNetworkManager()
 {
 	mInstance = NULL;
+	mReplicator = NULL;
+	mType = 0;
 
 	initialize();
 }  // gkNetworkManager::gkNetworkManager
@@ -55,6 +57,8 @@ void gkNetworkManager::initialize(void)
 
 void gkNetworkManager::deinitialize(void)
 {
+	destroyReplicator();
+
 	if(mInstance != NULL)
 	{
 		delete mInstance;
@@ -91,6 +95,7 @@ void gkNetworkManager::createNetworkInstance(const int & pType, const gkString &
 		mInstance = new gkNetworkClient(pName);
 	}  // else
 
+	mType = pType;
 	mInstance -> setAddress(pAddress);
 	mInstance -> setPort(pPort);
 }  // void gkNetworkManager::startNetworkInstance
@@ -136,6 +141,68 @@ void gkNetworkManager::sendMessage(
 	}  // if
 }  // gkNetworkManager::sendMessage
 
+void gkNetworkManager::flushNetworkInstance(void)
+{
+	if(mInstance != NULL)
+	{
+		mInstance ->flush();
+	}  // if
+}  // gkNetworkManager::flushNetworkInstance
+
+void gkNetworkManager::dispatchNetworkMessages(void)
+{
+	if(mInstance != NULL)
+	{
+		mInstance ->dispatchMessages();
+	}  // if
+}  // gkNetworkManager::dispatchNetworkMessages
+
+void gkNetworkManager::setNetworkInstanceCompression(bool pCompress)
+{
+	if(mInstance != NULL)
+	{
+		mInstance ->setCompression(pCompress);
+	}  // if
+}  // gkNetworkManager::setNetworkInstanceCompression
+
+gkNetworkReplicator * gkNetworkManager::createReplicator(gkScene * pScene)
+{
+	if(mInstance == NULL || pScene == NULL)
+	{
+		gkLogger::write("Network replication needs a network instance and a scene\n");
+		return NULL;
+	}  // if
+
+	destroyReplicator();
+
+	mReplicator = new gkNetworkReplicator(pScene, mType == 0);
+	mInstance -> setReplicator(mReplicator);
+
+	return mReplicator;
+}  // gkNetworkReplicator * gkNetworkManager::createReplicator
+
+void gkNetworkManager::destroyReplicator(void)
+{
+	if(mReplicator != NULL)
+	{
+		if(mInstance != NULL)
+		{
+			mInstance -> setReplicator(NULL);
+		}  // if
+
+		delete mReplicator;
+		mReplicator = NULL;
+	}  // if
+}  // void gkNetworkManager::destroyReplicator
+
+void gkNetworkManager::updateReplication(gkScalar pDelta)
+{
+	if(mReplicator != NULL)
+	{
+		mReplicator -> update(mInstance, pDelta);
+	}  // if
+}  // void gkNetworkManager::updateReplication
+
 bool gkNetworkManager::isNetworkInstanceExists(void)
 {
 	if(mInstance != NULL)
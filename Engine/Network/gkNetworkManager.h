@@ -35,6 +35,7 @@
 #include "gkNetworkInstance.h"
 #include "gkNetworkServer.h"
 #include "gkNetworkClient.h"
+#include "gkNetworkReplication.h"
 
 #include <enet/enet.h>
 
@@ -44,6 +45,10 @@ class gkNetworkManager : public utSingleton<gkNetworkManager>
 private:
 
 	gkNetworkInstance * mInstance;
+	gkNetworkReplicator * mReplicator;
+
+	// 0 for a server instance, 1 for a client instance
+	int mType;
 
 	// initialize
 	// Input: None
@@ -117,6 +122,48 @@ public:
 		const gkString & pSender, const gkString & pReceiver, 
 		const gkString & pSubject, const gkString & pBody);
 
+	// flushNetworkInstance
+	// Input: None
+	// Return: None
+	// Send the messages of this tick as one packet, called by the engine every tick
+	void flushNetworkInstance(void);
+
+	// dispatchNetworkMessages
+	// Input: None
+	// Return: None
+	// Send the received messages through MessageManager, called by the engine every tick
+	void dispatchNetworkMessages(void);
+
+	// setNetworkInstanceCompression
+	// Input: pCompress Whether to compress the packets of the instance
+	// Return: None
+	// Must be set before the instance is started, and the same on every peer
+	void setNetworkInstanceCompression(bool pCompress);
+
+	// createReplicator
+	// Input: pScene The scene whose objects are replicated
+	// Return: gkNetworkReplicator The replicator, sending on a server and
+	//         receiving on a client, or NULL without a network instance
+	// There is one replicator, it is removed with the instance
+	gkNetworkReplicator * createReplicator(gkScene * pScene);
+
+	// getReplicator
+	// Input: None
+	// Return: gkNetworkReplicator The replicator if one exists
+	GK_INLINE gkNetworkReplicator * getReplicator(void) { return mReplicator; }
+
+	// destroyReplicator
+	// Input: None
+	// Return: None
+	// Remove the replicator, before its scene is destroyed
+	void destroyReplicator(void);
+
+	// updateReplication
+	// Input: pDelta The tick length in seconds
+	// Return: None
+	// Send or apply the snapshots, called by the engine every tick before the flush
+	void updateReplication(gkScalar pDelta);
+
 	// isNetworkInstanceExists
 	// Input: None
 	// Return: bool To indicate whether there is a network instance
@@ -0,0 +1,188 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Kai-Ting (Danil) Ko
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+
+#include "gkNetworkPacket.h"
+
+void gkNetworkPacketWriter::writeBytes(const void * pData, UTsize pLength)
+{
+	const UTuint8 * lBytes = (const UTuint8 *)pData;
+	mBuffer.insert(mBuffer.end(), lBytes, lBytes + pLength);
+}  // void gkNetworkPacketWriter::writeBytes
+
+void gkNetworkPacketWriter::writeVarU32(UTuint32 pValue)
+{
+	while (pValue >= 0x80)
+	{
+		mBuffer.push_back((UTuint8)(pValue | 0x80));
+		pValue >>= 7;
+	}  // while
+
+	mBuffer.push_back((UTuint8)pValue);
+}  // void gkNetworkPacketWriter::writeVarU32
+
+void gkNetworkPacketWriter::patchU32(UTsize pOffset, UTuint32 pValue)
+{
+	GK_ASSERT(pOffset + 4 <= mBuffer.size());
+
+	for (int i = 0; i < 4; ++i)
+	{
+		mBuffer[pOffset + i] = (UTuint8)(pValue >> (i * 8));
+	}  // for
+}  // void gkNetworkPacketWriter::patchU32
+
+bool gkNetworkPacketWriter::writeMessage(
+	const gkString & pSender, const gkString & pReceiver,
+	const gkString & pSubject, const gkString & pBody)
+{
+	if (pSender.length() > 0xFFFF || pReceiver.length() > 0xFFFF || pSubject.length() > 0xFFFF)
+	{
+		return false;
+	}  // if
+
+	writeU8(GK_NET_FRAME_MESSAGE);
+	writeU16((UTuint16)pSender.length());
+	writeU16((UTuint16)pReceiver.length());
+	writeU16((UTuint16)pSubject.length());
+	writeU32((UTuint32)pBody.length());
+
+	writeBytes(pSender.data(), pSender.length());
+	writeBytes(pReceiver.data(), pReceiver.length());
+	writeBytes(pSubject.data(), pSubject.length());
+	writeBytes(pBody.data(), pBody.length());
+
+	return true;
+}  // bool gkNetworkPacketWriter::writeMessage
+
+bool gkNetworkPacketReader::readU8(UTuint8 & pValue)
+{
+	if (mPosition + 1 > mLength)
+	{
+		return false;
+	}  // if
+
+	pValue = mData[mPosition++];
+	return true;
+}  // bool gkNetworkPacketReader::readU8
+
+bool gkNetworkPacketReader::readU16(UTuint16 & pValue)
+{
+	if (mPosition + 2 > mLength)
+	{
+		return false;
+	}  // if
+
+	pValue = (UTuint16)(mData[mPosition] | (mData[mPosition + 1] << 8));
+	mPosition += 2;
+	return true;
+}  // bool gkNetworkPacketReader::readU16
+
+bool gkNetworkPacketReader::readU32(UTuint32 & pValue)
+{
+	UTuint16 lLow, lHigh;
+	if (!readU16(lLow) || !readU16(lHigh))
+	{
+		return false;
+	}  // if
+
+	pValue = (UTuint32)lLow | ((UTuint32)lHigh << 16);
+	return true;
+}  // bool gkNetworkPacketReader::readU32
+
+bool gkNetworkPacketReader::readVarU32(UTuint32 & pValue)
+{
+	pValue = 0;
+
+	for (int lShift = 0; lShift < 35; lShift += 7)
+	{
+		UTuint8 lByte;
+		if (!readU8(lByte))
+		{
+			return false;
+		}  // if
+
+		pValue |= (UTuint32)(lByte & 0x7F) << lShift;
+		if ((lByte & 0x80) == 0)
+		{
+			return true;
+		}  // if
+	}  // for
+
+	// More than five bytes
+	return false;
+}  // bool gkNetworkPacketReader::readVarU32
+
+bool gkNetworkPacketReader::readVarS32(int & pValue)
+{
+	UTuint32 lValue;
+	if (!readVarU32(lValue))
+	{
+		return false;
+	}  // if
+
+	pValue = (int)(lValue >> 1) ^ -(int)(lValue & 1);
+	return true;
+}  // bool gkNetworkPacketReader::readVarS32
+
+bool gkNetworkPacketReader::readBlock(const UTuint8 *& pData, UTsize pLength)
+{
+	if (pLength > mLength - mPosition)
+	{
+		return false;
+	}  // if
+
+	pData = mData + mPosition;
+	mPosition += pLength;
+	return true;
+}  // bool gkNetworkPacketReader::readBlock
+
+bool gkNetworkPacketReader::readString(gkString & pValue, UTsize pLength)
+{
+	if (pLength > mLength - mPosition)
+	{
+		return false;
+	}  // if
+
+	pValue.assign((const char *)mData + mPosition, pLength);
+	mPosition += pLength;
+	return true;
+}  // bool gkNetworkPacketReader::readString
+
+bool gkNetworkPacketReader::readMessage(gkString & pSender, gkString & pReceiver, gkString & pSubject, gkString & pBody)
+{
+	UTuint16 lSenderLength, lReceiverLength, lSubjectLength;
+	UTuint32 lBodyLength;
+
+	if (!readU16(lSenderLength) || !readU16(lReceiverLength) || !readU16(lSubjectLength) || !readU32(lBodyLength))
+	{
+		return false;
+	}  // if
+
+	return readString(pSender, lSenderLength) &&
+		readString(pReceiver, lReceiverLength) &&
+		readString(pSubject, lSubjectLength) &&
+		readString(pBody, lBodyLength);
+}  // bool gkNetworkPacketReader::readMessage
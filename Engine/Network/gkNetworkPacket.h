@@ -0,0 +1,164 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Kai-Ting (Danil) Ko
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _gkNetworkPacket_h_
+#define _gkNetworkPacket_h_
+
+#include "gkCommon.h"
+#include <vector>
+
+// Wire format of network packets, integers are little endian.
+// A packet is a sequence of frames, each starting with its type:
+//   GK_NET_FRAME_MESSAGE   u16 from, u16 to, u16 subject, u32 body length,
+//                          then the four strings without terminators
+//   GK_NET_FRAME_SNAPSHOT  u32 length, then a gkReplicationEncoder snapshot
+enum gkNetworkFrameType
+{
+	GK_NET_FRAME_MESSAGE = 1,
+	GK_NET_FRAME_SNAPSHOT = 2
+};
+
+// gkNetworkPacketWriter
+// Appends frames to a growing byte buffer, clearing keeps the memory
+class gkNetworkPacketWriter
+{
+protected:
+	std::vector<UTuint8> mBuffer;
+
+public:
+	// writeU8, writeU16, writeU32, writeBytes
+	// Input: The value or bytes to append
+	// Return: None
+	GK_INLINE void writeU8(UTuint8 pValue)
+	{
+		mBuffer.push_back(pValue);
+	}  // void writeU8
+
+	GK_INLINE void writeU16(UTuint16 pValue)
+	{
+		mBuffer.push_back((UTuint8)(pValue & 0xFF));
+		mBuffer.push_back((UTuint8)(pValue >> 8));
+	}  // void writeU16
+
+	GK_INLINE void writeU32(UTuint32 pValue)
+	{
+		writeU16((UTuint16)(pValue & 0xFFFF));
+		writeU16((UTuint16)(pValue >> 16));
+	}  // void writeU32
+
+	void writeBytes(const void * pData, UTsize pLength);
+
+	// writeVarU32, writeVarS32
+	// Input: pValue The value to append
+	// Return: None
+	// Seven bits per byte, small values take one byte. Signed values are
+	// zigzag coded so small negative values stay small too
+	void writeVarU32(UTuint32 pValue);
+
+	GK_INLINE void writeVarS32(int pValue)
+	{
+		writeVarU32(((UTuint32)pValue << 1) ^ (UTuint32)(pValue >> 31));
+	}  // void writeVarS32
+
+	// patchU32
+	// Input: pOffset Offset of a value written earlier with writeU32
+	//        pValue The value to store there
+	// Return: None
+	// Fill in lengths and counts known once the frame is written
+	void patchU32(UTsize pOffset, UTuint32 pValue);
+
+	// writeMessage
+	// Input: pSender, pReceiver, pSubject, pBody The message parts
+	// Return: bool False if a part is too long for the frame
+	// Append a GK_NET_FRAME_MESSAGE frame
+	bool writeMessage(
+		const gkString & pSender, const gkString & pReceiver,
+		const gkString & pSubject, const gkString & pBody);
+
+	// clear
+	// Input: None
+	// Return: None
+	// Empty the buffer, the memory is kept for the next frames
+	GK_INLINE void clear(void)                  { mBuffer.clear(); }
+
+	GK_INLINE bool empty(void) const            { return mBuffer.empty(); }
+	GK_INLINE UTsize size(void) const           { return (UTsize)mBuffer.size(); }
+	GK_INLINE const UTuint8 * ptr(void) const   { return mBuffer.empty() ? 0 : &mBuffer[0]; }
+
+	// swap
+	// Input: pOther The writer to exchange buffers with
+	// Return: None
+	// Hand a batch over without copying it
+	GK_INLINE void swap(gkNetworkPacketWriter & pOther) { mBuffer.swap(pOther.mBuffer); }
+};  // gkNetworkPacketWriter
+
+// gkNetworkPacketReader
+// Reads frames from received bytes, every read is bounds checked
+class gkNetworkPacketReader
+{
+protected:
+	const UTuint8 * mData;
+	UTsize mLength;
+	UTsize mPosition;
+
+public:
+	gkNetworkPacketReader(const void * pData, UTsize pLength)
+		:   mData((const UTuint8 *)pData), mLength(pLength), mPosition(0)
+	{
+	}  // gkNetworkPacketReader
+
+	// atEnd
+	// Input: None
+	// Return: bool True once every byte has been read
+	GK_INLINE bool atEnd(void) const { return mPosition >= mLength; }
+
+	bool readU8(UTuint8 & pValue);
+	bool readU16(UTuint16 & pValue);
+	bool readU32(UTuint32 & pValue);
+	bool readVarU32(UTuint32 & pValue);
+	bool readVarS32(int & pValue);
+
+	// readBlock
+	// Input: pLength The number of bytes to read
+	// Return: bool False if the packet is shorter
+	// Points pData at the next bytes in place and skips them
+	bool readBlock(const UTuint8 *& pData, UTsize pLength);
+
+	// readString
+	// Input: pLength The number of bytes to read
+	// Return: bool False if the packet is shorter
+	// Assigns into pValue, which reuses its memory
+	bool readString(gkString & pValue, UTsize pLength);
+
+	// readMessage
+	// Input: None
+	// Return: bool False on a malformed frame
+	// Read the body of a GK_NET_FRAME_MESSAGE frame, the type is already read
+	bool readMessage(gkString & pSender, gkString & pReceiver, gkString & pSubject, gkString & pBody);
+};  // gkNetworkPacketReader
+
+#endif  // _gkNetworkPacket_h_
@@ -0,0 +1,997 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Kai-Ting (Danil) Ko
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+
+#include "gkNetworkReplication.h"
+#include "gkNetworkInstance.h"
+#include "gkGameObject.h"
+#include "gkScene.h"
+#include "gkVariable.h"
+#include "gkLogger.h"
+
+// Object masks of snapshot entries
+#define GK_REPL_POSITION     0x01
+#define GK_REPL_ORIENTATION  0x02
+#define GK_REPL_LINEAR       0x04
+#define GK_REPL_ANGULAR      0x08
+#define GK_REPL_VARIABLES    0x10
+// Names follow, the object starts from zero baselines
+#define GK_REPL_NAMES        0x20
+#define GK_REPL_REMOVED      0x80
+#define GK_REPL_FULL         0x3F
+
+// Snapshot flags
+#define GK_REPL_KEYFRAME     0x01
+
+#define GK_REPL_MAX_ID       0xFFFF
+#define GK_REPL_MAX_VARIABLES 0xFF
+// Quantized values stay within +-2^30, so their deltas fit in 32 bits
+#define GK_REPL_MAX_QUANTIZED 0x3FFFFFFF
+
+static int gkReplQuantize(gkScalar pValue, gkScalar pStep)
+{
+	const gkScalar lValue = gkMath::Floor(pValue / pStep + gkScalar(0.5));
+
+	// Casting floats out of the int range is undefined, clamp them first
+	if (lValue >= (gkScalar)GK_REPL_MAX_QUANTIZED)
+	{
+		return GK_REPL_MAX_QUANTIZED;
+	}  // if
+
+	if (lValue <= -(gkScalar)GK_REPL_MAX_QUANTIZED)
+	{
+		return -GK_REPL_MAX_QUANTIZED;
+	}  // if
+
+	// NaN
+	if (lValue != lValue)
+	{
+		return 0;
+	}  // if
+
+	return (int)lValue;
+}  // int gkReplQuantize
+
+// Smallest three: the index of the largest component in the top two bits,
+// the other three in 10 bits each. The largest one is rebuilt from them
+static UTuint32 gkReplPackQuaternion(const gkQuaternion & pValue)
+{
+	gkQuaternion lValue = pValue;
+	lValue.normalise();
+
+	const gkScalar lComponents[4] = {lValue.w, lValue.x, lValue.y, lValue.z};
+
+	int lLargest = 0;
+	for (int i = 1; i < 4; ++i)
+	{
+		if (gkAbs(lComponents[i]) > gkAbs(lComponents[lLargest]))
+		{
+			lLargest = i;
+		}  // if
+	}  // for
+
+	// q and -q are the same rotation, keep the largest positive
+	const gkScalar lSign = lComponents[lLargest] < 0 ? gkScalar(-1) : gkScalar(1);
+
+	UTuint32 lPacked = (UTuint32)lLargest << 30;
+	int lShift = 20;
+	for (int i = 0; i < 4; ++i)
+	{
+		if (i == lLargest)
+		{
+			continue;
+		}  // if
+
+		// The others are within +-1/sqrt(2)
+		gkScalar lUnit = (lComponents[i] * lSign * gkScalar(0.70710678) + gkScalar(0.5));
+		int lBits = (int)(gkClamp<gkScalar>(lUnit, 0, 1) * 1023 + gkScalar(0.5));
+		lPacked |= (UTuint32)lBits << lShift;
+		lShift -= 10;
+	}  // for
+
+	return lPacked;
+}  // UTuint32 gkReplPackQuaternion
+
+static gkQuaternion gkReplUnpackQuaternion(UTuint32 pPacked)
+{
+	const int lLargest = (int)(pPacked >> 30);
+
+	gkScalar lComponents[4];
+	gkScalar lSum = 0;
+	int lShift = 20;
+	for (int i = 0; i < 4; ++i)
+	{
+		if (i == lLargest)
+		{
+			continue;
+		}  // if
+
+		gkScalar lUnit = (gkScalar)((pPacked >> lShift) & 0x3FF) / 1023;
+		lComponents[i] = (lUnit - gkScalar(0.5)) * gkScalar(1.41421356);
+		lSum += lComponents[i] * lComponents[i];
+		lShift -= 10;
+	}  // for
+
+	lComponents[lLargest] = gkMath::Sqrt(gkMax<gkScalar>(0, 1 - lSum));
+
+	gkQuaternion lValue(lComponents[0], lComponents[1], lComponents[2], lComponents[3]);
+	lValue.normalise();
+	return lValue;
+}  // gkQuaternion gkReplUnpackQuaternion
+
+static void gkReplWriteString(gkNetworkPacketWriter & pOut, const gkString & pValue)
+{
+	UTuint16 lLength = (UTuint16)gkMin<UTsize>(pValue.length(), 0xFFFF);
+	pOut.writeU16(lLength);
+	pOut.writeBytes(pValue.data(), lLength);
+}  // void gkReplWriteString
+
+static bool gkReplReadString(gkNetworkPacketReader & pIn, gkString & pValue)
+{
+	UTuint16 lLength;
+	return pIn.readU16(lLength) && pIn.readString(pValue, lLength);
+}  // bool gkReplReadString
+
+static void gkReplQuantize(const gkVector3 & pValue, gkScalar pStep, int * pOut)
+{
+	pOut[0] = gkReplQuantize(pValue.x, pStep);
+	pOut[1] = gkReplQuantize(pValue.y, pStep);
+	pOut[2] = gkReplQuantize(pValue.z, pStep);
+}  // void gkReplQuantize
+
+static bool gkReplEqual(const int * pA, const int * pB)
+{
+	return pA[0] == pB[0] && pA[1] == pB[1] && pA[2] == pB[2];
+}  // bool gkReplEqual
+
+static void gkReplWriteDelta(gkNetworkPacketWriter & pOut, const int * pValue, const int * pBase)
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		pOut.writeVarS32(pValue[i] - pBase[i]);
+	}  // for
+}  // void gkReplWriteDelta
+
+static bool gkReplReadDelta(gkNetworkPacketReader & pIn, int * pValue)
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		int lDelta;
+		if (!pIn.readVarS32(lDelta))
+		{
+			return false;
+		}  // if
+
+		pValue[i] += lDelta;
+	}  // for
+
+	return true;
+}  // bool gkReplReadDelta
+
+static void gkReplCopyVariables(gkReplicationState::Variables & pTo, const gkReplicationState::Variables & pFrom)
+{
+	pTo.resize(pFrom.size());
+	for (UTsize i = 0; i < pFrom.size(); ++i)
+	{
+		pTo[i].name = pFrom[i].name;
+		pTo[i].type = pFrom[i].type;
+		pTo[i].value = pFrom[i].value;
+	}  // for
+}  // void gkReplCopyVariables
+
+gkReplicationState::gkReplicationState()
+	:   id(0),
+	position(gkVector3::ZERO),
+	orientation(gkQuaternion::IDENTITY),
+	linearVelocity(gkVector3::ZERO),
+	angularVelocity(gkVector3::ZERO)
+{
+}  // gkReplicationState::gkReplicationState
+
+void gkReplicationState::copy(const gkReplicationState & pOther)
+{
+	id = pOther.id;
+	name = pOther.name;
+	position = pOther.position;
+	orientation = pOther.orientation;
+	linearVelocity = pOther.linearVelocity;
+	angularVelocity = pOther.angularVelocity;
+	gkReplCopyVariables(variables, pOther.variables);
+}  // void gkReplicationState::copy
+
+void gkReplicationSnapshot::copy(const gkReplicationSnapshot & pOther)
+{
+	sequence = pOther.sequence;
+	time = pOther.time;
+
+	states.resize(pOther.states.size());
+	for (UTsize i = 0; i < pOther.states.size(); ++i)
+	{
+		states[i].copy(pOther.states[i]);
+	}  // for
+}  // void gkReplicationSnapshot::copy
+
+gkReplicationEncoder::gkReplicationEncoder()
+	:   mSequence(0),
+	mStamp(0),
+	mPositionStep(gkScalar(1.0 / 1024.0)),
+	mVelocityStep(gkScalar(1.0 / 256.0))
+{
+}  // gkReplicationEncoder::gkReplicationEncoder
+
+void gkReplicationEncoder::setPrecision(gkScalar pPositionStep, gkScalar pVelocityStep)
+{
+	GK_ASSERT(pPositionStep > 0 && pVelocityStep > 0);
+
+	mPositionStep = pPositionStep;
+	mVelocityStep = pVelocityStep;
+	reset();
+}  // void gkReplicationEncoder::setPrecision
+
+void gkReplicationEncoder::reset(void)
+{
+	for (UTsize i = 0; i < mBaselines.size(); ++i)
+	{
+		mBaselines[i].sent = false;
+	}  // for
+}  // void gkReplicationEncoder::reset
+
+UTsize gkReplicationEncoder::encode(const gkReplicationStates & pStates, UTuint32 pTime, bool pKeyframe, gkNetworkPacketWriter & pOut)
+{
+	static const int lZero[3] = {0, 0, 0};
+
+	++mStamp;
+
+	const UTsize lFrameStart = pOut.size();
+	pOut.writeU8(GK_NET_FRAME_SNAPSHOT);
+	const UTsize lLengthOffset = pOut.size();
+	pOut.writeU32(0);
+
+	pOut.writeU32(mSequence);
+	pOut.writeU32(pTime);
+	pOut.writeU8(pKeyframe ? GK_REPL_KEYFRAME : 0);
+	const UTsize lCountOffset = pOut.size();
+	pOut.writeU32(0);
+
+	UTuint32 lCount = 0;
+	int lPosition[3], lLinear[3], lAngular[3];
+
+	for (UTsize i = 0; i < pStates.size(); ++i)
+	{
+		const gkReplicationState & lState = pStates[i];
+		GK_ASSERT(i == 0 || pStates[i - 1].id < lState.id);
+
+		if (lState.id >= mBaselines.size())
+		{
+			mBaselines.resize(lState.id + 1);
+		}  // if
+
+		Baseline & lBase = mBaselines[lState.id];
+		lBase.stamp = mStamp;
+
+		gkReplQuantize(lState.position, mPositionStep, lPosition);
+		gkReplQuantize(lState.linearVelocity, mVelocityStep, lLinear);
+		gkReplQuantize(lState.angularVelocity, mVelocityStep, lAngular);
+		const UTuint32 lOrientation = gkReplPackQuaternion(lState.orientation);
+
+		UTuint8 lMask = GK_REPL_FULL;
+		if (!pKeyframe && lBase.sent && lBase.variables.size() == lState.variables.size())
+		{
+			lMask = 0;
+
+			if (!gkReplEqual(lPosition, lBase.position))
+				lMask |= GK_REPL_POSITION;
+			if (lOrientation != lBase.orientation)
+				lMask |= GK_REPL_ORIENTATION;
+			if (!gkReplEqual(lLinear, lBase.linearVelocity))
+				lMask |= GK_REPL_LINEAR;
+			if (!gkReplEqual(lAngular, lBase.angularVelocity))
+				lMask |= GK_REPL_ANGULAR;
+
+			for (UTsize v = 0; v < lState.variables.size(); ++v)
+			{
+				if (lState.variables[v].type != lBase.variables[v].type ||
+					lState.variables[v].value != lBase.variables[v].value)
+				{
+					lMask |= GK_REPL_VARIABLES;
+					break;
+				}  // if
+			}  // for
+
+			if (lMask == 0)
+			{
+				// Unchanged, the clients keep the previous state
+				continue;
+			}  // if
+		}  // if
+
+		const bool lFull = (lMask & GK_REPL_NAMES) != 0;
+
+		pOut.writeVarU32(lState.id);
+		pOut.writeU8(lMask);
+
+		if (lFull)
+		{
+			gkReplWriteString(pOut, lState.name);
+			pOut.writeVarU32(lState.variables.size());
+			for (UTsize v = 0; v < lState.variables.size(); ++v)
+			{
+				gkReplWriteString(pOut, lState.variables[v].name);
+			}  // for
+		}  // if
+
+		if (lMask & GK_REPL_POSITION)
+			gkReplWriteDelta(pOut, lPosition, lFull ? lZero : lBase.position);
+		if (lMask & GK_REPL_ORIENTATION)
+			pOut.writeU32(lOrientation);
+		if (lMask & GK_REPL_LINEAR)
+			gkReplWriteDelta(pOut, lLinear, lFull ? lZero : lBase.linearVelocity);
+		if (lMask & GK_REPL_ANGULAR)
+			gkReplWriteDelta(pOut, lAngular, lFull ? lZero : lBase.angularVelocity);
+
+		if (lMask & GK_REPL_VARIABLES)
+		{
+			UTuint32 lChanged = 0;
+			for (UTsize v = 0; v < lState.variables.size(); ++v)
+			{
+				if (lFull || lState.variables[v].type != lBase.variables[v].type ||
+					lState.variables[v].value != lBase.variables[v].value)
+				{
+					++lChanged;
+				}  // if
+			}  // for
+
+			pOut.writeVarU32(lChanged);
+			for (UTsize v = 0; v < lState.variables.size(); ++v)
+			{
+				const gkReplicationState::Variable & lVariable = lState.variables[v];
+				if (lFull || lVariable.type != lBase.variables[v].type || lVariable.value != lBase.variables[v].value)
+				{
+					pOut.writeVarU32(v);
+					pOut.writeU8((UTuint8)lVariable.type);
+					gkReplWriteString(pOut, lVariable.value);
+				}  // if
+			}  // for
+		}  // if
+
+		for (int k = 0; k < 3; ++k)
+		{
+			lBase.position[k] = lPosition[k];
+			lBase.linearVelocity[k] = lLinear[k];
+			lBase.angularVelocity[k] = lAngular[k];
+		}  // for
+
+		lBase.orientation = lOrientation;
+		lBase.sent = true;
+		gkReplCopyVariables(lBase.variables, lState.variables);
+
+		++lCount;
+	}  // for
+
+	// Objects no longer replicated, a keyframe replaces every object anyway
+	for (UTsize i = 0; i < mBaselines.size(); ++i)
+	{
+		Baseline & lBase = mBaselines[i];
+		if (lBase.sent && lBase.stamp != mStamp)
+		{
+			lBase.sent = false;
+
+			if (!pKeyframe)
+			{
+				pOut.writeVarU32(i);
+				pOut.writeU8(GK_REPL_REMOVED);
+				++lCount;
+			}  // if
+		}  // if
+	}  // for
+
+	pOut.patchU32(lCountOffset, lCount);
+	pOut.patchU32(lLengthOffset, (UTuint32)(pOut.size() - lLengthOffset - 4));
+
+	++mSequence;
+
+	return pOut.size() - lFrameStart;
+}  // UTsize gkReplicationEncoder::encode
+
+gkReplicationDecoder::gkReplicationDecoder()
+	:   mSequence(0),
+	mSynchronized(false),
+	mPositionStep(gkScalar(1.0 / 1024.0)),
+	mVelocityStep(gkScalar(1.0 / 256.0))
+{
+}  // gkReplicationDecoder::gkReplicationDecoder
+
+void gkReplicationDecoder::setPrecision(gkScalar pPositionStep, gkScalar pVelocityStep)
+{
+	GK_ASSERT(pPositionStep > 0 && pVelocityStep > 0);
+
+	mPositionStep = pPositionStep;
+	mVelocityStep = pVelocityStep;
+}  // void gkReplicationDecoder::setPrecision
+
+void gkReplicationDecoder::reset(void)
+{
+	for (UTsize i = 0; i < mBaselines.size(); ++i)
+	{
+		mBaselines[i].live = false;
+	}  // for
+
+	mSynchronized = false;
+}  // void gkReplicationDecoder::reset
+
+bool gkReplicationDecoder::decode(const UTuint8 * pData, UTsize pLength, gkReplicationSnapshot & pSnapshot)
+{
+	gkNetworkPacketReader lReader(pData, pLength);
+
+	UTuint32 lSequence, lTime, lCount;
+	UTuint8 lFlags;
+	if (!lReader.readU32(lSequence) || !lReader.readU32(lTime) || !lReader.readU8(lFlags) || !lReader.readU32(lCount))
+	{
+		mSynchronized = false;
+		return false;
+	}  // if
+
+	const bool lKeyframe = (lFlags & GK_REPL_KEYFRAME) != 0;
+	if (!lKeyframe && (!mSynchronized || lSequence != mSequence + 1))
+	{
+		// Wait for the next keyframe
+		mSynchronized = false;
+		return false;
+	}  // if
+
+	if (lKeyframe)
+	{
+		for (UTsize i = 0; i < mBaselines.size(); ++i)
+		{
+			mBaselines[i].live = false;
+		}  // for
+	}  // if
+
+	// A malformed frame leaves the baselines half updated, resynchronize
+	mSynchronized = false;
+
+	for (UTuint32 n = 0; n < lCount; ++n)
+	{
+		UTuint32 lId;
+		UTuint8 lMask;
+		if (!lReader.readVarU32(lId) || lId > GK_REPL_MAX_ID || !lReader.readU8(lMask))
+		{
+			return false;
+		}  // if
+
+		if (lId >= mBaselines.size())
+		{
+			mBaselines.resize(lId + 1);
+		}  // if
+
+		Baseline & lBase = mBaselines[lId];
+
+		if (lMask & GK_REPL_REMOVED)
+		{
+			lBase.live = false;
+			continue;
+		}  // if
+
+		if (lMask & GK_REPL_NAMES)
+		{
+			UTuint32 lVariables;
+			if (!gkReplReadString(lReader, lBase.name) || !lReader.readVarU32(lVariables) || lVariables > GK_REPL_MAX_VARIABLES)
+			{
+				return false;
+			}  // if
+
+			lBase.variables.resize(lVariables);
+			for (UTuint32 v = 0; v < lVariables; ++v)
+			{
+				if (!gkReplReadString(lReader, lBase.variables[v].name))
+				{
+					return false;
+				}  // if
+
+				lBase.variables[v].type = 0;
+				lBase.variables[v].value.clear();
+			}  // for
+
+			for (int k = 0; k < 3; ++k)
+			{
+				lBase.position[k] = lBase.linearVelocity[k] = lBase.angularVelocity[k] = 0;
+			}  // for
+
+			lBase.orientation = gkReplPackQuaternion(gkQuaternion::IDENTITY);
+			lBase.live = true;
+		}  // if
+		else if (!lBase.live)
+		{
+			return false;
+		}  // else if
+
+		if ((lMask & GK_REPL_POSITION) && !gkReplReadDelta(lReader, lBase.position))
+			return false;
+		if ((lMask & GK_REPL_ORIENTATION) && !lReader.readU32(lBase.orientation))
+			return false;
+		if ((lMask & GK_REPL_LINEAR) && !gkReplReadDelta(lReader, lBase.linearVelocity))
+			return false;
+		if ((lMask & GK_REPL_ANGULAR) && !gkReplReadDelta(lReader, lBase.angularVelocity))
+			return false;
+
+		if (lMask & GK_REPL_VARIABLES)
+		{
+			UTuint32 lChanged;
+			if (!lReader.readVarU32(lChanged) || lChanged > lBase.variables.size())
+			{
+				return false;
+			}  // if
+
+			for (UTuint32 c = 0; c < lChanged; ++c)
+			{
+				UTuint32 lIndex;
+				UTuint8 lType;
+				if (!lReader.readVarU32(lIndex) || lIndex >= lBase.variables.size() ||
+					!lReader.readU8(lType) || !gkReplReadString(lReader, lBase.variables[lIndex].value))
+				{
+					return false;
+				}  // if
+
+				lBase.variables[lIndex].type = lType;
+			}  // for
+		}  // if
+	}  // for
+
+	mSequence = lSequence;
+	mSynchronized = true;
+
+	pSnapshot.sequence = lSequence;
+	pSnapshot.time = lTime;
+
+	UTsize lLive = 0;
+	for (UTsize i = 0; i < mBaselines.size(); ++i)
+	{
+		if (mBaselines[i].live)
+		{
+			++lLive;
+		}  // if
+	}  // for
+
+	pSnapshot.states.resize(lLive);
+
+	UTsize lIndex = 0;
+	for (UTsize i = 0; i < mBaselines.size(); ++i)
+	{
+		const Baseline & lBase = mBaselines[i];
+		if (!lBase.live)
+		{
+			continue;
+		}  // if
+
+		gkReplicationState & lState = pSnapshot.states[lIndex++];
+		lState.id = (UTuint16)i;
+		lState.name = lBase.name;
+		lState.position = gkVector3((gkScalar)lBase.position[0], (gkScalar)lBase.position[1], (gkScalar)lBase.position[2]) * mPositionStep;
+		lState.orientation = gkReplUnpackQuaternion(lBase.orientation);
+		lState.linearVelocity = gkVector3((gkScalar)lBase.linearVelocity[0], (gkScalar)lBase.linearVelocity[1], (gkScalar)lBase.linearVelocity[2]) * mVelocityStep;
+		lState.angularVelocity = gkVector3((gkScalar)lBase.angularVelocity[0], (gkScalar)lBase.angularVelocity[1], (gkScalar)lBase.angularVelocity[2]) * mVelocityStep;
+		gkReplCopyVariables(lState.variables, lBase.variables);
+	}  // for
+
+	return true;
+}  // bool gkReplicationDecoder::decode
+
+gkReplicationInterpolator::gkReplicationInterpolator(int pCapacity)
+	:   mFirst(0),
+	mCount(0)
+{
+	mSnapshots.resize(gkMax(pCapacity, 2));
+}  // gkReplicationInterpolator::gkReplicationInterpolator
+
+const gkReplicationSnapshot & gkReplicationInterpolator::at(int pIndex) const
+{
+	return mSnapshots[(mFirst + pIndex) % mSnapshots.size()];
+}  // const gkReplicationSnapshot & gkReplicationInterpolator::at
+
+void gkReplicationInterpolator::push(const gkReplicationSnapshot & pSnapshot)
+{
+	if (mCount > 0 && pSnapshot.time <= getLatestTime())
+	{
+		return;
+	}  // if
+
+	const int lCapacity = (int)mSnapshots.size();
+	if (mCount == lCapacity)
+	{
+		// Reuse the oldest slot
+		mFirst = (mFirst + 1) % lCapacity;
+		--mCount;
+	}  // if
+
+	mSnapshots[(mFirst + mCount) % lCapacity].copy(pSnapshot);
+	++mCount;
+}  // void gkReplicationInterpolator::push
+
+void gkReplicationInterpolator::clear(void)
+{
+	mFirst = 0;
+	mCount = 0;
+}  // void gkReplicationInterpolator::clear
+
+bool gkReplicationInterpolator::sample(UTuint32 pTime, gkReplicationStates & pStates) const
+{
+	if (mCount == 0)
+	{
+		return false;
+	}  // if
+
+	// The last snapshot at or before pTime, the oldest one when pTime is earlier
+	int lFrom = 0;
+	while (lFrom + 1 < mCount && at(lFrom + 1).time <= pTime)
+	{
+		++lFrom;
+	}  // while
+
+	const gkReplicationSnapshot & lA = at(lFrom);
+	pStates.resize(lA.states.size());
+	for (UTsize i = 0; i < lA.states.size(); ++i)
+	{
+		pStates[i].copy(lA.states[i]);
+	}  // for
+
+	if (lFrom + 1 >= mCount || pTime <= lA.time)
+	{
+		return true;
+	}  // if
+
+	const gkReplicationSnapshot & lB = at(lFrom + 1);
+	const gkScalar lT = (gkScalar)(pTime - lA.time) / (gkScalar)(lB.time - lA.time);
+
+	// Both are sorted by id, blend the objects found in both
+	UTsize j = 0;
+	for (UTsize i = 0; i < pStates.size(); ++i)
+	{
+		gkReplicationState & lState = pStates[i];
+		while (j < lB.states.size() && lB.states[j].id < lState.id)
+		{
+			++j;
+		}  // while
+
+		if (j >= lB.states.size())
+		{
+			break;
+		}  // if
+
+		const gkReplicationState & lNext = lB.states[j];
+		if (lNext.id != lState.id)
+		{
+			continue;
+		}  // if
+
+		lState.position += (lNext.position - lState.position) * lT;
+		lState.linearVelocity += (lNext.linearVelocity - lState.linearVelocity) * lT;
+		lState.angularVelocity += (lNext.angularVelocity - lState.angularVelocity) * lT;
+		lState.orientation = gkQuaternion::nlerp(lT, lState.orientation, lNext.orientation, true);
+	}  // for
+
+	return true;
+}  // bool gkReplicationInterpolator::sample
+
+gkNetworkReplicator::gkNetworkReplicator(gkScene * pScene, bool pServer)
+	:   mScene(pScene),
+	mServer(pServer),
+	mRate(20),
+	mDelay(100),
+	mKeyframeInterval(40),
+	mAccumulator(0),
+	mTime(0),
+	mTimeFraction(0),
+	mConnectCount(0),
+	mPlaying(false),
+	mLastSnapshotSize(0)
+{
+}  // gkNetworkReplicator::gkNetworkReplicator
+
+void gkNetworkReplicator::setRate(int pRate)
+{
+	mRate = gkMax(pRate, 1);
+}  // void gkNetworkReplicator::setRate
+
+void gkNetworkReplicator::setInterpolationDelay(UTuint32 pDelay)
+{
+	mDelay = pDelay;
+	mPlaying = false;
+}  // void gkNetworkReplicator::setInterpolationDelay
+
+void gkNetworkReplicator::setKeyframeInterval(int pInterval)
+{
+	mKeyframeInterval = gkMax(pInterval, 1);
+}  // void gkNetworkReplicator::setKeyframeInterval
+
+void gkNetworkReplicator::setPrecision(gkScalar pPositionStep, gkScalar pVelocityStep)
+{
+	mEncoder.setPrecision(pPositionStep, pVelocityStep);
+	mDecoder.setPrecision(pPositionStep, pVelocityStep);
+	mDecoder.reset();
+}  // void gkNetworkReplicator::setPrecision
+
+bool gkNetworkReplicator::addObject(gkGameObject * pObject)
+{
+	return addObject(pObject, utArray<gkString>());
+}  // bool gkNetworkReplicator::addObject
+
+bool gkNetworkReplicator::addObject(gkGameObject * pObject, const utArray<gkString> & pVariables)
+{
+	if (!mServer || pObject == NULL)
+	{
+		return false;
+	}  // if
+
+	for (UTsize i = 0; i < mEntries.size(); ++i)
+	{
+		if (mEntries[i].object == pObject)
+		{
+			return false;
+		}  // if
+	}  // for
+
+	// The lowest free id, entries are sorted by id
+	UTsize lId = 0;
+	while (lId < mEntries.size() && mEntries[lId].id == lId)
+	{
+		++lId;
+	}  // while
+
+	if (lId > GK_REPL_MAX_ID)
+	{
+		gkLogger::write("Network replication is out of object ids.\n");
+		return false;
+	}  // if
+
+	Entry lEntry;
+	lEntry.id = (UTuint16)lId;
+	lEntry.object = pObject;
+
+	for (UTsize i = 0; i < pVariables.size() && lEntry.variables.size() < GK_REPL_MAX_VARIABLES; ++i)
+	{
+		gkVariable * lVariable = pObject->getVariable(pVariables[i]);
+		if (lVariable == NULL)
+		{
+			gkLogger::write("Object " + pObject->getName() + " has no variable " + pVariables[i] + " to replicate.\n");
+			continue;
+		}  // if
+
+		lEntry.variables.push_back(lVariable);
+	}  // for
+
+	// Keep the order by moving the entries after lId up
+	mEntries.push_back(lEntry);
+	for (UTsize i = mEntries.size() - 1; i > lId; --i)
+	{
+		mEntries[i] = mEntries[i - 1];
+	}  // for
+
+	mEntries[lId] = lEntry;
+	return true;
+}  // bool gkNetworkReplicator::addObject
+
+void gkNetworkReplicator::removeObject(gkGameObject * pObject)
+{
+	if (!mServer)
+	{
+		// Entries are indexed by id, forget the object and resolve its name again
+		for (UTsize i = 0; i < mEntries.size(); ++i)
+		{
+			if (mEntries[i].object == pObject)
+			{
+				mEntries[i].object = NULL;
+				mEntries[i].resolved.clear();
+				mEntries[i].applied.clear();
+			}  // if
+		}  // for
+
+		return;
+	}  // if
+
+	for (UTsize i = 0; i < mEntries.size(); ++i)
+	{
+		if (mEntries[i].object == pObject)
+		{
+			for (UTsize j = i + 1; j < mEntries.size(); ++j)
+			{
+				mEntries[j - 1] = mEntries[j];
+			}  // for
+
+			mEntries.pop_back();
+			return;
+		}  // if
+	}  // for
+}  // void gkNetworkReplicator::removeObject
+
+void gkNetworkReplicator::receiveSnapshot(const UTuint8 * pData, UTsize pLength)
+{
+	if (mServer)
+	{
+		return;
+	}  // if
+
+	if (mDecoder.decode(pData, pLength, mSnapshot))
+	{
+		mInterpolator.push(mSnapshot);
+	}  // if
+}  // void gkNetworkReplicator::receiveSnapshot
+
+void gkNetworkReplicator::advanceTime(gkScalar pDelta)
+{
+	mTimeFraction += pDelta * 1000;
+
+	const UTuint32 lMilliseconds = (UTuint32)mTimeFraction;
+	mTime += lMilliseconds;
+	mTimeFraction -= (gkScalar)lMilliseconds;
+}  // void gkNetworkReplicator::advanceTime
+
+void gkNetworkReplicator::update(gkNetworkInstance * pInstance, gkScalar pDelta)
+{
+	advanceTime(pDelta);
+
+	if (!mServer)
+	{
+		applySnapshot();
+		return;
+	}  // if
+
+	if (pInstance == NULL)
+	{
+		return;
+	}  // if
+
+	const gkScalar lInterval = gkScalar(1) / mRate;
+
+	mAccumulator += pDelta;
+	if (mAccumulator >= lInterval)
+	{
+		// After a long tick send one snapshot, not a burst of them
+		mAccumulator = gkMin(mAccumulator - lInterval, lInterval);
+		sendSnapshot(pInstance);
+	}  // if
+}  // void gkNetworkReplicator::update
+
+void gkNetworkReplicator::sendSnapshot(gkNetworkInstance * pInstance)
+{
+	mStates.resize(mEntries.size());
+
+	for (UTsize i = 0; i < mEntries.size(); ++i)
+	{
+		const Entry & lEntry = mEntries[i];
+		gkGameObject * lObject = lEntry.object;
+		gkReplicationState & lState = mStates[i];
+
+		lState.id = lEntry.id;
+		lState.name = lObject->getName();
+		lState.position = lObject->getWorldPosition();
+		lState.orientation = lObject->getWorldOrientation();
+		lState.linearVelocity = lObject->getLinearVelocity();
+		lState.angularVelocity = lObject->getAngularVelocity();
+
+		lState.variables.resize(lEntry.variables.size());
+		for (UTsize v = 0; v < lEntry.variables.size(); ++v)
+		{
+			const gkVariable * lVariable = lEntry.variables[v];
+			lState.variables[v].name = lVariable->getName();
+			lState.variables[v].type = lVariable->getType();
+			lState.variables[v].value = lVariable->getValueString();
+		}  // for
+	}  // for
+
+	// Late joiners start from a keyframe, send one as soon as a peer connects
+	bool lKeyframe = mEncoder.getSequence() % mKeyframeInterval == 0;
+
+	const int lConnectCount = pInstance->getConnectCount();
+	if (lConnectCount != mConnectCount)
+	{
+		mConnectCount = lConnectCount;
+		lKeyframe = true;
+	}  // if
+
+	mFrame.clear();
+	mLastSnapshotSize = mEncoder.encode(mStates, mTime, lKeyframe, mFrame);
+	pInstance->sendFrames(mFrame);
+}  // void gkNetworkReplicator::sendSnapshot
+
+void gkNetworkReplicator::applySnapshot(void)
+{
+	if (mInterpolator.empty())
+	{
+		return;
+	}  // if
+
+	const UTuint32 lLatest = mInterpolator.getLatestTime();
+	const UTuint32 lTarget = lLatest > mDelay ? lLatest - mDelay : 0;
+
+	// Play smoothly, unless the playback fell too far behind
+	if (!mPlaying || mTime + mDelay < lTarget)
+	{
+		mTime = lTarget;
+		mTimeFraction = 0;
+		mPlaying = true;
+	}  // if
+	else if (mTime > lLatest)
+	{
+		// Snapshots are late, hold the latest one
+		mTime = lLatest;
+	}  // else if
+
+	if (!mInterpolator.sample(mTime, mStates))
+	{
+		return;
+	}  // if
+
+	for (UTsize i = 0; i < mStates.size(); ++i)
+	{
+		const gkReplicationState & lState = mStates[i];
+
+		if (lState.id >= mEntries.size())
+		{
+			mEntries.resize(lState.id + 1);
+		}  // if
+
+		Entry & lEntry = mEntries[lState.id];
+		if (lEntry.object == NULL || lEntry.resolved != lState.name)
+		{
+			lEntry.object = mScene->getObject(lState.name);
+			lEntry.resolved = lState.name;
+			lEntry.applied.clear();
+		}  // if
+
+		gkGameObject * lObject = lEntry.object;
+		if (lObject == NULL || !lObject->isInstanced())
+		{
+			continue;
+		}  // if
+
+		lObject->setPosition(lState.position);
+		lObject->setOrientation(lState.orientation);
+
+		if (lObject->getAttachedBody() != NULL)
+		{
+			lObject->setLinearVelocity(lState.linearVelocity, TRANSFORM_WORLD);
+			lObject->setAngularVelocity(lState.angularVelocity, TRANSFORM_WORLD);
+		}  // if
+
+		lEntry.applied.resize(lState.variables.size());
+		for (UTsize v = 0; v < lState.variables.size(); ++v)
+		{
+			const gkReplicationState::Variable & lValue = lState.variables[v];
+			if (lEntry.applied[v] == lValue.value)
+			{
+				continue;
+			}  // if
+
+			gkVariable * lVariable = lObject->getVariable(lValue.name);
+			if (lVariable != NULL)
+			{
+				lVariable->setValue(lValue.type, lValue.value);
+			}  // if
+
+			lEntry.applied[v] = lValue.value;
+		}  // for
+	}  // for
+}  // void gkNetworkReplicator::applySnapshot
@@ -0,0 +1,320 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Kai-Ting (Danil) Ko
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _gkNetworkReplication_h_
+#define _gkNetworkReplication_h_
+
+#include "gkCommon.h"
+#include "gkMathUtils.h"
+#include "gkNetworkPacket.h"
+
+class gkScene;
+class gkGameObject;
+class gkVariable;
+class gkNetworkInstance;
+
+// Replicated state of one object, positions and velocities are in world space
+struct gkReplicationState
+{
+	struct Variable
+	{
+		gkString name;
+		int      type;
+		gkString value;
+	};
+
+	typedef utArray<Variable> Variables;
+
+	UTuint16     id;
+	gkString     name;
+	gkVector3    position;
+	gkQuaternion orientation;
+	gkVector3    linearVelocity;
+	gkVector3    angularVelocity;
+	Variables    variables;
+
+	gkReplicationState();
+
+	// copy
+	// Input: pOther The state to copy
+	// Return: None
+	// Assigns member by member, so the strings and arrays keep their memory
+	void copy(const gkReplicationState & pOther);
+};  // gkReplicationState
+
+typedef utArray<gkReplicationState> gkReplicationStates;
+
+// States of the replicated objects at one server time, sorted by id
+struct gkReplicationSnapshot
+{
+	UTuint32            sequence;
+	UTuint32            time;
+	gkReplicationStates states;
+
+	gkReplicationSnapshot() : sequence(0), time(0) {}
+
+	void copy(const gkReplicationSnapshot & pOther);
+};  // gkReplicationSnapshot
+
+// gkReplicationEncoder
+// Writes snapshots as GK_NET_FRAME_SNAPSHOT frames, each one a delta against
+// the snapshot before it. Positions and velocities are quantized to fixed
+// steps and sent as variable length differences, orientations are packed
+// into 32 bits with the smallest three components. Objects that did not
+// change are left out, names are only sent with keyframes and new objects.
+// Deltas rely on the frames arriving in order, like on a reliable enet channel.
+class gkReplicationEncoder
+{
+protected:
+	struct Baseline
+	{
+		bool      sent;
+		UTuint32  stamp;
+		int       position[3];
+		UTuint32  orientation;
+		int       linearVelocity[3];
+		int       angularVelocity[3];
+		gkReplicationState::Variables variables;
+
+		Baseline() : sent(false), stamp(0) {}
+	};  // Baseline
+
+	// Indexed by object id
+	utArray<Baseline> mBaselines;
+	UTuint32 mSequence;
+	UTuint32 mStamp;
+	gkScalar mPositionStep;
+	gkScalar mVelocityStep;
+
+public:
+	gkReplicationEncoder();
+
+	// setPrecision
+	// Input: pPositionStep Quantization step of positions in units
+	//        pVelocityStep Quantization step of velocities in units per second
+	// Return: None
+	// Must match the decoder, changing it restarts with a keyframe
+	void setPrecision(gkScalar pPositionStep, gkScalar pVelocityStep);
+
+	// encode
+	// Input: pStates The objects to send, sorted by id
+	//        pTime The server time in milliseconds
+	//        pKeyframe Whether to send every object in full
+	//        pOut The writer the frame is appended to
+	// Return: UTsize The size of the frame in bytes
+	UTsize encode(const gkReplicationStates & pStates, UTuint32 pTime, bool pKeyframe, gkNetworkPacketWriter & pOut);
+
+	// reset
+	// Input: None
+	// Return: None
+	// Forget the baselines, the next snapshot is sent in full
+	void reset(void);
+
+	GK_INLINE UTuint32 getSequence(void) const { return mSequence; }
+};  // gkReplicationEncoder
+
+// gkReplicationDecoder
+// Rebuilds the snapshots written by gkReplicationEncoder
+class gkReplicationDecoder
+{
+protected:
+	struct Baseline
+	{
+		bool      live;
+		gkString  name;
+		int       position[3];
+		UTuint32  orientation;
+		int       linearVelocity[3];
+		int       angularVelocity[3];
+		gkReplicationState::Variables variables;
+
+		Baseline() : live(false) {}
+	};  // Baseline
+
+	utArray<Baseline> mBaselines;
+	UTuint32 mSequence;
+	bool     mSynchronized;
+	gkScalar mPositionStep;
+	gkScalar mVelocityStep;
+
+public:
+	gkReplicationDecoder();
+
+	void setPrecision(gkScalar pPositionStep, gkScalar pVelocityStep);
+
+	// decode
+	// Input: pData, pLength The frame after its type and length
+	//        pSnapshot Receives every live object
+	// Return: bool False for malformed frames and for deltas received before
+	//         a keyframe, like after joining a running server
+	bool decode(const UTuint8 * pData, UTsize pLength, gkReplicationSnapshot & pSnapshot);
+
+	void reset(void);
+
+	GK_INLINE bool isSynchronized(void) const { return mSynchronized; }
+};  // gkReplicationDecoder
+
+// gkReplicationInterpolator
+// Keeps the last received snapshots and samples them between two server times
+class gkReplicationInterpolator
+{
+protected:
+	// Ring of snapshots, the slots are reused
+	utArray<gkReplicationSnapshot> mSnapshots;
+	int mFirst;
+	int mCount;
+
+	const gkReplicationSnapshot & at(int pIndex) const;
+
+public:
+	gkReplicationInterpolator(int pCapacity = 16);
+
+	// push
+	// Input: pSnapshot A received snapshot
+	// Return: None
+	// Snapshots older than the latest one are ignored
+	void push(const gkReplicationSnapshot & pSnapshot);
+
+	// sample
+	// Input: pTime Server time in milliseconds
+	//        pStates Receives the interpolated states
+	// Return: bool False without snapshots
+	// Positions and velocities are blended linearly, orientations with nlerp.
+	// Variables change with the snapshot they were received in. Times past
+	// the latest snapshot hold its states.
+	bool sample(UTuint32 pTime, gkReplicationStates & pStates) const;
+
+	void clear(void);
+
+	GK_INLINE bool empty(void) const { return mCount == 0; }
+	GK_INLINE UTuint32 getLatestTime(void) const { return mCount > 0 ? at(mCount - 1).time : 0; }
+};  // gkReplicationInterpolator
+
+// gkNetworkReplicator
+// Replicates game objects of a scene from the server to its clients.
+// The server sends snapshots at a fixed rate, clients play them back a
+// fixed delay behind the latest one so there is always a snapshot to
+// blend towards. Replicated objects should be root objects, their
+// transforms are set in parent space on the clients.
+class gkNetworkReplicator
+{
+protected:
+	struct Entry
+	{
+		UTuint16               id;
+		gkGameObject *         object;
+		utArray<gkVariable *>  variables;
+		// Client side, the name the object was resolved with
+		gkString               resolved;
+		utArray<gkString>      applied;
+
+		Entry() : id(0), object(NULL) {}
+	};  // Entry
+
+	gkScene * mScene;
+	bool mServer;
+	int mRate;
+	UTuint32 mDelay;
+	int mKeyframeInterval;
+
+	// Server: sorted by id, client: indexed by id
+	utArray<Entry> mEntries;
+
+	gkScalar mAccumulator;
+	// Server time, or the playback time on clients, in milliseconds
+	UTuint32 mTime;
+	gkScalar mTimeFraction;
+	int mConnectCount;
+	bool mPlaying;
+	UTsize mLastSnapshotSize;
+
+	gkReplicationEncoder mEncoder;
+	gkReplicationDecoder mDecoder;
+	gkReplicationInterpolator mInterpolator;
+	gkReplicationSnapshot mSnapshot;
+	gkReplicationStates mStates;
+	gkNetworkPacketWriter mFrame;
+
+	void advanceTime(gkScalar pDelta);
+	void sendSnapshot(gkNetworkInstance * pInstance);
+	void applySnapshot(void);
+
+public:
+	// Constructor
+	// Input: pScene The scene the objects are in
+	//        pServer Whether this side sends the snapshots
+	gkNetworkReplicator(gkScene * pScene, bool pServer);
+
+	// setRate
+	// Input: pRate Snapshots per second sent by the server
+	void setRate(int pRate);
+
+	// setInterpolationDelay
+	// Input: pDelay Milliseconds clients play behind the latest snapshot,
+	//        two or three snapshot intervals hide late packets
+	void setInterpolationDelay(UTuint32 pDelay);
+
+	// setKeyframeInterval
+	// Input: pInterval Snapshots between keyframes, late joiners wait for one
+	void setKeyframeInterval(int pInterval);
+
+	// setPrecision
+	// Input: pPositionStep, pVelocityStep Quantization steps, the same on every side
+	void setPrecision(gkScalar pPositionStep, gkScalar pVelocityStep);
+
+	// addObject
+	// Input: pObject The object to replicate
+	//        pVariables Names of its variables to replicate
+	// Return: bool False on clients, for objects already added or once every id is taken
+	bool addObject(gkGameObject * pObject, const utArray<gkString> & pVariables);
+	bool addObject(gkGameObject * pObject);
+
+	// removeObject
+	// Input: pObject The object to stop replicating
+	// Game objects call it on the manager's replicator when they are destroyed,
+	// on clients it drops the object found by name
+	void removeObject(gkGameObject * pObject);
+
+	// receiveSnapshot
+	// Input: pData, pLength A GK_NET_FRAME_SNAPSHOT frame after its type and length
+	// Return: None
+	// Client side, called by the network instance on the main thread
+	void receiveSnapshot(const UTuint8 * pData, UTsize pLength);
+
+	// update
+	// Input: pInstance The network instance to send through
+	//        pDelta The tick length in seconds
+	// Return: None
+	// The server appends a snapshot to the tick's batch when one is due,
+	// clients move the objects to their interpolated states
+	void update(gkNetworkInstance * pInstance, gkScalar pDelta);
+
+	GK_INLINE bool isServer(void) const { return mServer; }
+	GK_INLINE UTsize getLastSnapshotSize(void) const { return mLastSnapshotSize; }
+};  // gkNetworkReplicator
+
+#endif  // _gkNetworkReplication_h_
@@ -74,6 +74,8 @@
 #include "AI/gkFSM.h"
 
 #ifdef OGREKIT_COMPILE_ENET
+#include "Network/gkNetworkPacket.h"
+#include "Network/gkNetworkReplication.h"
 #include "Network/gkNetworkInstance.h"
 #include "Network/gkNetworkClient.h"
 #include "Network/gkNetworkServer.h"
@@ -82,6 +84,7 @@
 
 #ifdef OGREKIT_COMPILE_RECAST
 #include "AI/gkRecast.h"
+#include "AI/gkNavPathQueue.h"
 #endif
 
 #ifdef OGREKIT_COMPILE_OPENSTEER
@@ -186,8 +189,10 @@
 #include "Physics/gkPhysicsDebug.h"
 #include "Physics/gkRagDoll.h"
 #include "Physics/gkRigidBody.h"
+#include "Physics/gkSensorFilter.h"
 #include "Physics/gkSoftBody.h"
 #include "Physics/gkVehicle.h"
+#include "Physics/gkRayBatch.h"
 #include "Physics/gkRayTest.h"
 #include "Physics/gkSweptTest.h"
 
@@ -214,7 +219,9 @@
 #include "utTypes.h"
 
 #include "Thread/gkActiveObject.h"
+#include "Thread/gkAtomic.h"
 #include "Thread/gkCriticalSection.h"
+#include "Thread/gkJobSystem.h"
 #include "Thread/gkNonCopyable.h"
 #include "Thread/gkNonCopyable.h"
 #include "Thread/gkPtrRef.h"
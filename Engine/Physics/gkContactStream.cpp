@@ -0,0 +1,196 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "gkContactStream.h"
+#include "gkPhysicsController.h"
+#include "gkGameObject.h"
+
+
+
+gkContactStream::gkContactStream()
+	:	m_stamp(1),
+	    m_scratch(16 * 1024),
+	    m_first(0),
+	    m_last(0)
+{
+}
+
+
+
+gkContactStream::~gkContactStream()
+{
+}
+
+
+
+void gkContactStream::collect(btDispatcher* dispatcher)
+{
+	begin();
+
+	int nr = dispatcher->getNumManifolds();
+	for (int i = 0; i < nr; ++i)
+	{
+		btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+
+		gkPhysicsController* colA = gkPhysicsController::castController(manifold->getBody0());
+		gkPhysicsController* colB = gkPhysicsController::castController(manifold->getBody1());
+
+		// sensor volumes have no controller
+		if (!colA || !colB)
+			continue;
+
+		addManifold(colA, colB, manifold);
+		addManifold(colB, colA, manifold);
+	}
+
+	end();
+}
+
+
+
+void gkContactStream::addManifold(gkPhysicsController* owner, gkPhysicsController* collider, btPersistentManifold* manifold)
+{
+	int mode = owner->_getContactMode();
+
+	if (mode == gkPhysicsController::CM_NONE)
+		return;
+
+	// ghosts report the collider only
+	if (mode == gkPhysicsController::CM_COLLIDER || collider->getObject()->getProperties().isGhost())
+	{
+		add(owner, collider, 0);
+		return;
+	}
+
+	int nrc = manifold->getNumContacts();
+	for (int j = 0; j < nrc; ++j)
+	{
+		const btManifoldPoint& pt = manifold->getContactPoint(j);
+		if (pt.getDistance() < 0.f)
+			add(owner, collider, &pt);
+	}
+}
+
+
+
+void gkContactStream::clear(void)
+{
+	++m_stamp;
+
+	m_colliders.clear(true);
+	m_points.clear(true);
+}
+
+
+
+void gkContactStream::begin(void)
+{
+	clear();
+
+	m_scratch.reset();
+	m_first = m_last = 0;
+	m_owners.clear(true);
+}
+
+
+
+void gkContactStream::add(gkPhysicsController* owner, gkPhysicsController* collider, const btManifoldPoint* point)
+{
+	// while building the span holds the owner slot and the count
+	if (owner->m_contactStamp != m_stamp)
+	{
+		owner->m_contactStamp = m_stamp;
+		owner->m_contactFirst = m_owners.size();
+		owner->m_contactCount = 0;
+		m_owners.push_back(owner);
+	}
+
+	++owner->m_contactCount;
+
+	Record* rec = m_scratch.allocArray<Record>(1);
+	rec->m_owner    = owner->m_contactFirst;
+	rec->m_collider = collider;
+	rec->m_point    = point;
+	rec->m_next     = 0;
+
+	if (m_last)
+		m_last->m_next = rec;
+	else
+		m_first = rec;
+	m_last = rec;
+}
+
+
+
+void gkContactStream::end(void)
+{
+	UTsize i, pos = 0;
+
+	UTsize* cursor = m_scratch.allocArray<UTsize>(m_owners.size());
+	for (i = 0; i < m_owners.size(); ++i)
+	{
+		gkPhysicsController* owner = m_owners[i];
+
+		cursor[i] = pos;
+		owner->m_contactFirst = pos;
+		pos += owner->m_contactCount;
+	}
+
+	m_colliders.resize(pos);
+	m_points.resize(pos);
+
+	for (const Record* rec = m_first; rec; rec = rec->m_next)
+	{
+		UTsize at = cursor[rec->m_owner]++;
+
+		m_colliders[at] = rec->m_collider;
+		if (rec->m_point)
+			m_points[at] = *rec->m_point;
+		else
+		{
+			// the default constructor leaves the distance and positions unset
+			const btVector3 zero(0, 0, 0);
+			m_points[at] = btManifoldPoint(zero, zero, zero, btScalar(0.));
+		}
+	}
+
+	m_first = m_last = 0;
+	m_owners.clear(true);
+}
+
+
+
+UTsize gkContactStream::getNumContacts(const gkPhysicsController* owner) const
+{
+	return owner->m_contactStamp == m_stamp ? owner->m_contactCount : 0;
+}
+
+
+
+UTsize gkContactStream::getFirstContact(const gkPhysicsController* owner) const
+{
+	return owner->m_contactStamp == m_stamp ? owner->m_contactFirst : 0;
+}
@@ -0,0 +1,103 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkContactStream_h_
+#define _gkContactStream_h_
+
+#include "gkCommon.h"
+#include "btBulletDynamicsCommon.h"
+#include "BulletCollision/NarrowPhaseCollision/btManifoldPoint.h"
+#include "utMemoryPool.h"
+
+
+class gkPhysicsController;
+
+
+// Contacts of all controllers of a world, rebuilt every physics substep in
+// one pass over the manifolds. Colliders and points are kept in two parallel
+// arrays and sorted by owner, each controller keeps a span into them.
+// Controllers that are not contact listeners are skipped before anything is
+// copied. The scratch of a build lives in a frame arena that is reset by the
+// next one.
+class gkContactStream
+{
+public:
+	gkContactStream();
+	~gkContactStream();
+
+	// rebuilds the stream from the manifolds of the dispatcher
+	void collect(btDispatcher* dispatcher);
+
+	// drops all contacts, the memory is kept
+	void clear(void);
+
+	// manual rebuild, collect() is begin(), add() for every contact & end()
+	void begin(void);
+	void add(gkPhysicsController* owner, gkPhysicsController* collider, const btManifoldPoint* point);
+	void end(void);
+
+
+	UTsize getNumContacts(const gkPhysicsController* owner) const;
+
+	// index of the first contact of owner, the others follow
+	UTsize getFirstContact(const gkPhysicsController* owner) const;
+
+	GK_INLINE gkPhysicsController*   getCollider(UTsize i) const { return m_colliders[i]; }
+	GK_INLINE const btManifoldPoint& getPoint(UTsize i) const    { return m_points[i]; }
+
+	GK_INLINE UTsize size(void) const       { return m_colliders.size(); }
+	GK_INLINE UTuint32 getStamp(void) const { return m_stamp; }
+
+	// bytes of the last build's scratch and its peak
+	GK_INLINE const utAllocStats& getScratchStats(void) const { return m_scratch.getStats(); }
+
+private:
+	struct Record
+	{
+		UTsize                 m_owner;
+		gkPhysicsController*   m_collider;
+		const btManifoldPoint* m_point;
+		Record*                m_next;
+	};
+
+	void addManifold(gkPhysicsController* owner, gkPhysicsController* collider, btPersistentManifold* manifold);
+
+	// build number, a controller span is valid when its stamp matches
+	UTuint32                       m_stamp;
+
+	utArray<gkPhysicsController*>  m_colliders;
+	utArray<btManifoldPoint>       m_points;
+
+	// contacts in manifold order and the owners in order of appearance,
+	// records are allocated from m_scratch
+	utFrameArena                   m_scratch;
+	Record*                        m_first;
+	Record*                        m_last;
+	utArray<gkPhysicsController*>  m_owners;
+};
+
+
+#endif//_gkContactStream_h_
@@ -31,13 +31,41 @@
 #include "gkRigidBody.h"
 #include "gkEngine.h"
 #include "gkUserDefs.h"
+#include "Thread/gkJobSystem.h"
 
 #include "OgreCamera.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+# define GK_DBVT_SSE 1
+# include <xmmintrin.h>
+#endif
+
+
+// extent of boxes that can never be visible, padding and objects outside the broadphase
+#define GK_DBVT_EMPTY_EXTENT -1e30f
+
+
+
+class gkDbvtCullJob : public gkJob
+{
+public:
+	gkDbvtCullJob(gkDbvt* dbvt, UTsize firstWord, UTsize lastWord)
+		:	m_dbvt(dbvt), m_firstWord(firstWord), m_lastWord(lastWord)
+	{
+	}
+
+	void run(void) { m_dbvt->cullRange(m_firstWord, m_lastWord); }
+
+private:
+	gkDbvt* m_dbvt;
+	UTsize  m_firstWord, m_lastWord;
+};
+
 
 
 gkDbvt::gkDbvt()
-	:    m_tvs(0),
+	:    m_nrCams(0),
+	     m_tvs(0),
 	     m_tot(0),
 	     m_debug(gkString("btDbvt"), false)
 {
@@ -51,45 +79,207 @@ gkDbvt::~gkDbvt()
 
 
 
-void gkDbvt::Process(const btDbvtNode* nd)
+void gkDbvt::pack(gkPhysicsControllers& controllers)
+{
+	const UTsize nr = controllers.size();
+	const UTsize padded = (nr + 31) & ~31;
+
+	m_cx.resize(padded);
+	m_cy.resize(padded);
+	m_cz.resize(padded);
+	m_ex.resize(padded);
+	m_ey.resize(padded);
+	m_ez.resize(padded);
+
+	UTsize i;
+	for (i = 0; i < nr; ++i)
+	{
+		gkPhysicsController* cont = controllers[i];
+		btCollisionObject* colObj = cont->getCollisionObject();
+		btBroadphaseProxy* proxy = colObj ? colObj->getBroadphaseHandle() : 0;
+
+		if (proxy && !cont->isSuspended())
+		{
+			const btVector3 center = (proxy->m_aabbMax + proxy->m_aabbMin) * btScalar(0.5);
+			const btVector3 extent = (proxy->m_aabbMax - proxy->m_aabbMin) * btScalar(0.5);
+
+			m_cx[i] = (float)center.x();
+			m_cy[i] = (float)center.y();
+			m_cz[i] = (float)center.z();
+			m_ex[i] = (float)extent.x();
+			m_ey[i] = (float)extent.y();
+			m_ez[i] = (float)extent.z();
+		}
+		else
+		{
+			m_cx[i] = m_cy[i] = m_cz[i] = 0.f;
+			m_ex[i] = m_ey[i] = m_ez[i] = GK_DBVT_EMPTY_EXTENT;
+		}
+	}
+
+	for (; i < padded; ++i)
+	{
+		m_cx[i] = m_cy[i] = m_cz[i] = 0.f;
+		m_ex[i] = m_ey[i] = m_ez[i] = GK_DBVT_EMPTY_EXTENT;
+	}
+}
+
+
+
+void gkDbvt::cullRange(UTsize firstWord, UTsize lastWord)
+{
+	// A box is outside a plane when even its corner furthest along the
+	// normal is behind it: dot(n, c) + dot(|n|, e) + d < 0.
+
+	const float* cx = m_cx.ptr();
+	const float* cy = m_cy.ptr();
+	const float* cz = m_cz.ptr();
+	const float* ex = m_ex.ptr();
+	const float* ey = m_ey.ptr();
+	const float* ez = m_ez.ptr();
+
+	for (int c = 0; c < m_nrCams; ++c)
+	{
+		const Planes& pl = m_planes[c];
+		UTuint32* bits = m_bits[c].ptr();
+
+		for (UTsize w = firstWord; w < lastWord; ++w)
+		{
+			UTuint32 word = 0;
+
+#ifdef GK_DBVT_SSE
+			const __m128 zero = _mm_setzero_ps();
+
+			for (UTsize k = 0; k < 32; k += 4)
+			{
+				const UTsize b = w * 32 + k;
+				const __m128 bcx = _mm_loadu_ps(cx + b), bcy = _mm_loadu_ps(cy + b), bcz = _mm_loadu_ps(cz + b);
+				const __m128 bex = _mm_loadu_ps(ex + b), bey = _mm_loadu_ps(ey + b), bez = _mm_loadu_ps(ez + b);
+
+				__m128 inside = _mm_cmpeq_ps(zero, zero);
+				for (int p = 0; p < 6; ++p)
+				{
+					__m128 dist = _mm_add_ps(
+					                  _mm_add_ps(_mm_mul_ps(bcx, _mm_set1_ps(pl.nx[p])),
+					                             _mm_add_ps(_mm_mul_ps(bcy, _mm_set1_ps(pl.ny[p])), _mm_mul_ps(bcz, _mm_set1_ps(pl.nz[p])))),
+					                  _mm_add_ps(_mm_add_ps(_mm_mul_ps(bex, _mm_set1_ps(pl.ax[p])),
+					                                        _mm_add_ps(_mm_mul_ps(bey, _mm_set1_ps(pl.ay[p])), _mm_mul_ps(bez, _mm_set1_ps(pl.az[p])))),
+					                             _mm_set1_ps(pl.d[p])));
+
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, zero));
+				}
+
+				word |= (UTuint32)_mm_movemask_ps(inside) << k;
+			}
+#else
+			for (UTsize k = 0; k < 32; ++k)
+			{
+				const UTsize b = w * 32 + k;
+				bool inside = true;
+
+				for (int p = 0; p < 6 && inside; ++p)
+				{
+					float dist = cx[b] * pl.nx[p] + cy[b] * pl.ny[p] + cz[b] * pl.nz[p] +
+					             ex[b] * pl.ax[p] + ey[b] * pl.ay[p] + ez[b] * pl.az[p] + pl.d[p];
+					inside = dist >= 0.f;
+				}
+
+				if (inside)
+					word |= 1U << k;
+			}
+#endif
+
+			bits[w] = word;
+		}
+	}
+}
+
+
+
+void gkDbvt::apply(gkPhysicsControllers& controllers)
 {
-	btBroadphaseProxy* proxy = (btBroadphaseProxy*)nd->data;
-	if (gkPhysicsController::castController(proxy->m_clientObject)->_markDbvt(true))
-		m_tvs++;
+	const UTsize nr = controllers.size();
+	const UTsize words = m_visible.size();
+
+	UTsize w, i;
+	for (w = 0; w < words; ++w)
+	{
+		UTuint32 word = 0;
+		for (int c = 0; c < m_nrCams; ++c)
+			word |= m_bits[c][w];
+		m_visible[w] = word;
+	}
+
+	// _markDbvt only touches the movable when the state flips
+	for (i = 0; i < nr; ++i)
+	{
+		const bool vis = (m_visible[i >> 5] & (1U << (i & 31))) != 0;
+		controllers[i]->_markDbvt(vis);
+		if (vis)
+			m_tvs++;
+	}
 }
 
 
 
-void gkDbvt::mark(gkCamera* cam, btDbvtBroadphase* cullTree, gkPhysicsControllers& controllers)
+void gkDbvt::mark(gkCamera* cam, gkPhysicsControllers& controllers)
 {
-	GK_ASSERT(cam && cullTree);
+	mark(&cam, 1, controllers);
+}
+
 
-	const Ogre::Plane* planes = cam->getCamera()->getFrustumPlanes();
 
-	btVector3 normals[6];
-	btScalar offsets[6];
+void gkDbvt::mark(gkCamera* const* cams, int nrCams, gkPhysicsControllers& controllers)
+{
+	GK_ASSERT(cams && nrCams > 0);
+
+	m_nrCams = gkMin<int>(nrCams, MAX_CAMERAS);
 
-	for (int i = 0; i < 6; ++i)
+	for (int c = 0; c < m_nrCams; ++c)
 	{
-		normals[i].setValue(planes[i].normal.x, planes[i].normal.y, planes[i].normal.z);
-		offsets[i] = planes[i].d;
+		GK_ASSERT(cams[c]);
+		const Ogre::Plane* planes = cams[c]->getCamera()->getFrustumPlanes();
+
+		Planes& pl = m_planes[c];
+		for (int i = 0; i < 6; ++i)
+		{
+			pl.nx[i] = (float)planes[i].normal.x;
+			pl.ny[i] = (float)planes[i].normal.y;
+			pl.nz[i] = (float)planes[i].normal.z;
+			pl.ax[i] = gkAbs(pl.nx[i]);
+			pl.ay[i] = gkAbs(pl.ny[i]);
+			pl.az[i] = gkAbs(pl.nz[i]);
+			pl.d[i]  = (float)planes[i].d;
+		}
 	}
 
 
 	m_tot = controllers.size();
 	m_tvs = 0;
 
-	if (!controllers.empty())
+	pack(controllers);
+
+	const UTsize words = m_cx.size() / 32;
+	for (int c = 0; c < m_nrCams; ++c)
+		m_bits[c].resize(words);
+	m_visible.resize(words);
+
+
+	gkJobSystem* jobs = gkJobSystem::getSingletonPtr();
+	if (jobs && jobs->getNumThreads() > 0 && m_cx.size() > BOXES_PER_JOB)
 	{
-		// Mark all invisible
+		const UTsize wordsPerJob = BOXES_PER_JOB / 32;
+		gkJobCounter counter;
+
+		for (UTsize w = 0; w < words; w += wordsPerJob)
+			jobs->submit(new gkDbvtCullJob(this, w, gkMin<UTsize>(w + wordsPerJob, words)), &counter);
 
-		gkPhysicsControllers::Iterator iter = controllers.iterator();
-		while (iter.hasMoreElements())
-			iter.getNext()->_markDbvt(false);
+		jobs->wait(counter);
 	}
+	else
+		cullRange(0, words);
 
-	btDbvt::collideKDOP(cullTree->m_sets[1].m_root, normals, offsets, 6, *this);
-	btDbvt::collideKDOP(cullTree->m_sets[0].m_root, normals, offsets, 6, *this);
+	apply(controllers);
 
 
 	if (gkEngine::getSingleton().getUserDefs().debugFps)
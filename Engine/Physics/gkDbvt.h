@@ -32,21 +32,72 @@
 #include "gkVariable.h"
 
 
+class gkDbvtCullJob;
 
-class gkDbvt : public btDbvt::ICollide
+
+// Frustum culling of the physics controllers. The broadphase AABBs are
+// packed into flat arrays and tested against the planes of every camera
+// four boxes at a time, large scenes are split over the job system.
+// Results are one visibility bit per controller and camera, an object
+// stays visible as long as one of the cameras sees it.
+class gkDbvt
 {
+public:
+	enum
+	{
+		MAX_CAMERAS    = 8,
+		// boxes per culling job, a multiple of 32 so jobs never share a bitset word
+		BOXES_PER_JOB  = 2048,
+	};
+
+	typedef utArray<UTuint32> Bitset;
+
 public:
 	gkDbvt();
 	~gkDbvt();
 
 	gkVariable* getInfo(void) {return &m_debug;}
-	void mark(gkCamera* cam, struct btDbvtBroadphase* cullTree, gkPhysicsControllers& controllers);
 
-	void Process(const btDbvtNode* nd);
+	void mark(gkCamera* cam, gkPhysicsControllers& controllers);
+
+	// Culls against all cameras in one pass, up to MAX_CAMERAS.
+	void mark(gkCamera* const* cams, int nrCams, gkPhysicsControllers& controllers);
+
+
+	// Results of the last mark, indexed like the controller array that was passed.
+	GK_INLINE int            getNumCameras(void) const     { return m_nrCams; }
+	GK_INLINE const Bitset&  getVisibility(int cam) const  { GK_ASSERT(cam >= 0 && cam < m_nrCams); return m_bits[cam]; }
+	GK_INLINE const Bitset&  getVisibility(void) const     { return m_visible; }
+
+	GK_INLINE bool isVisible(UTsize controller, int cam) const
+	{
+		return (getVisibility(cam)[controller >> 5] & (1U << (controller & 31))) != 0;
+	}
 
 private:
+	friend class gkDbvtCullJob;
+
+	struct Planes
+	{
+		// plane normals, the absolute normals and the offsets, one array per component
+		float nx[6], ny[6], nz[6];
+		float ax[6], ay[6], az[6];
+		float d[6];
+	};
+
+	void pack(gkPhysicsControllers& controllers);
+	void cullRange(UTsize firstWord, UTsize lastWord);
+	void apply(gkPhysicsControllers& controllers);
 	void updateDebug(void);
 
+	// box centers and half extents, padded to a multiple of 32
+	utArray<float> m_cx, m_cy, m_cz, m_ex, m_ey, m_ez;
+
+	Planes      m_planes[MAX_CAMERAS];
+	Bitset      m_bits[MAX_CAMERAS];
+	Bitset      m_visible;
+	int         m_nrCams;
+
 	int         m_tvs, m_tot;
 	gkVariable  m_debug;
 };
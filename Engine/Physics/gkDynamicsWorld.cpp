@@ -35,10 +35,13 @@
 #include "gkCamera.h"
 #include "gkVariable.h"
 #include "gkDbvt.h"
+#include "gkParallelDispatcher.h"
+#include "gkParallelSolver.h"
 #include "btBulletDynamicsCommon.h"
 #include "BulletCollision/CollisionDispatch/btGhostObject.h"
 #include "BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h"
 #include "BulletCollision/CollisionDispatch/btCollisionDispatcher.h"
+#include "gkSensorGhost.h"
 
 
 
@@ -54,7 +57,9 @@ gkDynamicsWorld::gkDynamicsWorld(const gkString& name, gkScene* scene)
 	        m_constraintSolver(0),
 	        m_debug(0),
 	        m_handleContacts(true),
-	        m_dbvt(0)
+	        m_dbvt(0),
+	        m_sensorFilter(0),
+	        m_steps(0)
 {
 	createInstanceImpl();
 }
@@ -75,15 +80,32 @@ void gkDynamicsWorld::createInstanceImpl(void)
 	if (m_dynamicsWorld)
 		return;
 
-	m_collisionConfiguration = new btDefaultCollisionConfiguration();
+	// narrowphase & islands on the job system
+	bool parallel = gkEngine::getSingleton().getUserDefs().parallelPhysics;
+
+	if (parallel)
+		m_collisionConfiguration = new gkParallelCollisionConfiguration();
+	else
+		m_collisionConfiguration = new btDefaultCollisionConfiguration();
 
 	m_pairCache = new btDbvtBroadphase();
 
 	m_ghostPairCallback = new btGhostPairCallback();
 	m_pairCache->getOverlappingPairCache()->setInternalGhostPairCallback(m_ghostPairCallback);
 
-	m_dispatcher = new btCollisionDispatcher(m_collisionConfiguration);
-	m_constraintSolver = new btSequentialImpulseConstraintSolver();
+	m_sensorFilter = new gkSensorGhostFilter();
+	m_pairCache->getOverlappingPairCache()->setOverlapFilterCallback(m_sensorFilter);
+
+	if (parallel)
+	{
+		m_dispatcher = new gkParallelDispatcher(m_collisionConfiguration);
+		m_constraintSolver = new gkParallelSolver();
+	}
+	else
+	{
+		m_dispatcher = new btCollisionDispatcher(m_collisionConfiguration);
+		m_constraintSolver = new btSequentialImpulseConstraintSolver();
+	}
 	m_dynamicsWorld = new btDiscreteDynamicsWorld(m_dispatcher, m_pairCache, m_constraintSolver, m_collisionConfiguration);
 
 	gkVector3& grav = m_scene->getProperties().m_gravity;
@@ -99,12 +121,16 @@ void gkDynamicsWorld::createInstanceImpl(void)
 	// register gimpact-algorithm
 	btCollisionDispatcher* dispatcher = static_cast<btCollisionDispatcher *>(m_dynamicsWorld ->getDispatcher());
 	btGImpactCollisionAlgorithm::registerAlgorithm(dispatcher);
+
+	dispatcher->setNearCallback(gkSensorGhost::nearCallback);
 }
 
 
 
 void gkDynamicsWorld::destroyInstanceImpl(void)
 {
+	releaseSensorGhosts(true);
+
 	int i;
 	for (i = m_dynamicsWorld->getNumConstraints() - 1; i >= 0; i--)
 	{
@@ -126,6 +152,9 @@ void gkDynamicsWorld::destroyInstanceImpl(void)
 	delete m_pairCache;
 	m_pairCache = 0;
 
+	delete m_sensorFilter;
+	m_sensorFilter = 0;
+
 	delete m_collisionConfiguration;
 	m_collisionConfiguration = 0;
 
@@ -309,6 +338,53 @@ gkCharacter* gkDynamicsWorld::createCharacter(gkGameObject* state)
 
 
 
+gkSensorGhost* gkDynamicsWorld::getSensorGhost(UTuint32 sensorId)
+{
+	gkSensorGhost* ghost;
+
+	UTsize pos = m_sensorGhosts.find((UTint32)sensorId);
+	if (pos != UT_NPOS)
+		ghost = m_sensorGhosts.at(pos);
+	else
+	{
+		ghost = new gkSensorGhost(m_dynamicsWorld);
+		m_sensorGhosts.insert((UTint32)sensorId, ghost);
+	}
+
+	ghost->setLastUsed(m_steps);
+	return ghost;
+}
+
+
+
+UTuint32 gkDynamicsWorld::createSensorId(void)
+{
+	// sensors are created on the main thread
+	static UTuint32 lastId = 0;
+	return ++lastId;
+}
+
+
+
+void gkDynamicsWorld::releaseSensorGhosts(bool all)
+{
+	// sensors pulsing slower than this recreate their volume
+	const UTuint32 maxUnused = 60;
+
+	// backwards, remove() moves the last entry into the gap
+	for (UTsize i = m_sensorGhosts.size(); i-- > 0; )
+	{
+		gkSensorGhost* ghost = m_sensorGhosts.at(i);
+		if (all || m_steps - ghost->getLastUsed() > maxUnused)
+		{
+			m_sensorGhosts.remove(m_sensorGhosts.ptr()[i].first);
+			delete ghost;
+		}
+	}
+}
+
+
+
 void gkDynamicsWorld::destroyObject(gkPhysicsController* cont)
 {
 	UTsize pos;
@@ -382,6 +458,9 @@ void gkDynamicsWorld::step(gkScalar tick)
 	//	m_dynamicsWorld->stepSimulation(tick,10,1./240.);
 	m_dynamicsWorld->stepSimulation(tick);
 
+	++m_steps;
+	releaseSensorGhosts(false);
+
 	m_dynamicsWorld->debugDrawWorld();
 
 	// uncomment this to print bullet profiling information
@@ -392,14 +471,7 @@ void gkDynamicsWorld::step(gkScalar tick)
 
 void gkDynamicsWorld::resetContacts()
 {
-	if (m_handleContacts && !m_objects.empty())
-	{
-		gkPhysicsControllers::Iterator iter = m_objects.iterator();
-		while (iter.hasMoreElements())
-		{
-			iter.getNext()->_resetContactInfo();
-		}
-	}
+	m_contacts.clear();
 }
 
 
@@ -415,31 +487,7 @@ void gkDynamicsWorld::presubstep(gkScalar tick)
 void gkDynamicsWorld::substep(gkScalar tick)
 {
 	if (m_handleContacts)
-	{
-		int nr = m_dispatcher->getNumManifolds();
-
-		for (int i = 0; i < nr; ++i)
-		{
-			btPersistentManifold* manifold = m_dispatcher->getManifoldByIndexInternal(i);
-
-			gkPhysicsController* colA = gkPhysicsController::castController(manifold->getBody0());
-			gkPhysicsController* colB = gkPhysicsController::castController(manifold->getBody1());
-
-			colA->_resetContactInfo();
-			colB->_resetContactInfo();
-		}
-
-		for (int i = 0; i < nr; ++i)
-		{
-			btPersistentManifold* manifold = m_dispatcher->getManifoldByIndexInternal(i);
-
-			gkPhysicsController* colA = gkPhysicsController::castController(manifold->getBody0());
-			gkPhysicsController* colB = gkPhysicsController::castController(manifold->getBody1());
-
-			colA->_handleManifold(manifold);
-			colB->_handleManifold(manifold);
-		}
-	}
+		m_contacts.collect(m_dispatcher);
 	
 	// update callbacks
 	utArrayIterator<gkDynamicsWorld::Listeners> iter(m_listeners);
@@ -500,7 +548,17 @@ void gkDynamicsWorld::handleDbvt(gkCamera* cam)
 	if (!m_dbvt)
 		return;
 
-	m_dbvt->mark(cam, (btDbvtBroadphase*)m_pairCache, m_objects);
+	m_dbvt->mark(cam, m_objects);
+}
+
+
+
+void gkDynamicsWorld::handleDbvt(gkCamera* const* cams, int nrCams)
+{
+	if (!m_dbvt || nrCams <= 0)
+		return;
+
+	m_dbvt->mark(cams, nrCams, m_objects);
 }
 
 
@@ -32,6 +32,7 @@
 #include "gkMathUtils.h"
 #include "LinearMath/btScalar.h"
 #include "gkGhost.h"
+#include "gkContactStream.h"
 
 class btDynamicsWorld;
 class btCollisionConfiguration;
@@ -48,6 +49,8 @@ class btGhostPairCallback;
 class gkPhysicsDebug;
 class gkDbvt;
 class gkPhysicsConstraintProperties;
+class gkSensorGhost;
+class gkSensorGhostFilter;
 
 class gkDynamicsWorld
 {
@@ -63,6 +66,8 @@ public:
 
 	typedef utArray<Listener*> Listeners;
 
+	typedef utHashTable<utIntHashKey, gkSensorGhost*> SensorGhosts;
+
 
 protected:
 
@@ -78,11 +83,18 @@ protected:
 	bool                        m_handleContacts;
 	gkDbvt*                     m_dbvt;
 	Listeners                   m_listeners;
+	gkContactStream             m_contacts;
+	gkSensorGhostFilter*        m_sensorFilter;
+	SensorGhosts                m_sensorGhosts;
+	UTuint32                    m_steps;
 
 
 	// drawing all but static wireframes
 	void localDrawObject(gkPhysicsController* phyCon);
 
+	// drops the volumes of sensors that stopped querying
+	void releaseSensorGhosts(bool all);
+
 	void createInstanceImpl(void);
 	void destroyInstanceImpl(void);
 
@@ -109,6 +121,14 @@ public:
 	gkGhost* createGhost(gkGameObject* state);
 	void destroyObject(gkPhysicsController* cont);
 
+	// persistent overlap volume of a sensor, created on first use and
+	// released when the sensor stops querying it for a while
+	gkSensorGhost* getSensorGhost(UTuint32 sensorId);
+
+	// ids are never reused, so a new sensor cannot find the volume of a
+	// destroyed one (which outlives it until it is released)
+	static UTuint32 createSensorId(void);
+
 	GK_INLINE btDynamicsWorld* getBulletWorld(void) {GK_ASSERT(m_dynamicsWorld); return m_dynamicsWorld;}
 	GK_INLINE gkScene* getScene(void)               {GK_ASSERT(m_scene); return m_scene;}
 
@@ -116,7 +136,10 @@ public:
 
 	void resetContacts();
 
+	GK_INLINE const gkContactStream& getContactStream(void) const {return m_contacts;}
+
 	void handleDbvt(gkCamera* cam);
+	void handleDbvt(gkCamera* const* cams, int nrCams);
 
 	gkPhysicsDebug* getDebug() const { return m_debug; }
 
@@ -128,6 +151,8 @@ public:
 	
 	void addListener(Listener *listener);
 	void removeListener(Listener *listener);
+
+	GK_INLINE bool hasListeners(void) const {return !m_listeners.empty();}
 };
 
 
@@ -129,23 +129,10 @@ void gkGhost::setWorldTransform(const btTransform& worldTrans)
 }
 
 
-void gkGhost::_handleManifold(btPersistentManifold* manifold)
+int gkGhost::_getContactMode(void)
 {
-	gkPhysicsController* colA = castController(manifold->getBody0());
-	gkPhysicsController* colB = castController(manifold->getBody1());
-
-	gkPhysicsController* collider = colB;
-
-	if (collider == this)
-	{
-		collider = colA;
-	}
-
-	m_localContacts.reserve(1);
-
-	gkContactInfo cinf;
-	cinf.collider = collider;
-	m_localContacts.push_back(cinf);
+	// every overlapping object, listener or not
+	return CM_COLLIDER;
 }
 
 
@@ -49,7 +49,7 @@ public:
 
 	void create(void);
 	void destroy(void);
-	void _handleManifold(btPersistentManifold* manifold);
+	int _getContactMode(void);
 };
 
 #endif//_gkGhost_h_
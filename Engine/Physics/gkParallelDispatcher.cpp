@@ -0,0 +1,304 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "gkParallelDispatcher.h"
+#include "gkMathUtils.h"
+#include "Thread/gkJobSystem.h"
+#include "BulletCollision/CollisionDispatch/btConvexConvexAlgorithm.h"
+#include "LinearMath/btQuickprof.h"
+
+
+
+// btConvexConvexAlgorithm with its own simplex solver. The solver is only
+// passed by address to the base class, it is constructed right after it.
+class gkConvexConvexAlgorithm : public btConvexConvexAlgorithm
+{
+public:
+	gkConvexConvexAlgorithm(const btCollisionAlgorithmConstructionInfo& ci,
+	                        const btCollisionObjectWrapper* body0Wrap,
+	                        const btCollisionObjectWrapper* body1Wrap,
+	                        btConvexPenetrationDepthSolver* pdSolver,
+	                        int numPerturbationIterations,
+	                        int minimumPointsPerturbationThreshold)
+		:	btConvexConvexAlgorithm(ci.m_manifold, ci, body0Wrap, body1Wrap, &m_simplex, pdSolver,
+		                            numPerturbationIterations, minimumPointsPerturbationThreshold)
+	{
+	}
+
+private:
+	btVoronoiSimplexSolver m_simplex;
+};
+
+
+
+class gkConvexConvexCreateFunc : public btConvexConvexAlgorithm::CreateFunc
+{
+public:
+	gkConvexConvexCreateFunc(btSimplexSolverInterface* simplexSolver, btConvexPenetrationDepthSolver* pdSolver)
+		:	btConvexConvexAlgorithm::CreateFunc(simplexSolver, pdSolver)
+	{
+	}
+
+	btCollisionAlgorithm* CreateCollisionAlgorithm(btCollisionAlgorithmConstructionInfo& ci,
+	        const btCollisionObjectWrapper* body0Wrap, const btCollisionObjectWrapper* body1Wrap)
+	{
+		void* mem = ci.m_dispatcher1->allocateCollisionAlgorithm(sizeof(gkConvexConvexAlgorithm));
+		return new(mem) gkConvexConvexAlgorithm(ci, body0Wrap, body1Wrap, m_pdSolver,
+		                                        m_numPerturbationIterations, m_minimumPointsPerturbationThreshold);
+	}
+};
+
+
+
+static btDefaultCollisionConstructionInfo gkMakeConstructionInfo(btDefaultCollisionConstructionInfo info)
+{
+	// the algorithm pool has to hold the larger convex algorithm
+	const int size = (int)((sizeof(gkConvexConvexAlgorithm) + 15) & ~15);
+	info.m_customCollisionAlgorithmMaxElementSize = btMax(info.m_customCollisionAlgorithmMaxElementSize, size);
+	return info;
+}
+
+
+
+gkParallelCollisionConfiguration::gkParallelCollisionConfiguration(const btDefaultCollisionConstructionInfo& info)
+	:	btDefaultCollisionConfiguration(gkMakeConstructionInfo(info))
+{
+	// replaced before any dispatcher reads the create functions
+	m_convexConvexCreateFunc->~btCollisionAlgorithmCreateFunc();
+	btAlignedFree(m_convexConvexCreateFunc);
+
+	void* mem = btAlignedAlloc(sizeof(gkConvexConvexCreateFunc), 16);
+	m_convexConvexCreateFunc = new(mem) gkConvexConvexCreateFunc(m_simplexSolver, m_pdSolver);
+}
+
+
+
+// GImpact meshes lock & unlock the vertex data of the shared shape while they
+// collide, pairs with one of them run on the calling thread.
+static bool gkIsSerialPair(const btBroadphasePair& pair)
+{
+	const btCollisionObject* ob0 = static_cast<btCollisionObject*>(pair.m_pProxy0->m_clientObject);
+	const btCollisionObject* ob1 = static_cast<btCollisionObject*>(pair.m_pProxy1->m_clientObject);
+
+	return ob0->getCollisionShape()->getShapeType() == GIMPACT_SHAPE_PROXYTYPE ||
+	       ob1->getCollisionShape()->getShapeType() == GIMPACT_SHAPE_PROXYTYPE;
+}
+
+
+
+class gkParallelDispatchJob : public gkJob
+{
+public:
+	gkParallelDispatchJob(gkParallelDispatcher* dispatcher, btBroadphasePair* pairs, int first, int last, const btDispatcherInfo& info)
+		:	m_dispatcher(dispatcher), m_pairs(pairs), m_first(first), m_last(last), m_info(info)
+	{
+	}
+
+	void run(void) { m_dispatcher->dispatchRange(m_pairs, m_first, m_last, m_info, false); }
+
+private:
+	gkParallelDispatcher*    m_dispatcher;
+	btBroadphasePair*        m_pairs;
+	int                      m_first, m_last;
+	const btDispatcherInfo&  m_info;
+};
+
+
+
+gkParallelDispatcher::gkParallelDispatcher(btCollisionConfiguration* config)
+	:	btCollisionDispatcher(config),
+	    m_parallel(false)
+{
+}
+
+
+
+gkParallelDispatcher::~gkParallelDispatcher()
+{
+}
+
+
+
+btPersistentManifold* gkParallelDispatcher::getNewManifold(const btCollisionObject* body0, const btCollisionObject* body1)
+{
+	if (!m_parallel)
+		return btCollisionDispatcher::getNewManifold(body0, body1);
+
+	gkCriticalSection::Lock guard(m_cs);
+
+	// taken back out of the list, applyEvents adds it in pair order
+	btPersistentManifold* manifold = btCollisionDispatcher::getNewManifold(body0, body1);
+	if (manifold)
+	{
+		m_manifoldsPtr.pop_back();
+		addEvent(manifold, false);
+	}
+	return manifold;
+}
+
+
+
+void gkParallelDispatcher::releaseManifold(btPersistentManifold* manifold)
+{
+	if (!m_parallel)
+	{
+		btCollisionDispatcher::releaseManifold(manifold);
+		return;
+	}
+
+	// contacts go now, the manifold itself once all pairs are done
+	clearManifold(manifold);
+
+	gkCriticalSection::Lock guard(m_cs);
+	addEvent(manifold, true);
+}
+
+
+
+void* gkParallelDispatcher::allocateCollisionAlgorithm(int size)
+{
+	if (!m_parallel)
+		return btCollisionDispatcher::allocateCollisionAlgorithm(size);
+
+	gkCriticalSection::Lock guard(m_cs);
+	return btCollisionDispatcher::allocateCollisionAlgorithm(size);
+}
+
+
+
+void gkParallelDispatcher::freeCollisionAlgorithm(void* ptr)
+{
+	if (!m_parallel)
+	{
+		btCollisionDispatcher::freeCollisionAlgorithm(ptr);
+		return;
+	}
+
+	gkCriticalSection::Lock guard(m_cs);
+	btCollisionDispatcher::freeCollisionAlgorithm(ptr);
+}
+
+
+
+void gkParallelDispatcher::dispatchAllCollisionPairs(btOverlappingPairCache* pairCache, const btDispatcherInfo& info, btDispatcher* dispatcher)
+{
+	gkJobSystem* jobs = gkJobSystem::getSingletonPtr();
+	const int nrPairs = pairCache->getNumOverlappingPairs();
+
+	if (!jobs || jobs->getNumThreads() == 0 || jobs->getThreadIndex() == -1 || nrPairs < 2 * PAIRS_PER_JOB)
+	{
+		btCollisionDispatcher::dispatchAllCollisionPairs(pairCache, info, dispatcher);
+		return;
+	}
+
+	BT_PROFILE("dispatchAllCollisionPairs");
+
+	btBroadphasePair* pairs = pairCache->getOverlappingPairArrayPtr();
+	m_threadPair.resize(jobs->getNumThreads() + 1);
+
+	m_parallel = true;
+
+	gkJobCounter counter;
+	for (int first = 0; first < nrPairs; first += PAIRS_PER_JOB)
+		jobs->submit(new gkParallelDispatchJob(this, pairs, first, gkMin<int>(first + PAIRS_PER_JOB, nrPairs), info), &counter);
+
+	jobs->wait(counter);
+
+	dispatchRange(pairs, 0, nrPairs, info, true);
+
+	m_parallel = false;
+
+	applyEvents(nrPairs);
+}
+
+
+
+void gkParallelDispatcher::dispatchRange(btBroadphasePair* pairs, int first, int last, const btDispatcherInfo& info, bool serial)
+{
+	int& current = m_threadPair[gkJobSystem::getSingleton().getThreadIndex()];
+
+	btNearCallback nearCallback = getNearCallback();
+	for (int i = first; i < last; ++i)
+	{
+		if (gkIsSerialPair(pairs[i]) != serial)
+			continue;
+
+		current = i;
+		nearCallback(pairs[i], *this, info);
+	}
+}
+
+
+
+void gkParallelDispatcher::addEvent(btPersistentManifold* manifold, bool release)
+{
+	ManifoldEvent ev;
+	ev.m_pair     = m_threadPair[gkJobSystem::getSingleton().getThreadIndex()];
+	ev.m_manifold = manifold;
+	ev.m_release  = release;
+	m_events.push_back(ev);
+}
+
+
+
+void gkParallelDispatcher::applyEvents(int nrPairs)
+{
+	if (m_events.empty())
+		return;
+
+	// counting sort by pair, events of one pair keep their order
+	UTsize i;
+	m_pairStart.resize(nrPairs + 1);
+	for (i = 0; i < m_pairStart.size(); ++i)
+		m_pairStart[i] = 0;
+
+	for (i = 0; i < m_events.size(); ++i)
+		++m_pairStart[m_events[i].m_pair + 1];
+
+	for (i = 1; i < m_pairStart.size(); ++i)
+		m_pairStart[i] += m_pairStart[i - 1];
+
+	m_sorted.resize(m_events.size());
+	for (i = 0; i < m_events.size(); ++i)
+		m_sorted[m_pairStart[m_events[i].m_pair]++] = m_events[i];
+
+	// replays what btCollisionDispatcher did with the list
+	for (i = 0; i < m_sorted.size(); ++i)
+	{
+		btPersistentManifold* manifold = m_sorted[i].m_manifold;
+
+		if (m_sorted[i].m_release)
+			btCollisionDispatcher::releaseManifold(manifold);
+		else
+		{
+			manifold->m_index1a = m_manifoldsPtr.size();
+			m_manifoldsPtr.push_back(manifold);
+		}
+	}
+
+	m_events.clear(true);
+	m_sorted.clear(true);
+}
@@ -0,0 +1,105 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkParallelDispatcher_h_
+#define _gkParallelDispatcher_h_
+
+#include "gkCommon.h"
+#include "Thread/gkCriticalSection.h"
+#include "btBulletCollisionCommon.h"
+
+
+class gkParallelDispatchJob;
+
+
+// Collision configuration for gkParallelDispatcher. Convex pairs get their own
+// simplex solver instead of sharing the one of the configuration, so that
+// pairs can be processed on several threads.
+class gkParallelCollisionConfiguration : public btDefaultCollisionConfiguration
+{
+public:
+	gkParallelCollisionConfiguration(const btDefaultCollisionConstructionInfo& info = btDefaultCollisionConstructionInfo());
+};
+
+
+
+// Narrowphase dispatcher that processes the overlapping pairs on the job
+// system in fixed chunks of PAIRS_PER_JOB pairs. Pairs with a GImpact mesh, whose
+// shape is not safe to share between threads, run on the calling thread after
+// the chunks. Manifolds created and released meanwhile are applied to the
+// manifold list in pair order afterwards, the list (and so the solver input) is
+// the same as with btCollisionDispatcher whatever the number of threads.
+class gkParallelDispatcher : public btCollisionDispatcher
+{
+public:
+	enum
+	{
+		PAIRS_PER_JOB = 64,
+	};
+
+public:
+	gkParallelDispatcher(btCollisionConfiguration* config);
+	virtual ~gkParallelDispatcher();
+
+	virtual btPersistentManifold* getNewManifold(const btCollisionObject* body0, const btCollisionObject* body1);
+	virtual void releaseManifold(btPersistentManifold* manifold);
+
+	virtual void* allocateCollisionAlgorithm(int size);
+	virtual void  freeCollisionAlgorithm(void* ptr);
+
+	virtual void dispatchAllCollisionPairs(btOverlappingPairCache* pairCache, const btDispatcherInfo& info, btDispatcher* dispatcher);
+
+private:
+	friend class gkParallelDispatchJob;
+
+	struct ManifoldEvent
+	{
+		int                   m_pair;
+		btPersistentManifold* m_manifold;
+		bool                  m_release;
+	};
+
+	typedef utArray<ManifoldEvent> ManifoldEvents;
+
+	// runs the pairs of the range which are (not) serial
+	void dispatchRange(btBroadphasePair* pairs, int first, int last, const btDispatcherInfo& info, bool serial);
+	void addEvent(btPersistentManifold* manifold, bool release);
+	void applyEvents(int nrPairs);
+
+	gkCriticalSection m_cs;
+	bool              m_parallel;
+
+	// manifold changes in the order of the threads, sorted by pair afterwards
+	ManifoldEvents    m_events;
+	ManifoldEvents    m_sorted;
+	utArray<int>      m_pairStart;
+
+	// pair each job thread works on
+	utArray<int>      m_threadPair;
+};
+
+
+#endif//_gkParallelDispatcher_h_
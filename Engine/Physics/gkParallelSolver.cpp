@@ -0,0 +1,189 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "gkParallelSolver.h"
+#include "Thread/gkJobSystem.h"
+
+
+
+class gkParallelSolverJob : public gkJob
+{
+public:
+	gkParallelSolverJob(gkParallelSolver* solver, UTsize group) : m_solver(solver), m_group(group) {}
+
+	void run(void) { m_solver->solve(m_solver->m_groups[m_group]); }
+
+private:
+	gkParallelSolver* m_solver;
+	UTsize            m_group;
+};
+
+
+
+static bool gkIsKinematic(const btCollisionObject* colObj)
+{
+	return colObj && colObj->isKinematicObject();
+}
+
+
+
+gkParallelSolver::gkParallelSolver()
+	:	m_deferred(false),
+	    m_info(0),
+	    m_debugDrawer(0),
+	    m_dispatcher(0)
+{
+	m_solvers.push_back(new btSequentialImpulseConstraintSolver());
+}
+
+
+
+gkParallelSolver::~gkParallelSolver()
+{
+	for (UTsize i = 0; i < m_solvers.size(); ++i)
+		delete m_solvers[i];
+}
+
+
+
+void gkParallelSolver::prepareSolve(int numBodies, int numManifolds)
+{
+	gkJobSystem* jobs = gkJobSystem::getSingletonPtr();
+
+	m_deferred = jobs && jobs->getNumThreads() > 0 && jobs->getThreadIndex() != -1;
+	if (!m_deferred)
+		return;
+
+	while ((int)m_solvers.size() <= jobs->getNumThreads())
+		m_solvers.push_back(new btSequentialImpulseConstraintSolver());
+
+	m_groups.clear(true);
+	m_bodies.clear(true);
+	m_manifolds.clear(true);
+	m_constraints.clear(true);
+}
+
+
+
+btScalar gkParallelSolver::solveGroup(btCollisionObject** bodies, int numBodies,
+                                      btPersistentManifold** manifolds, int numManifolds,
+                                      btTypedConstraint** constraints, int numConstraints,
+                                      const btContactSolverInfo& info, btIDebugDraw* debugDrawer, btDispatcher* dispatcher)
+{
+	if (!m_deferred)
+		return m_solvers[0]->solveGroup(bodies, numBodies, manifolds, numManifolds, constraints, numConstraints, info, debugDrawer, dispatcher);
+
+	// the arrays belong to the island callback and are refilled for the next group
+	Group group;
+	group.m_firstBody       = m_bodies.size();
+	group.m_nrBodies        = (UTsize)numBodies;
+	group.m_firstManifold   = m_manifolds.size();
+	group.m_nrManifolds     = (UTsize)numManifolds;
+	group.m_firstConstraint = m_constraints.size();
+	group.m_nrConstraints   = (UTsize)numConstraints;
+	group.m_shared          = false;
+
+	int i;
+	for (i = 0; i < numBodies; ++i)
+		m_bodies.push_back(bodies[i]);
+
+	for (i = 0; i < numManifolds; ++i)
+	{
+		m_manifolds.push_back(manifolds[i]);
+		group.m_shared = group.m_shared || gkIsKinematic(manifolds[i]->getBody0()) || gkIsKinematic(manifolds[i]->getBody1());
+	}
+
+	for (i = 0; i < numConstraints; ++i)
+	{
+		m_constraints.push_back(constraints[i]);
+		group.m_shared = group.m_shared || gkIsKinematic(&constraints[i]->getRigidBodyA()) || gkIsKinematic(&constraints[i]->getRigidBodyB());
+	}
+
+	m_groups.push_back(group);
+
+	m_info        = &info;
+	m_debugDrawer = debugDrawer;
+	m_dispatcher  = dispatcher;
+	return btScalar(0.);
+}
+
+
+
+void gkParallelSolver::allSolved(const btContactSolverInfo& info, btIDebugDraw* debugDrawer)
+{
+	if (!m_deferred)
+		return;
+
+	m_deferred = false;
+
+	gkJobSystem& jobs = gkJobSystem::getSingleton();
+	gkJobCounter counter;
+
+	UTsize i;
+	if (m_groups.size() > 1)
+	{
+		for (i = 0; i < m_groups.size(); ++i)
+		{
+			if (!m_groups[i].m_shared)
+				jobs.submit(new gkParallelSolverJob(this, i), &counter);
+		}
+	}
+
+	for (i = 0; i < m_groups.size(); ++i)
+	{
+		if (m_groups[i].m_shared || m_groups.size() == 1)
+			solve(m_groups[i]);
+	}
+
+	jobs.wait(counter);
+}
+
+
+
+void gkParallelSolver::reset(void)
+{
+	for (UTsize i = 0; i < m_solvers.size(); ++i)
+		m_solvers[i]->reset();
+}
+
+
+
+btSequentialImpulseConstraintSolver* gkParallelSolver::getSolver(void)
+{
+	int index = gkJobSystem::getSingleton().getThreadIndex();
+	GK_ASSERT(index >= 0 && index < (int)m_solvers.size());
+	return m_solvers[index];
+}
+
+
+
+void gkParallelSolver::solve(const Group& group)
+{
+	getSolver()->solveGroup(group.m_nrBodies ? &m_bodies[group.m_firstBody] : 0, (int)group.m_nrBodies,
+	                        group.m_nrManifolds ? &m_manifolds[group.m_firstManifold] : 0, (int)group.m_nrManifolds,
+	                        group.m_nrConstraints ? &m_constraints[group.m_firstConstraint] : 0, (int)group.m_nrConstraints,
+	                        *m_info, m_debugDrawer, m_dispatcher);
+}
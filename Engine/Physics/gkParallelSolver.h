@@ -0,0 +1,94 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkParallelSolver_h_
+#define _gkParallelSolver_h_
+
+#include "gkCommon.h"
+#include "btBulletDynamicsCommon.h"
+
+
+class gkParallelSolverJob;
+
+
+// Constraint solver that solves the simulation islands on the job system.
+// The island groups handed to solveGroup() are only collected, allSolved()
+// solves them with one btSequentialImpulseConstraintSolver per thread. Groups
+// share no dynamic bodies, the results are the same as solving them in turn.
+// Groups touching a kinematic body are solved on the calling thread, the
+// solver writes to kinematic bodies that can be part of several groups.
+class gkParallelSolver : public btConstraintSolver
+{
+public:
+	gkParallelSolver();
+	virtual ~gkParallelSolver();
+
+	virtual void prepareSolve(int numBodies, int numManifolds);
+
+	virtual btScalar solveGroup(btCollisionObject** bodies, int numBodies,
+	                            btPersistentManifold** manifolds, int numManifolds,
+	                            btTypedConstraint** constraints, int numConstraints,
+	                            const btContactSolverInfo& info, btIDebugDraw* debugDrawer, btDispatcher* dispatcher);
+
+	virtual void allSolved(const btContactSolverInfo& info, btIDebugDraw* debugDrawer);
+
+	virtual void reset(void);
+
+	virtual btConstraintSolverType getSolverType(void) const { return BT_SEQUENTIAL_IMPULSE_SOLVER; }
+
+private:
+	friend class gkParallelSolverJob;
+
+	struct Group
+	{
+		UTsize m_firstBody, m_nrBodies;
+		UTsize m_firstManifold, m_nrManifolds;
+		UTsize m_firstConstraint, m_nrConstraints;
+		bool   m_shared;
+	};
+
+	typedef utArray<Group>                                 Groups;
+	typedef utArray<btSequentialImpulseConstraintSolver*>  Solvers;
+
+	btSequentialImpulseConstraintSolver* getSolver(void);
+	void solve(const Group& group);
+
+	// one per job thread
+	Solvers                         m_solvers;
+	bool                            m_deferred;
+
+	Groups                          m_groups;
+	utArray<btCollisionObject*>     m_bodies;
+	utArray<btPersistentManifold*>  m_manifolds;
+	utArray<btTypedConstraint*>     m_constraints;
+
+	const btContactSolverInfo*      m_info;
+	btIDebugDraw*                   m_debugDrawer;
+	btDispatcher*                   m_dispatcher;
+};
+
+
+#endif//_gkParallelSolver_h_
@@ -46,7 +46,10 @@ gkPhysicsController::gkPhysicsController(gkGameObject* object, gkDynamicsWorld*
 	     m_collisionObject(0),
 	     m_shape(0),
 	     m_suspend(false),
-	     m_dbvtMark(true)
+	     m_dbvtMark(true),
+	     m_contactStamp(0),
+	     m_contactFirst(0),
+	     m_contactCount(0)
 {
 	// initial copy from object
 	m_props = object->getProperties().m_physics;
@@ -109,41 +112,54 @@ gkPhysicsProperties& gkPhysicsController::getProperties(void)
 }
 
 
-gkContactInfo::Array& gkPhysicsController::getContacts(void)
+UTsize gkPhysicsController::getNumContacts(void) const
 {
-	return m_localContacts;
+	return m_owner ? m_owner->getContactStream().getNumContacts(this) : 0;
 }
 
 
-gkContactInfo::Iterator gkPhysicsController::getContactIterator(void)
+gkPhysicsController* gkPhysicsController::getContactCollider(UTsize i) const
 {
-	return gkContactInfo::Iterator(m_localContacts);
+	GK_ASSERT(i < getNumContacts());
+	return m_owner->getContactStream().getCollider(m_contactFirst + i);
+}
+
+
+const btManifoldPoint& gkPhysicsController::getContactPoint(UTsize i) const
+{
+	GK_ASSERT(i < getNumContacts());
+	return m_owner->getContactStream().getPoint(m_contactFirst + i);
+}
+
+
+gkContactInfo gkPhysicsController::getContact(UTsize i) const
+{
+	gkContactInfo cinf;
+	cinf.collider = getContactCollider(i);
+	cinf.point    = getContactPoint(i);
+	return cinf;
 }
 
 
 
 bool gkPhysicsController::collidesWith(gkGameObject* ob, gkContactInfo* cpy)
 {
-	if (!m_localContacts.empty())
-	{
-		UTsize i, s;
-		gkContactInfo::Array::Pointer p;
+	UTsize i, s;
 
-		i = 0;
-		s = m_localContacts.size();
-		p = m_localContacts.ptr();
+	i = 0;
+	s = getNumContacts();
 
-		while (i < s)
-		{
-			GK_ASSERT(p[i].collider);
+	while (i < s)
+	{
+		gkPhysicsController* collider = getContactCollider(i);
+		GK_ASSERT(collider);
 
-			if (p[i].collider->getObject() == ob)
-			{
-				if (cpy) *cpy = p[i];
-				return true;
-			}
-			++i;
+		if (collider->getObject() == ob)
+		{
+			if (cpy) *cpy = getContact(i);
+			return true;
 		}
+		++i;
 	}
 	return false;
 }
@@ -152,31 +168,28 @@ bool gkPhysicsController::collidesWith(gkGameObject* ob, gkContactInfo* cpy)
 
 bool gkPhysicsController::collidesWith(const gkString& name, gkContactInfo* cpy, bool emptyFilter)
 {
+	UTsize i, s = getNumContacts();
 
-	if (!m_localContacts.empty())
+	if (s)
 	{
 		if (name.empty() && emptyFilter)
 		{
-			if (cpy) *cpy = m_localContacts.at(0);
+			if (cpy) *cpy = getContact(0);
 			return true;
 		}
 
 
-		UTsize i, s;
-		gkContactInfo::Array::Pointer p;
-
 		i = 0;
-		s = m_localContacts.size();
-		p = m_localContacts.ptr();
 
 		while (i < s)
 		{
-			GK_ASSERT(p[i].collider);
-			gkGameObject* gobj = p[i].collider->getObject();
+			gkPhysicsController* collider = getContactCollider(i);
+			GK_ASSERT(collider);
+			gkGameObject* gobj = collider->getObject();
 
 			if (name.find(gobj->getName()) != gkString::npos)
 			{
-				if (cpy) *cpy = p[i];
+				if (cpy) *cpy = getContact(i);
 				return true;
 			}
 
@@ -190,122 +203,55 @@ bool gkPhysicsController::collidesWith(const gkString& name, gkContactInfo* cpy,
 
 
 
-bool gkPhysicsController::sensorCollides(const gkString& prop, const gkString& material, bool onlyActor, bool testAllMaterials, utArray<gkGameObject*>* collisionList)
+bool gkPhysicsController::sensorCollides(const gkSensorFilter& filter, bool onlyActor, bool testAllMaterials, utArray<gkGameObject*>* collisionList)
 {
-	if (collisionList){
-		collisionList->clear();
-	}
+	if (collisionList)
+		collisionList->clear(true);
+
 	if (onlyActor && !m_object->getProperties().isActor())
 		return false;
 
+	UTsize i, s = getNumContacts();
+	if (!s)
+		return false;
 
-	if (!m_localContacts.empty())
-	{
-		if (!collisionList && prop.empty() && material.empty())
-		{
-			// there are contacts and we do not care about property, nor empty, nor we need a list of objects (list = NULL)
-			// any filter
-			return true;
-		}
+	// any collision, no list wanted
+	if (filter.isEmpty() && (!collisionList || onlyActor))
+		return true;
 
-		UTsize i, s;
-		gkContactInfo::Array::Pointer p;
+	m_sensorSeen.clear(true);
 
-		i = 0;
-		s = m_localContacts.size();
-		p = m_localContacts.ptr();
+	gkGameObject* last = 0;
+	for (i = 0; i < s; ++i)
+	{
+		gkPhysicsController* collider = getContactCollider(i);
+		GK_ASSERT(collider);
+		gkGameObject* gobj = collider->getObject();
 
-		while (i < s)
-		{
-			GK_ASSERT(p[i].collider);
-			gkGameObject* gobj = p[i].collider->getObject();
+		// points of one manifold come in a row
+		if (gobj == last)
+			continue;
+		last = gobj;
 
+		if (!filter.test(gobj, onlyActor, testAllMaterials))
+			continue;
 
-			if (onlyActor)
-			{
+		if (!collisionList)
+			return true;
 
-				if (prop.empty() && material.empty())
-					return true;
+		if (m_sensorSeen.insert(gobj, gobj))
+			collisionList->push_back(gobj);
+	}
 
-				if (gobj->getProperties().isActor())
-				{
-					if (!prop.empty())
-					{
-						if (gobj->hasVariable(prop)){
-							if (!collisionList){
-								return true;
-							}
-							else if (collisionList->find(gobj)==UT_NPOS)
-								collisionList->push_back(gobj);
-						}
-					}
-					else if (!material.empty())
-					{
-						if (gobj->hasSensorMaterial(material, !testAllMaterials))
-						{
-							if (!collisionList)
-							{
-								return true;
-							}
-							else if (collisionList->find(gobj)==UT_NPOS){
-								collisionList->push_back(gobj);
-							}
-						}
-					}
-				}
-			}
-			else
-			{
-				if (prop.empty() && material.empty())
-					if (!collisionList)
-					{
-						return true;
-					}
-					else if (collisionList->find(gobj)==UT_NPOS)
-					{
-						collisionList->push_back(gobj);
-					}
+	return collisionList && !collisionList->empty();
+}
 
-				if (!prop.empty())
-				{
-					if (gobj->hasVariable(prop))
-					{
-						if (!collisionList)
-						{
-							return true;
-						}
-						else if (collisionList->find(gobj)==UT_NPOS)
-						{
-							collisionList->push_back(gobj);
-						}
-					}
-				}
-				else if (!material.empty())
-				{
-					if (gobj->hasSensorMaterial(material, !testAllMaterials)){
-						if (!collisionList)
-						{
-							return true;
-						}
-						else if (collisionList->find(gobj)==UT_NPOS)
-						{
-							collisionList->push_back(gobj);
-						}
-					}
-				}
-			}
 
-			++i;
-		}
-	}
-	if (!collisionList)
-		return false;
-	else if (collisionList->empty())
-		return false;
-	else
-		return true;
-}
 
+bool gkPhysicsController::sensorCollides(const gkString& prop, const gkString& material, bool onlyActor, bool testAllMaterials, utArray<gkGameObject*>* collisionList)
+{
+	return sensorCollides(gkSensorFilter(prop, material), onlyActor, testAllMaterials, collisionList);
+}
 
 
 
@@ -686,65 +632,17 @@ void gkPhysicsController::setTransform(const btTransform& worldTrans)
 	node->setOrientation(rot);
 	node->setPosition(loc);
 
-	m_object->notifyUpdate();
+	m_object->markTransformDirty(gkGameObject::TD_NOTIFY);
 }
 
 
 
-void gkPhysicsController::_handleManifold(btPersistentManifold* manifold)
+int gkPhysicsController::_getContactMode(void)
 {
 	if (m_suspend
 			|| !m_props.isContactListener()
 			|| !m_object->isInstanced())
-		return;
-
+		return CM_NONE;
 
-	gkPhysicsController* colA = castController(manifold->getBody0());
-	gkPhysicsController* colB = castController(manifold->getBody1());
-
-	gkPhysicsController* collider = colB;
-
-	if (collider == this)
-	{
-		collider = colA;
-	}
-
-
-	if (collider->m_object->getProperties().isGhost()){
-		m_localContacts.reserve(1);
-
-		gkContactInfo cinf;
-		cinf.collider = collider;
-		m_localContacts.push_back(cinf);
-	}
-	else {
-		int nrc = manifold->getNumContacts();
-
-		if (nrc)
-		{
-			m_localContacts.reserve(nrc);
-
-			for (int j = 0; j < nrc; ++j)
-			{
-				gkContactInfo cinf;
-				btManifoldPoint& pt = manifold->getContactPoint(j);
-
-				if (pt.getDistance() < 0.f)
-				{
-					cinf.collider = collider;
-					cinf.point    = pt;
-
-					m_localContacts.push_back(cinf);
-				}
-			}
-		}
-	}
-}
-
-
-
-void gkPhysicsController::_resetContactInfo(void)
-{
-	if (m_props.isContactListener())
-		m_localContacts.clear(true);
+	return CM_POINTS;
 }
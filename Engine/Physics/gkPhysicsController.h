@@ -33,6 +33,7 @@
 
 
 #include "gkSerialize.h"
+#include "gkSensorFilter.h"
 
 class btDynamicsWorld;
 class btTriangleMesh;
@@ -44,9 +45,6 @@ struct gkContactInfo
 {
 	gkPhysicsController* collider;
 	btManifoldPoint      point;
-
-	typedef utArray<gkContactInfo> Array;
-	typedef utArrayIterator<Array> Iterator;
 };
 
 
@@ -74,8 +72,12 @@ public:
 
 	void enableContactProcessing(bool v);
 
-	gkContactInfo::Array&    getContacts(void);
-	gkContactInfo::Iterator  getContactIterator(void);
+	// Contacts of the last physics substep, a span of the world contact stream.
+	UTsize                 getNumContacts(void) const;
+	bool                   hasContacts(void) const {return getNumContacts() != 0;}
+	gkPhysicsController*   getContactCollider(UTsize i) const;
+	const btManifoldPoint& getContactPoint(UTsize i) const;
+	gkContactInfo          getContact(UTsize i) const;
 
 
 	// Collision tests.
@@ -87,7 +89,9 @@ public:
 	// If prop is empty and material is empty, return any old collision.
 	// If onlyActor is true, filter collision on actor settings (gkGameObjectProperties).
 	// If testAllMaterials is true, test all assigned opposed to only testing the first assigned.
-//	bool sensorCollides(const gkString& prop, const gkString& material = "", bool onlyActor = false, bool testAllMaterials = false);
+	// Sensors keep a gkSensorFilter, the string sensorCollides builds one per call.
+	// sensorTest only compares strings, ray filters call it from gkRayBatch jobs.
+	bool sensorCollides(const gkSensorFilter& filter, bool onlyActor, bool testAllMaterials, utArray<gkGameObject*>* list=NULL);
 	bool sensorCollides(const gkString& prop, const gkString& material, bool onlyActor, bool testAllMaterials, utArray<gkGameObject*>* list=NULL);
 	static bool sensorTest(gkGameObject* ob, const gkString& prop, const gkString& material = "", bool onlyActor = false, bool testAllMaterials = false);
 
@@ -115,8 +119,14 @@ public:
 	virtual void create(void)  {}
 	virtual void destroy(void) {}
 
-	virtual void _handleManifold(btPersistentManifold* manifold);
-	void _resetContactInfo(void);
+	enum ContactMode
+	{
+		CM_NONE,        // no contacts recorded
+		CM_POINTS,      // every penetrating point
+		CM_COLLIDER,    // one contact per manifold, without point
+	};
+
+	virtual int _getContactMode(void);
 	bool _markDbvt(bool v);
 	
 	btCollisionShape* _createShape(void);
@@ -129,7 +139,13 @@ protected:
 	void createShape(void);
 	void destroyShape(btCollisionShape* shape);
 
-	gkContactInfo::Array m_localContacts;
+	// span in the contact stream of the owner, see gkContactStream
+	friend class gkContactStream;
+	UTuint32 m_contactStamp;
+	UTsize   m_contactFirst, m_contactCount;
+
+	// objects already in the list of sensorCollides
+	utFlatHashTable<utPointerHashKey, gkGameObject*> m_sensorSeen;
 
 	gkDynamicsWorld* m_owner;
 	gkGameObject* m_object;
@@ -0,0 +1,516 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "gkRayBatch.h"
+#include "gkEngine.h"
+#include "gkScene.h"
+#include "gkDynamicsWorld.h"
+#include "gkPhysicsController.h"
+#include "Thread/gkJobSystem.h"
+#include "btBulletDynamicsCommon.h"
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+
+
+
+// Forwards the filter of a query, the hit is kept as in gkRayTest
+class gkRayBatchRayCallback : public gkRayTest::gkRayTestFilter
+{
+public:
+	gkRayBatchRayCallback(const gkRayTest::gkRayTestFilter* filter)
+		:	m_filter(filter)
+	{
+		m_collisionFilterGroup = btBroadphaseProxy::AllFilter;
+		m_collisionFilterMask = btBroadphaseProxy::AllFilter;
+	}
+
+	bool filterFunc(btCollisionObject* ob) const
+	{
+		return !m_filter || m_filter->filterFunc(ob);
+	}
+
+private:
+	const gkRayTest::gkRayTestFilter* m_filter;
+};
+
+
+
+// The hit rules of gkSweptTest with the filter of a query
+class gkRayBatchSweepCallback : public btCollisionWorld::ClosestConvexResultCallback
+{
+public:
+	gkRayBatchSweepCallback(const btVector3& from, const btVector3& to, const gkRayTest::gkRayTestFilter* filter)
+		:	btCollisionWorld::ClosestConvexResultCallback(from, to),
+		    m_filter(filter)
+	{
+		m_collisionFilterGroup = btBroadphaseProxy::AllFilter;
+		m_collisionFilterMask = btBroadphaseProxy::AllFilter;
+	}
+
+	bool needsCollision(btBroadphaseProxy* proxy0) const
+	{
+		if (!ClosestConvexResultCallback::needsCollision(proxy0))
+			return false;
+
+		return !m_filter || m_filter->filterFunc(static_cast<btCollisionObject*>(proxy0->m_clientObject));
+	}
+
+	btScalar addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace)
+	{
+		if (!convexResult.m_hitCollisionObject->hasContactResponse())
+			return 1.f;
+
+		// don't report time of impact for motion away from the contact normal
+		if (convexResult.m_hitNormalLocal.dot(m_convexToWorld - m_convexFromWorld) >= 0.f)
+			return 1.f;
+
+		return ClosestConvexResultCallback::addSingleResult(convexResult, normalInWorldSpace);
+	}
+
+private:
+	const gkRayTest::gkRayTestFilter* m_filter;
+};
+
+
+
+// Objects a job leaves to the calling thread, see gkRayBatch::m_deferred
+static bool gkIsDeferredObject(const btCollisionObject* ob, bool sweep)
+{
+	const btCollisionShape* shape = ob->getCollisionShape();
+	return shape->getShapeType() == GIMPACT_SHAPE_PROXYTYPE || (sweep && shape->isCompound());
+}
+
+
+
+// Broadphase leaves of a ray or sweep, the segment is shortened to the closest hit
+class gkRayBatchCaster : public btBroadphaseRayCallback
+{
+public:
+	gkRayBatchCaster(const btVector3& from, const btVector3& to, utArray<const btCollisionObject*>& deferred)
+		:	m_from(from), m_deferred(deferred)
+	{
+		btVector3 dir = to - from;
+		btScalar len = dir.length();
+		if (len > SIMD_EPSILON)
+			dir /= len;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			m_rayDirectionInverse[i] = dir[i] == btScalar(0.) ? btScalar(BT_LARGE_FLOAT) : btScalar(1.) / dir[i];
+			m_signs[i] = m_rayDirectionInverse[i] < 0.0;
+		}
+		m_lambda_max = len;
+	}
+
+	virtual btScalar getClosestHitFraction(void) const = 0;
+
+	void walk(const btDbvtNode* root, const btVector3& aabbMin, const btVector3& aabbMax, utArray<const btDbvtNode*>& stack)
+	{
+		if (!root)
+			return;
+
+		stack.clear(true);
+		stack.push_back(root);
+
+		btVector3 bounds[2];
+		while (!stack.empty())
+		{
+			const btScalar fraction = getClosestHitFraction();
+			if (fraction == btScalar(0.))
+				return;
+
+			const btDbvtNode* node = stack.back();
+			stack.pop_back();
+
+			bounds[0] = node->volume.Mins() - aabbMax;
+			bounds[1] = node->volume.Maxs() - aabbMin;
+
+			btScalar tmin = 1.f;
+			if (!btRayAabb2(m_from, m_rayDirectionInverse, m_signs, bounds, tmin, 0.f, m_lambda_max * fraction))
+				continue;
+
+			if (node->isinternal())
+			{
+				stack.push_back(node->childs[0]);
+				stack.push_back(node->childs[1]);
+			}
+			else
+				process(static_cast<btDbvtProxy*>(node->data));
+		}
+	}
+
+protected:
+	btVector3                          m_from;
+	utArray<const btCollisionObject*>& m_deferred;
+};
+
+
+
+class gkRayBatchRayCaster : public gkRayBatchCaster
+{
+public:
+	gkRayBatchRayCaster(const btVector3& from, const btVector3& to, const gkRayTest::gkRayTestFilter* filter,
+	                    utArray<const btCollisionObject*>& deferred)
+		:	gkRayBatchCaster(from, to, deferred), m_callback(filter)
+	{
+		m_fromTrans.setIdentity();
+		m_fromTrans.setOrigin(from);
+		m_toTrans.setIdentity();
+		m_toTrans.setOrigin(to);
+	}
+
+	btScalar getClosestHitFraction(void) const { return m_callback.m_closestHitFraction; }
+
+	bool process(const btBroadphaseProxy* proxy)
+	{
+		btCollisionObject* ob = static_cast<btCollisionObject*>(proxy->m_clientObject);
+		if (!m_callback.needsCollision(ob->getBroadphaseHandle()))
+			return true;
+
+		if (gkIsDeferredObject(ob, false))
+			m_deferred.push_back(ob);
+		else
+			btCollisionWorld::rayTestSingle(m_fromTrans, m_toTrans, ob, ob->getCollisionShape(), ob->getWorldTransform(), m_callback);
+		return true;
+	}
+
+	gkRayBatchRayCallback m_callback;
+	btTransform           m_fromTrans, m_toTrans;
+};
+
+
+
+class gkRayBatchSweepCaster : public gkRayBatchCaster
+{
+public:
+	gkRayBatchSweepCaster(const btVector3& from, const btVector3& to, btConvexShape* shape,
+	                      const gkRayTest::gkRayTestFilter* filter, utArray<const btCollisionObject*>& deferred)
+		:	gkRayBatchCaster(from, to, deferred), m_callback(from, to, filter), m_shape(shape)
+	{
+		m_fromTrans.setIdentity();
+		m_fromTrans.setOrigin(from);
+		m_toTrans.setIdentity();
+		m_toTrans.setOrigin(to);
+	}
+
+	btScalar getClosestHitFraction(void) const { return m_callback.m_closestHitFraction; }
+
+	bool process(const btBroadphaseProxy* proxy)
+	{
+		btCollisionObject* ob = static_cast<btCollisionObject*>(proxy->m_clientObject);
+		if (!m_callback.needsCollision(ob->getBroadphaseHandle()))
+			return true;
+
+		if (gkIsDeferredObject(ob, true))
+			m_deferred.push_back(ob);
+		else
+			btCollisionWorld::objectQuerySingle(m_shape, m_fromTrans, m_toTrans, ob, ob->getCollisionShape(), ob->getWorldTransform(), m_callback, 0.f);
+		return true;
+	}
+
+	gkRayBatchSweepCallback m_callback;
+	btConvexShape*          m_shape;
+	btTransform             m_fromTrans, m_toTrans;
+};
+
+
+
+class gkRayBatchJob : public gkJob
+{
+public:
+	gkRayBatchJob(gkRayBatch* batch, UTsize chunk, gkRayBatch::Results& results)
+		:	m_batch(batch), m_chunk(chunk), m_results(results)
+	{
+	}
+
+	void run(void) { m_batch->castChunk(m_chunk, m_results); }
+
+private:
+	gkRayBatch*          m_batch;
+	UTsize               m_chunk;
+	gkRayBatch::Results& m_results;
+};
+
+
+
+gkGameObject* gkRayBatch::Result::getObject(void) const
+{
+	return gkPhysicsController::castObject(collisionObject);
+}
+
+
+
+gkRayBatch::gkRayBatch(gkScene* scene)
+{
+	if (!scene)
+		scene = gkEngine::getSingleton().getActiveScene();
+
+	GK_ASSERT(scene);
+	m_world = scene->getDynamicsWorld()->getBulletWorld();
+}
+
+
+
+gkRayBatch::gkRayBatch(btCollisionWorld* world)
+	:	m_world(world)
+{
+}
+
+
+
+gkRayBatch::~gkRayBatch()
+{
+}
+
+
+
+UTsize gkRayBatch::addRay(const gkVector3& from, const gkVector3& to, const gkRayTest::gkRayTestFilter* filter)
+{
+	return addSweep(from, to, 0.f, filter);
+}
+
+
+
+UTsize gkRayBatch::addSweep(const gkVector3& from, const gkVector3& to, gkScalar radius, const gkRayTest::gkRayTestFilter* filter)
+{
+	Query query;
+	query.from   = from;
+	query.to     = to;
+	query.radius = radius;
+	query.filter = filter;
+
+	m_queries.push_back(query);
+	return m_queries.size() - 1;
+}
+
+
+
+void gkRayBatch::clear(void)
+{
+	m_queries.clear(true);
+}
+
+
+
+void gkRayBatch::cast(Results& results)
+{
+	GK_ASSERT(m_world);
+
+	results.resize(m_queries.size());
+	if (m_queries.empty())
+		return;
+
+	const UTsize nrChunks = (m_queries.size() + QUERIES_PER_JOB - 1) / QUERIES_PER_JOB;
+	m_deferred.resize(nrChunks);
+
+	gkJobSystem* jobs = gkJobSystem::getSingletonPtr();
+	UTsize i;
+
+	if (!jobs || jobs->getNumThreads() == 0 || jobs->getThreadIndex() == -1 || nrChunks < 2)
+	{
+		for (i = 0; i < nrChunks; ++i)
+			castChunk(i, results);
+	}
+	else
+	{
+		gkJobCounter counter;
+		for (i = 0; i < nrChunks; ++i)
+			jobs->submit(new gkRayBatchJob(this, i, results), &counter);
+
+		jobs->wait(counter);
+	}
+
+	castDeferred(results);
+}
+
+
+
+void gkRayBatch::castChunk(UTsize chunk, Results& results)
+{
+	const UTsize first = chunk * QUERIES_PER_JOB;
+	const UTsize last  = gkMin<UTsize>(first + QUERIES_PER_JOB, m_queries.size());
+
+	DeferredQueries& deferred = m_deferred[chunk];
+	deferred.clear(true);
+
+	Stack stack;
+	for (UTsize i = first; i < last; ++i)
+	{
+		if (m_queries[i].radius > 0.f)
+			castSweep(i, results[i], stack, deferred);
+		else
+			castRay(i, results[i], stack, deferred);
+	}
+}
+
+
+
+void gkRayBatch::castRay(UTsize index, Result& result, Stack& stack, DeferredQueries& deferred)
+{
+	const Query& query = m_queries[index];
+	const btVector3 from(query.from.x, query.from.y, query.from.z);
+	const btVector3 to(query.to.x, query.to.y, query.to.z);
+
+	utArray<const btCollisionObject*> objects;
+	gkRayBatchRayCaster caster(from, to, query.filter, objects);
+
+	btDbvtBroadphase* broadphase = static_cast<btDbvtBroadphase*>(m_world->getBroadphase());
+	const btVector3 zero(0, 0, 0);
+	caster.walk(broadphase->m_sets[0].m_root, zero, zero, stack);
+	caster.walk(broadphase->m_sets[1].m_root, zero, zero, stack);
+
+	const gkRayBatchRayCallback& callback = caster.m_callback;
+	result.collisionObject = callback.m_collisionObject;
+	result.hitFraction     = callback.m_closestHitFraction;
+
+	if (result.collisionObject)
+	{
+		btVector3 hitPoint;
+		hitPoint.setInterpolate3(from, to, callback.m_closestHitFraction);
+
+		result.hitPoint  = gkVector3(hitPoint);
+		result.hitNormal = gkVector3(callback.m_hitNormalWorld);
+	}
+	else
+	{
+		result.hitPoint  = gkVector3::ZERO;
+		result.hitNormal = gkVector3::ZERO;
+	}
+
+	defer(index, objects, deferred);
+}
+
+
+
+void gkRayBatch::castSweep(UTsize index, Result& result, Stack& stack, DeferredQueries& deferred)
+{
+	const Query& query = m_queries[index];
+	const btVector3 from(query.from.x, query.from.y, query.from.z);
+	const btVector3 to(query.to.x, query.to.y, query.to.z);
+
+	btSphereShape sphere(query.radius);
+	utArray<const btCollisionObject*> objects;
+	gkRayBatchSweepCaster caster(from, to, &sphere, query.filter, objects);
+
+	btTransform ident;
+	ident.setIdentity();
+	btVector3 aabbMin, aabbMax;
+	sphere.getAabb(ident, aabbMin, aabbMax);
+
+	btDbvtBroadphase* broadphase = static_cast<btDbvtBroadphase*>(m_world->getBroadphase());
+	caster.walk(broadphase->m_sets[0].m_root, aabbMin, aabbMax, stack);
+	caster.walk(broadphase->m_sets[1].m_root, aabbMin, aabbMax, stack);
+
+	const gkRayBatchSweepCallback& callback = caster.m_callback;
+	result.collisionObject = callback.m_hitCollisionObject;
+	result.hitFraction     = callback.m_closestHitFraction;
+
+	if (result.collisionObject)
+	{
+		result.hitPoint  = gkVector3(callback.m_hitPointWorld);
+		result.hitNormal = gkVector3(callback.m_hitNormalWorld);
+	}
+	else
+	{
+		result.hitPoint  = gkVector3::ZERO;
+		result.hitNormal = gkVector3::ZERO;
+	}
+
+	defer(index, objects, deferred);
+}
+
+
+
+void gkRayBatch::defer(UTsize index, const utArray<const btCollisionObject*>& objects, DeferredQueries& deferred)
+{
+	for (UTsize i = 0; i < objects.size(); ++i)
+	{
+		Deferred def;
+		def.query  = index;
+		def.object = objects[i];
+		deferred.push_back(def);
+	}
+}
+
+
+
+void gkRayBatch::castDeferred(Results& results)
+{
+	for (UTsize c = 0; c < m_deferred.size(); ++c)
+	{
+		const DeferredQueries& deferred = m_deferred[c];
+		for (UTsize i = 0; i < deferred.size(); ++i)
+		{
+			const Query& query = m_queries[deferred[i].query];
+			Result& result = results[deferred[i].query];
+			btCollisionObject* ob = const_cast<btCollisionObject*>(deferred[i].object);
+
+			const btVector3 from(query.from.x, query.from.y, query.from.z);
+			const btVector3 to(query.to.x, query.to.y, query.to.z);
+
+			btTransform fromTrans, toTrans;
+			fromTrans.setIdentity();
+			fromTrans.setOrigin(from);
+			toTrans.setIdentity();
+			toTrans.setOrigin(to);
+
+			// the fraction starts at the hit so far, only closer hits land here
+			if (query.radius > 0.f)
+			{
+				btSphereShape sphere(query.radius);
+				gkRayBatchSweepCallback callback(from, to, query.filter);
+				callback.m_closestHitFraction = result.hitFraction;
+
+				btCollisionWorld::objectQuerySingle(&sphere, fromTrans, toTrans, ob, ob->getCollisionShape(), ob->getWorldTransform(), callback, 0.f);
+
+				if (callback.m_hitCollisionObject)
+				{
+					result.collisionObject = callback.m_hitCollisionObject;
+					result.hitFraction     = callback.m_closestHitFraction;
+					result.hitPoint        = gkVector3(callback.m_hitPointWorld);
+					result.hitNormal       = gkVector3(callback.m_hitNormalWorld);
+				}
+			}
+			else
+			{
+				gkRayBatchRayCallback callback(query.filter);
+				callback.m_closestHitFraction = result.hitFraction;
+
+				btCollisionWorld::rayTestSingle(fromTrans, toTrans, ob, ob->getCollisionShape(), ob->getWorldTransform(), callback);
+
+				if (callback.m_collisionObject)
+				{
+					btVector3 hitPoint;
+					hitPoint.setInterpolate3(from, to, callback.m_closestHitFraction);
+
+					result.collisionObject = callback.m_collisionObject;
+					result.hitFraction     = callback.m_closestHitFraction;
+					result.hitPoint        = gkVector3(hitPoint);
+					result.hitNormal       = gkVector3(callback.m_hitNormalWorld);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,137 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkRayBatch_h_
+#define _gkRayBatch_h_
+
+#include "gkCommon.h"
+#include "gkMathUtils.h"
+#include "gkRayTest.h"
+
+class btCollisionWorld;
+class btDbvtNode;
+
+
+// Closest hit rays & sphere sweeps, queued and cast together. With the job
+// system running, batches are split into jobs of QUERIES_PER_JOB queries.
+//
+// The broadphase trees are walked here with a stack per job; btDbvtBroadphase
+// shares one stack between all ray tests, so btCollisionWorld::rayTest cannot
+// run on several threads. Filters are called on the worker threads, and the
+// world must not change while the batch runs. Objects that are not safe to
+// query from several threads, GImpact meshes (which lock the shared vertex
+// data) and compounds for sweeps (Bullet's profiler), are queried on the
+// calling thread after the jobs.
+class gkRayBatch
+{
+public:
+	enum
+	{
+		QUERIES_PER_JOB = 64,
+	};
+
+	struct Query
+	{
+		gkVector3 from, to;
+
+		// zero casts a ray, otherwise a sphere of this radius is swept
+		gkScalar radius;
+
+		// optional, only filterFunc is used
+		const gkRayTest::gkRayTestFilter* filter;
+	};
+
+	struct Result
+	{
+		// zero when nothing was hit
+		const btCollisionObject* collisionObject;
+
+		gkVector3 hitPoint;
+		gkVector3 hitNormal;
+		gkScalar  hitFraction;
+
+		GK_INLINE bool hasHit(void) const { return collisionObject != 0; }
+
+		gkGameObject* getObject(void) const;
+	};
+
+	typedef utArray<Query>  Queries;
+	typedef utArray<Result> Results;
+
+public:
+	gkRayBatch(gkScene* scene = 0);
+
+	// the world has to use a btDbvtBroadphase, like gkDynamicsWorld
+	gkRayBatch(btCollisionWorld* world);
+
+	~gkRayBatch();
+
+	// the index of the query in the results
+	UTsize addRay(const gkVector3& from, const gkVector3& to, const gkRayTest::gkRayTestFilter* filter = 0);
+
+	// hits like gkSweptTest: objects without contact response and
+	// moving away from the hit are skipped
+	UTsize addSweep(const gkVector3& from, const gkVector3& to, gkScalar radius, const gkRayTest::gkRayTestFilter* filter = 0);
+
+	// casts all queries, results[i] answers query i
+	void cast(Results& results);
+
+	void clear(void);
+
+	GK_INLINE UTsize         size(void) const       { return m_queries.size(); }
+	GK_INLINE const Queries& getQueries(void) const { return m_queries; }
+
+	// casts the queries of one job on the calling thread
+	void castChunk(UTsize chunk, Results& results);
+
+private:
+
+	typedef utArray<const btDbvtNode*> Stack;
+
+	struct Deferred
+	{
+		UTsize query;
+		const btCollisionObject* object;
+	};
+
+	typedef utArray<Deferred>        DeferredQueries;
+	typedef utArray<DeferredQueries> ChunkQueries;
+
+	void castRay(UTsize index, Result& result, Stack& stack, DeferredQueries& deferred);
+	void castSweep(UTsize index, Result& result, Stack& stack, DeferredQueries& deferred);
+	void defer(UTsize index, const utArray<const btCollisionObject*>& objects, DeferredQueries& deferred);
+	void castDeferred(Results& results);
+
+	btCollisionWorld*  m_world;
+	Queries            m_queries;
+
+	// queries against GImpact meshes, and sweeps against compounds, are
+	// done on the calling thread once the jobs finished, in query order
+	ChunkQueries       m_deferred;
+};
+
+
+#endif//_gkRayBatch_h_
@@ -0,0 +1,156 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "gkSensorFilter.h"
+#include "gkGameObject.h"
+
+
+
+// Interned names, the index of a name is its bit
+class gkSensorTags
+{
+public:
+	gkSensorTags() : m_generation(1) {}
+
+	~gkSensorTags()
+	{
+		for (UTsize i = 0; i < m_names.size(); ++i)
+			delete m_names[i];
+	}
+
+	utHashTable<utCharHashKey, UTsize> m_bits;
+	utArray<gkString*>                 m_names;
+	UTuint32                           m_generation;
+};
+
+
+static gkSensorTags& getSensorTags(void)
+{
+	static gkSensorTags tags;
+	return tags;
+}
+
+
+
+gkSensorFilter::gkSensorFilter(const gkString& prop, const gkString& material)
+	:	m_prop(prop), m_material(material),
+	    m_propTag(intern(prop)), m_materialTag(intern(material))
+{
+}
+
+
+
+void gkSensorFilter::setProperty(const gkString& prop)
+{
+	m_prop = prop;
+	m_propTag = intern(prop);
+}
+
+
+
+void gkSensorFilter::setMaterial(const gkString& material)
+{
+	m_material = material;
+	m_materialTag = intern(material);
+}
+
+
+
+bool gkSensorFilter::test(gkGameObject* ob, bool onlyActor, bool testAllMaterials) const
+{
+	GK_ASSERT(ob);
+
+	if (onlyActor && !ob->getProperties().isActor())
+		return false;
+
+	if (!m_prop.empty())
+	{
+		if (!m_propTag)
+			return ob->hasVariable(m_prop);
+
+		return (ob->getSensorMasks().props & m_propTag) != 0;
+	}
+
+	if (!m_material.empty())
+	{
+		if (!m_materialTag)
+			return ob->hasSensorMaterial(m_material, !testAllMaterials);
+
+		const gkGameObject::SensorMasks& masks = ob->getSensorMasks();
+		return ((testAllMaterials ? masks.materials : masks.firstMaterial) & m_materialTag) != 0;
+	}
+
+	return true;
+}
+
+
+
+gkSensorFilter::Mask gkSensorFilter::intern(const gkString& name)
+{
+	if (name.empty())
+		return 0;
+
+	Mask bit = find(name);
+	if (bit)
+		return bit;
+
+	gkSensorTags& tags = getSensorTags();
+	if (tags.m_names.size() >= MAX_TAGS)
+		return 0;
+
+	// same hash as an interned name, the masks could not tell them apart
+	if (tags.m_bits.find(name.c_str()) != UT_NPOS)
+		return 0;
+
+	gkString* stored = new gkString(name);
+	UTsize index = tags.m_names.size();
+	tags.m_names.push_back(stored);
+	tags.m_bits.insert(stored->c_str(), index);
+	++tags.m_generation;
+
+	return Mask(1) << index;
+}
+
+
+
+gkSensorFilter::Mask gkSensorFilter::find(const gkString& name)
+{
+	gkSensorTags& tags = getSensorTags();
+
+	UTsize pos = tags.m_bits.find(name.c_str());
+	if (pos == UT_NPOS)
+		return 0;
+
+	UTsize index = tags.m_bits.at(pos);
+	return *tags.m_names[index] == name ? Mask(1) << index : 0;
+}
+
+
+
+UTuint32 gkSensorFilter::getGeneration(void)
+{
+	return getSensorTags().m_generation;
+}
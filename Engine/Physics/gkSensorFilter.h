@@ -0,0 +1,81 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkSensorFilter_h_
+#define _gkSensorFilter_h_
+
+#include "gkCommon.h"
+
+class gkGameObject;
+
+
+// Property or material filter of a sensor. The names are interned once to one
+// bit each, and game objects keep masks of the tags they carry (see
+// gkGameObject::getSensorMasks), so a test is a mask test per object. Up to
+// MAX_TAGS names get a bit; filters on later names compare strings like
+// gkPhysicsController::sensorTest.
+//
+// Tags and masks are updated on the logic thread, not from physics jobs.
+class gkSensorFilter
+{
+public:
+	typedef UTuint64 Mask;
+
+	enum
+	{
+		MAX_TAGS = 64,
+	};
+
+public:
+	gkSensorFilter(const gkString& prop = "", const gkString& material = "");
+
+	void setProperty(const gkString& prop);
+	void setMaterial(const gkString& material);
+
+	GK_INLINE const gkString& getProperty(void) const { return m_prop; }
+	GK_INLINE const gkString& getMaterial(void) const { return m_material; }
+
+	GK_INLINE bool isEmpty(void) const { return m_prop.empty() && m_material.empty(); }
+
+	// as sensorTest: the property when set, else the material, else anything
+	bool test(gkGameObject* ob, bool onlyActor = false, bool testAllMaterials = false) const;
+
+	// bit of a name, it is added when unknown, 0 when all bits are taken
+	static Mask intern(const gkString& name);
+
+	// bit of a name, 0 when it was never interned
+	static Mask find(const gkString& name);
+
+	// changes whenever a tag is added, masks of older generations are stale
+	static UTuint32 getGeneration(void);
+
+private:
+	gkString m_prop, m_material;
+	Mask     m_propTag, m_materialTag;
+};
+
+
+#endif//_gkSensorFilter_h_
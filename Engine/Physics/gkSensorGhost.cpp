@@ -0,0 +1,279 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "gkSensorGhost.h"
+
+
+
+// the world's pair cache already filtered what reaches the ghost
+class gkSensorGhostPairs : public btOverlapFilterCallback
+{
+public:
+	bool needBroadphaseCollision(btBroadphaseProxy* proxy0, btBroadphaseProxy* proxy1) const
+	{
+		return true;
+	}
+};
+
+static gkSensorGhostPairs gkAcceptPairs;
+
+
+
+gkSensorGhost::gkSensorGhost(btCollisionWorld* world)
+	:	m_world(world),
+	    m_ghost(0),
+	    m_shape(0),
+	    m_radius(0),
+	    m_height(0),
+	    m_lastUsed(0),
+	    m_moved(true)
+{
+	m_ghost = new btPairCachingGhostObject();
+	m_ghost->setCollisionFlags(btCollisionObject::CF_NO_CONTACT_RESPONSE | btCollisionObject::CF_DISABLE_VISUALIZE_OBJECT);
+	m_ghost->getOverlappingPairCache()->setOverlapFilterCallback(&gkAcceptPairs);
+}
+
+
+
+gkSensorGhost::~gkSensorGhost()
+{
+	if (m_shape)
+		m_world->removeCollisionObject(m_ghost);
+
+	delete m_ghost;
+	delete m_shape;
+}
+
+
+
+void gkSensorGhost::setSphere(gkScalar radius)
+{
+	if (m_shape && m_shape->getShapeType() == SPHERE_SHAPE_PROXYTYPE)
+	{
+		if (m_radius != radius)
+		{
+			// near sensors switch between range & reset range
+			static_cast<btSphereShape*>(m_shape)->setUnscaledRadius(radius);
+			m_radius = radius;
+			m_moved = true;
+			m_world->updateSingleAabb(m_ghost);
+		}
+		return;
+	}
+
+	m_radius = radius;
+	setShape(new btSphereShape(radius));
+}
+
+
+
+void gkSensorGhost::setCone(gkScalar radius, gkScalar height)
+{
+	if (m_shape && m_shape->getShapeType() == CONE_SHAPE_PROXYTYPE && m_radius == radius && m_height == height)
+		return;
+
+	m_radius = radius;
+	m_height = height;
+	setShape(new btConeShapeZ(radius, height));
+}
+
+
+
+void gkSensorGhost::setShape(btCollisionShape* shape)
+{
+	btCollisionShape* old = m_shape;
+
+	m_shape = shape;
+	m_ghost->setCollisionShape(m_shape);
+	m_moved = true;
+
+	// the proxy stays, only its bounds change
+	if (old)
+		m_world->updateSingleAabb(m_ghost);
+	else
+		m_world->addCollisionObject(m_ghost, btBroadphaseProxy::SensorTrigger, 0);
+
+	delete old;
+}
+
+
+
+void gkSensorGhost::setTransform(const btTransform& trans)
+{
+	GK_ASSERT(m_shape);
+
+	// idle owners keep their pairs as they are
+	if (trans == m_ghost->getWorldTransform())
+		return;
+
+	m_ghost->setWorldTransform(trans);
+	m_world->updateSingleAabb(m_ghost);
+	m_moved = true;
+}
+
+
+
+bool gkSensorGhost::collides(utArray<const btCollisionObject*>& hits, const btCollisionObject* ignore)
+{
+	hits.clear(true);
+
+	if (!m_shape)
+		return false;
+
+	btDispatcher* dispatcher = m_world->getDispatcher();
+
+	// proxies have the same margin
+	btVector3 aabbMin, aabbMax;
+	m_shape->getAabb(m_ghost->getWorldTransform(), aabbMin, aabbMax);
+	aabbMin -= btVector3(gContactBreakingThreshold, gContactBreakingThreshold, gContactBreakingThreshold);
+	aabbMax += btVector3(gContactBreakingThreshold, gContactBreakingThreshold, gContactBreakingThreshold);
+
+	btBroadphasePairArray& pairs = m_ghost->getOverlappingPairCache()->getOverlappingPairArray();
+	for (int i = 0; i < pairs.size(); ++i)
+	{
+		btBroadphasePair& pair = pairs[i];
+
+		btCollisionObject* ob0 = static_cast<btCollisionObject*>(pair.m_pProxy0->m_clientObject);
+		btCollisionObject* ob1 = static_cast<btCollisionObject*>(pair.m_pProxy1->m_clientObject);
+
+		btCollisionObject* other = ob0 == m_ghost ? ob1 : ob0;
+		if (other == ignore)
+			continue;
+
+		// pairs left from an older position are only dropped by the next step
+		btBroadphaseProxy* proxy = other->getBroadphaseHandle();
+		if (!TestAabbAgainstAabb2(aabbMin, aabbMax, proxy->m_aabbMin, proxy->m_aabbMax))
+			continue;
+
+		btCollisionObjectWrapper wrap0(0, ob0->getCollisionShape(), ob0, ob0->getWorldTransform(), -1, -1);
+		btCollisionObjectWrapper wrap1(0, ob1->getCollisionShape(), ob1, ob1->getWorldTransform(), -1, -1);
+
+		// the algorithm & its manifold live as long as the pair
+		if (!pair.m_algorithm)
+			pair.m_algorithm = dispatcher->findAlgorithm(&wrap0, &wrap1);
+
+		if (!pair.m_algorithm)
+			continue;
+
+		// Objects that are not simulated only move through setWorldTransform,
+		// which bumps their revision. When neither side moved the manifold of
+		// the last query is still right. The ghost's own pair cache is not
+		// used by anything else, its pairs keep the revision.
+		bool idle = !m_moved && (other->isStaticObject() || !other->isActive());
+		if (!idle || pair.m_internalTmpValue != other->getUpdateRevisionInternal())
+		{
+			// points of the last query would be kept while in reach
+			m_manifolds.resize(0);
+			pair.m_algorithm->getAllContactManifolds(m_manifolds);
+			for (int j = 0; j < m_manifolds.size(); ++j)
+				m_manifolds[j]->clearManifold();
+
+			btManifoldResult result(&wrap0, &wrap1);
+			pair.m_algorithm->processCollision(&wrap0, &wrap1, m_world->getDispatchInfo(), &result);
+			pair.m_internalTmpValue = other->getUpdateRevisionInternal();
+		}
+
+		m_manifolds.resize(0);
+		pair.m_algorithm->getAllContactManifolds(m_manifolds);
+
+		if (hasContact(m_manifolds))
+			hits.push_back(other);
+	}
+
+	m_moved = false;
+	return !hits.empty();
+}
+
+
+
+bool gkSensorGhost::hasContact(const btManifoldArray& manifolds)
+{
+	for (int i = 0; i < manifolds.size(); ++i)
+	{
+		const btPersistentManifold* manifold = manifolds[i];
+
+		// points are kept up to the breaking threshold, only overlaps count
+		for (int j = 0; j < manifold->getNumContacts(); ++j)
+		{
+			if (manifold->getContactPoint(j).getDistance() <= 0.f)
+				return true;
+		}
+	}
+	return false;
+}
+
+
+
+void gkSensorGhost::debugDraw(const btVector3& color)
+{
+	if (m_shape && m_world->getDebugDrawer())
+		m_world->debugDrawObject(m_ghost->getWorldTransform(), m_shape, color);
+}
+
+
+
+bool gkSensorGhost::isSensorProxy(const btBroadphaseProxy* proxy)
+{
+	if (proxy->m_collisionFilterGroup != btBroadphaseProxy::SensorTrigger || proxy->m_collisionFilterMask != 0)
+		return false;
+
+	// game objects always point back to their controller
+	const btCollisionObject* ob = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+	return ob->getInternalType() == btCollisionObject::CO_GHOST_OBJECT && !ob->getUserPointer();
+}
+
+
+
+void gkSensorGhost::nearCallback(btBroadphasePair& pair, btCollisionDispatcher& dispatcher, const btDispatcherInfo& info)
+{
+	// sensor pairs only run when their sensor queries
+	if (isSensorProxy(pair.m_pProxy0) || isSensorProxy(pair.m_pProxy1))
+		return;
+
+	btCollisionDispatcher::defaultNearCallback(pair, dispatcher, info);
+}
+
+
+
+bool gkSensorGhostFilter::needBroadphaseCollision(btBroadphaseProxy* proxy0, btBroadphaseProxy* proxy1) const
+{
+	bool sensor0 = gkSensorGhost::isSensorProxy(proxy0);
+	bool sensor1 = gkSensorGhost::isSensorProxy(proxy1);
+
+	if (sensor0 || sensor1)
+	{
+		if (sensor0 && sensor1)
+			return false;
+
+		// what a contact test in the default group accepts
+		const btBroadphaseProxy* other = sensor0 ? proxy1 : proxy0;
+		return (other->m_collisionFilterMask & btBroadphaseProxy::DefaultFilter) != 0;
+	}
+
+	bool collides = (proxy0->m_collisionFilterGroup & proxy1->m_collisionFilterMask) != 0;
+	collides = collides && (proxy1->m_collisionFilterGroup & proxy0->m_collisionFilterMask);
+	return collides;
+}
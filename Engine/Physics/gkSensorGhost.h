@@ -0,0 +1,98 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkSensorGhost_h_
+#define _gkSensorGhost_h_
+
+#include "gkCommon.h"
+#include "gkMathUtils.h"
+#include "btBulletDynamicsCommon.h"
+#include "BulletCollision/CollisionDispatch/btGhostObject.h"
+
+
+// Persistent overlap volume of a near or radar sensor. The ghost stays in the
+// broadphase and follows the owner, so the objects around it come from the
+// pair cache and only those get a narrowphase test on query, with collision
+// algorithms kept per pair.
+//
+// The world never dispatches sensor pairs (see nearCallback) and queries
+// (rays, sweeps & contact tests) never see the volumes, see
+// gkSensorGhostFilter.
+class gkSensorGhost
+{
+public:
+	gkSensorGhost(btCollisionWorld* world);
+	~gkSensorGhost();
+
+	// the shape is only replaced when the size changed
+	void setSphere(gkScalar radius);
+	void setCone(gkScalar radius, gkScalar height);
+
+	// moves the volume, new overlaps are paired at once
+	void setTransform(const btTransform& trans);
+
+	// objects touching the volume, ignore is skipped
+	bool collides(utArray<const btCollisionObject*>& hits, const btCollisionObject* ignore = 0);
+
+	void debugDraw(const btVector3& color);
+
+	GK_INLINE btPairCachingGhostObject* getGhostObject(void) const {return m_ghost;}
+	GK_INLINE btCollisionShape*         getShape(void) const       {return m_shape;}
+
+	// world step of the last query
+	GK_INLINE UTuint32 getLastUsed(void) const  {return m_lastUsed;}
+	GK_INLINE void     setLastUsed(UTuint32 v)  {m_lastUsed = v;}
+
+	static bool isSensorProxy(const btBroadphaseProxy* proxy);
+
+	// the dispatcher's near callback, skips sensor pairs
+	static void nearCallback(btBroadphasePair& pair, btCollisionDispatcher& dispatcher, const btDispatcherInfo& info);
+
+private:
+	void setShape(btCollisionShape* shape);
+
+	static bool hasContact(const btManifoldArray& manifolds);
+
+	btCollisionWorld*          m_world;
+	btPairCachingGhostObject*  m_ghost;
+	btCollisionShape*          m_shape;
+	gkScalar                   m_radius, m_height;
+	UTuint32                   m_lastUsed;
+	bool                       m_moved;
+	btManifoldArray            m_manifolds;
+};
+
+
+// The default group & mask test for everything else, sensor volumes pair
+// with whatever a default contact test would have found.
+class gkSensorGhostFilter : public btOverlapFilterCallback
+{
+public:
+	bool needBroadphaseCollision(btBroadphaseProxy* proxy0, btBroadphaseProxy* proxy1) const;
+};
+
+
+#endif//_gkSensorGhost_h_
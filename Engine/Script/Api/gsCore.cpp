@@ -1850,7 +1850,7 @@ bool gsGameObject::hasContacts()
 	{
 		gkPhysicsController* ob = get()->getPhysicsController();
 		if (ob)
-			return !ob->getContacts().empty();
+			return ob->hasContacts();
 	}
 	return false;
 }
@@ -2538,7 +2538,7 @@ void import(const gkString& scriptName)
 	gkLuaScript* script = gkLuaManager::getSingleton().getByName<gkLuaScript>(gkResourceName(scriptName, ""));
 
 	if (script)
-		script->execute();
+		script->import();
 }
 
 gkString getPlatform() {
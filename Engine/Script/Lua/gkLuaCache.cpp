@@ -0,0 +1,320 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "gkLuaCache.h"
+#include "gkLuaUtils.h"
+#include "gkMathUtils.h"
+#include "gkPath.h"
+#include "gkLogger.h"
+#include "utStreams.h"
+
+#include <stdio.h>
+
+
+#define GK_LUA_CACHE_MAGIC      UT_ID('G', 'K', 'L', 'C')
+#define GK_LUA_CACHE_FORMAT     1
+#define GK_LUA_CACHE_FILE       "scripts.gkluacache"
+
+// Size of the lua_dump header (LUAC_HEADERSIZE), the chunk name follows it
+// as a size_t length and the zero terminated string.
+#define GK_LUA_DUMP_HEADER      12
+
+
+// On disk layout, offsets are relative to the start of the file.
+struct gkLuaCacheHeader
+{
+	UTuint32 m_magic;
+	UTuint32 m_format;
+	UTuint32 m_engine;          // GK_VERSION
+	UTuint32 m_lua;             // gkLuaCacheLayout
+	UTuint32 m_nrChunks;
+	UTuint32 m_pad;
+	UTuint64 m_chunks;          // gkLuaCache::Chunk[m_nrChunks]
+	UTuint64 m_code;
+	UTuint64 m_codeSize;
+	UTuint64 m_codeHash;        // hashText of the code block
+};
+
+
+static UTuint32 gkLuaCacheLayout(void)
+{
+	// lua_load checks the rest of the bytecode header itself
+	return  (UTuint32)LUA_VERSION_NUM
+	        | (UTuint32)sizeof(size_t) << 16
+	        | (UTuint32)sizeof(lua_Number) << 24;
+}
+
+
+static utIntHashKey gkLuaCacheKey(UTuint64 hash)
+{
+	return utIntHashKey((int)(hash ^ (hash >> 32)));
+}
+
+
+static int gkLuaCacheWriter(lua_State* L, const void* p, size_t sz, void* ud)
+{
+	utArray<char>* buffer = static_cast<utArray<char>*>(ud);
+
+	UTsize size = buffer->size();
+	if (size + sz > buffer->capacity())
+		buffer->reserve(gkMax<UTsize>(size + sz, buffer->capacity() * 2));
+
+	buffer->resize(size + sz);
+	memcpy(buffer->ptr() + size, p, sz);
+	return 0;
+}
+
+
+gkLuaCache::gkLuaCache(const gkString& cacheDir)
+	:	m_dirty(false),
+		m_hits(0),
+		m_misses(0)
+{
+	gkPath path(cacheDir);
+	path.append(GK_LUA_CACHE_FILE);
+	m_cacheFile = path.getPath();
+}
+
+
+gkLuaCache::~gkLuaCache()
+{
+}
+
+
+UTuint64 gkLuaCache::hashText(const char* text, UTsize len)
+{
+	// 64 bit FNV-1a, the text size is compared as well
+	UTuint64 hash = 0xCBF29CE484222325ULL;
+	for (UTsize i = 0; i < len; ++i)
+	{
+		hash ^= (unsigned char)text[i];
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+
+const gkLuaCache::Chunk* gkLuaCache::findChunk(UTuint64 hash, UTsize len) const
+{
+	UTsize pos = m_index.find(gkLuaCacheKey(hash));
+	if (pos == UT_NPOS)
+		return 0;
+
+	const Chunk& chunk = m_chunks[m_index.at(pos)];
+	if (chunk.m_hash != hash || chunk.m_textSize != len)
+		return 0;
+	return &chunk;
+}
+
+
+bool gkLuaCache::load(void)
+{
+	m_chunks.clear();
+	m_index.clear();
+	m_code.clear();
+	m_dirty = false;
+
+	if (!gkPath(m_cacheFile).isFile())
+		return false;
+
+	utFileStream fs;
+	fs.open(m_cacheFile.c_str(), utStream::SM_READ);
+	if (!fs.isOpen() || fs.size() < sizeof(gkLuaCacheHeader))
+		return false;
+
+	utArray<char> data;
+	data.resize(fs.size());
+	bool ok = fs.read(data.ptr(), data.size()) == data.size();
+	fs.close();
+
+	const UTuint64 size = (UTuint64)data.size();
+	const gkLuaCacheHeader* hdr = (const gkLuaCacheHeader*)data.ptr();
+
+	ok = ok &&
+	     hdr->m_magic    == GK_LUA_CACHE_MAGIC  &&
+	     hdr->m_format   == GK_LUA_CACHE_FORMAT &&
+	     hdr->m_engine   == GK_VERSION          &&
+	     hdr->m_lua      == gkLuaCacheLayout()  &&
+	     hdr->m_chunks   <= size && hdr->m_nrChunks <= (size - hdr->m_chunks) / sizeof(Chunk) &&
+	     hdr->m_code     <= size && hdr->m_codeSize <= size - hdr->m_code;
+
+	ok = ok && hashText(data.ptr() + hdr->m_code, (UTsize)hdr->m_codeSize) == hdr->m_codeHash;
+	if (!ok)
+	{
+		gkLogMessage("LuaCache: " << m_cacheFile << " is out of date.");
+		return false;
+	}
+
+	const Chunk* chunks = (const Chunk*)(data.ptr() + hdr->m_chunks);
+	for (UTuint32 i = 0; i < hdr->m_nrChunks; ++i)
+	{
+		const Chunk& chunk = chunks[i];
+		if (chunk.m_code > hdr->m_codeSize || chunk.m_codeSize > hdr->m_codeSize - chunk.m_code ||
+		    chunk.m_codeSize < GK_LUA_DUMP_HEADER)
+			continue;
+
+		if (m_index.find(gkLuaCacheKey(chunk.m_hash)) != UT_NPOS)
+			continue;
+
+		m_index.insert(gkLuaCacheKey(chunk.m_hash), m_chunks.size());
+		m_chunks.push_back(chunk);
+	}
+
+	m_code.resize((UTsize)hdr->m_codeSize);
+	if (hdr->m_codeSize > 0)
+		memcpy(m_code.ptr(), data.ptr() + hdr->m_code, (size_t)hdr->m_codeSize);
+	return true;
+}
+
+
+bool gkLuaCache::loadChunk(lua_State* L, const char* text, UTsize len, const char* name)
+{
+	const Chunk* chunk = findChunk(hashText(text, len), len);
+	if (!chunk)
+	{
+		++m_misses;
+		return false;
+	}
+
+	// header, chunk name, rest of the bytecode
+	const char* code = m_code.ptr() + chunk->m_code;
+	size_t nameSize = strlen(name) + 1;
+	UTsize size = chunk->m_codeSize + sizeof(size_t) + nameSize;
+
+	m_buffer.resize(size);
+	char* dest = m_buffer.ptr();
+	memcpy(dest, code, GK_LUA_DUMP_HEADER);
+	memcpy(dest + GK_LUA_DUMP_HEADER, &nameSize, sizeof(size_t));
+	memcpy(dest + GK_LUA_DUMP_HEADER + sizeof(size_t), name, nameSize);
+	memcpy(dest + GK_LUA_DUMP_HEADER + sizeof(size_t) + nameSize, code + GK_LUA_DUMP_HEADER, chunk->m_codeSize - GK_LUA_DUMP_HEADER);
+
+	if (luaL_loadbuffer(L, dest, size, name) != 0)
+	{
+		lua_pop(L, 1);
+		++m_misses;
+		return false;
+	}
+
+	++m_hits;
+	return true;
+}
+
+
+void gkLuaCache::addChunk(lua_State* L, const char* text, UTsize len)
+{
+	// a text whose folded hash is taken stays uncached
+	UTuint64 hash = hashText(text, len);
+	if (m_index.find(gkLuaCacheKey(hash)) != UT_NPOS)
+		return;
+
+	m_buffer.clear(true);
+	if (lua_dump(L, gkLuaCacheWriter, &m_buffer) != 0)
+		return;
+
+	// only a top level chunk in the layout this Lua writes is split
+	const char* dump = m_buffer.ptr();
+	UTsize size = m_buffer.size();
+	if (size < GK_LUA_DUMP_HEADER + sizeof(size_t) || memcmp(dump, LUA_SIGNATURE, 4) != 0 || dump[8] != sizeof(size_t))
+		return;
+
+	size_t nameLen;
+	memcpy(&nameLen, dump + GK_LUA_DUMP_HEADER, sizeof(size_t));
+	if (nameLen > size - GK_LUA_DUMP_HEADER - sizeof(size_t))
+		return;
+	UTsize nameSize = sizeof(size_t) + nameLen;
+
+	Chunk chunk;
+	chunk.m_hash     = hash;
+	chunk.m_textSize = (UTuint32)len;
+	chunk.m_codeSize = (UTuint32)(size - nameSize);
+	chunk.m_code     = m_code.size();
+
+	UTsize offs = m_code.size();
+	if (offs + chunk.m_codeSize > m_code.capacity())
+		m_code.reserve(gkMax<UTsize>(offs + chunk.m_codeSize, m_code.capacity() * 2));
+	m_code.resize(offs + chunk.m_codeSize);
+	memcpy(m_code.ptr() + offs, dump, GK_LUA_DUMP_HEADER);
+	memcpy(m_code.ptr() + offs + GK_LUA_DUMP_HEADER, dump + GK_LUA_DUMP_HEADER + nameSize, size - GK_LUA_DUMP_HEADER - nameSize);
+
+	m_index.insert(gkLuaCacheKey(hash), m_chunks.size());
+	m_chunks.push_back(chunk);
+	m_dirty = true;
+}
+
+
+bool gkLuaCache::save(void)
+{
+	if (!m_dirty)
+		return true;
+
+	const UTsize chunks = sizeof(gkLuaCacheHeader);
+	const UTsize code   = chunks + m_chunks.size() * sizeof(Chunk);
+
+	utArray<char> data;
+	data.resize(code + m_code.size());
+
+	gkLuaCacheHeader* hdr = (gkLuaCacheHeader*)data.ptr();
+	memset(hdr, 0, sizeof(gkLuaCacheHeader));
+	hdr->m_magic    = GK_LUA_CACHE_MAGIC;
+	hdr->m_format   = GK_LUA_CACHE_FORMAT;
+	hdr->m_engine   = GK_VERSION;
+	hdr->m_lua      = gkLuaCacheLayout();
+	hdr->m_nrChunks = m_chunks.size();
+	hdr->m_chunks   = chunks;
+	hdr->m_code     = code;
+	hdr->m_codeSize = m_code.size();
+	hdr->m_codeHash = hashText(m_code.ptr(), m_code.size());
+
+	if (!m_chunks.empty())
+		memcpy(data.ptr() + chunks, m_chunks.ptr(), m_chunks.size() * sizeof(Chunk));
+	if (!m_code.empty())
+		memcpy(data.ptr() + code, m_code.ptr(), m_code.size());
+
+	// write aside and swap, so a crash never leaves a truncated cache behind
+	gkString temp = m_cacheFile + ".tmp";
+
+	utFileStream fs;
+	fs.open(temp.c_str(), utStream::SM_WRITE);
+	if (!fs.isOpen())
+	{
+		gkLogMessage("LuaCache: Unable to write " << temp << ".");
+		return false;
+	}
+
+	bool ok = fs.write(data.ptr(), data.size()) == data.size();
+	fs.close();
+
+	remove(m_cacheFile.c_str());
+	if (!ok || rename(temp.c_str(), m_cacheFile.c_str()) != 0)
+	{
+		remove(temp.c_str());
+		gkLogMessage("LuaCache: Unable to write " << m_cacheFile << ".");
+		return false;
+	}
+
+	m_dirty = false;
+	return true;
+}
@@ -0,0 +1,90 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkLuaCache_h_
+#define _gkLuaCache_h_
+
+#include "gkCommon.h"
+
+struct lua_State;
+
+
+// Compiled Lua chunks keyed by a hash of their source text.
+//
+// Chunks are kept as lua_dump bytecode in one file of the cache directory,
+// which is read when the cache is created and rewritten on save when new
+// scripts were compiled. The chunk name is left out of the stored bytecode
+// and put back on load, so scripts with the same text share one entry and
+// still report their own name in errors.
+class gkLuaCache
+{
+public:
+	gkLuaCache(const gkString& cacheDir);
+	~gkLuaCache();
+
+	// Reads the cache file, false when there is none or it is stale.
+	bool load(void);
+
+	// Rewrites the cache file when chunks were added since load.
+	bool save(void);
+
+	// Pushes the cached function for text, false when it has to be compiled.
+	bool loadChunk(lua_State* L, const char* text, UTsize len, const char* name);
+
+	// Stores the function on top of the stack, compiled from text.
+	void addChunk(lua_State* L, const char* text, UTsize len);
+
+	GK_INLINE const gkString& getCacheFile(void) const {return m_cacheFile;}
+	GK_INLINE UTsize          getHits(void) const      {return m_hits;}
+	GK_INLINE UTsize          getMisses(void) const    {return m_misses;}
+
+	static UTuint64 hashText(const char* text, UTsize len);
+
+private:
+
+	struct Chunk
+	{
+		UTuint64 m_hash;
+		UTuint32 m_textSize;
+		UTuint32 m_codeSize;
+		UTuint64 m_code;        // offset in m_code
+	};
+
+	typedef utArray<Chunk>                    Chunks;
+	typedef utHashTable<utIntHashKey, UTsize> ChunkIndex;
+
+	const Chunk* findChunk(UTuint64 hash, UTsize len) const;
+
+	gkString      m_cacheFile;
+	Chunks        m_chunks;
+	ChunkIndex    m_index;      // folded hash to chunk
+	utArray<char> m_code;       // bytecode of all chunks, without the chunk name
+	utArray<char> m_buffer;     // bytecode of the chunk being loaded or dumped
+	bool          m_dirty;
+	UTsize        m_hits, m_misses;
+};
+
+#endif//_gkLuaCache_h_
@@ -0,0 +1,167 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "gkLuaGc.h"
+#include "gkLuaUtils.h"
+#include "gkMathUtils.h"
+#include "LinearMath/btQuickprof.h"
+
+
+// Smallest live size the pause applies to, so tiny heaps do not cycle every frame
+#define GK_LUA_GC_MIN_ESTIMATE 256
+
+// Allocation paid for per collector call, in KB
+#define GK_LUA_GC_STEP_KB 4
+
+// Most the budget grows to while the collector is behind
+#define GK_LUA_GC_MAX_CATCH_UP 8
+
+
+gkLuaGc::gkLuaGc(lua_State* state)
+	:	L(state),
+		m_clock(new btClock()),
+		m_budget(0),
+		m_pause(200),
+		m_estimate(GK_LUA_GC_MIN_ESTIMATE),
+		m_inCycle(false),
+		m_lastHeap(0),
+		m_debt(0),
+		m_catchUp(1),
+		m_steps(0),
+		m_time(0),
+		m_cycles(0)
+{
+}
+
+
+gkLuaGc::~gkLuaGc()
+{
+	delete m_clock;
+}
+
+
+int gkLuaGc::getHeapKb(void) const
+{
+	return lua_gc(L, LUA_GCCOUNT, 0);
+}
+
+
+void gkLuaGc::stop(void)
+{
+	// lua_gc steps and full collections rearm the automatic collector
+	if (m_budget > 0)
+		lua_gc(L, LUA_GCSTOP, 0);
+}
+
+
+void gkLuaGc::setBudget(unsigned long microSeconds)
+{
+	m_budget = microSeconds;
+
+	if (m_budget > 0)
+	{
+		m_estimate = gkMax<int>(getHeapKb(), GK_LUA_GC_MIN_ESTIMATE);
+		m_lastHeap = getHeapKb();
+		stop();
+	}
+	else
+		lua_gc(L, LUA_GCRESTART, 0);
+}
+
+
+void gkLuaGc::update(void)
+{
+	m_steps = 0;
+	m_time = 0;
+
+	if (m_budget == 0)
+		return;
+
+	int heap = getHeapKb();
+	int threshold = m_estimate * m_pause / 100;
+
+	// what the scripts allocated since the last update, less what was freed
+	int allocated = gkMax<int>(heap - m_lastHeap, 0);
+
+	if (!m_inCycle)
+	{
+		if (heap < threshold)
+		{
+			m_lastHeap = heap;
+			return;
+		}
+		m_inCycle = true;
+		m_debt = 0;
+	}
+
+	m_debt += allocated;
+
+	// Far past the pause size the budget doubles every frame, up to a limit,
+	// and drops back once the heap is under control
+	if (heap >= threshold * 2)
+		m_catchUp = gkMin<int>(m_catchUp * 2, GK_LUA_GC_MAX_CATCH_UP);
+	else
+		m_catchUp = 1;
+
+	const unsigned long limit = m_budget * m_catchUp;
+
+	m_clock->reset();
+	do
+	{
+		++m_steps;
+
+		// Work for the allocation, like the automatic collector, and at
+		// least one basic step a frame. lua_gc returns 1 at the end of the cycle.
+		int kb = gkMin<int>(m_debt, GK_LUA_GC_STEP_KB);
+		m_debt -= kb;
+
+		if (lua_gc(L, LUA_GCSTEP, kb) != 0)
+		{
+			m_inCycle = false;
+			m_estimate = gkMax<int>(getHeapKb(), GK_LUA_GC_MIN_ESTIMATE);
+			m_debt = 0;
+			++m_cycles;
+			break;
+		}
+	}
+	while (m_debt > 0 && m_clock->getTimeMicroseconds() < limit);
+
+	m_time = m_clock->getTimeMicroseconds();
+	m_lastHeap = getHeapKb();
+	stop();
+}
+
+
+void gkLuaGc::collect(void)
+{
+	lua_gc(L, LUA_GCCOLLECT, 0);
+
+	m_inCycle = false;
+	m_estimate = gkMax<int>(getHeapKb(), GK_LUA_GC_MIN_ESTIMATE);
+	m_lastHeap = m_estimate;
+	m_debt = 0;
+	stop();
+}
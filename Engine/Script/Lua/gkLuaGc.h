@@ -0,0 +1,95 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkLuaGc_h_
+#define _gkLuaGc_h_
+
+#include "gkCommon.h"
+
+struct lua_State;
+class btClock;
+
+
+// Runs the Lua collector in time slices once per frame.
+//
+// With a budget the automatic collector is stopped, so garbage is no longer
+// collected inside allocations or after every script call. A new cycle starts
+// once the heap grew past the pause size (like lua_gc LUA_GCSETPAUSE). During
+// a cycle update() does the work the automatic collector would have done for
+// the memory allocated since the last frame, within the budget; what does not
+// fit is carried over. When the scripts allocate faster than the budget
+// collects and the heap reaches twice the pause size, the budget doubles each
+// frame up to eight times its size, so no frame collects for longer.
+//
+// The atomic step ending a cycle cannot be split, with small heaps it takes
+// most of a cycle's time; that is why gkUserDefs leaves the budget off.
+class gkLuaGc
+{
+public:
+	gkLuaGc(lua_State* L);
+	~gkLuaGc();
+
+	// Microseconds per update, 0 gives the collector back to Lua
+	void setBudget(unsigned long microSeconds);
+
+	GK_INLINE unsigned long getBudget(void)   const {return m_budget;}
+	GK_INLINE bool          isScheduled(void) const {return m_budget > 0;}
+
+	// Heap growth in percent of the live size before a cycle starts, default 200
+	GK_INLINE void setPause(int percent) {m_pause = percent > 100 ? percent : 100;}
+	GK_INLINE int  getPause(void) const  {return m_pause;}
+
+	// Incremental steps within the budget
+	void update(void);
+
+	// Full collection, regardless of the budget
+	void collect(void);
+
+	int getHeapKb(void) const;
+
+	// Work of the last update
+	GK_INLINE unsigned long getLastSteps(void)        const {return m_steps;}
+	GK_INLINE unsigned long getLastMicroSeconds(void) const {return m_time;}
+	GK_INLINE unsigned long getCycles(void)           const {return m_cycles;}
+
+private:
+
+	void stop(void);
+
+	lua_State*    L;
+	btClock*      m_clock;
+	unsigned long m_budget;
+	int           m_pause;
+	int           m_estimate;   // heap KB after the last cycle
+	bool          m_inCycle;
+	int           m_lastHeap;   // heap KB after the last update
+	int           m_debt;       // KB allocated and not paid for by collector work
+	int           m_catchUp;    // budget multiplier while behind
+
+	unsigned long m_steps, m_time, m_cycles;
+};
+
+#endif//_gkLuaGc_h_
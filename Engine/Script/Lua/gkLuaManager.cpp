@@ -26,7 +26,11 @@
 */
 #include "gkLuaManager.h"
 #include "gkLuaScript.h"
+#include "gkLuaCache.h"
+#include "gkLuaGc.h"
 #include "gkLuaUtils.h"
+#include "gkUserDefs.h"
+#include "gkStats.h"
 #include "gkUtils.h"
 #include "gkTextManager.h"
 #include "gkTextFile.h"
@@ -39,21 +43,70 @@ extern "C" int _OgreKitLua_install(lua_State* L);
 
 gkLuaManager::gkLuaManager()
 	:   gkResourceManager("LuaManager", "Lua"),
-		L(0)
+		L(0),
+		m_cache(0),
+		m_gc(0),
+		m_environments(false)
 {
 	L = lua_open();
 	luaL_openlibs(L);
 
 	_OgreKitLua_install(L);
+
+	m_gc = new gkLuaGc(L);
+
+	gkEngine* engine = gkEngine::getSingletonPtr();
+	if (engine)
+	{
+		gkUserDefs& defs = engine->getUserDefs();
+		if (!defs.luaCachePath.empty())
+		{
+			m_cache = new gkLuaCache(defs.luaCachePath);
+			m_cache->load();
+		}
+
+		m_gc->setBudget(defs.luaGcBudget);
+		m_environments = defs.luaEnvironments;
+	}
 }
 
 
 gkLuaManager::~gkLuaManager()
 {
 	destroyAll();
+
+	if (m_cache)
+	{
+		saveCache();
+		delete m_cache;
+		m_cache = 0;
+	}
+
+	delete m_gc;
 	if (L) lua_close(L);
 }
 
+
+void gkLuaManager::update(void)
+{
+	m_gc->update();
+
+	gkStats* stats = gkStats::getSingletonPtr();
+	if (stats)
+		stats->addScriptGc(m_gc->getLastSteps(), m_gc->getLastMicroSeconds(), m_gc->getHeapKb());
+}
+
+
+void gkLuaManager::saveCache(void)
+{
+	if (!m_cache)
+		return;
+
+	gkLogMessage("LuaCache: " << m_cache->getHits() << " scripts loaded from cache, "
+	             << m_cache->getMisses() << " compiled.");
+	m_cache->save();
+}
+
 gkResource* gkLuaManager::createImpl(const gkResourceName& name, const gkResourceHandle& handle)
 {
 	return new gkLuaScript(this, name, handle);
@@ -78,27 +131,40 @@ void gkLuaManager::notifyResourceDestroyedImpl(gkResource* res)
 
 void gkLuaManager::decompileAll(void)
 {
+	bool collect = false;
+
 	Resources::Iterator iter = m_resources.iterator();
 	while (iter.hasMoreElements())
 	{
 		gkLuaScript* script = (gkLuaScript*)iter.peekNextValue();
-		script->decompile();
+		collect |= script->isCompiled();
+		script->decompile(false);
 		iter.next();
 	}
 
+	if (collect)
+		m_gc->collect();
 }
 
 
 void gkLuaManager::decompileGroup(const gkString& group)
 {
+	bool collect = false;
+
 	Resources::Iterator iter = m_resources.iterator();
 	while (iter.hasMoreElements())
 	{
 		gkLuaScript* script = (gkLuaScript*)iter.peekNextValue();
 		if (script->getGroupName() == group)
-			script->decompile();
+		{
+			collect |= script->isCompiled();
+			script->decompile(false);
+		}
 		iter.next();
 	}
+
+	if (collect)
+		m_gc->collect();
 }
 
 gkLuaScript* gkLuaManager::createFromText(const gkResourceName& name, const gkString& text)
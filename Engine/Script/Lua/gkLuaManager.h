@@ -36,6 +36,8 @@
 #include "Script/Lua/gkLuaScript.h"
 
 struct lua_State;
+class gkLuaCache;
+class gkLuaGc;
 
 
 class gkLuaManager : public gkResourceManager, public utSingleton<gkLuaManager>
@@ -50,6 +52,13 @@ private:
 	lua_State*   L;
 	//ScriptMap   m_scripts;
 
+	// compiled scripts, only set when gkUserDefs::luaCachePath is
+	gkLuaCache*  m_cache;
+
+	gkLuaGc*     m_gc;
+
+	bool         m_environments;
+
 
 public:
 	gkLuaManager();
@@ -61,6 +70,22 @@ public:
 	// access to the lua virtual machine
 	GK_INLINE lua_State* getLua(void) {return L;}
 
+	GK_INLINE gkLuaCache* getCache(void) {return m_cache;}
+
+	GK_INLINE gkLuaGc&    getGc(void)    {return *m_gc;}
+
+	// Scripts compiled afterwards keep their globals in a table of their own
+	// that reads through to _G, see gkUserDefs::luaEnvironments
+	GK_INLINE void setScriptEnvironments(bool v)   {m_environments = v;}
+	GK_INLINE bool hasScriptEnvironments(void) const {return m_environments;}
+
+	// Collects garbage within the frame budget, called once per frame by the engine
+	void update(void);
+
+	// Writes scripts compiled since startup to the cache, done on shutdown as well
+	void saveCache(void);
+
+	// Decompiled scripts are collected together
 	void decompileAll(void);
 	void decompileGroup(const gkString& group);
 
@@ -26,6 +26,8 @@
 */
 #include "gkLuaManager.h"
 #include "gkLuaScript.h"
+#include "gkLuaCache.h"
+#include "gkLuaGc.h"
 #include "gkLuaUtils.h"
 #include "gkDebugScreen.h"
 #include "gkLogger.h"
@@ -58,7 +60,7 @@ void gkLuaScript::setScript(const gkString& text)
 	m_compiled = false;
 }
 
-void gkLuaScript::decompile(void)
+void gkLuaScript::decompile(bool collect)
 {
 	if (!isCompiled())
 		return;
@@ -69,7 +71,9 @@ void gkLuaScript::decompile(void)
 	m_script = -1;
 	m_compiled = false;
 	m_isInvalid = false;
-	lua_gc(L, LUA_GCCOLLECT, 0);
+
+	if (collect)
+		gkLuaManager::getSingleton().getGc().collect();
 }
 
 
@@ -79,10 +83,16 @@ void gkLuaScript::compile(void)
 		return;
 
 	lua_State* L = gkLuaManager::getSingleton().getLua();
+	gkLuaCache* cache = gkLuaManager::getSingleton().getCache();
 	//lua_dumpstack(L);
 	{
 		lua_pushvalue(L, LUA_GLOBALSINDEX);
-		if (luaL_loadbuffer(L, m_text.c_str(), m_text.size() - 1, getName().c_str()) != 0)
+
+		const char* text = m_text.c_str();
+		UTsize len = m_text.empty() ? 0 : m_text.size() - 1;
+
+		bool cached = cache && cache->loadChunk(L, text, len, getName().c_str());
+		if (!cached && luaL_loadbuffer(L, text, len, getName().c_str()) != 0)
 		{
 			gkPrintf("%s\n", lua_tostring(L, -1));
 			dsPrintf("%s\n", lua_tostring(L, -1));
@@ -101,6 +111,20 @@ void gkLuaScript::compile(void)
 			return;
 		}
 
+		if (cache && !cached)
+			cache->addChunk(L, text, len);
+
+		// globals of the script go to its own table, lookups fall back to _G
+		if (gkLuaManager::getSingleton().hasScriptEnvironments())
+		{
+			lua_newtable(L);
+			lua_newtable(L);
+			lua_pushvalue(L, LUA_GLOBALSINDEX);
+			lua_setfield(L, -2, "__index");
+			lua_setmetatable(L, -2);
+			lua_setfenv(L, fnc);
+		}
+
 		lua_pushvalue(L, fnc);
 		m_script = luaL_ref(L, LUA_REGISTRYINDEX);
 		lua_popall(L);
@@ -141,7 +165,52 @@ bool gkLuaScript::execute(void)
 	char* str = (char*)lua_tostring(L, -1);
 	if (str) m_lastRetStrValue = str;
 
-	lua_gc(L, LUA_GCSTEP, 1);
+	// without a frame budget, collect a little after each call
+	if (!gkLuaManager::getSingleton().getGc().isScheduled())
+		lua_gc(L, LUA_GCSTEP, 1);
 	lua_popall(L);
 	return true;
 }
+
+
+
+bool gkLuaScript::import(void)
+{
+	if (!m_compiled)
+		compile();
+
+	if (m_isInvalid)
+		return false;
+
+	lua_State* L = gkLuaManager::getSingleton().getLua();
+
+	// level 1 is the Lua function that called into the engine
+	lua_Debug ar;
+	if (!lua_getstack(L, 1, &ar))
+		return execute();
+
+	lua_getinfo(L, "f", &ar);
+	if (lua_iscfunction(L, -1))
+	{
+		lua_pop(L, 1);
+		return execute();
+	}
+
+	// swap the environments, execute clears the stack so the own one is
+	// kept in the registry meanwhile
+	lua_rawgeti(L, LUA_REGISTRYINDEX, m_script);
+	lua_getfenv(L, -1);
+	int own = luaL_ref(L, LUA_REGISTRYINDEX);
+	lua_getfenv(L, -2);
+	lua_setfenv(L, -2);
+	lua_pop(L, 2);
+
+	bool ok = execute();
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, m_script);
+	lua_rawgeti(L, LUA_REGISTRYINDEX, own);
+	lua_setfenv(L, -2);
+	lua_pop(L, 1);
+	luaL_unref(L, LUA_REGISTRYINDEX, own);
+	return ok;
+}
@@ -32,6 +32,10 @@
 
 struct lua_State;
 
+// Scripts share _G unless gkLuaManager::hasScriptEnvironments is set. Then
+// every script runs in its own environment, a table whose metatable reads
+// through to _G. Globals set by one script are not seen by the others and
+// stay in the environment between executions, _G.name shares a value.
 class gkLuaScript : public gkResource
 {
 protected:
@@ -53,10 +57,16 @@ public:
 
 	void setScript(const gkString& text);
 
-	void decompile(void);
+	// Releases the compiled function, collect runs a full garbage collection
+	// afterwards. gkLuaManager decompiles many scripts and collects once.
+	void decompile(bool collect = true);
 	// compile & run the script
 	bool execute(void);
 
+	// Runs the script in the environment of the Lua function calling the
+	// engine, so its globals reach the caller. Used by OgreKit.import.
+	bool import(void);
+
 	GK_INLINE bool     getReturnBoolValue() { return m_lastRetBoolValue; }
 	GK_INLINE gkString getReturnStrValue()  { return m_lastRetStrValue;  }
 };
@@ -27,30 +27,53 @@
 #include "gkActiveObject.h"
 #include "gkLogger.h"
 
+class gkActiveObject::Drain : public gkJob
+{
+public:
+	Drain(gkActiveObject* obj) : m_obj(obj) {}
+
+	void run() { m_obj->run(); }
+
+private:
+	gkActiveObject* m_obj;
+};
+
 gkActiveObject::gkActiveObject(const gkString& name)
 	: m_name(name),
-	  m_thread(0),
-	  m_queue(name)
+	  m_running(false)
 {
-	m_thread = new gkThread(this);
 }
 
 gkActiveObject::~gkActiveObject()
 {
-	delete m_thread;
+	reset();
+
+	// the running call still references this object
+	if (gkJobSystem* jobs = gkJobSystem::getSingletonPtr())
+		jobs->wait(m_counter);
 }
 
 void gkActiveObject::run()
 {
-	gkPtrRef<gkCall> pCall;
-
-	while (m_queue.pop(pCall))
+	for (;;)
 	{
+		gkPtrRef<gkCall> pCall;
+		{
+			gkCriticalSection::Lock guard(m_cs);
+
+			if (m_queue.empty())
+			{
+				m_running = false;
+				return;
+			}
+
+			pCall = m_queue.front();
+			m_queue.pop_front();
+		}
+
 		try
 		{
 			pCall->run();
-
-			pCall = gkPtrRef<gkCall>(0);
 		}
 		catch (...) // catch all the exceptions.
 		{
@@ -61,27 +84,53 @@ void gkActiveObject::run()
 
 void gkActiveObject::enqueue(gkPtrRef<gkCall> pCall, bool front)
 {
-	m_queue.push(pCall, front);
+	bool start;
+	{
+		gkCriticalSection::Lock guard(m_cs);
+
+		if (front)
+			m_queue.push_front(pCall);
+		else
+			m_queue.push_back(pCall);
+
+		start = !m_running;
+		m_running = true;
+	}
+
+	if (start)
+	{
+		gkJobSystem* jobs = gkJobSystem::getSingletonPtr();
+		if (jobs)
+			jobs->submitBackground(new Drain(this), &m_counter);
+		else
+			run();
+	}
 }
 
 void gkActiveObject::reset()
 {
-	m_queue.reset();
+	gkCriticalSection::Lock guard(m_cs);
+
+	m_queue.clear();
 }
 
 void gkActiveObject::resetButKeepLast()
 {
-	m_queue.resetButKeepLast();
+	gkCriticalSection::Lock guard(m_cs);
+
+	while (m_queue.size() > 1)
+		m_queue.pop_front();
 }
 
 void gkActiveObject::join()
 {
-	m_queue.petitionToFinish();
-
-	m_thread->join();
+	if (gkJobSystem* jobs = gkJobSystem::getSingletonPtr())
+		jobs->wait(m_counter);
 }
 
 bool gkActiveObject::isEmpty() const
 {
-	return m_queue.isEmpty();
+	gkCriticalSection::Lock guard(m_cs);
+
+	return m_queue.empty();
 }
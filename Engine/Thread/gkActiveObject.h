@@ -29,11 +29,15 @@
 
 #include "gkNonCopyable.h"
 #include "gkThread.h"
-#include "gkQueue.h"
-#include "gkSyncObj.h"
+#include "gkCriticalSection.h"
 #include "gkPtrRef.h"
+#include "gkJobSystem.h"
+#include <deque>
 
-class gkActiveObject : public gkCall, gkNonCopyable
+// Runs the enqueued calls one after another as a background job of the
+// gkJobSystem.
+// Without a job system the calls run in place.
+class gkActiveObject : gkNonCopyable
 {
 public:
 
@@ -43,6 +47,7 @@ public:
 
 	void enqueue(gkPtrRef<gkCall> call, bool front = false);
 
+	// runs / waits for all enqueued calls
 	void join();
 
 	void reset();
@@ -55,13 +60,17 @@ public:
 
 private:
 
+	class Drain;
+
 	gkString m_name;
 
-	gkThread* m_thread;
+	std::deque<gkPtrRef<gkCall> > m_queue;
+
+	mutable gkCriticalSection m_cs;
 
-	gkQueue<gkPtrRef<gkCall> > m_queue;
+	bool m_running;
 
-	gkSyncObj m_syncObj;
+	gkJobCounter m_counter;
 };
 
 #endif//_gkActiveObject_h_
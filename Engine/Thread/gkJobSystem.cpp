@@ -0,0 +1,444 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "gkJobSystem.h"
+#include "gkLogger.h"
+
+#ifdef WIN32
+#include <process.h>
+#else
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+
+// Thread local index of the calling thread, -1 for threads the system does not own.
+#ifdef WIN32
+static DWORD gkJobThreadKey = TlsAlloc();
+static void gkSetJobThreadIndex(int index) { TlsSetValue(gkJobThreadKey, (LPVOID)(size_t)(index + 1)); }
+static int  gkGetJobThreadIndex(void)      { return (int)(size_t)TlsGetValue(gkJobThreadKey) - 1; }
+static void gkJobYield(void)               { SwitchToThread(); }
+#else
+static pthread_key_t gkJobThreadKey;
+static int gkJobThreadKeyCreated = pthread_key_create(&gkJobThreadKey, 0);
+static void gkSetJobThreadIndex(int index) { pthread_setspecific(gkJobThreadKey, (void*)(size_t)(index + 1)); }
+static int  gkGetJobThreadIndex(void)      { return (int)(size_t)pthread_getspecific(gkJobThreadKey) - 1; }
+static void gkJobYield(void)               { sched_yield(); }
+#endif
+
+
+
+// Fixed size Chase-Lev deque. The owner pushes & pops at the bottom,
+// other threads steal from the top.
+class gkJobSystem::Deque
+{
+public:
+	Deque() : m_top(0), m_bottom(0)
+	{
+		for (int i = 0; i < MAX_JOBS_PER_THREAD; ++i)
+			m_jobs[i] = 0;
+	}
+
+	bool push(gkJob* job)
+	{
+		int b = m_bottom.get();
+		int t = m_top.get();
+		if (b - t >= MAX_JOBS_PER_THREAD)
+			return false;
+
+		m_jobs[b & MASK] = job;
+		m_bottom.set(b + 1);
+		return true;
+	}
+
+	gkJob* pop(void)
+	{
+		int b = m_bottom.get() - 1;
+		m_bottom.set(b);
+
+		int t = m_top.get();
+		if (t > b)
+		{
+			m_bottom.set(b + 1);
+			return 0;
+		}
+
+		gkJob* job = m_jobs[b & MASK];
+		if (t == b)
+		{
+			// last job, race against thieves
+			if (!m_top.compareAndSwap(t, t + 1))
+				job = 0;
+			m_bottom.set(b + 1);
+		}
+		return job;
+	}
+
+	gkJob* steal(void)
+	{
+		int t = m_top.get();
+		int b = m_bottom.get();
+		if (t >= b)
+			return 0;
+
+		gkJob* job = m_jobs[t & MASK];
+		if (!m_top.compareAndSwap(t, t + 1))
+			return 0;
+		return job;
+	}
+
+private:
+	enum { MASK = MAX_JOBS_PER_THREAD - 1 };
+
+	gkAtomicInt    m_top;
+	gkAtomicInt    m_bottom;
+	gkJob* volatile m_jobs[MAX_JOBS_PER_THREAD];
+};
+
+
+
+class gkJobSystem::Worker : public gkCall
+{
+public:
+	Worker(gkJobSystem* sys, int index) : m_sys(sys), m_index(index), m_thread(0) {}
+	~Worker() { delete m_thread; }
+
+	void start(void) { m_thread = new gkThread(this); }
+	void join(void)  { m_thread->join(); }
+
+	void run(void)   { m_sys->workerLoop(m_index); }
+
+private:
+	gkJobSystem* m_sys;
+	int          m_index;
+	gkThread*    m_thread;
+};
+
+
+
+gkJobCounter::~gkJobCounter()
+{
+	GK_ASSERT(m_waiting.empty() && "jobs still depend on this counter");
+}
+
+
+
+gkJobSystem::gkJobSystem(int nrThreads)
+{
+	if (nrThreads <= 0)
+		nrThreads = getNumHardwareThreads() - 1;
+	if (nrThreads < 1)
+		nrThreads = 1;
+
+	// index zero belongs to the creating thread
+	gkSetJobThreadIndex(0);
+	m_deques.push_back(new Deque());
+
+	int i;
+	for (i = 1; i <= nrThreads; ++i)
+		m_deques.push_back(new Deque());
+
+	m_inBackground.resize(m_deques.size());
+	for (i = 0; i <= nrThreads; ++i)
+		m_inBackground[i] = false;
+
+	for (i = 1; i <= nrThreads; ++i)
+	{
+		Worker* worker = new Worker(this, i);
+		m_threads.push_back(worker);
+		worker->start();
+	}
+}
+
+
+
+gkJobSystem::~gkJobSystem()
+{
+	m_quit.set(1);
+
+	// wakes every worker, idle or not
+	m_wake.signal((int)m_threads.size());
+
+	UTsize i;
+	for (i = 0; i < m_threads.size(); ++i)
+	{
+		m_threads[i]->join();
+		m_threads[i]->release();
+	}
+
+	// drop whatever was not picked up
+	gkJob* job;
+	for (i = 0; i < m_deques.size(); ++i)
+	{
+		while ((job = m_deques[i]->pop()) != 0)
+			job->release();
+		delete m_deques[i];
+	}
+
+	while (!m_injected.empty())
+	{
+		m_injected.front()->release();
+		m_injected.pop_front();
+	}
+
+	while (!m_background.empty())
+	{
+		m_background.front()->release();
+		m_background.pop_front();
+	}
+
+	gkSetJobThreadIndex(-1);
+}
+
+
+
+int gkJobSystem::getNumHardwareThreads(void)
+{
+#ifdef WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	long nr = sysconf(_SC_NPROCESSORS_ONLN);
+	return nr > 0 ? (int)nr : 1;
+#else
+	return 1;
+#endif
+}
+
+
+
+int gkJobSystem::getThreadIndex(void)
+{
+	int index = gkGetJobThreadIndex();
+	return index < (int)m_deques.size() ? index : -1;
+}
+
+
+
+void gkJobSystem::submit(gkJob* job, gkJobCounter* counter, gkJobCounter* dependency)
+{
+	GK_ASSERT(job);
+
+	// work split off a background job stays in the background
+	int index = getThreadIndex();
+	if (index != -1 && m_inBackground[index])
+		job->m_background = true;
+
+	job->m_counter = counter;
+	if (counter)
+		counter->m_value.increment();
+
+	if (dependency)
+	{
+		gkCriticalSection::Lock guard(dependency->m_cs);
+
+		// the last job of the dependency drains the list under the same lock
+		if (!dependency->isDone())
+		{
+			dependency->m_waiting.push_back(job);
+			return;
+		}
+	}
+
+	schedule(job);
+}
+
+
+
+void gkJobSystem::submitBackground(gkJob* job, gkJobCounter* counter)
+{
+	GK_ASSERT(job);
+
+	job->m_background = true;
+	submit(job, counter);
+}
+
+
+
+void gkJobSystem::schedule(gkJob* job)
+{
+	int index = getThreadIndex();
+
+	if (job->m_background)
+	{
+		gkCriticalSection::Lock guard(m_cs);
+		m_background.push_back(job);
+		m_nrBackground.increment();
+	}
+	else if (index != -1)
+	{
+		if (!m_deques[index]->push(job))
+		{
+			execute(job);
+			return;
+		}
+	}
+	else
+	{
+		gkCriticalSection::Lock guard(m_cs);
+		m_injected.push_back(job);
+		m_nrInjected.increment();
+	}
+
+	m_wake.signal();
+}
+
+
+
+gkJob* gkJobSystem::findJob(int index, bool background)
+{
+	gkJob* job = 0;
+
+	if (index != -1 && (job = m_deques[index]->pop()) != 0)
+		return job;
+
+	if (m_nrInjected.get() > 0)
+	{
+		gkCriticalSection::Lock guard(m_cs);
+		if (!m_injected.empty())
+		{
+			job = m_injected.front();
+			m_injected.pop_front();
+			m_nrInjected.decrement();
+			return job;
+		}
+	}
+
+	// spread thieves over the victims
+	int nr = (int)m_deques.size();
+	int start = m_stealStart.increment();
+	for (int i = 0; i < nr; ++i)
+	{
+		int victim = (start + i) % nr;
+		if (victim < 0)
+			victim += nr;
+		if (victim != index && (job = m_deques[victim]->steal()) != 0)
+			return job;
+	}
+
+	if (background && m_nrBackground.get() > 0)
+	{
+		gkCriticalSection::Lock guard(m_cs);
+		if (!m_background.empty())
+		{
+			job = m_background.front();
+			m_background.pop_front();
+			m_nrBackground.decrement();
+			return job;
+		}
+	}
+	return 0;
+}
+
+
+
+void gkJobSystem::execute(gkJob* job)
+{
+	int index = getThreadIndex();
+	bool wasBackground = false;
+	if (index != -1)
+	{
+		wasBackground = m_inBackground[index];
+		m_inBackground[index] = job->m_background;
+	}
+
+	try
+	{
+		job->run();
+	}
+	catch (...) // catch all the exceptions.
+	{
+		gkLogMessage("JobSystem: job error.");
+	}
+
+	if (index != -1)
+		m_inBackground[index] = wasBackground;
+
+	gkJobCounter* counter = job->m_counter;
+	job->release();
+
+	if (counter)
+	{
+		gkJobCounter::Jobs waiting;
+		{
+			// wait() takes the lock before returning, so the counter
+			// stays valid until it is released here
+			gkCriticalSection::Lock guard(counter->m_cs);
+
+			if (counter->m_value.decrement() == 0 && !counter->m_waiting.empty())
+			{
+				waiting = counter->m_waiting;
+				counter->m_waiting.clear();
+			}
+		}
+
+		for (UTsize i = 0; i < waiting.size(); ++i)
+			schedule(waiting[i]);
+	}
+}
+
+
+
+void gkJobSystem::wait(gkJobCounter& counter)
+{
+	int index = getThreadIndex();
+
+	// only background work waits on background jobs
+	bool background = index != -1 && m_inBackground[index];
+
+	while (!counter.isDone())
+	{
+		gkJob* job = findJob(index, background);
+		if (job)
+			execute(job);
+		else
+			gkJobYield();
+	}
+
+	// sync with the thread that finished the last job
+	gkCriticalSection::Lock guard(counter.m_cs);
+}
+
+
+
+void gkJobSystem::workerLoop(int index)
+{
+	gkSetJobThreadIndex(index);
+
+	while (!m_quit.get())
+	{
+		gkJob* job = findJob(index, true);
+		if (job)
+			execute(job);
+		else
+			m_wake.wait(); // one token per scheduled job
+	}
+}
+
+
+
+UT_IMPLEMENT_SINGLETON(gkJobSystem);
@@ -0,0 +1,154 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkJobSystem_h_
+#define _gkJobSystem_h_
+
+#include "gkCommon.h"
+#include "gkThread.h"
+#include "gkAtomic.h"
+#include "gkSyncObj.h"
+#include "gkCriticalSection.h"
+#include "utSingleton.h"
+#include <deque>
+
+class gkJobCounter;
+
+// A unit of work for the job system. Jobs are reference counted like any
+// gkCall, the job system takes over the reference handed to submit() and
+// releases it once run() returned.
+class gkJob : public gkCall
+{
+public:
+	gkJob() : m_counter(0), m_background(false) {}
+	virtual ~gkJob() {}
+
+	GK_INLINE bool isBackground(void) const { return m_background; }
+
+private:
+	friend class gkJobSystem;
+
+	gkJobCounter* m_counter;
+	bool          m_background;
+};
+
+
+// Counts the unfinished jobs submitted with it. A job may also depend on a
+// counter, it is then held back until the counter drops to zero.
+class gkJobCounter : gkNonCopyable
+{
+public:
+	gkJobCounter() {}
+	~gkJobCounter();
+
+	GK_INLINE int  getValue(void) const { return m_value.get(); }
+	GK_INLINE bool isDone(void) const   { return m_value.get() == 0; }
+
+private:
+	friend class gkJobSystem;
+
+	typedef utArray<gkJob*> Jobs;
+
+	gkAtomicInt       m_value;
+	gkCriticalSection m_cs;
+	Jobs              m_waiting;
+};
+
+
+// Work stealing job system. Every thread owns a lock-free deque, jobs submitted
+// from a worker (or from the main thread, the creator of the system) go to the
+// owners deque and idle threads steal from the others. Threads that wait for a
+// counter run jobs meanwhile instead of blocking.
+//
+// Background jobs (long builds, gkActiveObject calls) wait in a queue of their
+// own that only workers take from. A thread waiting for a frame counter never
+// picks one up, jobs submitted from inside a background job are background
+// jobs as well.
+class gkJobSystem : public utSingleton<gkJobSystem>
+{
+public:
+	enum
+	{
+		// capacity of one thread deque, submitting into a full deque runs the job in place
+		MAX_JOBS_PER_THREAD = 4096
+	};
+
+	// nrThreads: worker threads besides the creating thread,
+	// zero uses one thread per extra core (at least one).
+	gkJobSystem(int nrThreads = 0);
+	~gkJobSystem();
+
+	void submit(gkJob* job, gkJobCounter* counter = 0, gkJobCounter* dependency = 0);
+
+	// submits a job which may run for a long time, see above
+	void submitBackground(gkJob* job, gkJobCounter* counter = 0);
+
+	// runs queued jobs until the counter reaches zero
+	void wait(gkJobCounter& counter);
+
+	GK_INLINE int getNumThreads(void) const { return (int)m_threads.size(); }
+
+	static int getNumHardwareThreads(void);
+
+	// index of the calling thread, zero for the creating thread,
+	// -1 for threads the system does not own
+	int getThreadIndex(void);
+
+private:
+
+	class Deque;
+	class Worker;
+
+	typedef utArray<Deque*>  Deques;
+	typedef utArray<Worker*> Workers;
+
+	gkJob* findJob(int index, bool background);
+	void   schedule(gkJob* job);
+	void   execute(gkJob* job);
+	void   workerLoop(int index);
+
+	Deques             m_deques;
+	Workers            m_threads;
+	gkSyncObj          m_wake;
+	gkAtomicInt        m_quit;
+	gkAtomicInt        m_stealStart;
+
+	// jobs submitted from threads the system does not know
+	gkCriticalSection  m_cs;
+	std::deque<gkJob*> m_injected;
+	gkAtomicInt        m_nrInjected;
+
+	// background jobs, under the same lock
+	std::deque<gkJob*> m_background;
+	gkAtomicInt        m_nrBackground;
+
+	// per thread index, whether it runs a background job
+	utArray<bool>      m_inBackground;
+
+	UT_DECLARE_SINGLETON(gkJobSystem);
+};
+
+#endif//_gkJobSystem_h_
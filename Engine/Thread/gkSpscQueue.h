@@ -0,0 +1,132 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkSpscQueue_h_
+#define _gkSpscQueue_h_
+
+#include "gkNonCopyable.h"
+#include "gkAtomic.h"
+#include "gkCommon.h"
+
+// Bounded lock free queue for one producer and one consumer thread.
+// Elements live in preallocated slots that are filled and read in place,
+// so slot memory (strings, buffers) is reused from one push to the next.
+template<typename T>
+class gkSpscQueue : gkNonCopyable
+{
+public:
+
+	// capacity is rounded up to a power of two
+	gkSpscQueue(int capacity = 64);
+
+	~gkSpscQueue();
+
+	// Producer side. Returns the next free slot or 0 when the queue is full,
+	// the slot becomes visible to the consumer with endPush.
+	T* beginPush(void);
+
+	void endPush(void);
+
+	// Consumer side. Returns the oldest slot or 0 when the queue is empty,
+	// it is handed back to the producer with pop.
+	T* front(void);
+
+	void pop(void);
+
+	bool isEmpty(void) const { return size() == 0; }
+
+	int size(void) const { return (m_tail.get() - m_head.get()) & m_wrap; }
+
+	int capacity(void) const { return m_capacity; }
+
+private:
+
+	T*  m_slots;
+	int m_capacity;
+
+	// indices run over twice the capacity, so full and empty differ
+	int m_wrap;
+
+	// written by the consumer
+	gkAtomicInt m_head;
+	char m_pad[64];
+	// written by the producer
+	gkAtomicInt m_tail;
+};
+
+template< typename T >
+gkSpscQueue<T>::gkSpscQueue(int capacity)
+	: m_capacity(1)
+{
+	while (m_capacity < capacity)
+		m_capacity <<= 1;
+
+	m_wrap  = m_capacity * 2 - 1;
+	m_slots = new T[m_capacity];
+}
+
+template< typename T >
+gkSpscQueue<T>::~gkSpscQueue()
+{
+	delete[] m_slots;
+}
+
+template< typename T >
+T* gkSpscQueue<T>::beginPush(void)
+{
+	int tail = m_tail.get();
+
+	if (((tail - m_head.get()) & m_wrap) == m_capacity)
+		return 0;
+
+	return &m_slots[tail & (m_capacity - 1)];
+}
+
+template< typename T >
+void gkSpscQueue<T>::endPush(void)
+{
+	// the barrier of set publishes the slot contents before the index
+	m_tail.set((m_tail.get() + 1) & m_wrap);
+}
+
+template< typename T >
+T* gkSpscQueue<T>::front(void)
+{
+	int head = m_head.get();
+
+	if (head == m_tail.get())
+		return 0;
+
+	return &m_slots[head & (m_capacity - 1)];
+}
+
+template< typename T >
+void gkSpscQueue<T>::pop(void)
+{
+	m_head.set((m_head.get() + 1) & m_wrap);
+}
+
+#endif//_gkSpscQueue_h_
@@ -35,14 +35,13 @@
 
 #include <Foundation/NSLock.h>
 
+// counts the signals like the semaphores of the other platforms
 class gkSyncObjPrivate
 {
-	enum {GK_HAS_DATA, GK_NO_DATA};
-
 public:
-	gkSyncObjPrivate()
+	gkSyncObjPrivate() : m_count(0)
 	{
-m_syncObj = [[NSConditionLock alloc] initWithCondition: GK_NO_DATA];
+		m_syncObj = [[NSCondition alloc] init];
 	}
 	~gkSyncObjPrivate()
 	{
@@ -50,17 +49,26 @@ m_syncObj = [[NSConditionLock alloc] initWithCondition: GK_NO_DATA];
 	}
 	void wait()
 	{
-[m_syncObj lockWhenCondition: GK_HAS_DATA];
-[m_syncObj unlockWithCondition: GK_NO_DATA];
+		[m_syncObj lock];
+		while (m_count == 0)
+			[m_syncObj wait];
+		--m_count;
+		[m_syncObj unlock];
 	}
-	void signal()
+	void signal(int count)
 	{
 		[m_syncObj lock];
-[m_syncObj unlockWithCondition: GK_HAS_DATA];
+		m_count += count;
+		if (count > 1)
+			[m_syncObj broadcast];
+		else
+			[m_syncObj signal];
+		[m_syncObj unlock];
 	}
 
 private:
-	NSConditionLock* m_syncObj;
+	NSCondition* m_syncObj;
+	int          m_count;
 
 };
 
@@ -139,19 +147,33 @@ bool gkSyncObj::wait()
 
 bool gkSyncObj::signal()
 {
+	return signal(1);
+}
+
+bool gkSyncObj::signal(int count)
+{
+	if (count <= 0)
+		return true;
+
 #ifdef OGREKIT_USE_COCOA
 
-	m_syncObj->signal();
+	m_syncObj->signal(count);
 
 #elif WIN32
-	if (!ReleaseSemaphore(m_syncObj, 1, 0))
+	if (!ReleaseSemaphore(m_syncObj, count, 0))
 		return false;
 #elif __APPLE__
-	OSStatus result = MPSignalSemaphore (m_syncObj);
-	GK_ASSERT(result == 0);
+	for (int i = 0; i < count; ++i)
+	{
+		OSStatus result = MPSignalSemaphore (m_syncObj);
+		GK_ASSERT(result == 0);
+	}
 #else
-	int result = sem_post(&m_syncObj);
-	GK_ASSERT(result != -1);
+	for (int i = 0; i < count; ++i)
+	{
+		int result = sem_post(&m_syncObj);
+		GK_ASSERT(result != -1);
+	}
 #endif
 	return true;
 }
@@ -44,6 +44,7 @@ class gkSyncObjPrivate;
 #include <semaphore.h>
 #endif
 
+// Counting semaphore, every signal releases one wait
 class gkSyncObj : gkNonCopyable
 {
 public:
@@ -56,6 +57,9 @@ public:
 
 	bool signal();
 
+	// releases count waits at once
+	bool signal(int count);
+
 private:
 
 #ifdef OGREKIT_USE_COCOA
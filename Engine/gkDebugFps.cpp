@@ -32,6 +32,7 @@
 #include "gkScene.h"
 #include "gkDynamicsWorld.h"
 #include "gkStats.h"
+#include "gkLogicManager.h"
 
 #include "OgreOverlayManager.h"
 #include "OgreOverlayElement.h"
@@ -69,6 +70,10 @@ gkDebugFps::gkDebugFps()
 	m_keys += "DBVT:\n";
 	m_keys += "Bufferswap&LOD:\n";
 	m_keys += "Animations:\n";
+	m_keys += "Sensors:\n";
+	m_keys += "Logic pool:\n";
+	m_keys += "Lua GC:\n";
+	m_keys += "Scenes:\n";
 }
 
 
@@ -174,6 +179,14 @@ void gkDebugFps::draw(void)
 	float dbvt = gkStats::getSingleton().getLastDbvtMicroSeconds() / 1000.0f;
 	float bufswaplod = gkStats::getSingleton().getLastBufSwapLodMicroSeconds() / 1000.0f;
 	float animations = gkStats::getSingleton().getLastAnimationsMicroSeconds() / 1000.0f;
+	unsigned long sensors = gkStats::getSingleton().getLastSensors();
+	unsigned long sensorsEval = gkStats::getSingleton().getLastSensorsEvaluated();
+	utAllocStats bricks = gkLogicManager::getBrickAllocator().getStats();
+	float scriptGc = gkStats::getSingleton().getLastScriptGcMicroSeconds() / 1000.0f;
+	unsigned long scriptGcSteps = gkStats::getSingleton().getLastScriptGcSteps();
+	unsigned long scriptHeap = gkStats::getSingleton().getScriptHeapKb();
+	unsigned long scenes = gkStats::getSingleton().getLastScenes();
+	unsigned long concurrentScenes = gkStats::getSingleton().getLastConcurrentScenes();
 #ifdef OGREKIT_USE_PROCESSMANAGER
 	float process = gkStats::getSingleton().getLastProcessMicroSeconds() / 1000.0f;
 #endif
@@ -220,6 +233,19 @@ void gkDebugFps::draw(void)
 	vals += Ogre::StringConverter::toString(animations, 3, 7, '0', std::ios::fixed) + "ms ";
 	vals += Ogre::StringConverter::toString( int(100 * animations / swap), 3 ) + "%\n";
 
+	vals += Ogre::StringConverter::toString(sensorsEval) + "/";
+	vals += Ogre::StringConverter::toString(sensors) + " evaluated\n";
+
+	vals += Ogre::StringConverter::toString(bricks.used / 1024) + "/";
+	vals += Ogre::StringConverter::toString(bricks.reserved / 1024) + "KB reserved\n";
+
+	vals += Ogre::StringConverter::toString(scriptGc, 3, 7, '0', std::ios::fixed) + "ms ";
+	vals += Ogre::StringConverter::toString(scriptGcSteps) + " steps ";
+	vals += Ogre::StringConverter::toString(scriptHeap) + "KB\n";
+
+	vals += Ogre::StringConverter::toString(concurrentScenes) + "/";
+	vals += Ogre::StringConverter::toString(scenes) + " concurrent\n";
+
 #ifdef OGREKIT_USE_PROCESSMANAGER
 	vals += Ogre::StringConverter::toString(process, 3, 7, '0', std::ios::fixed) + "ms ";
 	vals += Ogre::StringConverter::toString( int(100 * process / swap), 3 ) + "%\n";
@@ -76,6 +76,9 @@ gkDebugScreen::gkDebugScreen() :
 gkDebugScreen::~gkDebugScreen()
 {
 	finalize();
+
+	// lines have to go back to m_lineBuffer before it is destroyed
+	clear();
 }
 
 
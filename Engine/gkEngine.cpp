@@ -53,6 +53,8 @@
 #include "gkAnimationManager.h"
 #include "gkParticleManager.h"
 #include "gkHUDManager.h"
+#include "Thread/gkJobSystem.h"
+#include "gkSceneStages.h"
 
 #ifdef OGREKIT_COMPILE_ENET
 #include "Network/gkNetworkManager.h"
@@ -111,6 +113,7 @@
 gkScalar gkEngine::m_tickRate = ENGINE_TICKS_PER_SECOND;
 
 
+
 class gkOgreEnginePrivate : public Ogre::FrameListener, public gkTickState
 {
 public:
@@ -148,6 +151,10 @@ public:
 	void beginTickImpl(void);
 	void endTickImpl(void);
 
+	void updateScenes(gkScalar delta);
+	void updateScenesParallel(gkScalar delta);
+	void reportSerialScenes(void);
+
 
 	bool frameStarted(const Ogre::FrameEvent& evt);
 	bool frameRenderingQueued(const Ogre::FrameEvent& evt);
@@ -157,6 +164,8 @@ public:
 	gkWindowSystem*             windowsystem;       // current window system
 	gkScene*                    curScene;			// current scene
 	gkSceneArray				scenes;
+	gkSceneStages<gkScene>		sceneStages;
+	utHashTable<utPointerHashKey, const char*> serialReasons; // last logged, per scene
 	gkRenderFactoryPrivate*     plugin_factory;     // static plugin loading
 	Ogre::Root*                 root;
 	gkDebugScreen*              debug;
@@ -252,6 +261,8 @@ void gkEngine::initialize()
 
 	m_private->windowsystem = new gkWindowSystem();
 
+	new gkJobSystem(defs.jobThreads);
+
 	// gk Managers
 	new gkSceneManager();
 #ifdef OGREKIT_COMPILE_ENET
@@ -435,6 +446,7 @@ void gkEngine::finalize()
 
 
 	delete gkStats::getSingletonPtr();
+	delete gkJobSystem::getSingletonPtr();
 	delete m_private->debugFps;
 	delete m_private->debugPage;
 	delete m_private->debug;
@@ -590,6 +602,7 @@ void gkEngine::unregisterActiveScene(gkScene* scene)
 {
 	GK_ASSERT(m_private && scene);
 	m_private->scenes.erase(m_private->scenes.find(scene));
+	m_private->serialReasons.remove(scene);
 	if (m_private->curScene == scene)
 	{
 		if (m_private->scenes.size()>0)
@@ -714,6 +727,11 @@ bool gkOgreEnginePrivate::frameRenderingQueued(const Ogre::FrameEvent& evt)
 	if (!scenes.empty())
 		tick();
 
+#ifdef OGREKIT_USE_LUA
+	// the GPU is busy with the queued frame, collect script garbage meanwhile
+	gkLuaManager::getSingleton().update();
+#endif
+
 	// restart the clock to mesure time for swapping buffer and updatind scenemanager LOD
 	gkStats::getSingleton().startClock();
 
@@ -763,24 +781,35 @@ void gkOgreEnginePrivate::tickImpl(gkScalar dt)
 	// Proccess one full game tick
 	GK_ASSERT(windowsystem && !scenes.empty() && engine);
 
+	// recycle the messages of two ticks ago
+	gkMessageManager::getSingleton().nextTick();
 
 	// dispatch inputs
 	windowsystem->dispatch();
 
+#ifdef OGREKIT_COMPILE_ENET
+	// messages received since the last tick, logic sees them this tick
+	gkNetworkManager::getSingleton().dispatchNetworkMessages();
+#endif
+
 	// update main scene
-	gkSceneArray::Iterator siter1(scenes);
-	while (siter1.hasMoreElements())
-	{
-		gkScene* scene = siter1.getNext();
-		curScene = scene;
-		scene->update(dt);
-	}
+	if (engine->getUserDefs().parallelScenes && scenes.size() > 1)
+		updateScenesParallel(dt);
+	else
+		updateScenes(dt);
 
 	// update callbacks
 	utArrayIterator<gkEngine::Listeners> iter(engine->m_listeners);
 	while (iter.hasMoreElements())
 		iter.getNext()->tick(dt);
 
+#ifdef OGREKIT_COMPILE_ENET
+	// replicate this tick's state, then send the messages of this tick in one packet
+	gkNetworkManager& network = gkNetworkManager::getSingleton();
+	network.updateReplication(dt);
+	network.flushNetworkInstance();
+#endif
+
 	gkSceneArray::Iterator siter2(scenes);
 	while (siter2.hasMoreElements())
 		siter2.getNext()->applyConstraints();
@@ -793,4 +822,64 @@ void gkOgreEnginePrivate::tickImpl(gkScalar dt)
 
 
 
+void gkOgreEnginePrivate::updateScenes(gkScalar dt)
+{
+	gkSceneArray::Iterator iter(scenes);
+	while (iter.hasMoreElements())
+	{
+		gkScene* scene = iter.getNext();
+		curScene = scene;
+		scene->update(dt);
+	}
+
+	gkStats::getSingleton().addSceneUpdates(0, scenes.size());
+}
+
+
+
+void gkOgreEnginePrivate::updateScenesParallel(gkScalar dt)
+{
+	// gkSceneStages documents the order, it matches updateScenes for scenes
+	// that do not touch each other's objects
+	sceneStages.update(scenes, dt, &curScene);
+
+	gkStats::getSingleton().addSceneUpdates(sceneStages.getConcurrentCount(), scenes.size());
+	reportSerialScenes();
+}
+
+
+
+void gkOgreEnginePrivate::reportSerialScenes(void)
+{
+	// logs when a scene falls back to the main thread, and when it stops to
+	for (UTsize i = 0; i < scenes.size(); ++i)
+	{
+		gkScene* scene = scenes[i];
+		if (!scene->isInstanced())
+			continue;
+
+		const char* reason = scene->_getSerialReason();
+
+		UTsize pos = serialReasons.find(scene);
+		const char* logged = pos != UT_NPOS ? serialReasons.at(pos) : 0;
+		if (reason == logged)
+			continue;
+
+		if (reason)
+		{
+			gkLogMessage("Engine: Scene '" << scene->getName() << "' is updated on the main thread, " << reason << ".");
+		}
+		else
+		{
+			gkLogMessage("Engine: Scene '" << scene->getName() << "' is updated concurrently.");
+		}
+
+		if (pos != UT_NPOS)
+			serialReasons.remove(scene);
+		serialReasons.insert(scene, reason);
+	}
+}
+
+
+
 UT_IMPLEMENT_SINGLETON(gkEngine);
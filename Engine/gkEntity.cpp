@@ -59,6 +59,9 @@ void gkEntity::createInstanceImpl(void)
 
 	GK_ASSERT(!m_entity);
 
+	// material tags follow the mesh
+	invalidateSensorMasks();
+
 
 	if (!m_entityProps->m_mesh)
 		return;
@@ -49,11 +49,16 @@
 #include "gkRigidBody.h"
 #include "gkCharacter.h"
 #include "gkDynamicsWorld.h"
+#include "gkSensorFilter.h"
 #include "gkMesh.h"
 #include "gkVariable.h"
 
 #include "gkAnimationManager.h"
 
+#ifdef OGREKIT_COMPILE_ENET
+#include "Network/gkNetworkManager.h"
+#endif
+
 //using namespace Ogre;
 
 
@@ -71,15 +76,27 @@ gkGameObject::gkGameObject(gkInstancedManager* creator, const gkResourceName& na
 	     m_flags(0),
 	     m_actionBlender(0),
 	     m_cloneToScene(0),
-	     m_boneTransform(0)
+	     m_boneTransform(0),
+	     m_transformDirty(0),
+	     m_transformIndex(UT_NPOS)
 {
 	m_life.tick = 0;
 	m_life.timeToLive = 0;
+
+	m_sensorMasks.props = m_sensorMasks.firstMaterial = m_sensorMasks.materials = 0;
+	m_sensorMasks.generation = 0;
 }
 
 
 gkGameObject::~gkGameObject()
 {
+#ifdef OGREKIT_COMPILE_ENET
+	// leave the replicated objects, before the variables they read go
+	gkNetworkManager* network = gkNetworkManager::getSingletonPtr();
+	if (network && network->getReplicator())
+		network->getReplicator()->removeObject(this);
+#endif
+
 	clearVariables();
 
 
@@ -297,6 +314,12 @@ void gkGameObject::destroyInstanceImpl(void)
 
 	m_scene->removeAnimationUpdate(this);
 
+	if (m_transformDirty)
+	{
+		m_scene->removeTransformUpdate(this);
+		m_transformDirty = 0;
+	}
+
 	// Reset variables
 	utHashTableIterator<VariableMap> iter(m_variables);
 	while (iter.hasMoreElements())
@@ -336,6 +359,35 @@ bool gkGameObject::hasSensorMaterial(const gkString& name, bool onlyFirst)
 
 
 
+const gkGameObject::SensorMasks& gkGameObject::getSensorMasks(void)
+{
+	const UTuint32 generation = gkSensorFilter::getGeneration();
+	if (m_sensorMasks.generation == generation)
+		return m_sensorMasks;
+
+	m_sensorMasks.props = m_sensorMasks.firstMaterial = m_sensorMasks.materials = 0;
+
+	utHashTableIterator<VariableMap> iter(m_variables);
+	while (iter.hasMoreElements())
+		m_sensorMasks.props |= gkSensorFilter::find(iter.getNext().second->getName());
+
+	gkEntity* ent = getEntity();
+	gkMesh* me = ent ? ent->getEntityProperties().m_mesh : 0;
+	if (me)
+	{
+		m_sensorMasks.firstMaterial = gkSensorFilter::find(me->getFirstMaterial().m_name);
+
+		gkMesh::SubMeshIterator subs = me->getSubMeshIterator();
+		while (subs.hasMoreElements())
+			m_sensorMasks.materials |= gkSensorFilter::find(subs.getNext()->getMaterialName());
+	}
+
+	m_sensorMasks.generation = generation;
+	return m_sensorMasks;
+}
+
+
+
 Ogre::MovableObject* gkGameObject::getMovable(void)
 {
 	if (!isInstanced())
@@ -465,6 +517,9 @@ gkEuler gkGameObject::getWorldRotation(void)
 
 void gkGameObject::notifyUpdate(void)
 {
+	// covers a deferred notification still pending in gkScene::syncTransforms
+	m_transformDirty &= ~TD_SYNC_NOTIFY;
+
 	if (m_scene)
 		m_scene->notifyObjectUpdate(this);
 
@@ -479,6 +534,82 @@ void gkGameObject::notifyUpdate(void)
 
 
 
+void gkGameObject::markTransformDirty(int flags)
+{
+	if (m_scene && m_scene->isTransformDeferred())
+	{
+		if (!(m_transformDirty & TD_ALL))
+			m_scene->pushTransformUpdate(this);
+
+		m_transformDirty |= flags;
+		return;
+	}
+
+	if (flags & TD_PHYSICS)
+		updatePhysicsTransform();
+	if (flags & TD_NOTIFY)
+		notifyUpdate();
+}
+
+
+
+void gkGameObject::_beginTransformSync(void)
+{
+	int flags = m_transformDirty;
+
+	// sync flags left over when the object was queued again before its
+	// _endTransformSync, see gkScene::pushTransformUpdate
+	m_transformDirty = 0;
+	if (flags & (TD_NOTIFY | TD_SYNC_NOTIFY))
+		m_transformDirty |= TD_SYNC_NOTIFY;
+	if (flags & (TD_PHYSICS | TD_SYNC_PHYSICS))
+		m_transformDirty |= TD_SYNC_PHYSICS;
+}
+
+
+
+void gkGameObject::_endTransformSync(void)
+{
+	if (m_transformDirty & TD_SYNC_PHYSICS)
+	{
+		m_transformDirty &= ~TD_SYNC_PHYSICS;
+		updatePhysicsTransform();
+	}
+
+	if (m_transformDirty & TD_SYNC_NOTIFY)
+	{
+		// a parent synced in the same pass notifies its whole sub tree,
+		// so only the top most dirty object of a hierarchy notifies
+		gkGameObject* par = m_parent;
+		while (par && !(par->m_transformDirty & TD_SYNC_NOTIFY))
+			par = par->m_parent;
+
+		if (!par)
+			notifyUpdate();
+	}
+}
+
+
+
+void gkGameObject::updatePhysicsTransform(void)
+{
+	// update the rigid body state
+	if (m_rigidBody != 0)
+	{
+		m_rigidBody->updateTransform();
+	}
+	else if (m_character)
+	{
+		m_character->updateTransform();
+	}
+	else if (m_ghost)
+	{
+		m_ghost->updateTransform();
+	}
+}
+
+
+
 
 void gkGameObject::applyTransformState(const gkTransformState& newstate, const gkScalar& weight)
 {
@@ -506,19 +637,7 @@ void gkGameObject::applyTransformState(const gkTransformState& newstate, const g
 		m_node->setScale(state.scl);
 	//	m_node->needUpdate(true);
 
-		if (m_rigidBody)
-		{
-			m_rigidBody->setTransformState(state);
-		}
-		else if (m_character)
-		{
-			m_character->setTransformState(state);
-		}
-		else if (m_ghost){
-			m_ghost->setTransformState(state);
-		}
-
-		notifyUpdate();
+		markTransformDirty();
 	}
 }
 
@@ -545,7 +664,6 @@ void gkGameObject::setTransform(const gkTransformState& v)
 		return;
 
 	applyTransformState(v);
-	notifyUpdate();
 }
 
 
@@ -559,20 +677,7 @@ void gkGameObject::setPosition(const gkVector3& v)
 	if (m_node != 0)
 	{
 		m_node->setPosition(v);
-		notifyUpdate();
-
-		// update the rigid body state
-		if (m_rigidBody != 0)
-		{
-			m_rigidBody->updateTransform();
-		}
-		else if (m_character)
-		{
-			m_character->updateTransform();
-		}
-		else if (m_ghost) {
-			m_ghost->updateTransform();
-		}
+		markTransformDirty();
 	}
 }
 
@@ -586,7 +691,7 @@ void gkGameObject::setScale(const gkVector3& v)
 	if (m_node != 0)
 	{
 		m_node->setScale(v);
-		notifyUpdate();
+		markTransformDirty(TD_NOTIFY);
 	}
 }
 
@@ -601,19 +706,7 @@ void gkGameObject::setOrientation(const gkQuaternion& q)
 	if (m_node != 0)
 	{
 		m_node->setOrientation(q);
-		notifyUpdate();
-
-		// update the rigid body state
-		if (m_rigidBody != 0)
-		{
-			m_rigidBody->updateTransform();
-		}
-		else if (m_character)
-		{
-			m_character->updateTransform();
-		} else if (m_ghost) {
-			m_ghost->updateTransform();
-		}
+		markTransformDirty();
 	}
 }
 
@@ -628,21 +721,7 @@ void gkGameObject::setOrientation(const gkEuler& v)
 	{
 		gkQuaternion q = v.toQuaternion();
 		m_node->setOrientation(q);
-		notifyUpdate();
-
-		// update the rigid body state
-		if (m_rigidBody != 0)
-		{
-			m_rigidBody->updateTransform();
-		}
-		else if (m_character)
-		{
-			m_character->updateTransform();
-		}
-		else if (m_ghost)
-		{
-			m_ghost->updateTransform();
-		}
+		markTransformDirty();
 	}
 }
 
@@ -667,21 +746,7 @@ void gkGameObject::rotate(const gkQuaternion& dq, int tspace)
 	if (m_node != 0)
 	{
 		m_node->rotate(dq, (Ogre::Node::TransformSpace)tspace);
-		notifyUpdate();
-
-		// update the rigid body state
-		if (m_rigidBody != 0)
-		{
-			m_rigidBody->updateTransform();
-		}
-		else if (m_character)
-		{
-			m_character->updateTransform();
-		}
-		else if (m_ghost)
-		{
-			m_ghost->updateTransform();
-		}
+		markTransformDirty();
 	}
 }
 
@@ -695,21 +760,7 @@ void gkGameObject::yaw(const gkRadian& v, int tspace)
 	if (m_node != 0)
 	{
 		m_node->yaw(v, (Ogre::Node::TransformSpace)tspace);
-		notifyUpdate();
-
-		// update the rigid body state
-		if (m_rigidBody != 0)
-		{
-			m_rigidBody->updateTransform();
-		}
-		else if (m_character)
-		{
-			m_character->updateTransform();
-		}
-		else if (m_ghost)
-		{
-			m_ghost->updateTransform();
-		}
+		markTransformDirty();
 	}
 }
 
@@ -723,21 +774,7 @@ void gkGameObject::pitch(const gkRadian& v, int tspace )
 	if (m_node != 0)
 	{
 		m_node->pitch(v, (Ogre::Node::TransformSpace)tspace);
-		notifyUpdate();
-
-		// update the rigid body state
-		if (m_rigidBody != 0)
-		{
-			m_rigidBody->updateTransform();
-		}
-		else if (m_character)
-		{
-			m_character->updateTransform();
-		}
-		else if (m_ghost)
-		{
-					m_ghost->updateTransform();
-		}
+		markTransformDirty();
 	}
 }
 
@@ -751,21 +788,7 @@ void gkGameObject::roll(const gkRadian& v, int tspace)
 	if (m_node != 0)
 	{
 		m_node->roll(v, (Ogre::Node::TransformSpace)tspace);
-		notifyUpdate();
-
-		// update the rigid body state
-		if (m_rigidBody != 0)
-		{
-			m_rigidBody->updateTransform();
-		}
-		else if (m_character)
-		{
-			m_character->updateTransform();
-		}
-		else if (m_ghost)
-		{
-					m_ghost->updateTransform();
-		}
+		markTransformDirty();
 	}
 }
 
@@ -779,21 +802,7 @@ void gkGameObject::translate(const gkVector3& dloc, int tspace)
 	if (m_node != 0)
 	{
 		m_node->translate(dloc, (Ogre::Node::TransformSpace)tspace);
-		notifyUpdate();
-
-		// update the rigid body state
-		if (m_rigidBody != 0)
-		{
-			m_rigidBody->updateTransform();
-		}
-		else if (m_character)
-		{
-			m_character->updateTransform();
-		}
-		else if (m_ghost)
-		{
-					m_ghost->updateTransform();
-		}
+		markTransformDirty();
 	}
 }
 
@@ -807,7 +816,7 @@ void gkGameObject::scale(const gkVector3& dscale)
 	if (m_node != 0)
 	{
 		m_node->scale(dscale);
-		notifyUpdate();
+		markTransformDirty(TD_NOTIFY);
 	}
 }
 
@@ -915,6 +924,7 @@ void gkGameObject::clearVariables(void)
 	}
 
 	m_variables.clear();
+	invalidateSensorMasks();
 }
 
 
@@ -935,6 +945,7 @@ gkVariable* gkGameObject::createVariable(const gkString& name, bool debug)
 
 	gkVariable* prop = new gkVariable(name, debug);
 	m_variables.insert(findName, prop);
+	invalidateSensorMasks();
 
 
 	// add to the debugging interface
@@ -995,6 +1006,7 @@ void gkGameObject::removeVariable(const gkString& name)
             if (v->isDebug())
                     eng.removeDebugProperty(v);
             m_variables.remove(name);
+            invalidateSensorMasks();
        }
 }
 
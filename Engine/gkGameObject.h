@@ -52,6 +52,15 @@ public:
 		int timeToLive;
 	};
 
+	// Sensor filter tags this object carries, see gkSensorFilter
+	struct SensorMasks
+	{
+		UTuint64 props;
+		UTuint64 firstMaterial;
+		UTuint64 materials;
+		UTuint32 generation;
+	};
+
 	class Notifier
 	{
 	public:
@@ -93,6 +102,10 @@ public:
 
 	bool hasSensorMaterial(const gkString& name, bool onlyFirst = true);
 
+	// rebuilt when tags were added or the variables changed
+	const SensorMasks&  getSensorMasks(void);
+	GK_INLINE void      invalidateSensorMasks(void) {m_sensorMasks.generation = 0;}
+
 	// subtype access
 	GK_INLINE gkEntity*         getEntity(void)         {return m_type == GK_ENTITY    ? (gkEntity*)this : 0; }
 	GK_INLINE gkCamera*         getCamera(void)         {return m_type == GK_CAMERA    ? (gkCamera*)this : 0; }
@@ -120,6 +133,30 @@ public:
 	void notifyUpdate(void);
 
 
+	enum TransformDirty
+	{
+		TD_NOTIFY       = (1 << 0), // needs notifyUpdate
+		TD_PHYSICS      = (1 << 1), // the attached body has to follow the node
+		TD_ALL          = TD_NOTIFY | TD_PHYSICS,
+
+		// set while gkScene::syncTransforms handles the object
+		TD_SYNC_NOTIFY  = (1 << 2),
+		TD_SYNC_PHYSICS = (1 << 3),
+	};
+
+	// Records a transform change written to the node. In a running scene the
+	// body update and notifyUpdate are deferred to gkScene::syncTransforms,
+	// otherwise they happen at once.
+	void markTransformDirty(int flags = TD_ALL);
+	GK_INLINE bool isTransformDirty(void) {return (m_transformDirty & TD_ALL) != 0;}
+
+	void _beginTransformSync(void);
+	void _endTransformSync(void);
+
+	GK_INLINE UTsize _getTransformIndex(void) const {return m_transformIndex;}
+	GK_INLINE void   _setTransformIndex(UTsize v)   {m_transformIndex = v;}
+
+
 	GK_INLINE LifeSpan& getLifeSpan(void)               {return m_life;}
 	GK_INLINE void      setLifeSpan(const LifeSpan& v)  {m_life = v;}
 
@@ -354,6 +391,7 @@ protected:
 	bool                        m_isClone;
 	int                         m_flags;
 	LifeSpan                    m_life;
+	SensorMasks                 m_sensorMasks;
 
 
 	gkAnimationBlender*         m_actionBlender;
@@ -373,11 +411,19 @@ protected:
 
 	void sendNotification(const Notifier::Event& e);
 
+	void updatePhysicsTransform(void);
+
 private:
 
 	NavMeshData m_navMeshData;
 	// this is used during clone-process to a specified scene
 	gkScene* m_cloneToScene;
+
+	// TransformDirty flags
+	int m_transformDirty;
+
+	// slot in the scene's transform updates, UT_NPOS when not queued
+	UTsize m_transformIndex;
 };
 
 #endif//_gkGameObject_h_
@@ -27,6 +27,9 @@
 
 #include "gkMessageManager.h"
 
+// Messages per arena chunk
+#define GK_MESSAGE_CHUNK 64
+
 
 gkMessageManager::Message& gkMessageManager::Message::operator = (const Message& m)
 {
@@ -34,58 +37,296 @@ gkMessageManager::Message& gkMessageManager::Message::operator = (const Message&
 	m_to = m.m_to;
 	m_subject = m.m_subject;
 	m_body = m.m_body;
+	m_fromId = m.m_fromId;
+	m_toId = m.m_toId;
+	m_subjectId = m.m_subjectId;
 	return *this;
 }
 
 
+static gkMessageManager::Id gkInternFilter(const gkString& filter)
+{
+	if (filter.empty())
+		return 0;
+
+	return gkMessageManager::getSingleton().intern(filter);
+}
+
+
+gkMessageManager::GenericMessageListener::GenericMessageListener(const gkString& fromfilter, const gkString& tofilter, const gkString& subjectfilter)
+	:    m_fromFilter(fromfilter), m_toFilter(tofilter), m_subjectFilter(subjectfilter),
+	     m_fromId(gkInternFilter(fromfilter)), m_toId(gkInternFilter(tofilter)), m_subjectId(gkInternFilter(subjectfilter)),
+	     m_acceptEmptyTo(false), m_expiring(0), m_copied(0)
+{
+}
+
+
+void gkMessageManager::GenericMessageListener::setFromFilter(const gkString& from)
+{
+	m_fromFilter = from;
+	m_fromId = gkInternFilter(from);
+}
+
+
+void gkMessageManager::GenericMessageListener::setToFilter(const gkString& to)
+{
+	m_toFilter = to;
+	m_toId = gkInternFilter(to);
+}
+
+
+void gkMessageManager::GenericMessageListener::setSubjectFilter(const gkString& subject)
+{
+	gkMessageManager* mgr = gkMessageManager::getSingletonPtr();
+	bool registered = mgr && mgr->removeListener(this);
+
+	m_subjectFilter = subject;
+	m_subjectId = gkInternFilter(subject);
+
+	if (registered)
+		mgr->addListener(this);
+}
+
+
+// A filter that could not be interned compares the strings
+static bool gkFilterMatches(gkMessageManager::Id filterId, const gkString& filter, gkMessageManager::Id id, const gkString& str)
+{
+	if (filterId == gkMessageManager::UNKNOWN_ID)
+		return filter == str;
+	return filterId == 0 || filterId == id;
+}
+
+
+gkMessageManager::Id gkMessageManager::GenericMessageListener::getSubscription(void) const
+{
+	return m_subjectId != UNKNOWN_ID ? m_subjectId : 0;
+}
+
+
 void gkMessageManager::GenericMessageListener::handleMessage(gkMessageManager::Message* message)
 {
-	if (!m_fromFilter.empty() && m_fromFilter.compare(message->m_from) != 0) return;
-	if ((!m_toFilter.empty() && m_toFilter.compare(message->m_to) != 0)
-			&& (m_acceptEmptyTo && !message->m_to.empty())) return;
-	if (!m_subjectFilter.empty() && m_subjectFilter.compare(message->m_subject) != 0) return;
+	if (!gkFilterMatches(m_fromId, m_fromFilter, message->m_fromId, message->m_from)) return;
+	if (!gkFilterMatches(m_toId, m_toFilter, message->m_toId, message->m_to) && !(m_acceptEmptyTo && message->m_toId == 0)) return;
+	if (!gkFilterMatches(m_subjectId, m_subjectFilter, message->m_subjectId, message->m_subject)) return;
+
+	m_messages.push_back(message);
+}
+
+
+gkMessageManager::GenericMessageListener::~GenericMessageListener()
+{
+	emptyMessages();
+	deleteReleased();
+}
+
+
+void gkMessageManager::GenericMessageListener::expireMessages(void)
+{
+	deleteReleased();
 
-	Message m = *message;
+	// Not taken yet, their arena is about to be recycled. Usually there are
+	// none, the message sensor empties the listener on every query.
+	for (UTsize i = m_copied; i < m_expiring; ++i)
+		m_messages[i] = new Message(*m_messages[i]);
 
-	m_messages.push_back(m);
+	m_copied = m_expiring;
+	m_expiring = m_messages.size();
+}
+
+
+void gkMessageManager::GenericMessageListener::emptyMessages(void)
+{
+	for (UTsize i = 0; i < m_copied; ++i)
+		m_released.push_back(const_cast<Message*>(m_messages[i]));
+
+	m_messages.clear(true);
+	m_expiring = 0;
+	m_copied = 0;
+}
+
+
+void gkMessageManager::GenericMessageListener::deleteReleased(void)
+{
+	for (UTsize i = 0; i < m_released.size(); ++i)
+		delete m_released[i];
+	m_released.clear(true);
 }
 
 
 gkMessageManager::gkMessageManager()
+	:    m_tick(0)
 {
+	// id 0 is the empty string
+	intern("");
+}
 
+
+gkMessageManager::~gkMessageManager()
+{
+	for (int a = 0; a < 2; ++a)
+	{
+		for (UTsize i = 0; i < m_arenas[a].m_chunks.size(); ++i)
+			delete []m_arenas[a].m_chunks[i];
+	}
+
+	for (UTsize i = 0; i < m_strings.size(); ++i)
+		delete m_strings[i];
+}
+
+
+gkMessageManager::Id gkMessageManager::intern(const gkString& str)
+{
+	Id id = find(str);
+	if (id != UNKNOWN_ID)
+		return id;
+
+	UTsize pos = m_ids.find(str.c_str());
+	if (pos != UT_NPOS)
+	{
+		// same hash as an interned string, filters could not tell them apart
+		return UNKNOWN_ID;
+	}
+
+	gkString* stored = new gkString(str);
+	id = (Id)m_strings.size();
+	m_strings.push_back(stored);
+	m_ids.insert(stored->c_str(), id);
+	return id;
+}
+
+
+gkMessageManager::Id gkMessageManager::find(const gkString& str) const
+{
+	UTsize pos = m_ids.find(str.c_str());
+	if (pos == UT_NPOS)
+		return UNKNOWN_ID;
+
+	Id id = m_ids.at(pos);
+	return *m_strings[id] == str ? id : UNKNOWN_ID;
 }
 
 
 void gkMessageManager::addListener(MessageListener* listener)
 {
-	if ( m_listeners.find(listener) == UT_NPOS)
-		m_listeners.push_back(listener);
+	if (m_listeners.find(listener) != UT_NPOS)
+		return;
+
+	m_listeners.push_back(listener);
+
+	Id subject = listener->getSubscription();
+	if (subject == 0)
+	{
+		m_anySubject.push_back(listener);
+		return;
+	}
+
+	Listeners* list = m_subjects.get(subject);
+	if (!list)
+	{
+		m_subjects.insert(subject, Listeners());
+		list = m_subjects.get(subject);
+	}
+
+	list->push_back(listener);
 }
 
 
-void gkMessageManager::removeListener(MessageListener* listener)
+bool gkMessageManager::removeListener(MessageListener* listener)
 {
-	m_listeners.erase(listener);
+	UTsize pos = m_listeners.find(listener);
+	if (pos == UT_NPOS)
+		return false;
+
+	m_listeners.erase(pos);
+
+	// filed under the subject it was added with, setSubjectFilter removes
+	// the listener before changing it
+	Id subject = listener->getSubscription();
+	Listeners* list = subject != 0 ? m_subjects.get(subject) : &m_anySubject;
+	if (list)
+		list->erase(listener);
+
+	return true;
 }
 
 
-void gkMessageManager::sendMessage(gkString from, gkString to, gkString subject, gkString body)
+gkMessageManager::Message* gkMessageManager::allocMessage(void)
 {
-	Message* m = new Message();
+	Arena& arena = m_arenas[m_tick & 1];
+
+	UTsize chunk = arena.m_count / GK_MESSAGE_CHUNK;
+	if (chunk >= arena.m_chunks.size())
+		arena.m_chunks.push_back(new Message[GK_MESSAGE_CHUNK]);
+
+	return &arena.m_chunks[chunk][arena.m_count++ % GK_MESSAGE_CHUNK];
+}
+
+
+void gkMessageManager::deliver(Listeners& listeners, Message* message)
+{
+	// by index, a listener may add or remove listeners
+	for (UTsize i = 0; i < listeners.size(); ++i)
+		listeners[i]->handleMessage(message);
+}
+
+
+void gkMessageManager::sendMessage(const gkString& from, const gkString& to, const gkString& subject, const gkString& body)
+{
+	// Strings nobody filters on are not interned, they can only match empty filters
+	Message* m = allocMessage();
 	m->m_from = from;
 	m->m_to = to;
 	m->m_subject = subject;
 	m->m_body = body;
+	m->m_fromId = find(from);
+	m->m_toId = find(to);
+	m->m_subjectId = find(subject);
+
+	if (m->m_subjectId != UNKNOWN_ID && m->m_subjectId != 0)
+	{
+		Listeners* list = m_subjects.get(m->m_subjectId);
+		if (list)
+			deliver(*list, m);
+	}
+
+	deliver(m_anySubject, m);
+}
+
+
+void gkMessageManager::sendMessage(Id from, Id to, Id subject, const gkString& body)
+{
+	GK_ASSERT(from < m_strings.size() && to < m_strings.size() && subject < m_strings.size());
+
+	Message* m = allocMessage();
+	m->m_from = *m_strings[from];
+	m->m_to = *m_strings[to];
+	m->m_subject = *m_strings[subject];
+	m->m_body = body;
+	m->m_fromId = from;
+	m->m_toId = to;
+	m->m_subjectId = subject;
 
-	utArrayIterator<utArray<MessageListener*> > iter(m_listeners);
-	while (iter.hasMoreElements())
+	if (subject != 0)
 	{
-		iter.peekNext()->handleMessage(m);
-		iter.getNext();
+		Listeners* list = m_subjects.get(subject);
+		if (list)
+			deliver(*list, m);
 	}
 
-	delete m;
+	deliver(m_anySubject, m);
 }
 
+
+void gkMessageManager::nextTick(void)
+{
+	++m_tick;
+
+	// The arena of this tick held the messages of two ticks ago
+	for (UTsize i = 0; i < m_listeners.size(); ++i)
+		m_listeners[i]->expireMessages();
+
+	m_arenas[m_tick & 1].m_count = 0;
+}
+
+
 UT_IMPLEMENT_SINGLETON(gkMessageManager);
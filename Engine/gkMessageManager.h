@@ -31,10 +31,21 @@
 #include "gkCommon.h"
 #include "utSingleton.h"
 
+// Messages between objects. Names and subjects are interned to ids, so
+// filters compare integers, and listeners are kept in lists per subject.
+// Messages are stored in per tick arenas and handed out by reference, they
+// stay valid until the end of the tick after the one they were sent in.
+// Generic listeners copy what they still hold out of the arena before that.
 class gkMessageManager : public utSingleton<gkMessageManager>
 {
 public:
 
+	// Interned string, 0 is the empty string
+	typedef UTuint32 Id;
+
+	// Id of strings no listener filters on
+	static const Id UNKNOWN_ID = 0xFFFFFFFF;
+
 	struct Message
 	{
 		gkString m_from;
@@ -42,6 +53,10 @@ public:
 		gkString m_subject;
 		gkString m_body;
 
+		Id m_fromId, m_toId, m_subjectId;
+
+		Message() : m_fromId(0), m_toId(0), m_subjectId(0) {}
+
 		Message& operator = (const Message& m);
 	};
 
@@ -50,37 +65,107 @@ public:
 		MessageListener() {}
 		virtual ~MessageListener() {}
 
+		// Subject the listener is filed under, 0 to receive every message
+		virtual Id getSubscription(void) const { return 0; }
+
+		// The message is valid until the end of the next tick
 		virtual void handleMessage(gkMessageManager::Message* message) = 0;
+
+		// A tick started, references to messages sent two ticks ago go stale
+		virtual void expireMessages(void) {}
 	};
 
+	// Keeps the messages it accepts until emptyMessages, like a sensor which
+	// is not queried every tick. Messages held past their arena are copied.
 	struct GenericMessageListener : public MessageListener
 	{
 		gkString m_fromFilter, m_toFilter, m_subjectFilter;
+		Id m_fromId, m_toId, m_subjectId;
 		bool m_acceptEmptyTo;
-		utArray<Message> m_messages;
+		utArray<const Message*> m_messages;
 
-		GenericMessageListener(gkString fromfilter = "", gkString tofilter = "", gkString subjectfilter = "")
-			:    m_fromFilter(fromfilter), m_toFilter(tofilter), m_subjectFilter(subjectfilter), m_acceptEmptyTo(false) {}
+		GenericMessageListener(const gkString& fromfilter = "", const gkString& tofilter = "", const gkString& subjectfilter = "");
 
 		void setAcceptEmptyTo(bool accept){this->m_acceptEmptyTo=accept;}
 		bool isAcceptingEmptyTo(){return this->m_acceptEmptyTo;}
 
-		~GenericMessageListener() {m_messages.clear();}
+		// Changing the subject moves a registered listener to the new subject's list
+		void setFromFilter(const gkString& from);
+		void setToFilter(const gkString& to);
+		void setSubjectFilter(const gkString& subject);
+
+		~GenericMessageListener();
 
+		Id getSubscription(void) const;
 		void handleMessage(gkMessageManager::Message* message);
-		void emptyMessages() {m_messages.clear();}
+		void expireMessages(void);
+		// Emptied messages stay valid until the next tick starts
+		void emptyMessages(void);
+
+	private:
+		void deleteReleased(void);
+
+		// Messages received before the last tick started
+		UTsize m_expiring;
+
+		// The first m_messages are copies owned by the listener
+		UTsize m_copied;
+
+		// Copies emptied during this tick
+		utArray<Message*> m_released;
 	};
 
 private:
-	utArray<MessageListener*> m_listeners;
+	typedef utArray<MessageListener*> Listeners;
+
+	// Messages of one tick in fixed size chunks, the slots are reused
+	struct Arena
+	{
+		utArray<Message*> m_chunks;
+		UTsize m_count;
+
+		Arena() : m_count(0) {}
+	};
+
+	utHashTable<utCharHashKey, Id> m_ids;
+	utArray<gkString*>             m_strings;
+
+	Listeners m_listeners;
+	// Listeners without a subject filter
+	Listeners m_anySubject;
+	utHashTable<utIntHashKey, Listeners> m_subjects;
+
+	Arena    m_arenas[2];
+	UTuint32 m_tick;
+
+	Message* allocMessage(void);
+	void deliver(Listeners& listeners, Message* message);
 
 public:
 	gkMessageManager();
-	virtual ~gkMessageManager() {}
+	virtual ~gkMessageManager();
 
 	void addListener(MessageListener* listener);
-	void removeListener(MessageListener* listener);
-	void sendMessage(gkString from, gkString to, gkString subject, gkString body);
+	bool removeListener(MessageListener* listener);
+
+	// Id of a name or subject, it is added when unknown
+	Id intern(const gkString& str);
+
+	// Id of a name or subject, UNKNOWN_ID when it was never interned
+	Id find(const gkString& str) const;
+
+	GK_INLINE const gkString& getString(Id id) const { return *m_strings[id]; }
+
+	void sendMessage(const gkString& from, const gkString& to, const gkString& subject, const gkString& body);
+
+	// With interned ids, like senders caching the ids of their names
+	void sendMessage(Id from, Id to, Id subject, const gkString& body);
+
+	// Start the next tick, the messages of two ticks ago are recycled.
+	// Called by the engine at the start of every tick.
+	void nextTick(void);
+
+	GK_INLINE UTuint32 getTick(void) const { return m_tick; }
 
 	UT_DECLARE_SINGLETON(gkMessageManager);
 };
@@ -124,6 +124,15 @@ int gkPath::getFileSize(void) const
 }
 
 
+UTuint64 gkPath::getModificationTime(void) const
+{
+	struct stat st;
+	if (stat(m_path.c_str(), &st) == 0)
+		return (UTuint64)st.st_mtime;
+	return 0;
+}
+
+
 void gkPath::append(const gkString& v)
 {
 	if (m_path.at(m_path.size() - 1) != SEPERATOR[0])
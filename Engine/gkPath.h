@@ -60,6 +60,7 @@ public:
 	void    normalizePlatform(void) const;
 
 	int     getFileSize(void) const;
+	UTuint64 getModificationTime(void) const;
 	void    append(const gkString& v);
 
 	bool    isAbs(void) const;
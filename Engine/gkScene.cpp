@@ -46,6 +46,7 @@
 #include "gkLogicManager.h"
 #include "gkLogger.h"
 #include "gkDynamicsWorld.h"
+#include "gkDbvt.h"
 #include "gkRigidBody.h"
 #include "gkCharacter.h"
 #include "gkUserDefs.h"
@@ -93,6 +94,9 @@ using Ogre::TagPoint;
 
 #define DEFAULT_STARTUP_LUA_FILE		"OnInit.lua"
 
+// listeners moving other objects from notifyUpdate add a pass each
+#define GK_TRANSFORM_SYNC_PASSES		4
+
 
 
 gkScene::gkScene(gkInstancedManager* creator, const gkResourceName& name, const gkResourceHandle& handle)
@@ -107,6 +111,7 @@ gkScene::gkScene(gkInstancedManager* creator, const gkResourceName& name, const
 	     m_debugger(0),
 	     m_hasLights(false),
 	     m_markDBVT(false),
+	     m_deferTransforms(false),
 	     m_cloneCount(0),
 	     m_layers(0xFFFFFFFF),
 	     m_skybox(0),
@@ -119,6 +124,9 @@ gkScene::gkScene(gkInstancedManager* creator, const gkResourceName& name, const
 #ifdef OGREKIT_USE_PROCESSMANAGER
 		,m_processManager(0)
 #endif
+#ifdef OGREKIT_COMPILE_RECAST
+		,m_navPathQueue(0)
+#endif
 {
 	m_logicBrickManager = new gkLogicManager();
 }
@@ -155,6 +163,11 @@ gkScene::~gkScene()
 		m_processManager=0;
 	}
 
+#ifdef OGREKIT_COMPILE_RECAST
+	delete m_navPathQueue;
+	m_navPathQueue = 0;
+#endif
+
 	m_objects.clear();
 }
 
@@ -678,6 +691,29 @@ void gkScene::setMainCamera(gkCamera* cam)
 
 
 
+void gkScene::addCullCamera(gkCamera* cam)
+{
+	if (cam && m_cullCameras.find(cam) == UT_NPOS)
+	{
+		m_cullCameras.push_back(cam);
+		m_markDBVT = true;
+	}
+}
+
+
+
+void gkScene::removeCullCamera(gkCamera* cam)
+{
+	UTsize pos = m_cullCameras.find(cam);
+	if (pos != UT_NPOS)
+	{
+		m_cullCameras.erase(pos);
+		m_markDBVT = true;
+	}
+}
+
+
+
 gkRigidBody* gkScene::createRigidBody(gkGameObject* obj, gkPhysicsProperties& prop)
 {
 	_destroyPhysicsObject(obj);
@@ -1013,6 +1049,8 @@ void gkScene::createInstanceImpl(void)
 	if (!m_window)
 		setDisplayWindow(gkWindowSystem::getSingleton().getMainWindow());
 
+	m_deferTransforms = gkEngine::getSingleton().getUserDefs().deferTransforms;
+
 	// generic for now, but later scene properties will be used
 	// to extract more detailed management information
 
@@ -1183,12 +1221,22 @@ void gkScene::destroyInstanceImpl(void)
 	if (m_navMeshData.get())
 		m_navMeshData->destroyInstances();
 
+#ifdef OGREKIT_COMPILE_RECAST
+	// a running build keeps its own reference
+	m_navTileCache = PRECAST_TILE_CACHE();
+
+	if (m_navPathQueue)
+		m_navPathQueue->clear();
+#endif
+
 #ifdef OGREKIT_USE_LUA
 	// Free scripts
 	gkLuaManager::getSingleton().decompileGroup(getGroupName());
 #endif
 
 	m_cameras.clear(true);
+	m_cullCameras.clear(true);
+	m_transformObjects.clear(true);
 	m_lights.clear(true);
 	m_staticControllers.clear(true);
 
@@ -1375,6 +1423,9 @@ void gkScene::notifyInstanceDestroyed(gkGameObject* gobj)
 	_destroyPhysicsObject(gobj);
 
 
+	if (gobj->getType() == GK_CAMERA)
+		removeCullCamera(gobj->getCamera());
+
 	if (!isBeingDestroyed())
 	{
 		if (gobj->getType() == GK_CAMERA)
@@ -1581,6 +1632,88 @@ void gkScene::removeAnimationUpdate(gkGameObject* obj)
 
 
 
+void gkScene::pushTransformUpdate(gkGameObject* obj)
+{
+	// still waiting for its _endTransformSync in this pass, the pending
+	// sync is carried over to the new slot
+	UTsize pos = obj->_getTransformIndex();
+	if (pos != UT_NPOS)
+		m_transformObjects[pos] = 0;
+
+	obj->_setTransformIndex(m_transformObjects.size());
+	m_transformObjects.push_back(obj);
+}
+
+
+
+void gkScene::removeTransformUpdate(gkGameObject* obj)
+{
+	// cleared rather than erased, syncTransforms may be walking the array
+	UTsize pos = obj->_getTransformIndex();
+	if (pos != UT_NPOS)
+	{
+		m_transformObjects[pos] = 0;
+		obj->_setTransformIndex(UT_NPOS);
+	}
+}
+
+
+
+void gkScene::syncTransforms(void)
+{
+	if (m_transformObjects.empty())
+		return;
+
+	// Notified listeners may move further objects, those are appended and
+	// synced by the next pass. A pass flags all of its objects first, so a
+	// hierarchy is notified once from its top most dirty object.
+	UTsize first = 0, last, i;
+	for (int pass = 0; pass < GK_TRANSFORM_SYNC_PASSES; ++pass)
+	{
+		last = m_transformObjects.size();
+		if (first == last)
+			break;
+
+		for (i = first; i < last; ++i)
+		{
+			if (m_transformObjects[i])
+				m_transformObjects[i]->_beginTransformSync();
+		}
+
+		for (i = first; i < last; ++i)
+		{
+			gkGameObject* obj = m_transformObjects[i];
+			if (obj)
+			{
+				// before the call, listeners may queue or destroy the object
+				obj->_setTransformIndex(UT_NPOS);
+				obj->_endTransformSync();
+			}
+		}
+
+		first = last;
+	}
+
+	// anything moved by the last pass waits for the next sync
+	UTsize left = 0;
+	for (i = first; i < m_transformObjects.size(); ++i)
+	{
+		gkGameObject* obj = m_transformObjects[i];
+		if (obj)
+		{
+			obj->_setTransformIndex(left);
+			m_transformObjects[left++] = obj;
+		}
+	}
+
+	if (left > 0)
+		m_transformObjects.resize(left);
+	else
+		m_transformObjects.clear(true);
+}
+
+
+
 void gkScene::updateObjectsAnimations(const gkScalar tick)
 {
 	gkScalar animtick = tick;
@@ -1642,10 +1775,55 @@ void gkScene::update(gkScalar tickRate)
 	if (m_updateFlags & UF_PHYSICS)
 	{
 		gkStats::getSingleton().startClock();
-		m_physicsWorld->step(tickRate);
+		_stepPhysics(tickRate);
 		gkStats::getSingleton().stopPhysicsClock();
 	}
 
+	// update logic bricks, processes & node trees
+	_updateLogic(tickRate);
+
+	// update animations
+	if (m_updateFlags & UF_ANIMATIONS)
+	{
+		gkStats::getSingleton().startClock();
+		_updateAnimations(tickRate);
+		gkStats::getSingleton().stopAnimationsClock();
+	}
+
+	_updateSound(tickRate);
+
+	if (m_updateFlags & UF_DBVT)
+	{
+		gkStats::getSingleton().startClock();
+		_updateDbvt(tickRate);
+		gkStats::getSingleton().stopDbvtClock();
+	}
+
+	_endUpdate(tickRate);
+}
+
+
+
+void gkScene::_stepPhysics(gkScalar tickRate)
+{
+	if (!isInstanced())
+		return;
+
+	syncTransforms();
+
+	if (!(m_updateFlags & UF_PHYSICS))
+		return;
+
+	GK_ASSERT(m_physicsWorld);
+	m_physicsWorld->step(tickRate);
+}
+
+
+
+void gkScene::_updateLogic(gkScalar tickRate)
+{
+	if (!isInstanced())
+		return;
 
 	// update logic bricks
 	if (m_updateFlags & UF_LOGIC_BRICKS)
@@ -1653,6 +1831,8 @@ void gkScene::update(gkScalar tickRate)
 		gkStats::getSingleton().startClock();
 		m_logicBrickManager->update(tickRate);
 		gkStats::getSingleton().stopLogicBricksClock();
+		gkStats::getSingleton().addSensorActivity(m_logicBrickManager->getNumEvaluatedSensors(),
+		        m_logicBrickManager->getNumSensors());
 	}
 
 #ifdef OGREKIT_USE_PROCESSMANAGER
@@ -1674,15 +1854,30 @@ void gkScene::update(gkScalar tickRate)
 	}
 #endif
 
-	// update animations
-	if (m_updateFlags & UF_ANIMATIONS)
-	{
-		gkStats::getSingleton().startClock();
-		updateObjectsAnimations(tickRate);
-		gkStats::getSingleton().stopAnimationsClock();
-	}
+#ifdef OGREKIT_COMPILE_RECAST
+	// path requests made by the logic of this tick
+	if (m_navPathQueue)
+		m_navPathQueue->update();
+#endif
+}
+
 
 
+void gkScene::_updateAnimations(gkScalar tickRate)
+{
+	if (!isInstanced() || !(m_updateFlags & UF_ANIMATIONS))
+		return;
+
+	updateObjectsAnimations(tickRate);
+}
+
+
+
+void gkScene::_updateSound(gkScalar tickRate)
+{
+	if (!isInstanced())
+		return;
+
 #ifdef OGREKIT_OPENAL_SOUND
 	// update sound manager.
 	if (m_updateFlags & UF_SOUNDS)
@@ -1692,17 +1887,75 @@ void gkScene::update(gkScalar tickRate)
 		gkStats::getSingleton().stopSoundClock();
 	}
 #endif
+}
 
-	if (m_updateFlags & UF_DBVT)
+
+
+void gkScene::_updateDbvt(gkScalar tickRate)
+{
+	if (!isInstanced())
+		return;
+
+	syncTransforms();
+
+	if (!(m_updateFlags & UF_DBVT))
+		return;
+
+	if (m_markDBVT)
 	{
-		gkStats::getSingleton().startClock();
-		if (m_markDBVT)
-		{
-			m_markDBVT = false;
+		m_markDBVT = false;
+
+		if (m_cullCameras.empty())
 			m_physicsWorld->handleDbvt(m_startCam);
+		else
+		{
+			gkCamera* cams[gkDbvt::MAX_CAMERAS];
+			int nr = 0;
+
+			cams[nr++] = m_startCam;
+			for (UTsize i = 0; i < m_cullCameras.size() && nr < gkDbvt::MAX_CAMERAS; ++i)
+			{
+				if (m_cullCameras[i] != m_startCam)
+					cams[nr++] = m_cullCameras[i];
+			}
+
+			m_physicsWorld->handleDbvt(cams, nr);
 		}
-		gkStats::getSingleton().stopDbvtClock();
 	}
+}
+
+
+
+bool gkScene::_canUpdateConcurrently(void)
+{
+	return _getSerialReason() == 0;
+}
+
+
+
+const char* gkScene::_getSerialReason(void)
+{
+	if (!isInstanced())
+		return "it is not instanced";
+	if (!m_deferTransforms)
+		return "transforms are not deferred (deferTransforms)";
+	if (!m_physicsWorld)
+		return "it has no physics world";
+	if (m_physicsWorld->hasListeners())
+		return "its physics world has listeners";
+	if (m_physicsWorld->getDebug())
+		return "physics debug drawing is on";
+	return 0;
+}
+
+
+
+void gkScene::_endUpdate(gkScalar tickRate)
+{
+	if (!isInstanced())
+		return;
+
+	syncTransforms();
 
 	if (m_updateFlags & UF_DEBUG)
 	{
@@ -1741,18 +1994,20 @@ bool gkScene::asyncTryToCreateNavigationMesh(gkActiveObject& activeObj, const gk
 	{
 	public:
 
-		CreateNavMeshCall(PMESHDATA meshData, const gkRecast::Config& config, ASYNC_DT_RESULT result)
-			: m_meshData(meshData), m_config(config), m_result(result) {}
+		CreateNavMeshCall(PMESHDATA meshData, PRECAST_TILE_CACHE cache, const gkRecast::Config& config, ASYNC_DT_RESULT result)
+			: m_meshData(meshData), m_cache(cache), m_config(config), m_result(result) {}
 
 		~CreateNavMeshCall() {}
 
-		void run() { m_result = gkRecast::createNavMesh(m_meshData, m_config); }
+		void run() { m_result = gkRecast::createNavMesh(m_meshData, m_config, m_cache); }
 
 
 	private:
 
 		PMESHDATA m_meshData;
 
+		PRECAST_TILE_CACHE m_cache;
+
 		gkRecast::Config m_config;
 
 		ASYNC_DT_RESULT m_result;
@@ -1762,7 +2017,11 @@ bool gkScene::asyncTryToCreateNavigationMesh(gkActiveObject& activeObj, const gk
 
 	if (m_navMeshData.get() && m_navMeshData->hasChanged())
 	{
-		gkPtrRef<gkCall> call(new CreateNavMeshCall(PMESHDATA(m_navMeshData->cloneData()), config, result));
+		// unchanged tiles are taken from the previous build
+		if (!m_navTileCache.get())
+			m_navTileCache = PRECAST_TILE_CACHE(new gkRecastTileCache);
+
+		gkPtrRef<gkCall> call(new CreateNavMeshCall(PMESHDATA(m_navMeshData->cloneData()), m_navTileCache, config, result));
 
 		activeObj.enqueue(call);
 
@@ -1773,4 +2032,19 @@ bool gkScene::asyncTryToCreateNavigationMesh(gkActiveObject& activeObj, const gk
 
 	return false;
 }
+
+
+gkRecast::BuildStats gkScene::getNavMeshBuildStats(void) const
+{
+	return m_navTileCache.get() ? m_navTileCache->getStats() : gkRecast::BuildStats();
+}
+
+
+gkNavPathQueue* gkScene::getNavPathQueue(void)
+{
+	if (!m_navPathQueue)
+		m_navPathQueue = new gkNavPathQueue();
+
+	return m_navPathQueue;
+}
 #endif
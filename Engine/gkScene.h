@@ -42,6 +42,7 @@
 
 #ifdef OGREKIT_COMPILE_RECAST
 #include "gkRecast.h"
+#include "gkNavPathQueue.h"
 #endif
 
 class gkCurve;
@@ -57,6 +58,27 @@ public:
 	void update(gkScalar tickRate);
 	void beginFrame(void);
 
+	///The update() stages, in the order update() runs them.
+	///_stepPhysics, _updateAnimations and _updateDbvt do no gkStats timing. Objects
+	///they move notify their listeners (and the navigation mesh) right away, or from
+	///the syncTransforms these stages start with when transforms are deferred. The
+	///remaining stages must be called from the main thread.
+	void _stepPhysics(gkScalar tickRate);
+	void _updateLogic(gkScalar tickRate);
+	void _updateAnimations(gkScalar tickRate);
+	void _updateSound(gkScalar tickRate);
+	void _updateDbvt(gkScalar tickRate);
+	void _endUpdate(gkScalar tickRate);
+
+	///True when _stepPhysics, _updateAnimations and _updateDbvt, called right after
+	///syncTransforms, only touch data owned by this scene: transforms are deferred
+	///and the physics world has no listeners and no debug drawing. The engine runs
+	///these stages of such scenes on the job system.
+	bool _canUpdateConcurrently(void);
+
+	///Why _canUpdateConcurrently is false, 0 when it is true.
+	const char* _getSerialReason(void);
+
 
 
 	GK_INLINE gkSceneProperties&        getProperties(void)    { return m_baseProps;  }
@@ -122,6 +144,12 @@ public:
 #ifdef OGREKIT_COMPILE_RECAST
 	typedef gkAsyncResult<PDT_NAV_MESH > ASYNC_DT_RESULT;
 	bool asyncTryToCreateNavigationMesh(gkActiveObject& activeObj, const gkRecast::Config& config, ASYNC_DT_RESULT result);
+
+	// timings and tile counts of the last finished build
+	gkRecast::BuildStats getNavMeshBuildStats(void) const;
+
+	// path requests answered at the end of the logic update
+	gkNavPathQueue* getNavPathQueue(void);
 #endif
 
 
@@ -140,6 +168,11 @@ public:
 	GK_INLINE gkCameraSet&	getCameras(void)		{ return m_cameras; }
 	void setMainCamera(gkCamera* cam);
 
+	///Extra cameras culled together with the main camera (split screen, shadow views).
+	///Objects stay visible as long as one of the cameras sees them.
+	void addCullCamera(gkCamera* cam);
+	void removeCullCamera(gkCamera* cam);
+
 
 
 	GK_INLINE gkLightSet&    getLights(void) {return m_lights;}
@@ -160,6 +193,15 @@ public:
 	void pushAnimationUpdate(gkGameObject* obj);
 	void removeAnimationUpdate(gkGameObject* obj);
 
+	///Objects moved during the tick only write their scene node. Body updates
+	///and notifyUpdate are batched into syncTransforms, which runs before the
+	///physics step, before culling and at the end of the update. Call it
+	///directly when physics queries have to see objects moved this tick.
+	GK_INLINE bool isTransformDeferred(void) {return m_deferTransforms && isInstanced();}
+	void pushTransformUpdate(gkGameObject* obj);
+	void removeTransformUpdate(gkGameObject* obj);
+	void syncTransforms(void);
+
 	// Local property access.
 
 	void setSceneManagerType(int type);
@@ -256,8 +298,10 @@ private:
 	gkGameObjectArray       m_tickClones;
 	gkGameObjectSet         m_endObjects;
 	gkGameObjectSet         m_updateAnimObjects;
+	gkGameObjectArray       m_transformObjects;
 	gkPhysicsControllerSet  m_staticControllers;
 	gkCameraSet             m_cameras;
+	utArray<gkCamera*>      m_cullCameras;
 	gkLightSet              m_lights;
 
 	gkConstraintManager*    m_constraintManager;
@@ -266,10 +310,15 @@ private:
 
 	bool                    m_hasLights;
 	bool                    m_markDBVT;
+	bool                    m_deferTransforms;
 	int                     m_cloneCount;
 	UTuint32                m_layers;
 	gkBoundingBox           m_limits;
 	PNAVMESHDATA            m_navMeshData;
+#ifdef OGREKIT_COMPILE_RECAST
+	PRECAST_TILE_CACHE      m_navTileCache;
+	gkNavPathQueue*         m_navPathQueue;
+#endif
 	class gkSkyBoxGradient* m_skybox;
 
 	UTuint32				m_updateFlags;
@@ -0,0 +1,188 @@
+/*
+-------------------------------------------------------------------------------
+    This file is part of OgreKit.
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2006-2013 Charlie C.
+
+    Contributor(s): none yet.
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#ifndef _gkSceneStages_h_
+#define _gkSceneStages_h_
+
+#include "gkCommon.h"
+#include "gkStats.h"
+#include "Thread/gkJobSystem.h"
+
+
+// Runs one scene update stage as a job.
+template <typename Scene>
+class gkSceneStageJob : public gkJob
+{
+public:
+	typedef void (Scene::*Stage)(gkScalar);
+
+	gkSceneStageJob(Scene* scene, Stage stage, gkScalar dt)
+		:	m_scene(scene), m_stage(stage), m_dt(dt)
+	{
+	}
+
+	void run(void) { (m_scene->*m_stage)(m_dt); }
+
+private:
+	Scene*   m_scene;
+	Stage    m_stage;
+	gkScalar m_dt;
+};
+
+
+// Updates a set of scenes stage by stage, see gkScene::update for the stages.
+// The physics, animation and dbvt stages of scenes that _canUpdateConcurrently
+// run on the job system. Scene is gkScene, tests use their own.
+//
+// Ordering, what gkUserDefs::parallelScenes promises:
+// - Each scene runs its stages in the order of gkScene::update.
+// - The calling thread makes three passes over the scenes in registration
+//   order: physics and logic, animations and sound, dbvt and end of update.
+//   The stages of scenes that can not update concurrently run in these passes.
+// - The concurrent stages of all scenes finish before the pass that follows.
+// So logic, physics listeners and sounds of all scenes run in the same order
+// as when updating the scenes one after the other, and a message reaches the
+// same tick's logic. The result is the same as long as no stage of one scene
+// reads or moves the objects of another directly: that would see the other
+// scene in a different stage.
+template <typename Scene>
+class gkSceneStages
+{
+public:
+	typedef void (Scene::*Stage)(gkScalar);
+	typedef utArray<Scene*> Scenes;
+
+public:
+	gkSceneStages() : m_concurrent(0) {}
+
+	// current, when given, is set to the scene the calling thread works on
+	void update(Scenes& scenes, gkScalar dt, Scene** current = 0)
+	{
+		gkStats* stats = gkStats::getSingletonPtr();
+		UTsize i;
+
+		syncTransforms(scenes);
+
+		if (stats) stats->startClock();
+		m_concurrent = runConcurrent(scenes, &Scene::_stepPhysics, dt);
+		if (stats) stats->stopPhysicsClock();
+
+		for (i = 0; i < scenes.size(); ++i)
+		{
+			if (current)
+				*current = scenes[i];
+
+			if (!m_flags[i])
+			{
+				if (stats) stats->startClock();
+				scenes[i]->_stepPhysics(dt);
+				if (stats) stats->stopPhysicsClock();
+			}
+			scenes[i]->_updateLogic(dt);
+		}
+
+		if (stats) stats->startClock();
+		runConcurrent(scenes, &Scene::_updateAnimations, dt);
+		if (stats) stats->stopAnimationsClock();
+
+		for (i = 0; i < scenes.size(); ++i)
+		{
+			if (current)
+				*current = scenes[i];
+
+			if (!m_flags[i])
+			{
+				if (stats) stats->startClock();
+				scenes[i]->_updateAnimations(dt);
+				if (stats) stats->stopAnimationsClock();
+			}
+			scenes[i]->_updateSound(dt);
+		}
+
+		syncTransforms(scenes);
+
+		if (stats) stats->startClock();
+		runConcurrent(scenes, &Scene::_updateDbvt, dt);
+		if (stats) stats->stopDbvtClock();
+
+		for (i = 0; i < scenes.size(); ++i)
+		{
+			if (current)
+				*current = scenes[i];
+
+			if (!m_flags[i])
+			{
+				if (stats) stats->startClock();
+				scenes[i]->_updateDbvt(dt);
+				if (stats) stats->stopDbvtClock();
+			}
+			scenes[i]->_endUpdate(dt);
+		}
+	}
+
+	// scenes the last update stepped on the job system
+	GK_INLINE UTsize getConcurrentCount(void) const { return m_concurrent; }
+
+private:
+
+	// submits the stage of the scenes that allow it, the others are flagged
+	// for the pass that follows
+	UTsize runConcurrent(Scenes& scenes, Stage stage, gkScalar dt)
+	{
+		gkJobSystem& jobs = gkJobSystem::getSingleton();
+		gkJobCounter counter;
+		UTsize i, nr = 0;
+
+		m_flags.resize(scenes.size());
+		for (i = 0; i < scenes.size(); ++i)
+		{
+			m_flags[i] = scenes[i]->_canUpdateConcurrently();
+			if (m_flags[i])
+			{
+				jobs.submit(new gkSceneStageJob<Scene>(scenes[i], stage, dt), &counter);
+				++nr;
+			}
+		}
+
+		jobs.wait(counter);
+		return nr;
+	}
+
+	void syncTransforms(Scenes& scenes)
+	{
+		for (UTsize i = 0; i < scenes.size(); ++i)
+		{
+			if (scenes[i]->isInstanced())
+				scenes[i]->syncTransforms();
+		}
+	}
+
+	utArray<bool> m_flags;
+	UTsize        m_concurrent;
+};
+
+
+#endif//_gkSceneStages_h_
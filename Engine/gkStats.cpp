@@ -38,6 +38,13 @@ gkStats::gkStats()
 		m_bufswaplod(0),
 		m_animations(0),
 		m_process(0),
+		m_sensors(0),
+		m_sensorsEvaluated(0),
+		m_scriptGc(0),
+		m_scriptGcSteps(0),
+		m_scriptHeapKb(0),
+		m_scenes(0),
+		m_concurrentScenes(0),
 		m_lastRender(0),
 		m_lastLogicBricks(0),
 		m_lastLogicNodes(0),
@@ -47,7 +54,13 @@ gkStats::gkStats()
 		m_lastBufswaplod(0),
 		m_lastAnimations(0),
 		m_lastTotal(0),
-		m_lastProcess(0)
+		m_lastProcess(0),
+		m_lastSensors(0),
+		m_lastSensorsEvaluated(0),
+		m_lastScriptGc(0),
+		m_lastScriptGcSteps(0),
+		m_lastScenes(0),
+		m_lastConcurrentScenes(0)
 {
 	m_clock = new Ogre::Timer();
 	resetClock();
@@ -65,6 +78,12 @@ void gkStats::resetClock(void)
 	m_bufswaplod = 0;
 	m_animations = 0;
 	m_process = 0;
+	m_sensors = 0;
+	m_sensorsEvaluated = 0;
+	m_scriptGc = 0;
+	m_scriptGcSteps = 0;
+	m_scenes = 0;
+	m_concurrentScenes = 0;
 }
 
 void gkStats::startClock(void)
@@ -83,6 +102,12 @@ void gkStats::nextFrame(void)
 	m_lastBufswaplod = m_bufswaplod;
 	m_lastAnimations = m_animations;
 	m_lastProcess = m_process;
+	m_lastSensors = m_sensors;
+	m_lastSensorsEvaluated = m_sensorsEvaluated;
+	m_lastScriptGc = m_scriptGc;
+	m_lastScriptGcSteps = m_scriptGcSteps;
+	m_lastScenes = m_scenes;
+	m_lastConcurrentScenes = m_concurrentScenes;
 
 	resetClock();
 
@@ -135,4 +160,23 @@ void gkStats::stopProcessClock(void)
 	m_process += m_clock->getMicroseconds() - m_start;
 }
 
+void gkStats::addSensorActivity(unsigned long evaluated, unsigned long total)
+{
+	m_sensorsEvaluated += evaluated;
+	m_sensors += total;
+}
+
+void gkStats::addScriptGc(unsigned long steps, unsigned long microSeconds, unsigned long heapKb)
+{
+	m_scriptGcSteps += steps;
+	m_scriptGc += microSeconds;
+	m_scriptHeapKb = heapKb;
+}
+
+void gkStats::addSceneUpdates(unsigned long concurrent, unsigned long total)
+{
+	m_concurrentScenes += concurrent;
+	m_scenes += total;
+}
+
 UT_IMPLEMENT_SINGLETON(gkStats);
@@ -46,6 +46,13 @@ private:
 	unsigned long m_bufswaplod;
 	unsigned long m_animations;
 	unsigned long m_process;
+	unsigned long m_sensors;
+	unsigned long m_sensorsEvaluated;
+	unsigned long m_scriptGc;
+	unsigned long m_scriptGcSteps;
+	unsigned long m_scriptHeapKb;
+	unsigned long m_scenes;
+	unsigned long m_concurrentScenes;
 
 	unsigned long m_lastRender;
 	unsigned long m_lastLogicBricks;
@@ -57,6 +64,12 @@ private:
 	unsigned long m_lastAnimations;
 	unsigned long m_lastProcess;
 	unsigned long m_lastTotal;
+	unsigned long m_lastSensors;
+	unsigned long m_lastSensorsEvaluated;
+	unsigned long m_lastScriptGc;
+	unsigned long m_lastScriptGcSteps;
+	unsigned long m_lastScenes;
+	unsigned long m_lastConcurrentScenes;
 public:
 	gkStats();
 
@@ -76,6 +89,10 @@ public:
 	void stopAnimationsClock(void);
 	void stopProcessClock(void);
 
+	void addSensorActivity(unsigned long evaluated, unsigned long total);
+	void addScriptGc(unsigned long steps, unsigned long microSeconds, unsigned long heapKb);
+	void addSceneUpdates(unsigned long concurrent, unsigned long total);
+
 	unsigned long getLastRenderMicroSeconds(void)      {return m_lastRender; }
 	unsigned long getLastLogicBricksMicroSeconds(void) {return m_lastLogicBricks; }
 	unsigned long getLastLogicNodesMicroSeconds(void)  {return m_lastLogicNodes;}
@@ -86,6 +103,13 @@ public:
 	unsigned long getLastAnimationsMicroSeconds(void)  {return m_lastAnimations;}
 	unsigned long getLastProcessMicroSeconds(void)     {return m_lastProcess;}
 	unsigned long getLastTotalMicroSeconds(void)       {return m_lastTotal;}
+	unsigned long getLastSensors(void)                 {return m_lastSensors;}
+	unsigned long getLastSensorsEvaluated(void)        {return m_lastSensorsEvaluated;}
+	unsigned long getLastScriptGcMicroSeconds(void)    {return m_lastScriptGc;}
+	unsigned long getLastScriptGcSteps(void)           {return m_lastScriptGcSteps;}
+	unsigned long getScriptHeapKb(void)                {return m_scriptHeapKb;}
+	unsigned long getLastScenes(void)                  {return m_lastScenes;}
+	unsigned long getLastConcurrentScenes(void)        {return m_lastConcurrentScenes;}
 
 	UT_DECLARE_SINGLETON(gkStats);
 };
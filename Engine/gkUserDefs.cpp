@@ -87,8 +87,16 @@ gkUserDefs::gkUserDefs()
 	extWinhandle(""),
 	animFps(24.f),
 	shaderCachePath(""),
+	blendCachePath(""),
+	luaCachePath(""),
+	luaGcBudget(0),
+	luaEnvironments(false),
 	rtss(false),
-	hasFixedCapability(true)
+	hasFixedCapability(true),
+	parallelScenes(false),
+	jobThreads(0),
+	deferTransforms(false),
+	parallelPhysics(false)
 {
 }
 
@@ -327,6 +335,46 @@ void gkUserDefs::parseString(const gkString& key, const gkString& val)
 		shaderCachePath = val;
 		return;
 	}
+	if (KeyEq("blendcachepath"))
+	{
+		blendCachePath = val;
+		return;
+	}
+	if (KeyEq("luacachepath"))
+	{
+		luaCachePath = val;
+		return;
+	}
+	if (KeyEq("luagcbudget"))
+	{
+		luaGcBudget = gkMax<int>(0, Ogre::StringConverter::parseInt(val));
+		return;
+	}
+	if (KeyEq("luaenvironments"))
+	{
+		luaEnvironments = Ogre::StringConverter::parseBool(val);
+		return;
+	}
+	if (KeyEq("parallelscenes"))
+	{
+		parallelScenes = Ogre::StringConverter::parseBool(val);
+		return;
+	}
+	if (KeyEq("jobthreads"))
+	{
+		jobThreads = gkClamp<int>(Ogre::StringConverter::parseInt(val), 0, 64);
+		return;
+	}
+	if (KeyEq("defertransforms"))
+	{
+		deferTransforms = Ogre::StringConverter::parseBool(val);
+		return;
+	}
+	if (KeyEq("parallelphysics"))
+	{
+		parallelPhysics = Ogre::StringConverter::parseBool(val);
+		return;
+	}
 
 #undef KeyEq
 }
@@ -69,6 +69,10 @@ public:
 	bool                    enableshadows;
 	int                     defaultMipMap;      // Number of mipmaps to generate per texture (default 5)
 	gkString                shaderCachePath;    // RTShaderSystem cache file path
+	gkString                blendCachePath;     // Directory for converted .blend meshes, empty disables the cache
+	gkString                luaCachePath;       // Directory for compiled Lua scripts, empty disables the cache
+	int                     luaGcBudget;        // Microseconds of Lua garbage collection per frame, 0 leaves it to Lua
+	bool                    luaEnvironments;    // Every Lua script keeps its globals in its own table instead of _G
 
 	gkString                shadowtechnique;
 	gkColor                 colourshadow;
@@ -79,6 +83,10 @@ public:
 	bool                    rtss;               // Enable RTShadingSystem
 	bool                    hasFixedCapability; // Renderer supports fixed-function pipeline
 	gkString				androidConfig;		// Android Config Handle (Ogre 1.9)
+	bool                    parallelScenes;     // Update physics, animations & culling of the active scenes concurrently, stage by stage (see gkSceneStages.h for the order)
+	int                     jobThreads;         // Job system worker threads, 0 uses one per extra core
+	bool                    deferTransforms;    // Batch object transform updates once per scene stage, queries may then see bodies from before the move
+	bool                    parallelPhysics;    // Run the narrowphase & the constraint islands of each world on the job system
 
 	GK_INLINE bool          isD3DRenderSystem() { return isD3DRenderSystem(rendersystem); }
 
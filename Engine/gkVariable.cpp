@@ -33,7 +33,7 @@ gkVariable::gkVariable()
 	:    m_value((int)0),
 	     m_type(VAR_NULL),
 	     m_name(""),
-	     m_debug(false), m_lock(false)
+	     m_debug(false), m_lock(false), m_version(0)
 {
 }
 
@@ -43,7 +43,7 @@ gkVariable::gkVariable(const gkString& n, bool dbg)
 	:    m_value((int)0),
 	     m_type(VAR_NULL),
 	     m_name(n),
-	     m_debug(dbg), m_lock(false)
+	     m_debug(dbg), m_lock(false), m_version(0)
 {
 }
 
@@ -52,7 +52,7 @@ gkVariable::gkVariable(bool v, const gkString& name)
 	:    m_value((int)0),
 	     m_type(VAR_NULL),
 	     m_name(""),
-	     m_debug(false), m_lock(false)
+	     m_debug(false), m_lock(false), m_version(0)
 {
 	setValue(v);
 }
@@ -62,7 +62,7 @@ gkVariable::gkVariable(int v, const gkString& name)
 	:    m_value((int)0),
 	     m_type(VAR_NULL),
 	     m_name(""),
-	     m_debug(false), m_lock(false)
+	     m_debug(false), m_lock(false), m_version(0)
 {
 	setValue(v);
 }
@@ -72,7 +72,7 @@ gkVariable::gkVariable(gkScalar v, const gkString& name)
 	:    m_value((int)0),
 	     m_type(VAR_NULL),
 	     m_name(""),
-	     m_debug(false), m_lock(false)
+	     m_debug(false), m_lock(false), m_version(0)
 {
 	setValue(v);
 }
@@ -81,7 +81,7 @@ gkVariable::gkVariable(const gkString& v, const gkString& name)
 	:    m_value((int)0),
 	     m_type(VAR_NULL),
 	     m_name(""),
-	     m_debug(false), m_lock(false)
+	     m_debug(false), m_lock(false), m_version(0)
 {
 	setValue(v);
 }
@@ -90,7 +90,7 @@ gkVariable::gkVariable(const gkVector2& v, const gkString& name)
 	:    m_value((int)0),
 	     m_type(VAR_NULL),
 	     m_name(""),
-	     m_debug(false), m_lock(false)
+	     m_debug(false), m_lock(false), m_version(0)
 {
 	setValue(v);
 }
@@ -99,7 +99,7 @@ gkVariable::gkVariable(const gkVector3& v, const gkString& name)
 	:    m_value((int)0),
 	     m_type(VAR_NULL),
 	     m_name(""),
-	     m_debug(false), m_lock(false)
+	     m_debug(false), m_lock(false), m_version(0)
 {
 	setValue(v);
 }
@@ -108,7 +108,7 @@ gkVariable::gkVariable(const gkVector4& v, const gkString& name)
 	:    m_value((int)0),
 	     m_type(VAR_NULL),
 	     m_name(""),
-	     m_debug(false), m_lock(false)
+	     m_debug(false), m_lock(false), m_version(0)
 {
 	setValue(v);
 }
@@ -116,7 +116,7 @@ gkVariable::gkVariable(const gkQuaternion& v, const gkString& name)
 	:    m_value((int)0),
 	     m_type(VAR_NULL),
 	     m_name(""),
-	     m_debug(false), m_lock(false)
+	     m_debug(false), m_lock(false), m_version(0)
 {
 	setValue(v);
 }
@@ -125,7 +125,7 @@ gkVariable::gkVariable(const gkMatrix3& v, const gkString& name)
 	:    m_value((int)0),
 	     m_type(VAR_NULL),
 	     m_name(""),
-	     m_debug(false), m_lock(false)
+	     m_debug(false), m_lock(false), m_version(0)
 {
 	setValue(v);
 }
@@ -134,7 +134,7 @@ gkVariable::gkVariable(const gkMatrix4& v, const gkString& name)
 	:    m_value((int)0),
 	     m_type(VAR_NULL),
 	     m_name(""),
-	     m_debug(false), m_lock(false)
+	     m_debug(false), m_lock(false), m_version(0)
 {
 	setValue(v);
 }
@@ -155,6 +155,7 @@ void gkVariable::makeDefault(void)
 void gkVariable::reset(void)
 {
 	m_value = m_default;
+	++m_version;
 }
 
 
@@ -182,6 +183,7 @@ void gkVariable::setValue(gkScalar v)
 	{
 		m_type = VAR_REAL;
 		m_value = v;
+		++m_version;
 	}
 }
 
@@ -193,6 +195,7 @@ void gkVariable::setValue(bool v)
 	{
 		m_type = VAR_BOOL;
 		m_value = v;
+		++m_version;
 	}
 }
 
@@ -204,6 +207,7 @@ void gkVariable::setValue(int v)
 	{
 		m_type = VAR_INT;
 		m_value = v;
+		++m_version;
 	}
 }
 
@@ -214,6 +218,7 @@ void gkVariable::setValue(const gkString& v)
 	{
 		m_type = VAR_STRING;
 		m_value = v;
+		++m_version;
 	}
 }
 
@@ -224,6 +229,7 @@ void gkVariable::setValue(const gkVector2& v)
 	{
 		m_type = VAR_VEC2;
 		m_value = v;
+		++m_version;
 	}
 }
 
@@ -234,6 +240,7 @@ void gkVariable::setValue(const gkVector3& v)
 	{
 		m_type = VAR_VEC3;
 		m_value = v;
+		++m_version;
 	}
 }
 
@@ -244,6 +251,7 @@ void gkVariable::setValue(const gkVector4& v)
 	{
 		m_type = VAR_VEC4;
 		m_value = v;
+		++m_version;
 	}
 }
 
@@ -254,6 +262,7 @@ void gkVariable::setValue(const gkQuaternion& v)
 	{
 		m_type = VAR_QUAT;
 		m_value = v;
+		++m_version;
 	}
 }
 
@@ -264,6 +273,7 @@ void gkVariable::setValue(const gkMatrix3& v)
 	{
 		m_type = VAR_MAT3;
 		m_value = v;
+		++m_version;
 	}
 }
 
@@ -274,6 +284,7 @@ void gkVariable::setValue(const gkMatrix4& v)
 	{
 		m_type = VAR_MAT4;
 		m_value = v;
+		++m_version;
 	}
 }
 
@@ -284,6 +295,7 @@ void gkVariable::setValue(const gkVariable& v)
 	{
 		m_type  = v.m_type;
 		m_value = v.m_value;
+		++m_version;
 		m_debug = v.m_debug;
 		m_name  = v.m_name;
 	}
@@ -476,6 +488,7 @@ void gkVariable::assign(const gkString& o)
 	{
 		m_type  = VAR_STRING;
 		m_value = o;
+		++m_version;
 	}
 }
 
@@ -521,6 +534,7 @@ void gkVariable::assign(const gkVariable& nv)
 	{
 		m_type  = nv.m_type;
 		m_value = nv.m_value;
+		++m_version;
 	}
 }
 
@@ -80,6 +80,9 @@ public:
 	GK_INLINE bool  isDebug(void) const           { return m_debug; }
 	GK_INLINE const gkString& getName(void) const { return m_name; }
 
+	///Changes every time the value is written, lets observers poll for changes cheaply.
+	GK_INLINE UTuint32 getVersion(void) const     { return m_version; }
+
 	void setValue(int type, const gkString& v);
 
 
@@ -141,6 +144,7 @@ private:
 	int          m_type;
 	gkString     m_name;
 	bool         m_debug, m_lock;
+	UTuint32     m_version;
 };
 
 
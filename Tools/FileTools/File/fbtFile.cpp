@@ -30,6 +30,12 @@
 #include "fbtTables.h"
 #include "fbtPlatformHeaders.h"
 
+#if FBT_PLATFORM != FBT_PLATFORM_WIN32
+# include <pthread.h>
+# include <unistd.h>
+# include <sys/time.h>
+#endif
+
 // Common Identifiers
 const FBTuint32 ENDB = FBT_ID('E', 'N', 'D', 'B');
 const FBTuint32 DNA1 = FBT_ID('D', 'N', 'A', '1');
@@ -53,6 +59,12 @@ FBT_ASSERTCOMP(ChunkLenNative, sizeof(fbtFile::Chunk64) == sizeof(fbtFile::Chunk
 #define FBT_INVALID_INS     fbtPrintf("Table insertion failed!\n");
 #define FBT_LINK_FAILED     fbtPrintf("Linking failed!\n");
 
+// Link threads are only started for this many bytes of conversion work each
+#ifndef FBT_LINK_MIN_WORK
+#define FBT_LINK_MIN_WORK   (256 * 1024)
+#endif
+#define FBT_LINK_MAX_THREADS 16
+
 
 struct fbtChunk
 {
@@ -70,10 +82,42 @@ struct fbtChunk
 
 
 
+static FBTuint64 fbtGetMicroseconds(void)
+{
+#if FBT_PLATFORM == FBT_PLATFORM_WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (FBTuint64)(count.QuadPart / freq.QuadPart) * 1000000 +
+	       (FBTuint64)(count.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart;
+#else
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return (FBTuint64)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+
+static int fbtGetNumCores(void)
+{
+#if FBT_PLATFORM == FBT_PLATFORM_WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	return (int)sysconf(_SC_NPROCESSORS_ONLN);
+#else
+	return 1;
+#endif
+}
+
+
+
 fbtFile::fbtFile(const char* uid)
 	:   m_version(-1), m_fileVersion(0), m_fileHeader(0), m_uhid(uid), m_aluhid(0),
-	    m_memory(0), m_file(0), m_curFile(0)
+	    m_memory(0), m_file(0), m_curFile(0), m_mapping(0), m_inPlace(0), m_rawInPlace(0), m_linkThreads(0)
 {
+	fbtMemset(&m_stats, 0, sizeof(LoadStats));
 }
 
 
@@ -86,15 +130,15 @@ fbtFile::~fbtFile()
 	MemoryChunk* node = (MemoryChunk*)m_chunks.first, *tnd;
 	while (node)
 	{
-		if (node->m_block)
+		if (node->m_block && node->m_block != node->m_newBlock)
 		{
 			//printf("free  m_block: 0x%x\n", node->m_block);fflush(stdout);
-			fbtFree(node->m_block);
+			freeBlock(node->m_block);
 		}
 		if (node->m_newBlock)
 		{
 			//printf("free m_newBlock: 0x%x\n", node->m_newBlock);fflush(stdout);
-			fbtFree(node->m_newBlock);
+			freeBlock(node->m_newBlock);
 		}
 
 		tnd  = node;
@@ -105,6 +149,15 @@ fbtFile::~fbtFile()
 
 	delete m_file;
 	delete m_memory;
+	delete m_mapping;
+}
+
+
+void fbtFile::freeBlock(void* block)
+{
+	// blocks inside the mapping go away with it
+	if (block && !(m_mapping && m_mapping->contains(block)))
+		fbtFree(block);
 }
 
 
@@ -112,8 +165,32 @@ fbtFile::~fbtFile()
 int fbtFile::parse(const char* path, int mode)
 {
 	fbtStream* stream = 0;
+	FBTuint64 start = fbtGetMicroseconds();
+
+	if (mode == PM_MAPPED)
+	{
+		// one mapping per file object, chunks of an earlier parse may still point into it
+		if (!m_mapping)
+		{
+			fbtMappedStream* ms = new fbtMappedStream();
+			ms->open(path, fbtStream::SM_READ);
+
+			const unsigned char* magic = (const unsigned char*)ms->ptr();
+			if (ms->isOpen() && ms->size() > 2 && !(magic[0] == 0x1f && magic[1] == 0x8b))
+				stream = m_mapping = ms;
+			else
+				delete ms;
+		}
 
-	if (mode == PM_UNCOMPRESSED || mode == PM_COMPRESSED)
+		if (!stream)
+			mode = PM_COMPRESSED;
+	}
+
+	if (stream)
+	{
+		// already open
+	}
+	else if (mode == PM_UNCOMPRESSED || mode == PM_COMPRESSED)
 	{
 #if FBT_USE_GZ_FILE == 1
 		if (mode == PM_COMPRESSED)
@@ -151,8 +228,14 @@ int fbtFile::parse(const char* path, int mode)
 		m_curFile[pl] = 0;
 	}
 
+	FBTuint64 open = fbtGetMicroseconds() - start;
+
 	int result = parseStreamImpl(stream);
-	delete stream;
+	if (stream != m_mapping)
+		delete stream;
+
+	m_stats.m_open   = open;
+	m_stats.m_total += open;
 	return result;
 }
 
@@ -220,6 +303,9 @@ int fbtFile::parseStreamImpl(fbtStream* stream, bool suppressHeaderWarning)
 {
 	int status;
 
+	fbtMemset(&m_stats, 0, sizeof(LoadStats));
+	FBTuint64 start = fbtGetMicroseconds(), mark;
+
 	status = parseHeader(stream,suppressHeaderWarning);
 	if (status != FS_OK)
 	{
@@ -227,8 +313,11 @@ int fbtFile::parseStreamImpl(fbtStream* stream, bool suppressHeaderWarning)
 		return status;
 	}
 
+	m_stats.m_header = fbtGetMicroseconds() - start;
+
 	if (!m_memory)
 	{
+		mark = fbtGetMicroseconds();
 		m_memory = new fbtBinTables();
 
 		status = initializeTables(m_memory);
@@ -237,6 +326,7 @@ int fbtFile::parseStreamImpl(fbtStream* stream, bool suppressHeaderWarning)
 			fbtPrintf("Failed to initialize builtin tables\n");
 			return status;
 		}
+		m_stats.m_dna = fbtGetMicroseconds() - mark;
 	}
 
 
@@ -249,6 +339,11 @@ int fbtFile::parseStreamImpl(fbtStream* stream, bool suppressHeaderWarning)
 
 	// preallocate table
 	m_map.reserve(fbtDefaultAlloc);
+	m_inPlace = 0;
+	m_rawInPlace = 0;
+
+	// chunks are used straight from the mapping
+	char* mapped = m_mapping && stream == m_mapping ? m_mapping->ptr() : 0;
 
 
 	Chunk chunk;
@@ -277,22 +372,40 @@ int fbtFile::parseStreamImpl(fbtStream* stream, bool suppressHeaderWarning)
 			break;
 
 
-		void* curPtr = fbtMalloc(chunk.m_len);
-		//printf("alloc curPtr: 0x%x\n", curPtr);fflush(stdout);
-		if (!curPtr)
+		void* curPtr;
+		if (mapped && chunk.m_code != DNA1)
 		{
-			FBT_MALLOC_FAILED;
-			return FS_BAD_ALLOC;
-		}
+			if (chunk.m_len > stream->size() - stream->position())
+			{
+				FBT_INVALID_READ;
+				return FS_INV_READ;
+			}
 
-		if (stream->read(curPtr, chunk.m_len) <= 0)
+			curPtr = mapped + stream->position();
+			stream->seek(chunk.m_len, SEEK_CUR);
+		}
+		else
 		{
-			FBT_INVALID_READ;
-			return FS_INV_READ;
+			// the tables take over their block, it is never mapped
+			curPtr = fbtMalloc(chunk.m_len);
+			//printf("alloc curPtr: 0x%x\n", curPtr);fflush(stdout);
+			if (!curPtr)
+			{
+				FBT_MALLOC_FAILED;
+				return FS_BAD_ALLOC;
+			}
+
+			if (stream->read(curPtr, chunk.m_len) <= 0)
+			{
+				FBT_INVALID_READ;
+				return FS_INV_READ;
+			}
 		}
 
 		if (chunk.m_code == DNA1)
 		{
+			mark = fbtGetMicroseconds();
+
 			m_file = new fbtBinTables(curPtr, chunk.m_len);
 			m_file->m_ptr = m_fileHeader & FH_CHUNK_64 ? 8 : 4;
 
@@ -305,11 +418,19 @@ int fbtFile::parseStreamImpl(fbtStream* stream, bool suppressHeaderWarning)
 
 			compileOffsets();
 
+			m_stats.m_scan = mark - start - m_stats.m_header - m_stats.m_dna;
+			m_stats.m_dna += fbtGetMicroseconds() - mark;
+			mark = fbtGetMicroseconds();
+
 			if ((status = link()) != FS_OK)
 			{
 				FBT_LINK_FAILED;
 				return FS_LINK_FAILED;
 			}
+
+			m_stats.m_link   = fbtGetMicroseconds() - mark;
+			m_stats.m_chunks = m_map.size();
+			m_stats.m_total  = fbtGetMicroseconds() - start;
 			break;
 		}
 		else
@@ -318,7 +439,7 @@ int fbtFile::parseStreamImpl(fbtStream* stream, bool suppressHeaderWarning)
 			FBTsizeType pos;
 			if ((pos = m_map.find(chunk.m_old)) != FBT_NPOS)
 			{
-				fbtFree(curPtr);
+				freeBlock(curPtr);
 				curPtr = 0;
 				int result = fbtMemcmp(&m_map.at(pos)->m_chunk, &chunk, fbtChunk::BlockSize);
 				if (result != 0)
@@ -331,7 +452,7 @@ int fbtFile::parseStreamImpl(fbtStream* stream, bool suppressHeaderWarning)
 			if (m_map.find(chunk.m_old) != FBT_NPOS)
 			{
 				//printf("free  curPtr: 0x%x\n", curPtr);
-				fbtFree(curPtr);
+				freeBlock(curPtr);
 				curPtr = 0;
 			}
 #endif
@@ -542,21 +663,254 @@ void castValue(FBTsize* srcPtr, FBTsize* dstPtr, FBT_PRIM_TYPE srctp, FBT_PRIM_T
 }
 
 
+// Raw data has no struct to tell, chunks are 4 byte aligned. Blocks of 8 byte
+// values need more, see fbtIsWidePointer.
+#define FBT_RAW_ALIGN  4
+#define FBT_WIDE_ALIGN 8
+
+
+// Alignment of the memory struct: its widest member, pointers included.
+// Members are flattened, so every one is a pointer or a primitive.
+static FBTsize fbtStructAlignment(fbtBinTables* mp, fbtStruct* strc)
+{
+	fbtStruct::Members::Pointer md = strc->m_members.ptr();
+	FBTsizeType i, s = strc->m_members.size();
+	FBTsize align = 1;
+
+	for (i = 0; i < s; i++)
+	{
+		const fbtName& name = mp->m_name[md[i].m_key.k16[1]];
+		align = fbtMax<FBTsize>(align, name.m_ptrCount ? mp->m_ptr : mp->m_tlen[md[i].m_key.k16[0]]);
+	}
+	return align;
+}
+
+
+// Blocks used in place must be aligned for their struct. File chunks are only
+// 4 byte aligned, the others are copied.
+static bool fbtIsInPlaceAligned(const void* block, FBTsize align)
+{
+	return ((FBTsize)block % align) == 0;
+}
+
+
+// True when the member may point to raw data of 8 byte values: a void* or a
+// pointer to a wide primitive. Pointers to structs point to typed blocks.
+static bool fbtIsWidePointer(fbtBinTables* mp, const fbtStruct* member)
+{
+	FBTtype type = (FBTtype)member->m_key.k16[0];
+
+	if (mp->m_name[member->m_key.k16[1]].m_ptrCount != 1 || type >= mp->m_strc[0][0])
+		return false;
+	return mp->m_tlen[type] == 0 || mp->m_tlen[type] > 4;
+}
+
+
+// Reads a pointer of the file's size, the way fbtChunk::read reads the chunk
+// addresses. Members of file blocks may be misaligned, so it is read bytewise.
+static FBTsize fbtLoadPointer(const void* src, FBTuint8 size)
+{
+	union
+	{
+		FBTuint64   m_ptr;
+		FBTuint32   m_doublePtr[2];
+	} ptr;
+
+	if (size == 4)
+	{
+		fbtMemcpy(&ptr.m_doublePtr[0], src, 4);
+		return (FBTsize)ptr.m_doublePtr[0];
+	}
+
+	fbtMemcpy(&ptr.m_ptr, src, 8);
+#if FBT_ARCH == FBT_ARCH_32
+	return ptr.m_doublePtr[0] != 0 ? ptr.m_doublePtr[0] : ptr.m_doublePtr[1];
+#else
+	return (FBTsize)ptr.m_ptr;
+#endif
+}
+
+
+// True when every member of the memory struct sits at the same offset with the same
+// type and size in the file struct, so a file block can be used without conversion.
+static bool fbtCanLinkInPlace(fbtBinTables* mp, fbtBinTables* fp, fbtStruct* strc)
+{
+	if (!strc->m_link || strc->m_link->m_len != strc->m_len)
+		return false;
+
+	fbtStruct::Members::Pointer md = strc->m_members.ptr();
+	FBTsizeType i, s = strc->m_members.size();
+
+	for (i = 0; i < s; i++)
+	{
+		fbtStruct* dst = &md[i];
+		fbtStruct* src = dst->m_link;
+
+		if (!src || src->m_off != dst->m_off || src->m_len != dst->m_len)
+			return false;
+
+		if ((dst->m_flag & fbtStruct::NEED_CAST) || src->m_val.k32[0] != dst->m_val.k32[0])
+			return false;
+
+		const fbtName& nameD = mp->m_name[dst->m_key.k16[1]];
+		const fbtName& nameS = fp->m_name[src->m_key.k16[1]];
+
+		if (nameD.m_ptrCount != nameS.m_ptrCount || nameD.m_arraySize != nameS.m_arraySize)
+			return false;
+	}
+
+	return true;
+}
+
+
+// True when a member of the struct is a pointer to a pointer array, these
+// replace the array chunk and are resolved before the conversion.
+static bool fbtHasPointerArrays(fbtBinTables* mp, fbtStruct* strc)
+{
+	fbtStruct::Members::Pointer md = strc->m_members.ptr();
+	FBTsizeType i, s = strc->m_members.size();
+
+	for (i = 0; i < s; i++)
+	{
+		if (md[i].m_link && mp->m_name[md[i].m_key.k16[1]].m_ptrCount > 1)
+			return true;
+	}
+	return false;
+}
+
+
+// Converts a slice of the chunk list on its own thread.
+class fbtLinkJob
+{
+public:
+	typedef fbtFile::MemoryChunk MemoryChunk;
+
+	fbtFile*            m_fp;
+	MemoryChunk**       m_nodes;
+	FBTsizeType         m_first, m_last;
+	fbtArray<FBTuint64> m_times;
+	bool                m_started;
+
+#if FBT_PLATFORM == FBT_PLATFORM_WIN32
+	HANDLE              m_thread;
+#else
+	pthread_t           m_thread;
+#endif
+
+	fbtLinkJob() : m_fp(0), m_nodes(0), m_first(0), m_last(0), m_started(false) {}
+
+	void run(void)
+	{
+		for (FBTsizeType i = m_first; i < m_last; ++i)
+		{
+			MemoryChunk* node = m_nodes[i];
+
+			FBTuint64 start = fbtGetMicroseconds();
+			m_fp->linkChunk(node);
+			m_times[node->m_newTypeId] += fbtGetMicroseconds() - start;
+		}
+	}
+
+	void start(void);
+	void join(void);
+};
+
+
+#if FBT_PLATFORM == FBT_PLATFORM_WIN32
+
+static DWORD WINAPI fbtLinkThread(LPVOID job)
+{
+	static_cast<fbtLinkJob*>(job)->run();
+	return 0;
+}
+
+void fbtLinkJob::start(void)
+{
+	m_thread  = CreateThread(0, 0, fbtLinkThread, this, 0, 0);
+	m_started = m_thread != 0;
+	if (!m_started)
+		run();
+}
+
+void fbtLinkJob::join(void)
+{
+	if (m_started)
+	{
+		WaitForSingleObject(m_thread, INFINITE);
+		CloseHandle(m_thread);
+		m_started = false;
+	}
+}
+
+#else
+
+static void* fbtLinkThread(void* job)
+{
+	static_cast<fbtLinkJob*>(job)->run();
+	return 0;
+}
+
+void fbtLinkJob::start(void)
+{
+	m_started = pthread_create(&m_thread, 0, fbtLinkThread, this) == 0;
+	if (!m_started)
+		run();
+}
+
+void fbtLinkJob::join(void)
+{
+	if (m_started)
+	{
+		pthread_join(m_thread, 0);
+		m_started = false;
+	}
+}
+
+#endif
+
+
+// Relative cost of converting a chunk, used to split the chunk list evenly.
+static FBTsize fbtLinkWeight(const fbtFile::MemoryChunk* node)
+{
+	const FBTsize base = 64;
+	if (node->m_flag & fbtFile::MemoryChunk::BLK_IN_PLACE)
+		return base + node->m_chunk.m_len / 8;
+	return base + node->m_chunk.m_len;
+}
+
+
 int fbtFile::link(void)
 {
 	fbtBinTables::OffsM::Pointer md = m_memory->m_offs.ptr();
 	fbtBinTables::OffsM::Pointer fd = m_file->m_offs.ptr();
-	FBTsizeType s2, i2, a2, n;
-	fbtStruct::Members::Pointer p2;
-	FBTsize mlen, malen, total, pi;
-
-	char* dst, *src;
-	FBTsize* dstPtr, *srcPtr;
 
 	bool endianSwap = (m_fileHeader & FH_ENDIAN_SWAP) != 0;
 
 	static const FBThash hk = fbtCharHashKey("Link").hash();
 
+	FBTuint64 mark = fbtGetMicroseconds();
+
+
+	// per memory struct: 0 unknown, 1 in place, 2 rebuild
+	const bool sameLayout = !endianSwap && m_memory->m_ptr == m_file->m_ptr;
+	fbtArray<FBTuint8> inPlace;
+	inPlace.resize(m_memory->m_strcNr + 1);
+	fbtMemset(inPlace.ptr(), 0, inPlace.size());
+
+	// per memory struct: 0 unknown, 1 has pointer arrays, 2 none
+	fbtArray<FBTuint8> ptrArrays;
+	ptrArrays.resize(m_memory->m_strcNr + 1);
+	fbtMemset(ptrArrays.ptr(), 0, ptrArrays.size());
+
+	// per memory struct: 0 unknown, else the alignment of its blocks
+	fbtArray<FBTuint8> alignment;
+	alignment.resize(m_memory->m_strcNr + 1);
+	fbtMemset(alignment.ptr(), 0, alignment.size());
+
+
+	// raw blocks that could hold 8 byte values but are not aligned for them
+	FBTsizeType misalignedRaw = 0;
+
 
 	MemoryChunk* node;
 	for (node = (MemoryChunk*)m_chunks.first; node; node = node->m_next)
@@ -572,6 +926,18 @@ int fbtFile::link(void)
 
 		if (m_memory->m_type[ms->m_key.k16[0]].m_typeId == hk)
 		{
+			// raw data, nothing to convert
+			if (fbtIsInPlaceAligned(node->m_block, FBT_RAW_ALIGN))
+			{
+				node->m_newBlock = node->m_block;
+				node->m_flag |= MemoryChunk::BLK_IN_PLACE | MemoryChunk::BLK_RAW;
+				m_rawInPlace++;
+
+				if (node->m_chunk.m_len % FBT_WIDE_ALIGN == 0 && !fbtIsInPlaceAligned(node->m_block, FBT_WIDE_ALIGN))
+					misalignedRaw++;
+				continue;
+			}
+
 			FBTsize totSize = node->m_chunk.m_len;
 			node->m_newBlock = fbtMalloc(totSize);
 			//printf("alloc1 m_newBlock: 0x%x %d\n", node->m_newBlock, totSize);fflush(stdout);
@@ -590,9 +956,31 @@ int fbtFile::link(void)
 		if (skip(m_memory->m_type[ms->m_key.k16[0]].m_typeId))
 			continue;
 
+		if (ptrArrays[ms->m_strcId] == 0)
+			ptrArrays[ms->m_strcId] = fbtHasPointerArrays(m_memory, ms) ? 1 : 2;
 
 		FBTsize totSize = (node->m_chunk.m_nr * ms->m_len);
 
+		if (alignment[ms->m_strcId] == 0)
+			alignment[ms->m_strcId] = (FBTuint8)fbtStructAlignment(m_memory, ms);
+
+		if (sameLayout && totSize <= node->m_chunk.m_len && fbtIsInPlaceAligned(node->m_block, alignment[ms->m_strcId]))
+		{
+			FBTuint8& state = inPlace[ms->m_strcId];
+			if (state == 0)
+				state = fbtCanLinkInPlace(m_memory, m_file, ms) ? 1 : 2;
+
+			if (state == 1)
+			{
+				// only pointers are patched, below
+				node->m_chunk.m_len = totSize;
+				node->m_newBlock = node->m_block;
+				node->m_flag |= MemoryChunk::BLK_IN_PLACE;
+				m_inPlace++;
+				continue;
+			}
+		}
+
 		node->m_chunk.m_len = totSize;
 
 
@@ -607,13 +995,89 @@ int fbtFile::link(void)
 
 
 
-		// always zero this
-		fbtMemset(node->m_newBlock, 0, totSize);
+		// Always zero this. Chunks with pointer arrays are written to before the
+		// conversion, the others are zeroed by it.
+		if (ptrArrays[ms->m_strcId] == 1)
+		{
+			fbtMemset(node->m_newBlock, 0, totSize);
+			node->m_flag |= MemoryChunk::BLK_ZEROED;
+		}
+	}
+
+
+
+	// Misaligned raw blocks are copied when a wide pointer refers to them
+	if (misalignedRaw > 0)
+	{
+		// per memory struct: 0 unknown, 1 has wide pointers, 2 none
+		fbtArray<FBTuint8> widePtrs;
+		widePtrs.resize(m_memory->m_strcNr + 1);
+		fbtMemset(widePtrs.ptr(), 0, widePtrs.size());
+
+		for (node = (MemoryChunk*)m_chunks.first; node; node = node->m_next)
+		{
+			if (!node->m_newBlock)
+				continue;
+
+			fbtStruct* cs = md[node->m_newTypeId];
+			if (!cs->m_link || m_memory->m_type[cs->m_key.k16[0]].m_typeId == hk)
+				continue;
+
+			fbtStruct::Members::Pointer mm = cs->m_members.ptr();
+			FBTsizeType i, s = cs->m_members.size(), n;
+
+			FBTuint8& state = widePtrs[cs->m_strcId];
+			if (state == 0)
+			{
+				state = 2;
+				for (i = 0; i < s && state == 2; i++)
+					state = mm[i].m_link && fbtIsWidePointer(m_memory, &mm[i]) ? 1 : 2;
+			}
+			if (state == 2)
+				continue;
+
+			for (n = 0; n < node->m_chunk.m_nr; ++n)
+			{
+				const char* src = static_cast<const char*>(node->m_block) + (cs->m_link->m_len * n);
+
+				for (i = 0; i < s; i++)
+				{
+					if (!mm[i].m_link || !fbtIsWidePointer(m_memory, &mm[i]))
+						continue;
+
+					FBTsize oldPtr = fbtLoadPointer(src + mm[i].m_link->m_off, m_file->m_ptr);
+					MemoryChunk* bin = oldPtr ? findBlock(oldPtr) : 0;
+
+					if (!bin || !(bin->m_flag & MemoryChunk::BLK_IN_PLACE) ||
+					        m_memory->m_type[md[bin->m_newTypeId]->m_key.k16[0]].m_typeId != hk ||
+					        fbtIsInPlaceAligned(bin->m_block, FBT_WIDE_ALIGN))
+						continue;
+
+					bin->m_newBlock = fbtMalloc(bin->m_chunk.m_len);
+					if (!bin->m_newBlock)
+					{
+						FBT_MALLOC_FAILED;
+						return FS_BAD_ALLOC;
+					}
+
+					fbtMemcpy(bin->m_newBlock, bin->m_block, bin->m_chunk.m_len);
+					bin->m_flag &= ~MemoryChunk::BLK_IN_PLACE;
+					m_rawInPlace--;
+				}
+			}
+		}
 	}
 
 
 
-	FBTuint8 mps = m_memory->m_ptr, fps = m_file->m_ptr;
+	m_structStats.resize(m_memory->m_strcNr + 1);
+	fbtMemset(m_structStats.ptr(), 0, m_structStats.size() * sizeof(StructStats));
+
+
+	// Pointer arrays replace other chunks, so they are resolved here first. After this
+	// the conversion only writes to its own chunk and can be split over threads.
+	fbtArray<MemoryChunk*> work;
+	FBTsize workSize = 0, workWeight = 0;
 
 	for (node = (MemoryChunk*)m_chunks.first; node; node = node->m_next)
 	{
@@ -621,194 +1085,333 @@ int fbtFile::link(void)
 			continue;
 
 
-
 		fbtStruct* cs = md[node->m_newTypeId];
-		if (m_memory->m_type[cs->m_key.k16[0]].m_typeId == hk)
-			continue;
+		bool raw = m_memory->m_type[cs->m_key.k16[0]].m_typeId == hk;
 
-		if (!cs->m_link || skip(m_memory->m_type[cs->m_key.k16[0]].m_typeId) || !node->m_newBlock)
+		if (!raw && (!cs->m_link || skip(m_memory->m_type[cs->m_key.k16[0]].m_typeId) || !node->m_newBlock))
 		{
 			//printf("free  m_newBlock: 0x%x \n", node->m_newBlock);fflush(stdout);
 
-			fbtFree(node->m_newBlock);
+			if (!(node->m_flag & MemoryChunk::BLK_IN_PLACE))
+				fbtFree(node->m_newBlock);
 			node->m_newBlock = 0;
 
 			continue;
 		}
 
-		s2 = cs->m_members.size();
-		p2 = cs->m_members.ptr();
+		StructStats& stats = m_structStats[node->m_newTypeId];
+		stats.m_chunks++;
+		stats.m_bytes += node->m_chunk.m_len;
+
+		if (raw)
+			continue;
+
+		if (ptrArrays[cs->m_strcId] == 1)
+			linkPointerArrays(node);
+
+		work.push_back(node);
+
+		if (!(node->m_flag & MemoryChunk::BLK_IN_PLACE))
+			workSize += node->m_chunk.m_len;
+		workWeight += fbtLinkWeight(node);
+	}
+
+	m_stats.m_linkAlloc = fbtGetMicroseconds() - mark;
+	mark += m_stats.m_linkAlloc;
+
+
+
+	int nrThreads = m_linkThreads;
+	if (nrThreads <= 0)
+		nrThreads = fbtMin(fbtGetNumCores(), (int)fbtMin(workSize / FBT_LINK_MIN_WORK + 1, (FBTsize)FBT_LINK_MAX_THREADS));
+	nrThreads = fbtMax(1, fbtMin(nrThreads, FBT_LINK_MAX_THREADS));
+
+
+	fbtLinkJob jobs[FBT_LINK_MAX_THREADS];
+	FBTsizeType first = 0, nr = work.size();
+	FBTsize weight = 0;
+	int t;
+
+	for (t = 0; t < nrThreads; ++t)
+	{
+		fbtLinkJob& job = jobs[t];
+		job.m_fp    = this;
+		job.m_nodes = work.ptr();
+		job.m_first = first;
+
+		FBTsize end = workWeight / nrThreads * (t + 1);
+		while (first < nr && (weight < end || t == nrThreads - 1))
+			weight += fbtLinkWeight(work[first++]);
+
+		job.m_last  = first;
+
+		job.m_times.resize(m_memory->m_strcNr + 1);
+		fbtMemset(job.m_times.ptr(), 0, job.m_times.size() * sizeof(FBTuint64));
+	}
+
+	// the calling thread takes the first slice
+	for (t = 1; t < nrThreads; ++t)
+		jobs[t].start();
+
+	jobs[0].run();
+
+	for (t = 1; t < nrThreads; ++t)
+		jobs[t].join();
+
+	for (t = 0; t < nrThreads; ++t)
+	{
+		for (FBTsizeType i = 0; i < m_structStats.size(); ++i)
+			m_structStats[i].m_time += jobs[t].m_times[i];
+	}
+
+	m_stats.m_threads     = nrThreads;
+	m_stats.m_linkConvert = fbtGetMicroseconds() - mark;
+	mark += m_stats.m_linkConvert;
+
+
+
+	for (FBTsizeType i = 0; i < nr; ++i)
+		notifyData(work[i]->m_newBlock, work[i]->m_chunk);
+
+	m_stats.m_linkNotify = fbtGetMicroseconds() - mark;
+
 
-		for (n = 0; n < node->m_chunk.m_nr; ++n)
+
+	for (node = (MemoryChunk*)m_chunks.first; node; node = node->m_next)
+	{
+		if (node->m_block)
 		{
-			dst = static_cast<char*>(node->m_newBlock) + (cs->m_len * n);
-			src = static_cast<char*>(node->m_block) + (cs->m_link->m_len * n);
+			if (node->m_block != node->m_newBlock)
+				freeBlock(node->m_block);
+			node->m_block = 0;
+		}
+	}
 
+	return fbtFile::FS_OK;
+}
 
-			for (i2 = 0; i2 < s2; ++i2)
-			{
-				fbtStruct* dstStrc = &p2[i2];
-				fbtStruct* srcStrc = dstStrc->m_link;
 
-				// If it's missing we can safely skip this block
-				if (!srcStrc)
-					continue;
+void fbtFile::linkPointerArrays(MemoryChunk* node)
+{
+	fbtStruct* cs = m_memory->m_offs.at(node->m_newTypeId);
 
+	FBTsizeType s2 = cs->m_members.size(), i2, n;
+	fbtStruct::Members::Pointer p2 = cs->m_members.ptr();
 
-				dstPtr = reinterpret_cast<FBTsize*>(dst + dstStrc->m_off);
-				srcPtr = reinterpret_cast<FBTsize*>(src + srcStrc->m_off);
+	FBTuint8 mps = m_memory->m_ptr, fps = m_file->m_ptr;
+	FBTsize total, pi;
 
+	for (n = 0; n < node->m_chunk.m_nr; ++n)
+	{
+		char* dst = static_cast<char*>(node->m_newBlock) + (cs->m_len * n);
+		char* src = static_cast<char*>(node->m_block) + (cs->m_link->m_len * n);
 
+		for (i2 = 0; i2 < s2; ++i2)
+		{
+			fbtStruct* dstStrc = &p2[i2];
+			fbtStruct* srcStrc = dstStrc->m_link;
 
-				const fbtName& nameD = m_memory->m_name[dstStrc->m_key.k16[1]];
-				const fbtName& nameS = m_file->m_name[srcStrc->m_key.k16[1]];
+			if (!srcStrc || m_memory->m_name[dstStrc->m_key.k16[1]].m_ptrCount < 2)
+				continue;
 
+			FBTsize* dstPtr = reinterpret_cast<FBTsize*>(dst + dstStrc->m_off);
+			FBTsize* srcPtr = reinterpret_cast<FBTsize*>(src + srcStrc->m_off);
 
-				if (nameD.m_ptrCount > 0)
-				{
-					if ((*srcPtr))
-					{
-						if (nameD.m_ptrCount  > 1)
-						{
-							MemoryChunk* bin = findBlock((FBTsize)(*srcPtr));
-							if (bin)
-							{
-								if (bin->m_flag & MemoryChunk::BLK_MODIFIED)
-									(*dstPtr) = (FBTsize)bin->m_newBlock;
-								else
-								{
-									// take pointer size out of the equation
-									total = bin->m_chunk.m_len / fps;
-
-
-									FBTsize* nptr = (FBTsize*)fbtMalloc(total * mps);
-									fbtMemset(nptr, 0, total * mps);
-
-									// always use 32 bit, then offset + 2 for 64 bit (Old pointers are sorted in this mannor)
-									FBTuint32* optr = (FBTuint32*)bin->m_block;
-
-
-									for (pi = 0; pi < total; pi++, optr += (fps == 4 ? 1 : 2))
-										nptr[pi] = (FBTsize)findPtr((FBTsize) * optr);
-
-									(*dstPtr) = (FBTsize)(nptr);
-
-									bin->m_chunk.m_len = total * mps;
-									bin->m_flag |= MemoryChunk::BLK_MODIFIED;
-
-									fbtFree(bin->m_newBlock);
-									bin->m_newBlock = nptr;
-								}
-							}
-							else
-							{
-								//fbtPrintf("**block not found @ 0x%p)\n", src);
-							}
-						}
-						else
-						{
-							malen = nameD.m_arraySize > nameS.m_arraySize ? nameS.m_arraySize : nameD.m_arraySize;
+			FBTsize oldPtr = fbtLoadPointer(srcPtr, fps);
+			if (!oldPtr)
+				continue;
 
-							FBTsize* dptr = (FBTsize*)dstPtr;
+			MemoryChunk* bin = findBlock(oldPtr);
+			if (!bin)
+			{
+				//fbtPrintf("**block not found @ 0x%p)\n", src);
+				continue;
+			}
 
-							// always use 32 bit, then offset + 2 for 64 bit (Old pointers are sorted in this mannor)
-							FBTuint32* sptr = (FBTuint32*)srcPtr;
+			if (bin->m_flag & MemoryChunk::BLK_MODIFIED)
+			{
+				(*dstPtr) = (FBTsize)bin->m_newBlock;
+				continue;
+			}
 
+			// take pointer size out of the equation
+			total = bin->m_chunk.m_len / fps;
 
-							for (a2 = 0; a2 < malen; ++a2, sptr += (fps == 4 ? 1 : 2))
-								dptr[a2] = (FBTsize)findPtr((FBTsize) * sptr);
-						}
-					}
-				}
+
+			FBTsize* nptr = (FBTsize*)fbtMalloc(total * mps);
+			fbtMemset(nptr, 0, total * mps);
+
+			const char* optr = static_cast<const char*>(bin->m_block);
+
+			for (pi = 0; pi < total; pi++, optr += fps)
+				nptr[pi] = (FBTsize)findPtr(fbtLoadPointer(optr, fps));
+
+			(*dstPtr) = (FBTsize)(nptr);
+
+			bin->m_chunk.m_len = total * mps;
+			bin->m_flag |= MemoryChunk::BLK_MODIFIED;
+
+			if (bin->m_flag & MemoryChunk::BLK_IN_PLACE)
+			{
+				bin->m_flag &= ~MemoryChunk::BLK_IN_PLACE;
+				if (bin->m_flag & MemoryChunk::BLK_RAW)
+					m_rawInPlace--;
 				else
-				{
-					FBTsize dstElmSize = dstStrc->m_len / nameD.m_arraySize;
-					FBTsize srcElmSize = srcStrc->m_len / nameS.m_arraySize;
+					m_inPlace--;
+			}
+			else
+				fbtFree(bin->m_newBlock);
+			bin->m_newBlock = nptr;
+		}
+	}
+}
 
-					bool needCast = (dstStrc->m_flag & fbtStruct::NEED_CAST) != 0;
-					bool needSwap = endianSwap && srcElmSize > 1;
 
-					if (!needCast && !needSwap && srcStrc->m_val.k32[0] == dstStrc->m_val.k32[0]) //same type
-					{						
-						// Take the minimum length of any array.
-						mlen = fbtMin(srcStrc->m_len, dstStrc->m_len);
+// Called from the link threads, it may only write to the node's own block.
+void fbtFile::linkChunk(MemoryChunk* node)
+{
+	fbtStruct* cs = m_memory->m_offs.at(node->m_newTypeId);
 
-						fbtMemcpy(dstPtr, srcPtr, mlen);
-						continue;
-					}
+	FBTsizeType s2 = cs->m_members.size(), i2, a2, n;
+	fbtStruct::Members::Pointer p2 = cs->m_members.ptr();
 
-					FBTbyte* dstBPtr = reinterpret_cast<FBTbyte*>(dstPtr);
-					FBTbyte* srcBPtr = reinterpret_cast<FBTbyte*>(srcPtr);
+	FBTuint8 fps = m_file->m_ptr;
+	FBTsize mlen, malen;
 
-					FBT_PRIM_TYPE stp = FBT_PRIM_UNKNOWN, dtp  = FBT_PRIM_UNKNOWN;
+	bool endianSwap = (m_fileHeader & FH_ENDIAN_SWAP) != 0;
 
-					if (needCast || needSwap)
-					{
-						stp = fbtGetPrimType(srcStrc->m_val.k32[0]);
-						dtp = fbtGetPrimType(dstStrc->m_val.k32[0]);
+	// replaced by a pointer array
+	if (node->m_flag & MemoryChunk::BLK_MODIFIED)
+		return;
 
-						FBT_ASSERT(fbtIsNumberType(stp) && fbtIsNumberType(dtp) && stp != dtp);
-					}
+	const bool nodeInPlace = (node->m_flag & MemoryChunk::BLK_IN_PLACE) != 0;
 
-					FBTsize alen = fbtMin(nameS.m_arraySize, nameD.m_arraySize);
-					FBTsize elen = fbtMin(srcElmSize, dstElmSize);
+	if (!nodeInPlace && !(node->m_flag & MemoryChunk::BLK_ZEROED))
+		fbtMemset(node->m_newBlock, 0, node->m_chunk.m_len);
 
-					FBTbyte tmpBuf[8] = {0, };
-					FBTsize i;
-					for (i = 0; i < alen; i++)
-					{
-						FBTbyte* tmp = srcBPtr;
-						if (needSwap)
-						{
-							tmp = tmpBuf;
-							fbtMemcpy(tmpBuf, srcBPtr, srcElmSize);
-
-							if (stp == FBT_PRIM_SHORT || stp == FBT_PRIM_USHORT) 
-								fbtSwap16((FBTuint16*)tmpBuf, 1);
-							else if (stp >= FBT_PRIM_INT && stp <= FBT_PRIM_FLOAT) 
-								fbtSwap32((FBTuint32*)tmpBuf, 1);
-							else if (stp == FBT_PRIM_DOUBLE)
-								fbtSwap64((FBTuint64*)tmpBuf, 1);
-							else
-								fbtMemset(tmpBuf, 0, sizeof(tmpBuf)); //unknown type
-						}
-						
-						if (needCast)
-							castValue((FBTsize*)tmp, (FBTsize*)dstBPtr, stp, dtp, 1);
-						else
-							fbtMemcpy(dstBPtr, tmp, elen);
+	for (n = 0; n < node->m_chunk.m_nr; ++n)
+	{
+		char* dst = static_cast<char*>(node->m_newBlock) + (cs->m_len * n);
+		char* src = static_cast<char*>(node->m_block) + (cs->m_link->m_len * n);
+
+
+		for (i2 = 0; i2 < s2; ++i2)
+		{
+			fbtStruct* dstStrc = &p2[i2];
+			fbtStruct* srcStrc = dstStrc->m_link;
+
+			// If it's missing we can safely skip this block
+			if (!srcStrc)
+				continue;
+
+
+			FBTsize* dstPtr = reinterpret_cast<FBTsize*>(dst + dstStrc->m_off);
+			FBTsize* srcPtr = reinterpret_cast<FBTsize*>(src + srcStrc->m_off);
+
+
+
+			const fbtName& nameD = m_memory->m_name[dstStrc->m_key.k16[1]];
+			const fbtName& nameS = m_file->m_name[srcStrc->m_key.k16[1]];
+
+			// values are already where they belong
+			if (nodeInPlace && nameD.m_ptrCount == 0)
+				continue;
 
-						dstBPtr += dstElmSize;
-						srcBPtr += srcElmSize;
+
+			if (nameD.m_ptrCount > 0)
+			{
+				// pointer arrays are done by linkPointerArrays
+				if (nameD.m_ptrCount == 1)
+				{
+					malen = nameD.m_arraySize > nameS.m_arraySize ? nameS.m_arraySize : nameD.m_arraySize;
+
+					FBTsize* dptr = (FBTsize*)dstPtr;
+
+					const char* sptr = reinterpret_cast<const char*>(srcPtr);
+
+					// null entries are already null, in place blocks are not touched for them
+					for (a2 = 0; a2 < malen; ++a2, sptr += fps)
+					{
+						FBTsize oldPtr = fbtLoadPointer(sptr, fps);
+						if (oldPtr)
+							dptr[a2] = (FBTsize)findPtr(oldPtr);
 					}
 				}
 			}
-		}
+			else
+			{
+				FBTsize dstElmSize = dstStrc->m_len / nameD.m_arraySize;
+				FBTsize srcElmSize = srcStrc->m_len / nameS.m_arraySize;
 
-		notifyData(node->m_newBlock, node->m_chunk);
-	}
+				bool needCast = (dstStrc->m_flag & fbtStruct::NEED_CAST) != 0;
+				bool needSwap = endianSwap && srcElmSize > 1;
 
+				if (!needCast && !needSwap && srcStrc->m_val.k32[0] == dstStrc->m_val.k32[0]) //same type
+				{
+					// Take the minimum length of any array.
+					mlen = fbtMin(srcStrc->m_len, dstStrc->m_len);
 
+					fbtMemcpy(dstPtr, srcPtr, mlen);
+					continue;
+				}
 
-	for (node = (MemoryChunk*)m_chunks.first; node; node = node->m_next)
-	{
-		if (node->m_block)
-		{
-			fbtFree(node->m_block);
-			node->m_block = 0;
+				FBTbyte* dstBPtr = reinterpret_cast<FBTbyte*>(dstPtr);
+				FBTbyte* srcBPtr = reinterpret_cast<FBTbyte*>(srcPtr);
+
+				FBT_PRIM_TYPE stp = FBT_PRIM_UNKNOWN, dtp  = FBT_PRIM_UNKNOWN;
+
+				if (needCast || needSwap)
+				{
+					stp = fbtGetPrimType(srcStrc->m_val.k32[0]);
+					dtp = fbtGetPrimType(dstStrc->m_val.k32[0]);
+
+					FBT_ASSERT(fbtIsNumberType(stp) && fbtIsNumberType(dtp) && stp != dtp);
+				}
+
+				FBTsize alen = fbtMin(nameS.m_arraySize, nameD.m_arraySize);
+				FBTsize elen = fbtMin(srcElmSize, dstElmSize);
+
+				FBTbyte tmpBuf[8] = {0, };
+				FBTsize i;
+				for (i = 0; i < alen; i++)
+				{
+					FBTbyte* tmp = srcBPtr;
+					if (needSwap)
+					{
+						tmp = tmpBuf;
+						fbtMemcpy(tmpBuf, srcBPtr, srcElmSize);
+
+						if (stp == FBT_PRIM_SHORT || stp == FBT_PRIM_USHORT)
+							fbtSwap16((FBTuint16*)tmpBuf, 1);
+						else if (stp >= FBT_PRIM_INT && stp <= FBT_PRIM_FLOAT)
+							fbtSwap32((FBTuint32*)tmpBuf, 1);
+						else if (stp == FBT_PRIM_DOUBLE)
+							fbtSwap64((FBTuint64*)tmpBuf, 1);
+						else
+							fbtMemset(tmpBuf, 0, sizeof(tmpBuf)); //unknown type
+					}
+
+					if (needCast)
+						castValue((FBTsize*)tmp, (FBTsize*)dstBPtr, stp, dtp, 1);
+					else
+						fbtMemcpy(dstBPtr, tmp, elen);
+
+					dstBPtr += dstElmSize;
+					srcBPtr += srcElmSize;
+				}
+			}
 		}
 	}
-
-	return fbtFile::FS_OK;
 }
 
 
 
 
+// used by the link threads, so it skips the lookup cache
 void* fbtFile::findPtr(const FBTsize& iptr)
 {
 	FBTsizeType i;
-	if ((i = m_map.find(iptr)) != FBT_NPOS)
+	if ((i = m_map.lookup(iptr)) != FBT_NPOS)
 		return m_map.at(i)->m_newBlock;
 	return 0;
 }
@@ -842,6 +1445,10 @@ bool fbtFile::_setuid(const char* uid)
 
 int fbtFile::reflect(const char* path, const int mode, const fbtEndian& endian)
 {
+	// parseImage leaves the tables out
+	if (!m_memory)
+		return FS_FAILED;
+
 	fbtStream* fs;
 	
 #if FBT_USE_GZ_FILE == 1
@@ -907,6 +1514,419 @@ int fbtFile::reflect(const char* path, const int mode, const fbtEndian& endian)
 
 }
 
+// Image of the linked blocks, see writeImage. Offsets are from the start of
+// the image, blocks start on FBT_IMAGE_ALIGN and pointers to them hold their
+// offset until parseImage adds the address of the mapping.
+
+#define FBT_IMAGE_MAGIC     FBT_ID('F', 'B', 'T', 'I')
+#define FBT_IMAGE_FORMAT    1
+#define FBT_IMAGE_ALIGN     16
+
+struct fbtImageHeader
+{
+	FBTuint32   m_magic;
+	FBTuint32   m_format;
+	FBTuint32   m_ptr;          // pointer size
+	FBTuint32   m_endian;
+	FBTuint32   m_tables;       // hash of the memory tables
+	FBTint32    m_version;      // of the parsed file
+	FBTint32    m_fileHeader;
+	FBTuint32   m_nrChunks;
+	char        m_header[12];
+	FBTuint32   m_keyLen;
+	FBTuint64   m_key;
+	FBTuint64   m_chunks;       // fbtImageChunk[m_nrChunks]
+	FBTuint64   m_relocs;       // FBTuint64[m_nrRelocs], offsets of the pointers
+	FBTuint64   m_nrRelocs;
+	FBTuint64   m_size;         // of the whole image
+};
+
+struct fbtImageChunk
+{
+	FBTuint64   m_offs;
+	FBTuint64   m_old;
+	FBTuint32   m_code;
+	FBTuint32   m_len;
+	FBTuint32   m_typeid;       // memory struct
+	FBTuint32   m_nr;
+	FBTuint32   m_notify;       // passed to notifyData, like the linked structs
+	FBTuint32   m_pad;
+};
+
+
+static FBTuint64 fbtImageAlign(FBTuint64 offs)
+{
+	return (offs + FBT_IMAGE_ALIGN - 1) & ~(FBTuint64)(FBT_IMAGE_ALIGN - 1);
+}
+
+
+static FBTuint32 fbtImageHash(const void* data, FBTsize len)
+{
+	// FNV-1a
+	const FBTubyte* bp = static_cast<const FBTubyte*>(data);
+	FBTuint32 hash = 2166136261U;
+	for (FBTsize i = 0; i < len; ++i)
+		hash = (hash ^ bp[i]) * 16777619U;
+	return hash;
+}
+
+
+static bool fbtImageWrite(fbtStream* stream, FBTuint64& pos, const void* data, FBTsize len)
+{
+	static const char zeros[FBT_IMAGE_ALIGN] = {0};
+
+	if (len > 0 && stream->write(data, len) != len)
+		return false;
+	pos += len;
+
+	FBTsize pad = (FBTsize)(fbtImageAlign(pos) - pos);
+	if (pad > 0 && stream->write(zeros, pad) != pad)
+		return false;
+	pos += pad;
+	return true;
+}
+
+
+// Offsets of the pointers in a linked block, pointer arrays hold nothing else.
+static void fbtGetPointers(fbtBinTables* mp, const fbtFile::MemoryChunk* node, bool raw, fbtArray<FBTsize>& dest)
+{
+	dest.clear(true);
+
+	if (node->m_flag & fbtFile::MemoryChunk::BLK_MODIFIED)
+	{
+		for (FBTsize i = 0; i + sizeof(FBTsize) <= node->m_chunk.m_len; i += sizeof(FBTsize))
+			dest.push_back(i);
+		return;
+	}
+
+	if (raw)
+		return;
+
+	fbtStruct* cs = mp->m_offs.at(node->m_newTypeId);
+	fbtStruct::Members::Pointer mm = cs->m_members.ptr();
+	FBTsizeType i, s = cs->m_members.size(), n, a;
+
+	for (n = 0; n < node->m_chunk.m_nr; ++n)
+	{
+		for (i = 0; i < s; ++i)
+		{
+			const fbtName& name = mp->m_name[mm[i].m_key.k16[1]];
+			if (name.m_ptrCount == 0)
+				continue;
+
+			for (a = 0; a < name.m_arraySize; ++a)
+				dest.push_back(cs->m_len * n + mm[i].m_off + a * sizeof(FBTsize));
+		}
+	}
+}
+
+
+// Address of a linked block and its image offset. The hash keys compare the
+// hashes only, addresses that collide would be patched to the wrong block.
+struct fbtImageBlock
+{
+	FBTsize     m_addr;
+	FBTuint64   m_offs;
+};
+
+
+static bool fbtImageBlockLess(const fbtImageBlock& a, const fbtImageBlock& b)
+{
+	return a.m_addr < b.m_addr;
+}
+
+
+static FBTsizeType fbtImageFind(const fbtArray<fbtImageBlock>& blocks, FBTsize addr)
+{
+	FBTsizeType lo = 0, hi = blocks.size();
+	while (lo < hi)
+	{
+		FBTsizeType mid = lo + (hi - lo) / 2;
+		if (blocks[mid].m_addr < addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo < blocks.size() && blocks[lo].m_addr == addr ? lo : FBT_NPOS;
+}
+
+
+int fbtFile::writeImage(const char* path, const void* key, FBTsize keyLen)
+{
+	if (!m_memory || !m_chunks.first)
+		return FS_FAILED;
+
+	static const FBThash hk = fbtCharHashKey("Link").hash();
+	fbtBinTables::OffsM::Pointer md = m_memory->m_offs.ptr();
+
+	fbtArray<MemoryChunk*> nodes;
+	MemoryChunk* node;
+	for (node = (MemoryChunk*)m_chunks.first; node; node = node->m_next)
+	{
+		if (node->m_newBlock && node->m_newTypeId <= m_memory->m_strcNr)
+			nodes.push_back(node);
+	}
+
+
+	FBTuint64 size = fbtImageAlign(sizeof(fbtImageHeader));
+	FBTuint64 keyOffs = size;
+	size = fbtImageAlign(size + keyLen);
+	FBTuint64 chunkOffs = size;
+	size = fbtImageAlign(size + nodes.size() * sizeof(fbtImageChunk));
+
+
+	// blocks by address, the image offset is what a pointer to them becomes
+	fbtArray<fbtImageChunk> chunks;
+	chunks.resize(nodes.size());
+
+	fbtArray<fbtImageBlock> offsets;
+	offsets.resize(nodes.size());
+
+	FBTsizeType i, j;
+	for (i = 0; i < nodes.size(); ++i)
+	{
+		node = nodes[i];
+
+		fbtImageChunk& ic = chunks[i];
+		fbtMemset(&ic, 0, sizeof(fbtImageChunk));
+		ic.m_offs   = size;
+		ic.m_old    = node->m_chunk.m_old;
+		ic.m_code   = node->m_chunk.m_code;
+		ic.m_len    = node->m_chunk.m_len;
+		ic.m_typeid = node->m_newTypeId;
+		ic.m_nr     = node->m_chunk.m_nr;
+		ic.m_notify = m_memory->m_type[md[node->m_newTypeId]->m_key.k16[0]].m_typeId != hk ? 1 : 0;
+
+		offsets[i].m_addr = (FBTsize)node->m_newBlock;
+		offsets[i].m_offs = size;
+		size = fbtImageAlign(size + ic.m_len);
+	}
+
+	offsets.sort(fbtImageBlockLess);
+
+
+	// Every pointer that is set, with the offset it becomes. Pointers the link
+	// left to unknown blocks are cleared.
+	fbtArray<FBTuint64> fields, targets;
+	fbtArray<FBTsize> local;
+	FBTuint64 nrRelocs = 0;
+
+	for (i = 0; i < nodes.size(); ++i)
+	{
+		node = nodes[i];
+		fbtGetPointers(m_memory, node, chunks[i].m_notify == 0, local);
+
+		for (j = 0; j < local.size(); ++j)
+		{
+			FBTsize ptr = *reinterpret_cast<const FBTsize*>(static_cast<const char*>(node->m_newBlock) + local[j]);
+			if (!ptr)
+				continue;
+
+			FBTsizeType pos = fbtImageFind(offsets, ptr);
+			fields.push_back(chunks[i].m_offs + local[j]);
+			targets.push_back(pos != FBT_NPOS ? offsets[pos].m_offs : 0);
+			if (pos != FBT_NPOS)
+				nrRelocs++;
+		}
+	}
+
+	FBTuint64 relocOffs = size;
+	size += nrRelocs * sizeof(FBTuint64);
+
+
+	fbtImageHeader hdr;
+	fbtMemset(&hdr, 0, sizeof(fbtImageHeader));
+	hdr.m_magic      = FBT_IMAGE_MAGIC;
+	hdr.m_format     = FBT_IMAGE_FORMAT;
+	hdr.m_ptr        = sizeof(FBTsize);
+	hdr.m_endian     = (FBTuint32)fbtGetEndian();
+	hdr.m_tables     = fbtImageHash(getFBT(), getFBTlength());
+	hdr.m_version    = m_fileVersion;
+	hdr.m_fileHeader = m_fileHeader;
+	hdr.m_nrChunks   = nodes.size();
+	hdr.m_keyLen     = (FBTuint32)keyLen;
+	hdr.m_key        = keyOffs;
+	hdr.m_chunks     = chunkOffs;
+	hdr.m_relocs     = relocOffs;
+	hdr.m_nrRelocs   = nrRelocs;
+	hdr.m_size       = size;
+	fbtMemcpy(hdr.m_header, m_header.c_str(), fbtMin<FBTsize>(m_header.size(), 12));
+
+
+	fbtFileStream fs;
+	fs.open(path, fbtStream::SM_WRITE);
+	if (!fs.isOpen())
+		return FS_FAILED;
+
+	FBTuint64 pos = 0;
+	bool ok = fbtImageWrite(&fs, pos, &hdr, sizeof(fbtImageHeader)) &&
+	          fbtImageWrite(&fs, pos, key, keyLen) &&
+	          fbtImageWrite(&fs, pos, chunks.ptr(), chunks.size() * sizeof(fbtImageChunk));
+
+	// the blocks, pointers patched in a copy
+	fbtArray<char> buf;
+	for (i = 0, j = 0; i < nodes.size() && ok; ++i)
+	{
+		const fbtImageChunk& ic = chunks[i];
+		buf.resize(ic.m_len);
+		if (ic.m_len > 0)
+			fbtMemcpy(buf.ptr(), nodes[i]->m_newBlock, ic.m_len);
+
+		for (; j < fields.size() && fields[j] < ic.m_offs + ic.m_len; ++j)
+			*reinterpret_cast<FBTsize*>(buf.ptr() + (fields[j] - ic.m_offs)) = (FBTsize)targets[j];
+
+		ok = pos == ic.m_offs && fbtImageWrite(&fs, pos, buf.ptr(), ic.m_len);
+	}
+
+	for (j = 0; j < fields.size() && ok; ++j)
+	{
+		if (targets[j])
+			ok = fs.write(&fields[j], sizeof(FBTuint64)) == sizeof(FBTuint64);
+	}
+
+	fs.close();
+	return ok ? FS_OK : FS_FAILED;
+}
+
+
+
+int fbtFile::parseImage(const char* path, const void* key, FBTsize keyLen)
+{
+	if (m_chunks.first || m_mapping)
+		return FS_FAILED;
+
+	fbtMemset(&m_stats, 0, sizeof(LoadStats));
+	FBTuint64 start = fbtGetMicroseconds(), mark;
+
+	fbtMappedStream* ms = new fbtMappedStream();
+	ms->open(path, fbtStream::SM_READ);
+	if (!ms->isOpen() || ms->size() < (FBTsize)sizeof(fbtImageHeader))
+	{
+		delete ms;
+		return FS_FAILED;
+	}
+	m_mapping = ms;
+
+	char* base = ms->ptr();
+	const FBTuint64 size = ms->size();
+	const fbtImageHeader* hdr = reinterpret_cast<const fbtImageHeader*>(base);
+
+	if (hdr->m_magic   != FBT_IMAGE_MAGIC  ||
+	    hdr->m_format  != FBT_IMAGE_FORMAT ||
+	    hdr->m_ptr     != sizeof(FBTsize)  ||
+	    hdr->m_endian  != (FBTuint32)fbtGetEndian() ||
+	    hdr->m_tables  != fbtImageHash(getFBT(), getFBTlength()) ||
+	    hdr->m_size    != size             ||
+	    hdr->m_keyLen  != keyLen           ||
+	    keyLen         >  size             ||
+	    hdr->m_key     >  size - keyLen    ||
+	    (keyLen > 0 && fbtMemcmp(base + hdr->m_key, key, keyLen) != 0))
+		return FS_FAILED;
+
+	FBTuint64 dataStart = fbtImageAlign(sizeof(fbtImageHeader));
+	if (hdr->m_chunks < dataStart || hdr->m_chunks > size ||
+	    (size - hdr->m_chunks) / sizeof(fbtImageChunk) < hdr->m_nrChunks ||
+	    hdr->m_relocs < dataStart || hdr->m_relocs > size ||
+	    (size - hdr->m_relocs) / sizeof(FBTuint64) < hdr->m_nrRelocs)
+	{
+		FBT_INVALID_READ;
+		return FS_INV_READ;
+	}
+
+	m_stats.m_open = fbtGetMicroseconds() - start;
+	mark = fbtGetMicroseconds();
+
+
+	const fbtImageChunk* chunks = reinterpret_cast<const fbtImageChunk*>(base + hdr->m_chunks);
+	FBTuint64 i;
+
+	for (i = 0; i < hdr->m_nrChunks; ++i)
+	{
+		const fbtImageChunk& ic = chunks[i];
+		if (ic.m_offs < dataStart || ic.m_offs > size || size - ic.m_offs < ic.m_len)
+		{
+			FBT_INVALID_READ;
+			return FS_INV_READ;
+		}
+
+		MemoryChunk* bin = static_cast<MemoryChunk*>(fbtMalloc(sizeof(MemoryChunk)));
+		if (!bin)
+		{
+			FBT_MALLOC_FAILED;
+			return FS_BAD_ALLOC;
+		}
+		fbtMemset(bin, 0, sizeof(MemoryChunk));
+
+		// blocks stay in the mapping, the destructor leaves them to it
+		bin->m_newBlock      = base + ic.m_offs;
+		bin->m_newTypeId     = (FBTtype)ic.m_typeid;
+		bin->m_flag          = MemoryChunk::BLK_IN_PLACE | (ic.m_notify ? 0 : MemoryChunk::BLK_RAW);
+		bin->m_chunk.m_code  = ic.m_code;
+		bin->m_chunk.m_len   = ic.m_len;
+		bin->m_chunk.m_nr    = ic.m_nr;
+		bin->m_chunk.m_typeid= ic.m_typeid;
+		bin->m_chunk.m_old   = (FBTsize)ic.m_old;
+		m_chunks.push_back(bin);
+
+		if (ic.m_notify)
+			m_inPlace++;
+		else
+			m_rawInPlace++;
+	}
+
+
+	const FBTuint64* relocs = reinterpret_cast<const FBTuint64*>(base + hdr->m_relocs);
+	for (i = 0; i < hdr->m_nrRelocs; ++i)
+	{
+		FBTuint64 offs = relocs[i];
+		if (offs < dataStart || offs > size - sizeof(FBTsize) || (offs & (sizeof(FBTsize) - 1)) != 0)
+		{
+			FBT_INVALID_READ;
+			return FS_INV_READ;
+		}
+
+		FBTsize* ptr = reinterpret_cast<FBTsize*>(base + offs);
+		if (*ptr < dataStart || *ptr >= size)
+		{
+			FBT_INVALID_READ;
+			return FS_INV_READ;
+		}
+		*ptr = (FBTsize)(base + *ptr);
+	}
+
+	m_stats.m_link = m_stats.m_linkConvert = fbtGetMicroseconds() - mark;
+	mark = fbtGetMicroseconds();
+
+
+	m_header.resize(12);
+	fbtMemcpy(m_header.ptr(), hdr->m_header, 12);
+	m_fileVersion = hdr->m_version;
+	m_fileHeader  = hdr->m_fileHeader;
+
+	FBTsize pl = strlen(path);
+	m_curFile = (char*)fbtMalloc(pl + 1);
+	if (m_curFile)
+	{
+		fbtMemcpy(m_curFile, path, pl);
+		m_curFile[pl] = 0;
+	}
+
+	for (MemoryChunk* node = (MemoryChunk*)m_chunks.first; node; node = node->m_next)
+	{
+		if (!(node->m_flag & MemoryChunk::BLK_RAW))
+			notifyData(node->m_newBlock, node->m_chunk);
+	}
+
+	m_stats.m_linkNotify = fbtGetMicroseconds() - mark;
+	m_stats.m_link      += m_stats.m_linkNotify;
+	m_stats.m_chunks     = hdr->m_nrChunks;
+	m_stats.m_threads    = 1;
+	m_stats.m_total      = fbtGetMicroseconds() - start;
+	return FS_OK;
+}
+
+
+
 void fbtFile::writeStruct(fbtStream* stream, FBTtype index, FBTuint32 code, FBTsize len, void* writeData)
 {
 	Chunk ch;
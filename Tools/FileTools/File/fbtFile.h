@@ -33,6 +33,7 @@
 */
 
 class fbtStream;
+class fbtMappedStream;
 class fbtBinTables;
 
 
@@ -71,6 +72,10 @@ public:
 		PM_COMPRESSED,
 		PM_READTOMEMORY,
 
+		// Maps the file and links chunks in place when their file layout
+		// matches the memory layout, only the others are rebuilt. Compressed
+		// files fall back to PM_COMPRESSED.
+		PM_MAPPED,
 	};
 
 	enum FileHeader
@@ -115,6 +120,9 @@ public:
 		enum Flag
 		{
 			BLK_MODIFIED = (1 << 0),
+			BLK_IN_PLACE = (1 << 1), // m_newBlock is the file block
+			BLK_ZEROED   = (1 << 2), // m_newBlock was cleared before the conversion
+			BLK_RAW      = (1 << 3), // raw data, counted by getRawInPlaceCount
 		};
 
 		MemoryChunk* m_next, *m_prev;
@@ -127,6 +135,34 @@ public:
 		FBTtype      m_newTypeId;
 	};
 
+
+	/// Time spent in each stage of the last parse, in microseconds.
+	struct LoadStats
+	{
+		FBTuint64   m_open;         // opening or mapping the file
+		FBTuint64   m_header;
+		FBTuint64   m_scan;         // reading chunk headers and blocks
+		FBTuint64   m_dna;          // file tables and member matching
+		FBTuint64   m_link;         // all of link(), the three below included
+		FBTuint64   m_linkAlloc;    // new blocks and pointer arrays
+		FBTuint64   m_linkConvert;  // member conversion, on m_threads threads
+		FBTuint64   m_linkNotify;
+		FBTuint64   m_total;
+
+		FBTsizeType m_chunks;
+		FBTsizeType m_threads;
+	};
+
+	/// Link totals of one memory struct type.
+	struct StructStats
+	{
+		FBTsizeType m_chunks;
+		FBTsize     m_bytes;
+		FBTuint64   m_time;         // conversion time summed over threads
+	};
+
+	typedef fbtArray<StructStats> StructStatsArray;
+
 public:
 
 
@@ -140,6 +176,18 @@ public:
 	/// Saving in non native endianness is not implemented yet.
 	int reflect(const char* path, const int mode = PM_UNCOMPRESSED, const fbtEndian& endian = FBT_ENDIAN_NATIVE);
 
+	/// Writes the linked blocks of the last parse to an image, their pointers as
+	/// offsets into it. key is stored as is, for the caller to tell what the
+	/// image was made from.
+	int writeImage(const char* path, const void* key, FBTsize keyLen);
+
+	/// Maps an image written by writeImage and patches its pointers, the file
+	/// tables are neither read nor matched. Fails when the key, the pointer
+	/// size, the endian or the memory tables differ. Only for a new file
+	/// object, which can not be parsed again after a failure. The memory
+	/// tables are not loaded either, so the file can not be reflected.
+	int parseImage(const char* path, const void* key, FBTsize keyLen);
+
 
 	const fbtFixedString<12>&   getHeader(void)     const {return m_header;}
 	const int&                  getVersion(void)    const {return m_fileVersion;}
@@ -152,6 +200,22 @@ public:
 
 	fbtList& getChunks(void) {return m_chunks;}
 
+	/// Struct chunks linked without a copy by the last parse, only files with
+	/// the native endian and pointer size have any.
+	FBTsizeType getInPlaceCount(void) const {return m_inPlace;}
+
+	/// Raw data chunks used without a copy by the last parse, whatever the layout.
+	FBTsizeType getRawInPlaceCount(void) const {return m_rawInPlace;}
+
+	const LoadStats&        getLoadStats(void)   const {return m_stats;}
+
+	/// Indexed by memory struct id.
+	const StructStatsArray& getStructStats(void) const {return m_structStats;}
+
+	/// Threads used to convert chunks. 0 picks up to one per core depending on the amount
+	/// of work, 1 links on the calling thread.
+	void setLinkThreads(int nr) {m_linkThreads = nr;}
+
     virtual void setIgnoreList(FBTuint32 *stripList) {}
 
 	bool _setuid(const char* uid);
@@ -186,6 +250,13 @@ protected:
 	ChunkMap    m_map;
 	fbtBinTables* m_memory, *m_file;
 
+	fbtMappedStream* m_mapping;
+	FBTsizeType      m_inPlace, m_rawInPlace;
+
+	LoadStats        m_stats;
+	StructStatsArray m_structStats;
+	int              m_linkThreads;
+
 
 	virtual bool skip(const FBTuint32& id) {return false;}
 	void* findPtr(const FBTsize& iptr);
@@ -199,6 +270,12 @@ private:
 
 	int compileOffsets(void);
 	int link(void);
+	void linkPointerArrays(MemoryChunk* node);
+	void linkChunk(MemoryChunk* node);
+
+	void freeBlock(void* block);
+
+	friend class fbtLinkJob;
 };
 
 /** @}*/
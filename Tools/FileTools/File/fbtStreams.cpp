@@ -33,6 +33,13 @@
 #include "zconf.h"
 #endif
 
+#if FBT_PLATFORM != FBT_PLATFORM_WIN32
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
 
 fbtFileStream::fbtFileStream() 
 	:    m_file(), m_handle(0), m_mode(0), m_size(0)
@@ -174,6 +181,137 @@ FBTsize fbtFileStream::writef(const char* fmt, ...)
 }
 
 
+
+
+fbtMappedStream::fbtMappedStream()
+	:    m_buffer(0), m_pos(0), m_size(0), m_handle(0), m_mapping(0)
+{
+}
+
+
+fbtMappedStream::~fbtMappedStream()
+{
+	close();
+}
+
+
+void fbtMappedStream::open(const char* p, fbtStream::StreamMode mode)
+{
+	if (mode != fbtStream::SM_READ)
+		return;
+
+	close();
+
+#if FBT_PLATFORM == FBT_PLATFORM_WIN32
+
+	HANDLE fh = CreateFileA(p, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (fh == INVALID_HANDLE_VALUE)
+		return;
+
+	DWORD high = 0, low = GetFileSize(fh, &high);
+	if (high != 0 || low == 0 || low == INVALID_FILE_SIZE)
+	{
+		CloseHandle(fh);
+		return;
+	}
+
+	HANDLE mh = CreateFileMappingA(fh, 0, PAGE_WRITECOPY, 0, 0, 0);
+	if (!mh)
+	{
+		CloseHandle(fh);
+		return;
+	}
+
+	m_buffer = (char*)MapViewOfFile(mh, FILE_MAP_COPY, 0, 0, 0);
+	if (!m_buffer)
+	{
+		CloseHandle(mh);
+		CloseHandle(fh);
+		return;
+	}
+
+	m_handle  = fh;
+	m_mapping = mh;
+	m_size    = low;
+
+#else
+
+	int fd = ::open(p, O_RDONLY);
+	if (fd == -1)
+		return;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0 || (FBTuint64)st.st_size > (FBTuint64)0x7FFFFFFF)
+	{
+		::close(fd);
+		return;
+	}
+
+	void* mem = mmap(0, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+	// the mapping keeps its own reference to the file
+	::close(fd);
+
+	if (mem == MAP_FAILED)
+		return;
+
+	m_buffer = (char*)mem;
+	m_size   = (FBTsize)st.st_size;
+
+#endif
+
+	m_pos = 0;
+}
+
+
+void fbtMappedStream::close(void)
+{
+	if (!m_buffer)
+		return;
+
+#if FBT_PLATFORM == FBT_PLATFORM_WIN32
+	UnmapViewOfFile(m_buffer);
+	CloseHandle((HANDLE)m_mapping);
+	CloseHandle((HANDLE)m_handle);
+#else
+	munmap(m_buffer, m_size);
+#endif
+
+	m_buffer  = 0;
+	m_handle  = 0;
+	m_mapping = 0;
+	m_pos     = 0;
+	m_size    = 0;
+}
+
+
+FBTsize fbtMappedStream::seek(FBTint32 off, FBTint32 way)
+{
+	if (way == SEEK_SET)
+		m_pos = fbtClamp<FBTsize>(off, 0, m_size);
+	else if (way == SEEK_CUR)
+		m_pos = fbtClamp<FBTsize>(m_pos + off, 0, m_size);
+	else if (way == SEEK_END)
+		m_pos = m_size;
+	return m_pos;
+}
+
+
+FBTsize fbtMappedStream::read(void* dest, FBTsize nr) const
+{
+	if (!dest || !m_buffer || m_pos >= m_size)
+		return 0;
+
+	if ((m_size - m_pos) < nr)
+		nr = m_size - m_pos;
+
+	fbtMemcpy(dest, m_buffer + m_pos, nr);
+	m_pos += nr;
+	return nr;
+}
+
+
+
 #if FBT_USE_GZ_FILE == 1
 
 
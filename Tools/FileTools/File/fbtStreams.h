@@ -106,6 +106,42 @@ protected:
 
 
 
+// Maps a whole file copy on write, ptr() stays valid until close. Changes
+// made through ptr() are private to the process, the file is never written.
+class fbtMappedStream : public fbtStream
+{
+public:
+	fbtMappedStream();
+	~fbtMappedStream();
+
+	void open(const char* path, fbtStream::StreamMode mode);
+	void close(void);
+
+	bool     isOpen(void)    const   {return m_buffer != 0;}
+	bool     eof(void)       const   {return !m_buffer || m_pos >= m_size;}
+	FBTsize  position(void)  const   {return m_pos;}
+	FBTsize  size(void)      const   {return m_size;}
+
+	FBTsize  read(void* dest, FBTsize nr) const;
+	FBTsize  write(const void* src, FBTsize nr) {return -1;}
+
+	FBTsize seek(FBTint32 off, FBTint32 way);
+
+	char*       ptr(void)          {return m_buffer;}
+	const char* ptr(void) const    {return m_buffer;}
+
+	bool contains(const void* p) const
+	{
+		return m_buffer && (const char*)p >= m_buffer && (const char*)p < m_buffer + m_size;
+	}
+
+protected:
+
+	char*            m_buffer;
+	mutable FBTsize  m_pos;
+	FBTsize          m_size;
+	fbtFileHandle    m_handle, m_mapping;
+};
 
 #if FBT_USE_GZ_FILE == 1
 
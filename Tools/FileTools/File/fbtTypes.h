@@ -1024,15 +1024,7 @@ public:
 		if (m_lastPos != FBT_NPOS && m_lastKey == hk)
 			return m_lastPos;
 
-		FBThash hr = _FBT_UTHASHTABLE_HKHASH(hk);
-
-		FBT_ASSERT(m_bptr && m_iptr && m_nptr);
-
-		FBTsizeType fh = m_iptr[hr];
-		while (fh != FBT_NPOS && (key != m_bptr[fh].first))
-			fh = m_nptr[fh];
-
-
+		FBTsizeType fh = lookup(key);
 		if (fh != FBT_NPOS)
 		{
 			m_lastKey = hk;
@@ -1043,6 +1035,23 @@ public:
 		return fh;
 	}
 
+	// find without the last key cache, safe to call from several threads
+	FBTsizeType lookup(const Key& key) const
+	{
+		if (m_capacity == 0 || m_capacity == FBT_NPOS || m_size == 0)
+			return FBT_NPOS;
+
+		FBTsizeType hk = key.hash();
+		FBThash hr = _FBT_UTHASHTABLE_HKHASH(hk);
+
+		FBT_ASSERT(m_bptr && m_iptr && m_nptr);
+
+		FBTsizeType fh = m_iptr[hr];
+		while (fh != FBT_NPOS && (key != m_bptr[fh].first))
+			fh = m_nptr[fh];
+		return fh;
+	}
+
 
 
 	void erase(const Key& key) {remove(key);}
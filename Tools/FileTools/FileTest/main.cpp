@@ -1,116 +1,189 @@
-/*
--------------------------------------------------------------------------------
-    This file is part of FBT (File Binary Tables).
-    http://gamekit.googlecode.com/
-
-    Copyright (c) 2010 Charlie C & Erwin Coumans.
-
--------------------------------------------------------------------------------
-  This software is provided 'as-is', without any express or implied
-  warranty. In no event will the authors be held liable for any damages
-  arising from the use of this software.
-
-  Permission is granted to anyone to use this software for any purpose,
-  including commercial applications, and to alter it and redistribute it
-  freely, subject to the following restrictions:
-
-  1. The origin of this software must not be misrepresented; you must not
-     claim that you wrote the original software. If you use this software
-     in a product, an acknowledgment in the product documentation would be
-     appreciated but is not required.
-  2. Altered source versions must be plainly marked as such, and must not be
-     misrepresented as being the original software.
-  3. This notice may not be removed or altered from any source distribution.
--------------------------------------------------------------------------------
-*/
-#include "fbtBlend.h"
-#include "Blender.h"
-using namespace Blender;
-
-
-int main(int argc, char** argv)
-{
-	if (argc < 2)
-		return 1;
-
-
-	//btBulletFile fp;
-	fbtBlend fp;
-
-	if (fp.parse(argv[argc-1], fbtFile::PM_READTOMEMORY) != fbtFile::FS_OK)
-	{
-		return 1;
-	}
-
-	Blender::FileGlobal* fg = fp.m_fg;
-
-	for (Blender::Text* tx = (Blender::Text*)fp.m_text.first; tx; tx = (Blender::Text*)tx->id.next)
-	{
-		for (Blender::TextLine* tl = (Blender::TextLine*)tx->lines.first; tl; tl = tl->next)
-		{
-			fbtPrintf("%s\n", tl->line);
-
-		}
-	}
-
-
-
-	for (Blender::bScreen* bs = (Blender::bScreen*)fp.m_screen.first; bs; bs = (Blender::bScreen*)bs->id.next)
-	{
-		fbtPrintf("%s\n", bs->id.name);
-
-		for (Blender::ScrEdge* edge = (Blender::ScrEdge*)bs->edgebase.first; edge; edge = edge->next)
-		{
-			Blender::ScrVert* v1 = edge->v1;
-			Blender::ScrVert* v2 = edge->v2;
-
-			if (!v1)
-			{
-				fbtPrintf("%s Failed\n", bs->id.name);
-			}
-		}
-
-
-	}
-
-
-	fbtList& objects = fp.m_object;
-	for (Object* ob = (Object*)objects.first; ob; ob = (Object*)ob->id.next)
-	{
-		fbtPrintf("%s\n", ob->id.name);
-
-		if (ob->data && ob->type == 1)
-		{
-			Mesh* me = (Mesh*)ob->data;
-			fbtPrintf("\t%s\n", me->id.name);
-
-			if (me->mat && *me->mat)
-			{
-				for (int i = 0; i < me->totcol; ++i)
-				{
-					Material* ma = me->mat[i];
-
-					if (ma)
-					{
-						fbtPrintf("\t\t%s\n", ma->id.name);
-
-						if (ma->mtex)
-						{
-							int i = 0;
-							while (ma->mtex[i] != 0)
-							{
-								if (ma->mtex[i]->tex)
-									fbtPrintf("\t\t\t%s\n", ma->mtex[i]->tex->id.name);
-								++i;
-
-							}
-						}
-					}
-				}
-			}
-		}
-	}
-
-	//fp.reflect("Test.blend");
-	return 0;
-}
+/*
+-------------------------------------------------------------------------------
+    This file is part of FBT (File Binary Tables).
+    http://gamekit.googlecode.com/
+
+    Copyright (c) 2010 Charlie C & Erwin Coumans.
+
+-------------------------------------------------------------------------------
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "fbtBlend.h"
+#include "fbtTables.h"
+#include "Blender.h"
+#include <stdlib.h>
+#include <string.h>
+using namespace Blender;
+
+
+static fbtFile* sortFile = 0;
+
+static int compareStructTime(const void* a, const void* b)
+{
+	const fbtFile::StructStatsArray& st = sortFile->getStructStats();
+	FBTuint64 ta = st.at(*(const FBTsizeType*)a).m_time, tb = st.at(*(const FBTsizeType*)b).m_time;
+	return ta < tb ? 1 : ta > tb ? -1 : 0;
+}
+
+
+static void printLoadStats(fbtFile& fp)
+{
+	const fbtFile::LoadStats& ls = fp.getLoadStats();
+
+#define MS(us) ((double)(us) / 1000.0)
+	fbtPrintf("Load time %.2f ms, %u chunks, %u linked in place, %u raw in place\n", MS(ls.m_total), (unsigned int)ls.m_chunks,
+	          (unsigned int)fp.getInPlaceCount(), (unsigned int)fp.getRawInPlaceCount());
+	fbtPrintf("  open     %9.2f ms\n", MS(ls.m_open));
+	fbtPrintf("  header   %9.2f ms\n", MS(ls.m_header));
+	fbtPrintf("  chunks   %9.2f ms\n", MS(ls.m_scan));
+	fbtPrintf("  DNA      %9.2f ms\n", MS(ls.m_dna));
+	fbtPrintf("  link     %9.2f ms\n", MS(ls.m_link));
+	fbtPrintf("    alloc  %9.2f ms\n", MS(ls.m_linkAlloc));
+	fbtPrintf("    convert%9.2f ms, %u threads\n", MS(ls.m_linkConvert), (unsigned int)ls.m_threads);
+	fbtPrintf("    notify %9.2f ms\n", MS(ls.m_linkNotify));
+
+	// struct types by conversion time
+	const fbtFile::StructStatsArray& st = fp.getStructStats();
+	fbtArray<FBTsizeType> order;
+	for (FBTsizeType i = 0; i < st.size(); ++i)
+	{
+		if (st.at(i).m_chunks)
+			order.push_back(i);
+	}
+
+	sortFile = &fp;
+	qsort(order.ptr(), order.size(), sizeof(FBTsizeType), compareStructTime);
+
+	fbtBinTables* tables = fp.getMemoryTable();
+
+	fbtPrintf("  %-24s %8s %12s %10s\n", "struct", "chunks", "bytes", "ms");
+	for (FBTsizeType i = 0; i < order.size() && i < 20; ++i)
+	{
+		const fbtFile::StructStats& ss = st.at(order[i]);
+		fbtPrintf("  %-24s %8u %12lu %10.2f\n", tables->getStructType(tables->m_offs.at(order[i])),
+		          (unsigned int)ss.m_chunks, (unsigned long)ss.m_bytes, MS(ss.m_time));
+	}
+#undef MS
+}
+
+
+// AppTestLoader [-j threads] [-m parse mode] [-q] file.blend
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+		return 1;
+
+	int mode = fbtFile::PM_READTOMEMORY, threads = 0;
+	bool quiet = false;
+
+	for (int i = 1; i < argc - 1; ++i)
+	{
+		if (!strcmp(argv[i], "-j") && i + 1 < argc - 1)
+			threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-m") && i + 1 < argc - 1)
+			mode = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-q"))
+			quiet = true;
+	}
+
+
+	//btBulletFile fp;
+	fbtBlend fp;
+	fp.setLinkThreads(threads);
+
+	if (fp.parse(argv[argc-1], mode) != fbtFile::FS_OK)
+	{
+		return 1;
+	}
+
+	printLoadStats(fp);
+	if (quiet)
+		return 0;
+
+	Blender::FileGlobal* fg = fp.m_fg;
+
+	for (Blender::Text* tx = (Blender::Text*)fp.m_text.first; tx; tx = (Blender::Text*)tx->id.next)
+	{
+		for (Blender::TextLine* tl = (Blender::TextLine*)tx->lines.first; tl; tl = tl->next)
+		{
+			fbtPrintf("%s\n", tl->line);
+
+		}
+	}
+
+
+
+	for (Blender::bScreen* bs = (Blender::bScreen*)fp.m_screen.first; bs; bs = (Blender::bScreen*)bs->id.next)
+	{
+		fbtPrintf("%s\n", bs->id.name);
+
+		for (Blender::ScrEdge* edge = (Blender::ScrEdge*)bs->edgebase.first; edge; edge = edge->next)
+		{
+			Blender::ScrVert* v1 = edge->v1;
+			Blender::ScrVert* v2 = edge->v2;
+
+			if (!v1)
+			{
+				fbtPrintf("%s Failed\n", bs->id.name);
+			}
+		}
+
+
+	}
+
+
+	fbtList& objects = fp.m_object;
+	for (Object* ob = (Object*)objects.first; ob; ob = (Object*)ob->id.next)
+	{
+		fbtPrintf("%s\n", ob->id.name);
+
+		if (ob->data && ob->type == 1)
+		{
+			Mesh* me = (Mesh*)ob->data;
+			fbtPrintf("\t%s\n", me->id.name);
+
+			if (me->mat && *me->mat)
+			{
+				for (int i = 0; i < me->totcol; ++i)
+				{
+					Material* ma = me->mat[i];
+
+					if (ma)
+					{
+						fbtPrintf("\t\t%s\n", ma->id.name);
+
+						if (ma->mtex)
+						{
+							int i = 0;
+							while (ma->mtex[i] != 0)
+							{
+								if (ma->mtex[i]->tex)
+									fbtPrintf("\t\t\t%s\n", ma->mtex[i]->tex->id.name);
+								++i;
+
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	//fp.reflect("Test.blend");
+	return 0;
+}
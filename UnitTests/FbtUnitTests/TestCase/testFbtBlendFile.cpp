@@ -1,167 +1,280 @@
-#include "StdAfx.h"
-
-#include <string>
-#include "fbtBlend.h"
-#include "Blender.h"
-
-using namespace Blender;
-
-#define TEST_CASE_NAME testFbtBlendFile
-
-#ifndef GKB_IDNAME
-#define GKB_IDNAME(x) ((x) && (x)->id.name[0] != '0' ? (x)->id.name + 2 : "")
-#endif
-
-#ifndef OB_CAMERA
-#define OB_CAMERA 11
-#endif
-
-bool parseBlendFile(const char *fname)
-{
-	fbtBlend fp;
-
-	return fp.parse(fname, fbtFile::PM_READTOMEMORY) == fbtFile::FS_OK;	
-	//return fp.parse(fname, fbtFile::PM_COMPRESSED) == fbtFile::FS_OK;	
-}
-
-
-
-bool parse_Ptr_PtrPtr_PtrArray(const char *fname, 
-						      int& ptrPtrCount,
-						      int& ptrArrayCount)
-{
-	fbtBlend fp;
-	bool parseOk = fp.parse(fname, fbtFile::PM_READTOMEMORY) == fbtFile::FS_OK;
-	if (!parseOk)
-		return false;
-
-	for (Blender::Text* tx = (Blender::Text*)fp.m_text.first; tx; tx = (Blender::Text*)tx->id.next)
-	{
-		for (Blender::TextLine* tl = (Blender::TextLine*)tx->lines.first; tl; tl = tl->next)
-		{
-			bool textLine = tl->line != 0;
-			if (!textLine)
-				return false;
-
-			bool lengthMatch = strlen(tl->line) == tl->len;
-			if (!lengthMatch)
-				return false;
-		}
-	}
-
-	for (Blender::bScreen* bs = (Blender::bScreen*)fp.m_screen.first; bs; bs = (Blender::bScreen*)bs->id.next)
-	{
-		bool edgebaseElements = bs->edgebase.first != 0;
-		if (!edgebaseElements)
-			return false;
-
-		for (Blender::ScrEdge* edge = (Blender::ScrEdge*)bs->edgebase.first; edge; edge = edge->next)
-		{
-			Blender::ScrVert* v1 = edge->v1;
-			Blender::ScrVert* v2 = edge->v2;
-
-			bool hasVerts = v1 != 0;
-			if (!hasVerts)
-				return false;
-		}
-	}
-
-	ptrPtrCount = 0;
-	ptrArrayCount = 0;
-
-	fbtList& objects = fp.m_object;
-	for (Object* ob = (Object*)objects.first; ob; ob = (Object*)ob->id.next)
-	{
-		bool meshHasData = ob->data && ob->type == 1;
-		if (meshHasData)
-		{
-
-			Mesh* me = (Mesh*)ob->data;
-
-			bool meshHasMaterials = me->mat && *me->mat;
-			if (!meshHasMaterials)
-				return false;
-
-			for (int i = 0; i < me->totcol; ++i)
-			{
-				Material* ma = me->mat[i];
-				if (ma)
-				{
-					++ptrPtrCount;
-
-					if (ma->mtex)
-					{
-						int j = 0;
-						while (ma->mtex[j] != 0)
-						{
-							if (ma->mtex[j]->tex)
-							{
-								++ptrArrayCount;
-							}
-							++j;
-						}
-					}
-				}
-			}
-		}
-	}
-	return true;
-}
-
-TEST(TEST_CASE_NAME, parsePointer32BitLinks)
-{
-	int ptrPtrCount;
-	int ptrArrayCount;
-	EXPECT_TRUE(parse_Ptr_PtrPtr_PtrArray("TestData/le32bitLink.blend", ptrPtrCount, ptrArrayCount));
-
-	ASSERT_EQ(ptrPtrCount, 4);
-	ASSERT_EQ(ptrArrayCount, 24);
-}
-
-TEST(TEST_CASE_NAME, parsePointer64BitLinks)
-{
-	int ptrPtrCount;
-	int ptrArrayCount;
-	EXPECT_TRUE(parse_Ptr_PtrPtr_PtrArray("TestData/le64bitLink.blend", ptrPtrCount, ptrArrayCount));
-
-	ASSERT_EQ(ptrPtrCount, 4);
-	ASSERT_EQ(ptrArrayCount, 24);
-}
-
-TEST(TEST_CASE_NAME, parseBlend32bit)
-{	
-	EXPECT_TRUE(parseBlendFile("TestData/be32bit.blend"));
-	EXPECT_TRUE(parseBlendFile("TestData/le32bit.blend"));	
-	EXPECT_TRUE(parseBlendFile("TestData/le32bitLink.blend"));
-	EXPECT_TRUE(parseBlendFile("TestData/le32_bv225.blend"));
-	EXPECT_TRUE(parseBlendFile("TestData/Refl_le32bitLink.blend"));
-}
-
-TEST(TEST_CASE_NAME, parseBlend64bit)
-{	
-	EXPECT_TRUE(parseBlendFile("TestData/le64bitLink.blend"));
-}
-
-TEST(TEST_CASE_NAME, findCameraObj)
-{
-	fbtBlend fp;
-
-	const char *fname = "TestData/be32bit.blend";	
-	ASSERT_EQ(fp.parse(fname, fbtFile::PM_READTOMEMORY), fbtFile::FS_OK);
-
-	bool findCameraObj = 0;
-	std::string cameraName = "camera0";
-	 
-	fbtList& objects = fp.m_object;
-	for (Object* ob = (Object*)objects.first; ob; ob = (Object*)ob->id.next)
-	{
-		//printf("%d %s\n", ob->type, GKB_IDNAME(ob));
-		if (cameraName == GKB_IDNAME(ob) && ob->type == OB_CAMERA)
-		{
-			findCameraObj = true;
-			break;
-		}
-	}
-
-	EXPECT_TRUE(findCameraObj);
-}
+#include "StdAfx.h"
+
+#include <string>
+#include "fbtBlend.h"
+#include "Blender.h"
+
+using namespace Blender;
+
+#define TEST_CASE_NAME testFbtBlendFile
+
+#ifndef GKB_IDNAME
+#define GKB_IDNAME(x) ((x) && (x)->id.name[0] != '0' ? (x)->id.name + 2 : "")
+#endif
+
+#ifndef OB_CAMERA
+#define OB_CAMERA 11
+#endif
+
+bool parseBlendFile(const char *fname)
+{
+	fbtBlend fp;
+
+	return fp.parse(fname, fbtFile::PM_READTOMEMORY) == fbtFile::FS_OK;	
+	//return fp.parse(fname, fbtFile::PM_COMPRESSED) == fbtFile::FS_OK;	
+}
+
+
+
+bool parse_Ptr_PtrPtr_PtrArray(const char *fname, 
+						      int& ptrPtrCount,
+						      int& ptrArrayCount,
+						      int linkThreads = 0,
+						      int mode = fbtFile::PM_READTOMEMORY)
+{
+	fbtBlend fp;
+	fp.setLinkThreads(linkThreads);
+	bool parseOk = fp.parse(fname, mode) == fbtFile::FS_OK;
+	if (!parseOk)
+		return false;
+
+	for (Blender::Text* tx = (Blender::Text*)fp.m_text.first; tx; tx = (Blender::Text*)tx->id.next)
+	{
+		for (Blender::TextLine* tl = (Blender::TextLine*)tx->lines.first; tl; tl = tl->next)
+		{
+			bool textLine = tl->line != 0;
+			if (!textLine)
+				return false;
+
+			bool lengthMatch = strlen(tl->line) == tl->len;
+			if (!lengthMatch)
+				return false;
+		}
+	}
+
+	for (Blender::bScreen* bs = (Blender::bScreen*)fp.m_screen.first; bs; bs = (Blender::bScreen*)bs->id.next)
+	{
+		bool edgebaseElements = bs->edgebase.first != 0;
+		if (!edgebaseElements)
+			return false;
+
+		for (Blender::ScrEdge* edge = (Blender::ScrEdge*)bs->edgebase.first; edge; edge = edge->next)
+		{
+			Blender::ScrVert* v1 = edge->v1;
+			Blender::ScrVert* v2 = edge->v2;
+
+			bool hasVerts = v1 != 0;
+			if (!hasVerts)
+				return false;
+		}
+	}
+
+	ptrPtrCount = 0;
+	ptrArrayCount = 0;
+
+	fbtList& objects = fp.m_object;
+	for (Object* ob = (Object*)objects.first; ob; ob = (Object*)ob->id.next)
+	{
+		bool meshHasData = ob->data && ob->type == 1;
+		if (meshHasData)
+		{
+
+			Mesh* me = (Mesh*)ob->data;
+
+			bool meshHasMaterials = me->mat && *me->mat;
+			if (!meshHasMaterials)
+				return false;
+
+			for (int i = 0; i < me->totcol; ++i)
+			{
+				Material* ma = me->mat[i];
+				if (ma)
+				{
+					++ptrPtrCount;
+
+					if (ma->mtex)
+					{
+						int j = 0;
+						while (ma->mtex[j] != 0)
+						{
+							if (ma->mtex[j]->tex)
+							{
+								++ptrArrayCount;
+							}
+							++j;
+						}
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+TEST(TEST_CASE_NAME, parsePointer32BitLinks)
+{
+	int ptrPtrCount;
+	int ptrArrayCount;
+	EXPECT_TRUE(parse_Ptr_PtrPtr_PtrArray("TestData/le32bitLink.blend", ptrPtrCount, ptrArrayCount));
+
+	ASSERT_EQ(ptrPtrCount, 4);
+	ASSERT_EQ(ptrArrayCount, 24);
+}
+
+TEST(TEST_CASE_NAME, parsePointer64BitLinks)
+{
+	int ptrPtrCount;
+	int ptrArrayCount;
+	EXPECT_TRUE(parse_Ptr_PtrPtr_PtrArray("TestData/le64bitLink.blend", ptrPtrCount, ptrArrayCount));
+
+	ASSERT_EQ(ptrPtrCount, 4);
+	ASSERT_EQ(ptrArrayCount, 24);
+}
+
+TEST(TEST_CASE_NAME, parseLinkThreads)
+{
+	int ptrPtrCount;
+	int ptrArrayCount;
+	EXPECT_TRUE(parse_Ptr_PtrPtr_PtrArray("TestData/le32bitLink.blend", ptrPtrCount, ptrArrayCount, 4));
+
+	ASSERT_EQ(ptrPtrCount, 4);
+	ASSERT_EQ(ptrArrayCount, 24);
+
+
+	// endian swapped, every chunk is converted
+	fbtBlend fp1, fp4;
+	fp1.setLinkThreads(1);
+	fp4.setLinkThreads(4);
+
+	const char *fname = "TestData/be32bit.blend";
+	ASSERT_EQ(fp1.parse(fname, fbtFile::PM_READTOMEMORY), fbtFile::FS_OK);
+	ASSERT_EQ(fp4.parse(fname, fbtFile::PM_READTOMEMORY), fbtFile::FS_OK);
+
+	EXPECT_EQ(fp1.getLoadStats().m_threads, 1);
+	EXPECT_EQ(fp4.getLoadStats().m_threads, 4);
+	EXPECT_EQ(fp1.getLoadStats().m_chunks, fp4.getLoadStats().m_chunks);
+
+	const fbtFile::StructStatsArray& st1 = fp1.getStructStats(), &st4 = fp4.getStructStats();
+	ASSERT_EQ(st1.size(), st4.size());
+	for (FBTsizeType i = 0; i < st1.size(); ++i)
+	{
+		EXPECT_EQ(st1.at(i).m_chunks, st4.at(i).m_chunks);
+		EXPECT_EQ(st1.at(i).m_bytes, st4.at(i).m_bytes);
+	}
+
+	Object* ob1 = (Object*)fp1.m_object.first, *ob4 = (Object*)fp4.m_object.first;
+	for (; ob1 && ob4; ob1 = (Object*)ob1->id.next, ob4 = (Object*)ob4->id.next)
+	{
+		EXPECT_STREQ(ob1->id.name, ob4->id.name);
+		EXPECT_EQ(ob1->type, ob4->type);
+		EXPECT_EQ(memcmp(ob1->obmat, ob4->obmat, sizeof(ob1->obmat)), 0);
+		ASSERT_EQ(ob1->data != 0, ob4->data != 0);
+		if (ob1->data)
+			EXPECT_STREQ(((ID*)ob1->data)->name, ((ID*)ob4->data)->name);
+	}
+	EXPECT_TRUE(!ob1 && !ob4);
+}
+
+// the objects of both files match, by name, type, matrix and data
+void compareObjects(fbtBlend& a, fbtBlend& b)
+{
+	Object* oa = (Object*)a.m_object.first, *ob = (Object*)b.m_object.first;
+	for (; oa && ob; oa = (Object*)oa->id.next, ob = (Object*)ob->id.next)
+	{
+		// blocks linked in place are aligned for their pointers
+		EXPECT_EQ((FBTsize)oa % sizeof(void*), 0);
+		EXPECT_STREQ(oa->id.name, ob->id.name);
+		EXPECT_EQ(oa->type, ob->type);
+		EXPECT_EQ(memcmp(oa->obmat, ob->obmat, sizeof(oa->obmat)), 0);
+		ASSERT_EQ(oa->data != 0, ob->data != 0);
+		if (oa->data)
+			EXPECT_STREQ(((ID*)oa->data)->name, ((ID*)ob->data)->name);
+
+		if (oa->type == 1 && oa->data)
+		{
+			Mesh* ma = (Mesh*)oa->data, *mb = (Mesh*)ob->data;
+			ASSERT_EQ(ma->totvert, mb->totvert);
+			ASSERT_EQ(ma->mvert != 0, mb->mvert != 0);
+			if (ma->mvert)
+				EXPECT_EQ(memcmp(ma->mvert, mb->mvert, sizeof(MVert) * ma->totvert), 0);
+		}
+	}
+	EXPECT_TRUE(!oa && !ob);
+}
+
+TEST(TEST_CASE_NAME, parseMapped)
+{
+	const char* files[] =
+	{
+		"TestData/be32bit.blend",
+		"TestData/le32bit.blend",
+		"TestData/le32bitLink.blend",
+		"TestData/le64bitLink.blend",
+	};
+
+	for (int i = 0; i < 4; ++i)
+	{
+		fbtBlend mapped, read;
+		ASSERT_EQ(mapped.parse(files[i], fbtFile::PM_MAPPED), fbtFile::FS_OK);
+		ASSERT_EQ(read.parse(files[i], fbtFile::PM_READTOMEMORY), fbtFile::FS_OK);
+
+		compareObjects(mapped, read);
+	}
+
+	// null pointer array entries of 32 and 64 bit files, linked in place
+	int ptrPtrCount, ptrArrayCount;
+	EXPECT_TRUE(parse_Ptr_PtrPtr_PtrArray("TestData/le32bitLink.blend", ptrPtrCount, ptrArrayCount, 0, fbtFile::PM_MAPPED));
+	EXPECT_EQ(ptrPtrCount, 4);
+	EXPECT_EQ(ptrArrayCount, 24);
+	EXPECT_TRUE(parse_Ptr_PtrPtr_PtrArray("TestData/le64bitLink.blend", ptrPtrCount, ptrArrayCount, 0, fbtFile::PM_MAPPED));
+	EXPECT_EQ(ptrPtrCount, 4);
+	EXPECT_EQ(ptrArrayCount, 24);
+
+	// struct chunks are only linked in place when the file layout is the native one
+	fbtBlend swapped;
+	ASSERT_EQ(swapped.parse("TestData/be32bit.blend", fbtFile::PM_MAPPED), fbtFile::FS_OK);
+	EXPECT_EQ(swapped.getInPlaceCount(), 0);
+
+	fbtBlend native;
+	const char* nativeFile = sizeof(void*) == 8 ? "TestData/le64bitLink.blend" : "TestData/le32bitLink.blend";
+	ASSERT_EQ(native.parse(nativeFile, fbtFile::PM_MAPPED), fbtFile::FS_OK);
+	EXPECT_GT(native.getInPlaceCount(), 0);
+}
+
+TEST(TEST_CASE_NAME, parseBlend32bit)
+{	
+	EXPECT_TRUE(parseBlendFile("TestData/be32bit.blend"));
+	EXPECT_TRUE(parseBlendFile("TestData/le32bit.blend"));	
+	EXPECT_TRUE(parseBlendFile("TestData/le32bitLink.blend"));
+	EXPECT_TRUE(parseBlendFile("TestData/le32_bv225.blend"));
+	EXPECT_TRUE(parseBlendFile("TestData/Refl_le32bitLink.blend"));
+}
+
+TEST(TEST_CASE_NAME, parseBlend64bit)
+{	
+	EXPECT_TRUE(parseBlendFile("TestData/le64bitLink.blend"));
+}
+
+TEST(TEST_CASE_NAME, findCameraObj)
+{
+	fbtBlend fp;
+
+	const char *fname = "TestData/be32bit.blend";	
+	ASSERT_EQ(fp.parse(fname, fbtFile::PM_READTOMEMORY), fbtFile::FS_OK);
+
+	bool findCameraObj = 0;
+	std::string cameraName = "camera0";
+	 
+	fbtList& objects = fp.m_object;
+	for (Object* ob = (Object*)objects.first; ob; ob = (Object*)ob->id.next)
+	{
+		//printf("%d %s\n", ob->type, GKB_IDNAME(ob));
+		if (cameraName == GKB_IDNAME(ob) && ob->type == OB_CAMERA)
+		{
+			findCameraObj = true;
+			break;
+		}
+	}
+
+	EXPECT_TRUE(findCameraObj);
+}
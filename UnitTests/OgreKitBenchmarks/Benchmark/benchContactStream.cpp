@@ -0,0 +1,80 @@
+#include "StdAfx.h"
+#include "Fixtures/ContactFixture.h"
+
+#define TEST_CASE_NAME benchContactStream
+
+
+TEST(TEST_CASE_NAME, testStream)
+{
+	// a pile of bodies touching their neighbours, four points per manifold
+	const int objects = 500, manifolds = 2000, points = 4, substeps = 200;
+	Controllers cont(objects);
+
+	utArray<btManifoldPoint> pts;
+	for (int p = 0; p < points; ++p)
+		pts.push_back(makePoint(-0.01f * (p + 1)));
+
+	btClock clock;
+
+	// what every controller did before, an array of copies each
+	utArray< utArray<gkContactInfo> > local;
+	local.resize(objects);
+
+	clock.reset();
+	UTsize copied = 0;
+	for (int s = 0; s < substeps; ++s)
+	{
+		int i;
+		for (i = 0; i < manifolds; ++i)
+		{
+			local[i % objects].clear(true);
+			local[(i * 7 + 1) % objects].clear(true);
+		}
+
+		for (i = 0; i < manifolds; ++i)
+		{
+			int a = i % objects, b = (i * 7 + 1) % objects;
+			for (int p = 0; p < points; ++p)
+			{
+				gkContactInfo cinf;
+				cinf.collider = cont[b];
+				cinf.point    = pts[p];
+				local[a].push_back(cinf);
+
+				cinf.collider = cont[a];
+				local[b].push_back(cinf);
+			}
+		}
+	}
+	for (int i = 0; i < objects; ++i)
+		copied += local[i].size();
+	unsigned long tlocal = clock.getTimeMicroseconds();
+
+	gkContactStream stream;
+
+	clock.reset();
+	for (int s = 0; s < substeps; ++s)
+	{
+		stream.begin();
+		for (int i = 0; i < manifolds; ++i)
+		{
+			int a = i % objects, b = (i * 7 + 1) % objects;
+			for (int p = 0; p < points; ++p)
+			{
+				stream.add(cont[a], cont[b], &pts[p]);
+				stream.add(cont[b], cont[a], &pts[p]);
+			}
+		}
+		stream.end();
+	}
+	unsigned long tstream = clock.getTimeMicroseconds();
+
+	EXPECT_EQ(stream.size(), copied);
+
+	UTsize total = 0;
+	for (int i = 0; i < objects; ++i)
+		total += stream.getNumContacts(cont[i]);
+	EXPECT_EQ(total, stream.size());
+
+	printf("%i substeps of %i manifolds: per controller arrays %6lu us, contact stream %6lu us\n", substeps, manifolds, tlocal, tstream);
+}
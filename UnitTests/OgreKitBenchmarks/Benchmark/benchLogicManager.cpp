@@ -0,0 +1,25 @@
+#include "StdAfx.h"
+#include "Fixtures/LogicFixture.h"
+
+#define TEST_CASE_NAME benchLogicManager
+
+
+TEST(TEST_CASE_NAME, testScaling)
+{
+	const int counts[] = {250, 1000, 4000, 16000};
+	const int ticks = 100;
+
+	for (int c = 0; c < 4; ++c)
+	{
+		BenchScene bench(counts[c]);
+
+		btClock clock;
+		for (int t = 0; t < ticks; ++t)
+			bench.tick();
+		unsigned long us = clock.getTimeMicroseconds();
+
+		printf("%6i bricks: %8.3f ms/tick\n", counts[c] * 2, (double)us / (1000.0 * ticks));
+
+		EXPECT_EQ(bench.m_actuators[0]->m_count, ticks);
+	}
+}
@@ -0,0 +1,60 @@
+#include "StdAfx.h"
+
+#ifdef OGREKIT_USE_LUA
+
+#include "Fixtures/LuaFixture.h"
+
+#define TEST_CASE_NAME benchLuaCache
+
+
+TEST(TEST_CASE_NAME, testStartup)
+{
+	const int count = 300;
+	lua_State* L = luaL_newstate();
+	btClock clock;
+	int i;
+
+	utArray<gkString> scripts;
+	for (i = 0; i < count; ++i)
+		scripts.push_back(makeScript(i));
+
+	gkLuaCache cache(CACHE_DIR);
+	remove(cache.getCacheFile().c_str());
+
+	clock.reset();
+	for (i = 0; i < count; ++i)
+	{
+		compile(L, 0, scripts[i], "Script.lua");
+		runNumber(L);
+	}
+	unsigned long tsource = clock.getTimeMicroseconds();
+
+	for (i = 0; i < count; ++i)
+	{
+		compile(L, &cache, scripts[i], "Script.lua");
+		lua_pop(L, 1);
+	}
+	cache.save();
+
+	// a later start
+	clock.reset();
+	gkLuaCache loaded(CACHE_DIR);
+	loaded.load();
+	bool ok = true;
+	for (i = 0; i < count; ++i)
+	{
+		ok = ok && compile(L, &loaded, scripts[i], "Script.lua");
+		ok = ok && runNumber(L) == i;
+	}
+	unsigned long tcache = clock.getTimeMicroseconds();
+
+	EXPECT_TRUE(ok);
+	EXPECT_EQ(loaded.getHits(), count);
+
+	remove(cache.getCacheFile().c_str());
+	lua_close(L);
+
+	printf("%i scripts: compiled %6lu us, from cache %6lu us (both run them, the cache includes the file read)\n", count, tsource, tcache);
+}
+
+#endif
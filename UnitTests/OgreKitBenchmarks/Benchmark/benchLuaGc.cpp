@@ -0,0 +1,75 @@
+#include "StdAfx.h"
+#include <algorithm>
+#include <vector>
+
+#ifdef OGREKIT_USE_LUA
+
+#include "Script/Lua/gkLuaGc.h"
+#include "Fixtures/LuaFixture.h"
+
+#define TEST_CASE_NAME benchLuaGc
+
+
+TEST(TEST_CASE_NAME, testFrameTimes)
+{
+	const int frames = 2000;
+	const char* script = "for i = 1, 20 do local v = {x = i, name = 'obj' .. i} end\n";
+
+	btClock clock;
+	unsigned long total[2] = {0, 0}, slow[2], worst[2];
+
+	for (int scheduled = 0; scheduled < 2; ++scheduled)
+	{
+		lua_State* L = createState();
+		luaL_loadstring(L, script);
+		int ref = luaL_ref(L, LUA_REGISTRYINDEX);
+
+		gkLuaGc gc(L);
+		gc.setBudget(scheduled ? 500 : 0);
+
+		// collection time per frame, with 1 to 80 script calls per frame
+		std::vector<unsigned long> times;
+		unsigned int seed = 1;
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			seed = seed * 1103515245 + 12345;
+			int calls = 1 + (seed >> 16) % 80;
+			unsigned long t = 0;
+
+			for (int i = 0; i < calls; ++i)
+			{
+				lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+				lua_pcall(L, 0, 0, 0);
+
+				if (!scheduled)
+				{
+					// what gkLuaScript::execute did after each call
+					clock.reset();
+					lua_gc(L, LUA_GCSTEP, 1);
+					t += clock.getTimeMicroseconds();
+				}
+			}
+
+			if (scheduled)
+			{
+				gc.update();
+				t = gc.getLastMicroSeconds();
+			}
+
+			times.push_back(t);
+			total[scheduled] += t;
+		}
+
+		std::sort(times.begin(), times.end());
+		slow[scheduled] = times[frames * 99 / 100];
+		worst[scheduled] = times.back();
+
+		lua_close(L);
+	}
+
+	printf("gc per frame: after each script %4lu us average, %4lu us 99th percentile, %5lu us worst; "
+	       "500 us budget %4lu us average, %4lu us 99th percentile, %5lu us worst\n",
+	       total[0] / frames, slow[0], worst[0], total[1] / frames, slow[1], worst[1]);
+}
+
+#endif
@@ -0,0 +1,65 @@
+#include "StdAfx.h"
+#include "Fixtures/MessageFixture.h"
+
+#define TEST_CASE_NAME benchMessageManager
+
+
+TEST(TEST_CASE_NAME, testRouting)
+{
+	ScopedManager scoped;
+	gkMessageManager& mgr = scoped.get();
+
+	// one listener per object and subject, like message sensors
+	const int objects = 1000, messages = 20000;
+	utArray<gkMessageManager::GenericMessageListener*> listeners;
+	utArray<gkMessageManager::Id> names, subjects;
+	char buf[64];
+
+	for (int i = 0; i < objects; ++i)
+	{
+		sprintf(buf, "Object.%03i", i);
+		gkString name = buf;
+		sprintf(buf, "subject%i", i % 100);
+		gkString subject = buf;
+
+		gkMessageManager::GenericMessageListener* listener = new gkMessageManager::GenericMessageListener("", name, subject);
+		listener->setAcceptEmptyTo(true);
+		mgr.addListener(listener);
+		listeners.push_back(listener);
+
+		names.push_back(mgr.intern(name));
+		subjects.push_back(mgr.intern(subject));
+	}
+
+	btClock clock;
+	int received = 0;
+
+	clock.reset();
+	for (int i = 0; i < messages; ++i)
+		mgr.sendMessage(names[(i * 7) % objects], names[i % objects], subjects[i % objects], "body");
+	unsigned long tid = clock.getTimeMicroseconds();
+
+	for (int i = 0; i < objects; ++i)
+	{
+		received += listeners[i]->m_messages.size();
+		listeners[i]->emptyMessages();
+	}
+
+	mgr.nextTick();
+
+	clock.reset();
+	for (int i = 0; i < messages; ++i)
+		mgr.sendMessage(mgr.getString(names[(i * 7) % objects]), mgr.getString(names[i % objects]), mgr.getString(subjects[i % objects]), "body");
+	unsigned long tstr = clock.getTimeMicroseconds();
+
+	for (int i = 0; i < objects; ++i)
+	{
+		received += listeners[i]->m_messages.size();
+		mgr.removeListener(listeners[i]);
+		delete listeners[i];
+	}
+
+	EXPECT_EQ(received, messages * 2);
+
+	printf("%i messages to %i listeners: interned %6lu us, by name %6lu us\n", messages, objects, tid, tstr);
+}
@@ -0,0 +1,124 @@
+#include "StdAfx.h"
+
+#define TEST_CASE_NAME benchNetwork
+
+#ifdef OGREKIT_COMPILE_ENET
+
+#include "Fixtures/NetworkFixture.h"
+
+namespace
+{
+
+// the previous protocol, one ';' separated text packet per message
+struct TextDecoder
+{
+	int m_count;
+
+	TextDecoder() : m_count(0) {}
+
+	void decode(const ENetPacket* packet)
+	{
+		gkString from, to, subject, body;
+		gkString* parts[] = {&from, &to, &subject, &body};
+		int part = 0;
+		for (size_t i = 0; i < packet->dataLength; ++i)
+		{
+			char c = (char)packet->data[i];
+			if (c == ';' && part < 3)
+				++part;
+			else
+				*parts[part] += c;
+		}
+		m_count += part == 3;
+	}
+};
+
+
+struct BinaryDecoder
+{
+	int m_count;
+	gkString m_from, m_to, m_subject, m_body;
+
+	BinaryDecoder() : m_count(0) {}
+
+	void decode(const ENetPacket* packet)
+	{
+		gkNetworkPacketReader reader(packet->data, packet->dataLength);
+		UTuint8 type;
+		while (reader.readU8(type) && type == GK_NET_FRAME_MESSAGE)
+		{
+			if (!reader.readMessage(m_from, m_to, m_subject, m_body))
+				break;
+			++m_count;
+		}
+	}
+};
+
+}
+
+
+TEST(TEST_CASE_NAME, testLoopback)
+{
+	const int count = 20000, perTick = 100;
+	const gkString from = "Player", to = "Enemy.001", subject = "hit", body = "damage=10";
+
+	for (int compress = 0; compress < 2; ++compress)
+	{
+		unsigned long ttext, tbinary;
+		UTsize bytes = 0;
+		btClock clock;
+
+		{
+			LoopbackHosts hosts(compress != 0);
+			if (!hosts.isConnected())
+			{
+				printf("loopback enet hosts unavailable, skipping benchmark\n");
+				return;
+			}
+
+			TextDecoder decoder;
+			clock.reset();
+			for (int i = 0; i < count; ++i)
+			{
+				gkString text = from + ";" + to + ";" + subject + ";" + body;
+				ENetPacket* packet = enet_packet_create(text.c_str(), text.size(), ENET_PACKET_FLAG_RELIABLE);
+				enet_peer_send(hosts.m_peer, 0, packet);
+				enet_host_flush(hosts.m_client);
+
+				if ((i + 1) % perTick == 0)
+					EXPECT_TRUE(hosts.receive(i + 1, decoder));
+			}
+			ttext = clock.getTimeMicroseconds();
+		}
+
+		{
+			LoopbackHosts hosts(compress != 0);
+			ASSERT_TRUE(hosts.isConnected());
+
+			BinaryDecoder decoder;
+			gkNetworkPacketWriter batch;
+			clock.reset();
+			for (int i = 0; i < count; ++i)
+			{
+				batch.writeMessage(from, to, subject, body);
+
+				if ((i + 1) % perTick == 0)
+				{
+					bytes += batch.size();
+					ENetPacket* packet = enet_packet_create(batch.ptr(), batch.size(), ENET_PACKET_FLAG_RELIABLE);
+					enet_peer_send(hosts.m_peer, 0, packet);
+					enet_host_flush(hosts.m_client);
+					batch.clear();
+
+					EXPECT_TRUE(hosts.receive(i + 1, decoder));
+				}
+			}
+			tbinary = clock.getTimeMicroseconds();
+		}
+
+		printf("%s: text %7lu us, batched binary %7lu us (%i messages, %i per tick, %u bytes)\n",
+		       compress ? "range coder" : "plain      ", ttext, tbinary, count, perTick, (unsigned int)bytes);
+	}
+}
+
+#endif
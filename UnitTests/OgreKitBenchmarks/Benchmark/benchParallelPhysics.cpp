@@ -0,0 +1,32 @@
+#include "StdAfx.h"
+#include "Fixtures/PhysicsFixture.h"
+
+#define TEST_CASE_NAME benchParallelPhysics
+
+
+TEST(TEST_CASE_NAME, testPiles)
+{
+	const int frames = 120, piles = 16;
+	btClock clock;
+
+	clock.reset();
+	{
+		Scene scene(false, piles);
+		scene.run(frames);
+	}
+	unsigned long tserial = clock.getTimeMicroseconds();
+
+	unsigned long tparallel;
+	int threads;
+	{
+		gkJobSystem jobs;
+		threads = jobs.getNumThreads() + 1;
+
+		clock.reset();
+		Scene scene(true, piles);
+		scene.run(frames);
+		tparallel = clock.getTimeMicroseconds();
+	}
+
+	printf("%i frames of %i objects: serial %7lu us, %i threads %7lu us\n", frames, piles * 40, tserial, threads, tparallel);
+}
@@ -0,0 +1,57 @@
+#include "StdAfx.h"
+#include "Fixtures/RayBatchFixture.h"
+
+#define TEST_CASE_NAME benchRayBatch
+
+
+TEST(TEST_CASE_NAME, testLineOfSight)
+{
+	// line of sight checks between agents over the field
+	const int size = 40, count = 8000;
+	World world(size);
+
+	gkRayBatch batch(&world.m_world);
+	Random rnd;
+	for (int i = 0; i < count; ++i)
+		batch.addRay(rnd.point(size * 3.f), rnd.point(size * 3.f));
+
+	btClock clock;
+	int i, hits[3] = {0, 0, 0};
+
+	clock.reset();
+	for (i = 0; i < count; ++i)
+	{
+		gkRayTest::gkRayTestFilter ref;
+		ref.m_collisionFilterGroup = btBroadphaseProxy::AllFilter;
+		ref.m_collisionFilterMask = btBroadphaseProxy::AllFilter;
+		world.m_world.rayTest(toBullet(batch.getQueries()[i].from), toBullet(batch.getQueries()[i].to), ref);
+		hits[0] += ref.hasHit() ? 1 : 0;
+	}
+	unsigned long tsingle = clock.getTimeMicroseconds();
+
+	gkRayBatch::Results results;
+	clock.reset();
+	batch.cast(results);
+	unsigned long tbatch = clock.getTimeMicroseconds();
+	for (i = 0; i < count; ++i)
+		hits[1] += results[i].hasHit() ? 1 : 0;
+
+	unsigned long tparallel;
+	int threads;
+	{
+		gkJobSystem jobs;
+		threads = jobs.getNumThreads() + 1;
+
+		clock.reset();
+		batch.cast(results);
+		tparallel = clock.getTimeMicroseconds();
+	}
+	for (i = 0; i < count; ++i)
+		hits[2] += results[i].hasHit() ? 1 : 0;
+
+	EXPECT_EQ(hits[0], hits[1]);
+	EXPECT_EQ(hits[0], hits[2]);
+
+	printf("%i rays among %i objects: rayTest %6lu us, batch %6lu us, batch on %i threads %6lu us\n",
+	       count, size * size, tsingle, tbatch, threads, tparallel);
+}
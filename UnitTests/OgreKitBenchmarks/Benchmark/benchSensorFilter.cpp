@@ -0,0 +1,40 @@
+#include "StdAfx.h"
+#include "Fixtures/SensorFilterFixture.h"
+
+#define TEST_CASE_NAME benchSensorFilter
+
+
+TEST(TEST_CASE_NAME, testProperties)
+{
+	// every object against a handful of sensor filters, as contacts would
+	const int count = 2000, props = 8, rounds = 50;
+	Objects obs(count, props);
+
+	gkString names[4] = {"Prop.1", "Prop.3", "Prop.5", "NoSuchProp"};
+	gkSensorFilter filters[4];
+	int f;
+	for (f = 0; f < 4; ++f)
+		filters[f].setProperty(names[f]);
+
+	btClock clock;
+	int i, r, hits[2] = {0, 0};
+
+	clock.reset();
+	for (r = 0; r < rounds; ++r)
+		for (i = 0; i < count; ++i)
+			for (f = 0; f < 4; ++f)
+				hits[0] += gkPhysicsController::sensorTest(obs[i], names[f]) ? 1 : 0;
+	unsigned long tstring = clock.getTimeMicroseconds();
+
+	clock.reset();
+	for (r = 0; r < rounds; ++r)
+		for (i = 0; i < count; ++i)
+			for (f = 0; f < 4; ++f)
+				hits[1] += filters[f].test(obs[i]) ? 1 : 0;
+	unsigned long tmask = clock.getTimeMicroseconds();
+
+	EXPECT_EQ(hits[0], hits[1]);
+	EXPECT_EQ(hits[0], rounds * count * 3 / props);
+
+	printf("%i property tests: strings %6lu us, interned masks %6lu us\n", rounds * count * 4, tstring, tmask);
+}
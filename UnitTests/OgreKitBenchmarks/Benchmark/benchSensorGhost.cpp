@@ -0,0 +1,61 @@
+#include "StdAfx.h"
+#include "Fixtures/SensorGhostFixture.h"
+
+#define TEST_CASE_NAME benchSensorGhost
+
+
+TEST(TEST_CASE_NAME, testSensors)
+{
+	// 300 sensors in 2500 boxes never exactly touching one, walking & idle
+	const int sensors = 300, ticks = 100;
+	World world(50, 2.f);
+	btClock clock;
+
+	utArray<gkSensorGhost*> ghosts;
+	for (int i = 0; i < sensors; ++i)
+	{
+		ghosts.push_back(new gkSensorGhost(&world.m_world));
+		ghosts[i]->setSphere(1.5f);
+	}
+
+	utArray<const btCollisionObject*> hits;
+	btSphereShape sphere(1.5f);
+
+	for (int moving = 1; moving >= 0; --moving)
+	{
+		UTsize found[2] = {0, 0};
+		unsigned long time[2] = {0, 0};
+
+		for (int t = 0; t < ticks; ++t)
+		{
+			btScalar offset = moving ? btScalar(t) * 0.1f : 0.f;
+
+			clock.reset();
+			for (int i = 0; i < sensors; ++i)
+			{
+				world.contactTest(makeTransform(btScalar((i * 13) % 97) + offset, btScalar((i * 7) % 97) + 0.25f), &sphere, hits);
+				found[0] += hits.size();
+			}
+			time[0] += clock.getTimeMicroseconds();
+
+			clock.reset();
+			for (int i = 0; i < sensors; ++i)
+			{
+				ghosts[i]->setTransform(makeTransform(btScalar((i * 13) % 97) + offset, btScalar((i * 7) % 97) + 0.25f));
+				ghosts[i]->collides(hits);
+				found[1] += hits.size();
+			}
+			time[1] += clock.getTimeMicroseconds();
+
+			world.m_world.stepSimulation(btScalar(1.) / 60);
+		}
+
+		EXPECT_EQ(found[0], found[1]);
+
+		printf("%i %s sensors, %i ticks: contact tests %6lu us, sensor ghosts %6lu us\n",
+		       sensors, moving ? "moving" : "idle", ticks, time[0], time[1]);
+	}
+
+	for (int i = 0; i < sensors; ++i)
+		delete ghosts[i];
+}
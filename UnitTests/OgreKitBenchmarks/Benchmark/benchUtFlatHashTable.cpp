@@ -0,0 +1,95 @@
+#include "StdAfx.h"
+
+#define TEST_CASE_NAME benchUtFlatHashTable
+
+namespace
+{
+
+template<typename Table, typename Key>
+void benchTable(const char* name, const utArray<Key>& keys, const utArray<Key>& misses)
+{
+	const UTsize n = keys.size();
+	UTsize i, found = 0;
+	unsigned long tins, tfind, tmiss, titer, terase;
+	btClock clock;
+
+	Table table;
+
+	clock.reset();
+	for (i = 0; i < n; i++)
+		table.insert(keys[i], (int)i);
+	tins = clock.getTimeMicroseconds();
+
+	// lookups alternate between keys so the last key cache of utHashTable does not help
+	clock.reset();
+	for (int r = 0; r < 4; r++)
+		for (i = 0; i < n; i++)
+			found += table.find(keys[(i * 7919) % n]) != UT_NPOS;
+	tfind = clock.getTimeMicroseconds();
+
+	clock.reset();
+	for (i = 0; i < n; i++)
+		found += table.find(misses[i]) != UT_NPOS;
+	tmiss = clock.getTimeMicroseconds();
+
+	clock.reset();
+	int sum = 0;
+	typename Table::Iterator it = table.iterator();
+	while (it.hasMoreElements())
+		sum += it.getNext().second;
+	titer = clock.getTimeMicroseconds();
+
+	clock.reset();
+	for (i = 0; i < n; i += 2)
+		table.erase(keys[i]);
+	terase = clock.getTimeMicroseconds();
+
+	EXPECT_EQ(found, n * 4);
+	EXPECT_EQ(table.size(), n / 2);
+
+	printf("%-28s %7u keys: insert %6lu find %6lu miss %6lu iterate %5lu erase %6lu us (%i)\n",
+	       name, (unsigned int)n, tins, tfind, tmiss, titer, terase, sum & 1);
+}
+
+}
+
+
+TEST(TEST_CASE_NAME, testTables)
+{
+	const UTsize counts[] = {1000, 20000, 200000};
+
+	for (int c = 0; c < 3; c++)
+	{
+		const UTsize n = counts[c];
+
+		// integer ids, like fbt chunk old pointers and resource handles
+		utArray<utIntHashKey> ints, intMisses;
+		ints.reserve(n);
+		intMisses.reserve(n);
+		for (UTsize i = 0; i < n; i++)
+		{
+			ints.push_back(utIntHashKey((UTint32)(i * 16 + 0x8000000)));
+			intMisses.push_back(utIntHashKey((UTint32)(i * 16 + 0x8000001)));
+		}
+
+		benchTable<utHashTable<utIntHashKey, int>,     utIntHashKey>("utHashTable<int>",     ints, intMisses);
+		benchTable<utFlatHashTable<utIntHashKey, int>, utIntHashKey>("utFlatHashTable<int>", ints, intMisses);
+
+		// resource names, like "OBCube.001" or "MAMaterial.012"
+		utArray<utHashedString> names, nameMisses;
+		names.reserve(n);
+		nameMisses.reserve(n);
+		char buf[64];
+		const char* prefix[] = {"OB", "ME", "MA", "TE", "IM", "AC"};
+		for (UTsize i = 0; i < n; i++)
+		{
+			sprintf(buf, "%sObject.%03u", prefix[i % 6], (unsigned int)(i / 6));
+			names.push_back(utHashedString(buf));
+			sprintf(buf, "Missing.%u", (unsigned int)i);
+			nameMisses.push_back(utHashedString(buf));
+		}
+
+		benchTable<utHashTable<utHashedString, int>,     utHashedString>("utHashTable<string>",     names, nameMisses);
+		benchTable<utFlatHashTable<utHashedString, int>, utHashedString>("utFlatHashTable<string>", names, nameMisses);
+	}
+}
@@ -0,0 +1,64 @@
+#include "StdAfx.h"
+#include "Fixtures/MemoryPoolFixture.h"
+
+#define TEST_CASE_NAME benchUtMemoryPool
+
+
+TEST(TEST_CASE_NAME, testAllocators)
+{
+	const int count = 100000, rounds = 10;
+	utArray<PoolItem*> items;
+	items.resize(count);
+	btClock clock;
+	int i, r;
+
+	clock.reset();
+	for (r = 0; r < rounds; r++)
+	{
+		for (i = 0; i < count; i++)
+			items[i] = new PoolItem();
+		for (i = 0; i < count; i++)
+			delete items[i];
+	}
+	unsigned long theap = clock.getTimeMicroseconds();
+
+	utMemoryPool<PoolItem, 0> pool(1024);
+	clock.reset();
+	for (r = 0; r < rounds; r++)
+	{
+		for (i = 0; i < count; i++)
+			items[i] = pool.alloc();
+		for (i = 0; i < count; i++)
+			pool.dealloc(items[i]);
+	}
+	unsigned long tpool = clock.getTimeMicroseconds();
+
+	// per tick temporaries, a few hundred small arrays
+	const int temps = 500;
+	void* ptrs[temps];
+
+	clock.reset();
+	for (r = 0; r < 1000; r++)
+	{
+		for (i = 0; i < temps; i++)
+			ptrs[i] = malloc(16 + (i & 7) * 32);
+		for (i = 0; i < temps; i++)
+			free(ptrs[i]);
+	}
+	unsigned long tmalloc = clock.getTimeMicroseconds();
+
+	utFrameArena arena;
+	clock.reset();
+	for (r = 0; r < 1000; r++)
+	{
+		for (i = 0; i < temps; i++)
+			ptrs[i] = arena.alloc(16 + (i & 7) * 32);
+		arena.reset();
+	}
+	unsigned long tarena = clock.getTimeMicroseconds();
+
+	EXPECT_EQ(PoolItem::m_alive, 0);
+
+	printf("new/delete %6lu us, utMemoryPool %6lu us (%i objects x %i)\n", theap, tpool, count, rounds);
+	printf("malloc/free %6lu us, utFrameArena %6lu us (%i temporaries x 1000 ticks)\n", tmalloc, tarena, temps);
+}
@@ -0,0 +1,12 @@
+#ifndef _StdAfx_h_
+#define _StdAfx_h_
+
+#include "OgreKit.h"
+
+#include "Ogre.h"
+
+#include "LinearMath/btQuickprof.h"
+
+#include <gtest/gtest.h>
+
+#endif //_StdAfx_h_
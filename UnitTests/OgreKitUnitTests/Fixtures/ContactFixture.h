@@ -0,0 +1,50 @@
+#ifndef _ContactFixture_h_
+#define _ContactFixture_h_
+
+#include "Physics/gkContactStream.h"
+#include "Fixtures/ObjectFixture.h"
+
+namespace
+{
+
+// controllers without a world, only the contact span is used
+class Controllers
+{
+public:
+	ObjectManager                 m_manager;
+	utArray<gkGameObject*>        m_objects;
+	utArray<gkPhysicsController*> m_controllers;
+
+	Controllers(int count)
+	{
+		char buf[32];
+		for (int i = 0; i < count; ++i)
+		{
+			sprintf(buf, "Object.%03i", i);
+			gkGameObject* ob = new gkGameObject(&m_manager, gkResourceName(buf), i, GK_OBJECT);
+			m_objects.push_back(ob);
+			m_controllers.push_back(new gkPhysicsController(ob, 0));
+		}
+	}
+
+	~Controllers()
+	{
+		for (UTsize i = 0; i < m_controllers.size(); ++i)
+		{
+			delete m_controllers[i];
+			delete m_objects[i];
+		}
+	}
+
+	gkPhysicsController* operator[](int i) { return m_controllers[i]; }
+};
+
+
+btManifoldPoint makePoint(btScalar distance)
+{
+	return btManifoldPoint(btVector3(0, 0, 0), btVector3(0, 0, 0), btVector3(0, 0, 1), distance);
+}
+
+}
+
+#endif//_ContactFixture_h_
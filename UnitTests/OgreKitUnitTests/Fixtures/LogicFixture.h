@@ -0,0 +1,125 @@
+#ifndef _LogicFixture_h_
+#define _LogicFixture_h_
+
+#include "Fixtures/ObjectFixture.h"
+
+namespace
+{
+
+class BenchSensor : public gkLogicSensor
+{
+public:
+	BenchSensor(gkGameObject* object, gkLogicLink* link, const gkString& name)
+		:	gkLogicSensor(object, link, name) {}
+
+	gkLogicBrick* clone(gkLogicLink* link, gkGameObject* dest) { return 0; }
+	bool query(void) { return true; }
+};
+
+
+class BenchActuator : public gkLogicActuator
+{
+public:
+	int m_count;
+
+	BenchActuator(gkGameObject* object, gkLogicLink* link, const gkString& name)
+		:	gkLogicActuator(object, link, name), m_count(0) {}
+
+	gkLogicBrick* clone(gkLogicLink* link, gkGameObject* dest) { return 0; }
+	void execute(void) { ++m_count; }
+};
+
+
+// Switches its actuators on and off every other tick, so half of the
+// active actuators are pushed and the other half popped each update.
+class BenchController : public gkLogicController
+{
+public:
+	bool m_on;
+
+	BenchController(gkGameObject* object, gkLogicLink* link, const gkString& name)
+		:	gkLogicController(object, link, name), m_on(false) {}
+
+	gkLogicBrick* clone(gkLogicLink* link, gkGameObject* dest) { return 0; }
+
+	void execute(void)
+	{
+		m_on = !m_on;
+
+		gkLogicManager* mgr = m_link->getLogicManager();
+		gkActuatorIterator it(m_actuators);
+		while (it.hasMoreElements())
+			mgr->push(this, it.getNext(), m_on);
+	}
+};
+
+
+class BenchScene
+{
+public:
+	ObjectManager   m_creator;
+	gkEngine*       m_engine;
+	gkScene*        m_scene;
+	gkGameObject*   m_object;
+	gkLogicManager* m_logic;
+	gkLogicLink*    m_link;
+	BenchSensor*    m_sensor;
+
+	utArray<BenchController*> m_controllers;
+	utArray<BenchActuator*>   m_actuators;
+
+	BenchScene(int count)
+	{
+		// game objects use the engine singleton on destruction
+		m_engine = gkEngine::getSingletonPtr() ? 0 : new gkEngine();
+
+		m_scene  = new gkScene(&m_creator, gkResourceName("BenchScene"), 0);
+		m_object = new gkGameObject(&m_creator, gkResourceName("BenchObject"), 1);
+		m_object->setOwner(m_scene);
+		m_logic  = m_scene->getLogicBrickManager();
+
+		gkLogicLink* link = m_logic->createLink();
+		link->setState(1);
+		m_link = link;
+
+		m_sensor = new BenchSensor(m_object, link, "Sensor");
+		m_sensor->setMask(1);
+		link->push(m_sensor);
+
+		for (int i = 0; i < count; ++i)
+		{
+			BenchController* cont = new BenchController(m_object, link, "Controller");
+			BenchActuator* act = new BenchActuator(m_object, link, "Actuator");
+			cont->setMask(1);
+			act->setMask(1);
+			link->push(cont);
+			link->push(act);
+			cont->link(act);
+
+			m_controllers.push_back(cont);
+			m_actuators.push_back(act);
+		}
+	}
+
+	~BenchScene()
+	{
+		// deletes the link and its bricks
+		delete m_logic;
+		delete m_object;
+		delete m_scene;
+		delete m_engine;
+	}
+
+	void tick(void)
+	{
+		UTsize i;
+		for (i = 0; i < m_controllers.size(); ++i)
+			m_logic->push(m_sensor, m_controllers[i], true);
+
+		m_logic->update(gkScalar(1.0 / 60.0));
+	}
+};
+
+}
+
+#endif//_LogicFixture_h_
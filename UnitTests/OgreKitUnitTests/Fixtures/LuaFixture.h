@@ -0,0 +1,74 @@
+#ifndef _LuaFixture_h_
+#define _LuaFixture_h_
+
+#include "Script/Lua/gkLuaCache.h"
+#include "Script/Lua/gkLuaUtils.h"
+
+namespace
+{
+
+const char* CACHE_DIR = "TestData";
+
+
+// a logic script of a few dozen lines, the id makes every text unique
+gkString makeScript(int id)
+{
+	char buf[64];
+	gkString text = "local Player = {}\n";
+
+	for (int i = 0; i < 20; ++i)
+	{
+		sprintf(buf, "function Player.update%i(dt, speed)\n", i);
+		text += buf;
+		text += "\tlocal x, y = 0, 0\n\tfor i = 1, 10 do\n\t\tx = x + speed * dt * i\n\t\ty = y - x / 2\n\tend\n";
+		text += "\tif x > y then return x else return y end\nend\n";
+	}
+
+	sprintf(buf, "return %i\n", id);
+	text += buf;
+	return text;
+}
+
+
+// compiles text the way gkLuaScript does, through the cache when given
+bool compile(lua_State* L, gkLuaCache* cache, const gkString& text, const char* name)
+{
+	if (cache && cache->loadChunk(L, text.c_str(), text.size(), name))
+		return true;
+
+	if (luaL_loadbuffer(L, text.c_str(), text.size(), name) != 0)
+	{
+		lua_pop(L, 1);
+		return false;
+	}
+
+	if (cache)
+		cache->addChunk(L, text.c_str(), text.size());
+	return true;
+}
+
+
+int runNumber(lua_State* L)
+{
+	if (lua_pcall(L, 0, 1, 0) != 0)
+	{
+		lua_pop(L, 1);
+		return -1;
+	}
+
+	int ret = (int)lua_tonumber(L, -1);
+	lua_pop(L, 1);
+	return ret;
+}
+
+
+lua_State* createState(void)
+{
+	lua_State* L = luaL_newstate();
+	luaL_openlibs(L);
+	return L;
+}
+
+}
+
+#endif//_LuaFixture_h_
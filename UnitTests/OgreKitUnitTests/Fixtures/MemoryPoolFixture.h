@@ -0,0 +1,22 @@
+#ifndef _MemoryPoolFixture_h_
+#define _MemoryPoolFixture_h_
+
+namespace
+{
+
+struct PoolItem
+{
+	static int m_alive;
+
+	int   m_value;
+	char  m_pad[40];
+
+	PoolItem() : m_value(7) { ++m_alive; }
+	~PoolItem()             { --m_alive; }
+};
+
+int PoolItem::m_alive = 0;
+
+}
+
+#endif//_MemoryPoolFixture_h_
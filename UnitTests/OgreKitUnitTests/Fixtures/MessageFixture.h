@@ -0,0 +1,26 @@
+#ifndef _MessageFixture_h_
+#define _MessageFixture_h_
+
+namespace
+{
+
+// the tests run without an engine, the manager is created here when needed
+class ScopedManager
+{
+public:
+	gkMessageManager* m_owned;
+
+	ScopedManager() : m_owned(0)
+	{
+		if (!gkMessageManager::getSingletonPtr())
+			m_owned = new gkMessageManager();
+	}
+
+	~ScopedManager() { delete m_owned; }
+
+	gkMessageManager& get(void) { return gkMessageManager::getSingleton(); }
+};
+
+}
+
+#endif//_MessageFixture_h_
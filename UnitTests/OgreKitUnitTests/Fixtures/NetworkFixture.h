@@ -0,0 +1,87 @@
+#ifndef _NetworkFixture_h_
+#define _NetworkFixture_h_
+
+namespace
+{
+
+const enet_uint16 LOOPBACK_PORT = 47631;
+
+
+// a server and a client host connected over loopback
+class LoopbackHosts
+{
+public:
+	ENetHost* m_server;
+	ENetHost* m_client;
+	ENetPeer* m_peer;
+
+	LoopbackHosts(bool compress)
+		:	m_server(0), m_client(0), m_peer(0)
+	{
+		enet_initialize();
+
+		ENetAddress address;
+		address.host = ENET_HOST_ANY;
+		address.port = LOOPBACK_PORT;
+		m_server = enet_host_create(&address, 1, 2, 0, 0);
+		m_client = enet_host_create(0, 1, 2, 0, 0);
+		if (!m_server || !m_client)
+			return;
+
+		if (compress)
+		{
+			enet_host_compress_with_range_coder(m_server);
+			enet_host_compress_with_range_coder(m_client);
+		}
+
+		enet_address_set_host(&address, "127.0.0.1");
+		m_peer = enet_host_connect(m_client, &address, 2, 0);
+
+		bool connected = false;
+		ENetEvent ev;
+		for (int i = 0; i < 200 && !connected; ++i)
+		{
+			enet_host_service(m_server, &ev, 5);
+			connected = enet_host_service(m_client, &ev, 5) > 0 && ev.type == ENET_EVENT_TYPE_CONNECT;
+		}
+
+		if (!connected)
+			m_peer = 0;
+	}
+
+	~LoopbackHosts()
+	{
+		if (m_client) enet_host_destroy(m_client);
+		if (m_server) enet_host_destroy(m_server);
+		enet_deinitialize();
+	}
+
+	bool isConnected(void) const { return m_peer != 0; }
+
+	// services both hosts until the server has received count messages
+	template<typename Decoder>
+	bool receive(int count, Decoder& decoder)
+	{
+		ENetEvent ev;
+		for (int idle = 0; decoder.m_count < count && idle < 500; )
+		{
+			enet_host_service(m_client, &ev, 0);
+			if (enet_host_service(m_server, &ev, 1) > 0)
+			{
+				if (ev.type == ENET_EVENT_TYPE_RECEIVE)
+				{
+					decoder.decode(ev.packet);
+					enet_packet_destroy(ev.packet);
+				}
+				idle = 0;
+			}
+			else
+				++idle;
+		}
+		return decoder.m_count == count;
+	}
+};
+
+}
+
+#endif//_NetworkFixture_h_
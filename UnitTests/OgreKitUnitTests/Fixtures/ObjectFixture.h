@@ -0,0 +1,20 @@
+#ifndef _ObjectFixture_h_
+#define _ObjectFixture_h_
+
+namespace
+{
+
+// creator of the objects & scenes tests build by hand, nothing is loaded
+class ObjectManager : public gkInstancedManager
+{
+public:
+	ObjectManager(const gkString& type = "ObjectManager", const gkString& rtype = "GameObject")
+		:	gkInstancedManager(type, rtype) {}
+	virtual ~ObjectManager() {}
+
+	gkResource* createImpl(const gkResourceName& name, const gkResourceHandle& handle) { return 0; }
+};
+
+}
+
+#endif//_ObjectFixture_h_
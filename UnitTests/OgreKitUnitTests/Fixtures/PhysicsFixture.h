@@ -0,0 +1,203 @@
+#ifndef _PhysicsFixture_h_
+#define _PhysicsFixture_h_
+
+#include "Physics/gkParallelDispatcher.h"
+#include "Physics/gkParallelSolver.h"
+#include "Thread/gkJobSystem.h"
+#include "BulletCollision/Gimpact/btGImpactShape.h"
+#include "BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h"
+
+namespace
+{
+
+// an octahedron as an indexed triangle mesh
+const btScalar OCTAHEDRON_VERTS[] =
+{
+	0.6f, 0, 0,  -0.6f, 0, 0,  0, 0.6f, 0,  0, -0.6f, 0,  0, 0, 0.6f,  0, 0, -0.6f,
+};
+
+const int OCTAHEDRON_TRIS[] =
+{
+	0, 2, 4,  2, 1, 4,  1, 3, 4,  3, 0, 4,  2, 0, 5,  1, 2, 5,  3, 1, 5,  0, 3, 5,
+};
+
+
+// piles of boxes, hulls, spheres & compounds on a ground box, a hinge chain
+// and a kinematic box pushing through the first pile. With gimpact two of three
+// bodies of a pile share one GImpact mesh, so meshes touch meshes.
+class Scene
+{
+public:
+	btCollisionConfiguration* m_config;
+	btDispatcher*             m_dispatcher;
+	btBroadphaseInterface*    m_broadphase;
+	btConstraintSolver*       m_solver;
+	btDiscreteDynamicsWorld*  m_world;
+
+	utArray<btCollisionShape*>  m_shapes;
+	utArray<btRigidBody*>       m_bodies;
+	utArray<btTypedConstraint*> m_constraints;
+	btRigidBody*                m_kinematic;
+	btTriangleIndexVertexArray  m_mesh;
+
+	Scene(bool parallel, int piles, bool gimpact = false)
+		:	m_mesh(8, const_cast<int*>(OCTAHEDRON_TRIS), 3 * sizeof(int),
+		           6, const_cast<btScalar*>(OCTAHEDRON_VERTS), 3 * sizeof(btScalar))
+	{
+		if (parallel)
+		{
+			m_config     = new gkParallelCollisionConfiguration();
+			m_dispatcher = new gkParallelDispatcher(m_config);
+			m_solver     = new gkParallelSolver();
+		}
+		else
+		{
+			m_config     = new btDefaultCollisionConfiguration();
+			m_dispatcher = new btCollisionDispatcher(m_config);
+			m_solver     = new btSequentialImpulseConstraintSolver();
+		}
+
+		m_broadphase = new btDbvtBroadphase();
+		m_world = new btDiscreteDynamicsWorld(m_dispatcher, m_broadphase, m_solver, m_config);
+		m_world->setGravity(btVector3(0, 0, -10));
+		btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(m_dispatcher));
+
+		btCollisionShape* ground = addShape(new btBoxShape(btVector3(100, 100, 1)));
+		btCollisionShape* box    = addShape(new btBoxShape(btVector3(0.5f, 0.5f, 0.5f)));
+		btCollisionShape* sphere = addShape(new btSphereShape(0.5f));
+
+		btConvexHullShape* hull = new btConvexHullShape();
+		hull->addPoint(btVector3(-0.5f, -0.5f, -0.4f));
+		hull->addPoint(btVector3(0.6f, -0.4f, -0.5f));
+		hull->addPoint(btVector3(0.f, 0.6f, -0.5f));
+		hull->addPoint(btVector3(0.1f, 0.f, 0.6f));
+		hull->addPoint(btVector3(-0.3f, 0.2f, 0.4f));
+		addShape(hull);
+
+		btCompoundShape* compound = new btCompoundShape();
+		btTransform local;
+		local.setIdentity();
+		local.setOrigin(btVector3(-0.5f, 0, 0));
+		compound->addChildShape(local, box);
+		local.setOrigin(btVector3(0.5f, 0, 0.3f));
+		compound->addChildShape(local, sphere);
+		addShape(compound);
+
+		btGImpactMeshShape* mesh = new btGImpactMeshShape(&m_mesh);
+		mesh->updateBound();
+		addShape(mesh);
+
+		addBody(ground, 0, btVector3(0, 0, -1));
+
+		btCollisionShape* shapes[4] = {box, sphere, hull, compound};
+		for (int p = 0; p < piles; ++p)
+		{
+			const btVector3 base(btScalar((p % 4) * 12 - 18), btScalar((p / 4) * 12 - 18), 0);
+			for (int i = 0; i < 40; ++i)
+			{
+				btVector3 pos = base + btVector3(btScalar(i % 3) * 1.1f + btScalar(i % 7) * 0.01f,
+				                                 btScalar((i / 3) % 3) * 1.1f,
+				                                 1.f + btScalar(i / 9) * 1.2f);
+				addBody(gimpact && i % 3 != 1 ? mesh : shapes[(i + p) % 4], 1, pos);
+			}
+		}
+
+		// hinge chain hanging from a static anchor
+		btRigidBody* prev = addBody(box, 0, btVector3(30, 30, 10));
+		for (int i = 0; i < 6; ++i)
+		{
+			btRigidBody* link = addBody(box, 1, btVector3(30 + btScalar(i + 1) * 1.2f, 30, 10));
+			btHingeConstraint* hinge = new btHingeConstraint(*prev, *link, btVector3(0.6f, 0, 0), btVector3(-0.6f, 0, 0),
+			                                                 btVector3(0, 1, 0), btVector3(0, 1, 0));
+			m_world->addConstraint(hinge, true);
+			m_constraints.push_back(hinge);
+			prev = link;
+		}
+
+		m_kinematic = addBody(box, 0, btVector3(-22, -17, 0.5f));
+		m_kinematic->setCollisionFlags(m_kinematic->getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
+		m_kinematic->setActivationState(DISABLE_DEACTIVATION);
+	}
+
+	~Scene()
+	{
+		UTsize i;
+		for (i = 0; i < m_constraints.size(); ++i)
+		{
+			m_world->removeConstraint(m_constraints[i]);
+			delete m_constraints[i];
+		}
+		for (i = 0; i < m_bodies.size(); ++i)
+		{
+			m_world->removeRigidBody(m_bodies[i]);
+			delete m_bodies[i]->getMotionState();
+			delete m_bodies[i];
+		}
+		for (i = 0; i < m_shapes.size(); ++i)
+			delete m_shapes[i];
+
+		delete m_world;
+		delete m_solver;
+		delete m_broadphase;
+		delete m_dispatcher;
+		delete m_config;
+	}
+
+	btCollisionShape* addShape(btCollisionShape* shape)
+	{
+		m_shapes.push_back(shape);
+		return shape;
+	}
+
+	btRigidBody* addBody(btCollisionShape* shape, btScalar mass, const btVector3& pos)
+	{
+		btVector3 inertia(0, 0, 0);
+		if (mass > 0)
+			shape->calculateLocalInertia(mass, inertia);
+
+		btTransform trans;
+		trans.setIdentity();
+		trans.setOrigin(pos);
+
+		btRigidBody* body = new btRigidBody(mass, new btDefaultMotionState(trans), shape, inertia);
+		m_world->addRigidBody(body);
+		m_bodies.push_back(body);
+		return body;
+	}
+
+	void step(int frame)
+	{
+		btTransform trans;
+		trans.setIdentity();
+		trans.setOrigin(btVector3(-22 + btScalar(frame) * 0.05f, -17, 0.5f));
+		m_kinematic->getMotionState()->setWorldTransform(trans);
+
+		m_world->stepSimulation(btScalar(1.) / 60, 1, btScalar(1.) / 60);
+	}
+
+	void run(int frames)
+	{
+		for (int i = 0; i < frames; ++i)
+			step(i);
+	}
+
+	// all transforms, compared bit for bit
+	void getState(utArray<btScalar>& state)
+	{
+		state.clear();
+		for (UTsize i = 0; i < m_bodies.size(); ++i)
+		{
+			const btTransform& trans = m_bodies[i]->getWorldTransform();
+			for (int r = 0; r < 3; ++r)
+			{
+				state.push_back(trans.getOrigin()[r]);
+				for (int c = 0; c < 3; ++c)
+					state.push_back(trans.getBasis()[r][c]);
+			}
+		}
+	}
+};
+
+}
+
+#endif//_PhysicsFixture_h_
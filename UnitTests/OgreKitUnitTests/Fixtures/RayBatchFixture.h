@@ -0,0 +1,130 @@
+#ifndef _RayBatchFixture_h_
+#define _RayBatchFixture_h_
+
+#include "Physics/gkRayBatch.h"
+#include "Thread/gkJobSystem.h"
+#include "BulletCollision/Gimpact/btGImpactShape.h"
+
+namespace
+{
+
+// an octahedron as an indexed triangle mesh
+const btScalar OCTAHEDRON_VERTS[] =
+{
+	0.8f, 0, 0,  -0.8f, 0, 0,  0, 0.8f, 0,  0, -0.8f, 0,  0, 0, 0.8f,  0, 0, -0.8f,
+};
+
+const int OCTAHEDRON_TRIS[] =
+{
+	0, 2, 4,  2, 1, 4,  1, 3, 4,  3, 0, 4,  2, 0, 5,  1, 2, 5,  3, 1, 5,  0, 3, 5,
+};
+
+
+// a field of boxes, spheres & compounds, some off the ground, a few of them
+// without contact response and one volume no query may see. With gimpact
+// every fourth object is one shared GImpact mesh.
+class World
+{
+public:
+	btDefaultCollisionConfiguration m_config;
+	btCollisionDispatcher           m_dispatcher;
+	btDbvtBroadphase                m_broadphase;
+	btCollisionWorld                m_world;
+
+	btBoxShape                      m_box;
+	btSphereShape                   m_sphere;
+	btCompoundShape                 m_compound;
+	btTriangleIndexVertexArray      m_mesh;
+	btGImpactMeshShape              m_gimpact;
+	utArray<btCollisionObject*>     m_objects;
+
+	World(int size, bool gimpact = false)
+		:	m_dispatcher(&m_config),
+		    m_world(&m_dispatcher, &m_broadphase, &m_config),
+		    m_box(btVector3(0.5f, 0.5f, 0.5f)),
+		    m_sphere(0.6f),
+		    m_mesh(8, const_cast<int*>(OCTAHEDRON_TRIS), 3 * sizeof(int),
+		           6, const_cast<btScalar*>(OCTAHEDRON_VERTS), 3 * sizeof(btScalar)),
+		    m_gimpact(&m_mesh)
+	{
+		m_gimpact.updateBound();
+
+		btTransform local;
+		local.setIdentity();
+		local.setOrigin(btVector3(-0.4f, 0, 0));
+		m_compound.addChildShape(local, &m_box);
+		local.setOrigin(btVector3(0.5f, 0.2f, 0.3f));
+		m_compound.addChildShape(local, &m_sphere);
+
+		btCollisionShape* shapes[3] = {&m_box, &m_sphere, &m_compound};
+		for (int i = 0; i < size * size; ++i)
+		{
+			btVector3 pos(btScalar(i % size) * 3.f, btScalar(i / size) * 3.f, btScalar(i % 5) * 0.7f);
+			btCollisionObject* ob = addObject(gimpact && i % 4 == 1 ? &m_gimpact : shapes[i % 3], pos);
+
+			if (i % 11 == 0)
+				ob->setCollisionFlags(ob->getCollisionFlags() | btCollisionObject::CF_NO_CONTACT_RESPONSE);
+		}
+
+		// like a sensor volume, mask zero
+		btCollisionObject* hidden = addObject(&m_sphere, btVector3(1.5f, 1.5f, 0), btBroadphaseProxy::SensorTrigger, 0);
+		hidden->setCollisionFlags(hidden->getCollisionFlags() | btCollisionObject::CF_NO_CONTACT_RESPONSE);
+
+		m_world.updateAabbs();
+	}
+
+	~World()
+	{
+		for (UTsize i = 0; i < m_objects.size(); ++i)
+		{
+			m_world.removeCollisionObject(m_objects[i]);
+			delete m_objects[i];
+		}
+	}
+
+	btCollisionObject* addObject(btCollisionShape* shape, const btVector3& pos,
+	                             short group = btBroadphaseProxy::StaticFilter,
+	                             short mask = btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::StaticFilter)
+	{
+		btCollisionObject* ob = new btCollisionObject();
+		btTransform trans;
+		trans.setIdentity();
+		trans.setOrigin(pos);
+		ob->setWorldTransform(trans);
+		ob->setCollisionShape(shape);
+		m_world.addCollisionObject(ob, group, mask);
+		m_objects.push_back(ob);
+		return ob;
+	}
+};
+
+
+class Random
+{
+public:
+	Random() : m_seed(1) {}
+
+	gkScalar next(gkScalar lo, gkScalar hi)
+	{
+		m_seed = m_seed * 1103515245 + 12345;
+		return lo + (hi - lo) * gkScalar((m_seed >> 8) & 0xffff) / gkScalar(0xffff);
+	}
+
+	gkVector3 point(gkScalar size)
+	{
+		return gkVector3(next(-2, size), next(-2, size), next(-1, 4));
+	}
+
+private:
+	unsigned int m_seed;
+};
+
+
+btVector3 toBullet(const gkVector3& v)
+{
+	return btVector3(v.x, v.y, v.z);
+}
+
+}
+
+#endif//_RayBatchFixture_h_
@@ -0,0 +1,50 @@
+#ifndef _SensorFilterFixture_h_
+#define _SensorFilterFixture_h_
+
+#include "Physics/gkSensorFilter.h"
+#include "Fixtures/ObjectFixture.h"
+
+namespace
+{
+
+// game objects carrying a few properties each, object i has Prop.(i % props)
+class Objects
+{
+public:
+	ObjectManager          m_manager;
+	gkEngine*              m_engine;
+	utArray<gkGameObject*> m_objects;
+
+	Objects(int count, int props)
+	{
+		// game objects use the engine singleton on destruction
+		m_engine = gkEngine::getSingletonPtr() ? 0 : new gkEngine();
+
+		char buf[32];
+		for (int i = 0; i < count; ++i)
+		{
+			sprintf(buf, "Object.%03i", i);
+			gkGameObject* ob = new gkGameObject(&m_manager, gkResourceName(buf), i, GK_OBJECT);
+
+			sprintf(buf, "Prop.%i", i % props);
+			ob->createVariable(buf, false);
+			ob->createVariable("health", false);
+			ob->createVariable("speed", false);
+
+			m_objects.push_back(ob);
+		}
+	}
+
+	~Objects()
+	{
+		for (UTsize i = 0; i < m_objects.size(); ++i)
+			delete m_objects[i];
+		delete m_engine;
+	}
+
+	gkGameObject* operator[](int i) { return m_objects[i]; }
+};
+
+}
+
+#endif//_SensorFilterFixture_h_
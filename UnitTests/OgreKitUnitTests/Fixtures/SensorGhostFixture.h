@@ -0,0 +1,94 @@
+#ifndef _SensorGhostFixture_h_
+#define _SensorGhostFixture_h_
+
+#include "Physics/gkSensorGhost.h"
+
+namespace
+{
+
+// a grid of boxes on the ground, sensor volumes are added on top
+class World
+{
+public:
+	btDefaultCollisionConfiguration m_config;
+	btCollisionDispatcher           m_dispatcher;
+	btDbvtBroadphase                m_broadphase;
+	btGhostPairCallback             m_ghostPairs;
+	gkSensorGhostFilter             m_filter;
+	btSequentialImpulseConstraintSolver m_solver;
+	btDiscreteDynamicsWorld         m_world;
+
+	btBoxShape                      m_box;
+	utArray<btRigidBody*>           m_bodies;
+
+	World(int side, btScalar spacing)
+		:	m_dispatcher(&m_config),
+		    m_world(&m_dispatcher, &m_broadphase, &m_solver, &m_config),
+		    m_box(btVector3(0.5f, 0.5f, 0.5f))
+	{
+		m_broadphase.getOverlappingPairCache()->setInternalGhostPairCallback(&m_ghostPairs);
+		m_broadphase.getOverlappingPairCache()->setOverlapFilterCallback(&m_filter);
+		m_dispatcher.setNearCallback(gkSensorGhost::nearCallback);
+
+		for (int i = 0; i < side * side; ++i)
+		{
+			btTransform trans;
+			trans.setIdentity();
+			trans.setOrigin(btVector3(btScalar(i % side) * spacing, btScalar(i / side) * spacing, 0));
+
+			btRigidBody* body = new btRigidBody(0, 0, &m_box);
+			body->setWorldTransform(trans);
+			m_world.addRigidBody(body);
+			m_bodies.push_back(body);
+		}
+	}
+
+	~World()
+	{
+		for (UTsize i = 0; i < m_bodies.size(); ++i)
+		{
+			m_world.removeRigidBody(m_bodies[i]);
+			delete m_bodies[i];
+		}
+	}
+
+	// what the sensors did before, a contact test with a temporary object,
+	// counting overlaps only like the volumes do
+	void contactTest(const btTransform& trans, btCollisionShape* shape, utArray<const btCollisionObject*>& hits)
+	{
+		class Result : public btCollisionWorld::ContactResultCallback
+		{
+		public:
+			utArray<const btCollisionObject*>& m_hits;
+			Result(utArray<const btCollisionObject*>& hits) : m_hits(hits) {}
+
+			btScalar addSingleResult(btManifoldPoint& cp, const btCollisionObjectWrapper* colObj0, int partId0, int index0, const btCollisionObjectWrapper* colObj1, int partId1, int index1)
+			{
+				if (cp.getDistance() <= 0.f && m_hits.find(colObj1->getCollisionObject()) == UT_NPOS)
+					m_hits.push_back(colObj1->getCollisionObject());
+				return 0.;
+			}
+		};
+
+		btCollisionObject ob;
+		ob.setCollisionShape(shape);
+		ob.setWorldTransform(trans);
+
+		hits.clear();
+		Result result(hits);
+		m_world.contactTest(&ob, result);
+	}
+};
+
+
+btTransform makeTransform(btScalar x, btScalar y)
+{
+	btTransform trans;
+	trans.setIdentity();
+	trans.setOrigin(btVector3(x, y, 0));
+	return trans;
+}
+
+}
+
+#endif//_SensorGhostFixture_h_
@@ -0,0 +1,360 @@
+#include "StdAfx.h"
+#include "Fixtures/ObjectFixture.h"
+#include "Loaders/Blender2/gkBlendCache.h"
+#include "Loaders/Blender2/gkBlendInternalFile.h"
+#include "Loaders/Blender2/gkBlenderDefines.h"
+#include "Animation/gkAnimation.h"
+#include "gkSkeletonResource.h"
+
+#define TEST_CASE_NAME testBlendCache
+
+namespace
+{
+
+const char* BLEND_FILE = "TestData/Test0.blend";
+const char* CACHE_DIR  = "TestData";
+
+
+void buildMesh(gkMesh* mesh, int nrSubMeshes)
+{
+	mesh->createVertexGroup("Bone");
+	mesh->createVertexGroup("Bone.001");
+
+	for (int s = 0; s < nrSubMeshes; ++s)
+	{
+		gkSubMesh* sub = new gkSubMesh();
+		sub->setTotalLayers(2);
+		sub->setVertexColors(s == 0);
+
+		for (int i = 0; i < 30; ++i)
+		{
+			gkVertex v;
+			v.co = gkVector3(gkScalar(i), gkScalar(s), 1);
+			v.no = gkVector3::UNIT_Z;
+			v.vcol = 0xff00ff00 + i;
+			v.uv[1] = gkVector2(gkScalar(i) / 30, 0.5f);
+			sub->getVertexBuffer().push_back(v);
+		}
+
+		for (unsigned int i = 0; i < 10; ++i)
+		{
+			gkTriangle tri = {i * 3, i * 3 + 1, i * 3 + 2, gkTriangle::TRI_COLLIDER};
+			sub->getIndexBuffer().push_back(tri);
+
+			gkDeformVertex dv = {(int)(i & 1), 0.5f, (int)i};
+			sub->addDeformVert(dv);
+		}
+
+		gkMaterialProperties& mat = sub->getMaterial();
+		mat.m_name = s == 0 ? "Material" : "Material.001";
+		mat.m_mode |= gkMaterialProperties::MA_ALPHABLEND;
+		mat.m_diffuse = gkColor(0.2f, 0.4f, 0.6f, 0.8f);
+		mat.m_hardness = 50;
+		mat.m_totaltex = 1;
+		mat.m_textures[0].m_name = "Texture";
+		mat.m_textures[0].m_image = "//textures/wall.png";
+		mat.m_textures[0].m_layer = 1;
+		mat.m_textures[0].m_scale = gkVector3(2, 2, 1);
+
+		mesh->addSubMesh(sub);
+	}
+}
+
+
+void buildAnimation(gkKeyedAnimation* act)
+{
+	gkBoneChannel* bone = new gkBoneChannel("Bone.001", act);
+	act->addChannel(bone);
+
+	gkObjectChannel* obj = new gkObjectChannel("GKMainObjectChannel", act);
+	obj->setEulerRotation(true);
+	act->addChannel(obj);
+
+	for (int code = gkTransformChannel::SC_LOC_X; code <= gkTransformChannel::SC_LOC_Z; ++code)
+	{
+		akBezierSpline* spline = new akBezierSpline(code);
+		spline->setInterpolationMethod(akBezierSpline::BEZ_CUBIC);
+
+		for (int i = 0; i < 5; ++i)
+		{
+			akBezierVertex v = {{i - 0.25f, 0}, {gkScalar(i), gkScalar(code)}, {i + 0.25f, 1}};
+			spline->addVertex(v);
+		}
+		bone->addSpline(spline);
+	}
+
+	akBezierSpline* spline = new akBezierSpline(gkTransformChannel::SC_ROT_EULER_Z);
+	spline->setInterpolationMethod(akBezierSpline::BEZ_CONSTANT);
+	akBezierVertex v = {{0, 0}, {0, 1}, {0, 2}};
+	spline->addVertex(v);
+	obj->addSpline(spline);
+
+	act->setLength(4);
+}
+
+
+void buildSkeleton(gkSkeletonResource* skel)
+{
+	gkBone* root = skel->createBone("Bone");
+	root->setRestPosition(gkTransformState(gkVector3(0, 0, 1)));
+
+	gkBone* child = skel->createBone("Bone.001");
+	child->setParent(root);
+	child->setRestPosition(gkTransformState(gkVector3(0, 1, 0), gkQuaternion(0.5f, 0.5f, 0.5f, 0.5f), gkVector3(1, 2, 1)));
+}
+
+}
+
+
+TEST(TEST_CASE_NAME, testRoundTrip)
+{
+	gkEngine* engine = gkEngine::getSingletonPtr() ? 0 : new gkEngine();
+	ObjectManager creator("CacheManager", "Mesh");
+
+	gkMesh source(&creator, gkResourceName("Cube"), 0);
+	buildMesh(&source, 2);
+
+	gkString cacheFile;
+	{
+		gkBlendCache cache(BLEND_FILE, CACHE_DIR);
+		cacheFile = cache.getCacheFile();
+		remove(cacheFile.c_str());
+
+		EXPECT_FALSE(cache.load());
+
+		gkMesh mesh(&creator, gkResourceName("Cube"), 1);
+		EXPECT_FALSE(cache.loadMesh(&mesh, "Cube", "OBCube"));
+		cache.addMesh(&source, "Cube", "OBCube");
+		EXPECT_TRUE(cache.save());
+	}
+
+	{
+		gkBlendCache cache(BLEND_FILE, CACHE_DIR);
+		ASSERT_TRUE(cache.load());
+
+		// meshes shared by other objects are converted for the first one only
+		gkMesh other(&creator, gkResourceName("Cube"), 2);
+		EXPECT_FALSE(cache.loadMesh(&other, "Cube", "OBCube.001"));
+		EXPECT_FALSE(cache.loadMesh(&other, "Sphere", "OBCube"));
+
+		gkMesh mesh(&creator, gkResourceName("Cube"), 3);
+		ASSERT_TRUE(cache.loadMesh(&mesh, "Cube", "OBCube"));
+		EXPECT_EQ(cache.getHits(gkBlendCache::BC_MESH), 1);
+		EXPECT_EQ(cache.getMisses(gkBlendCache::BC_MESH), 2);
+
+		ASSERT_EQ(mesh.getGroups().size(), 2);
+		EXPECT_STREQ(mesh.getGroups()[1]->getName().c_str(), "Bone.001");
+		EXPECT_EQ(mesh.getGroups()[1]->getIndex(), 1);
+
+		ASSERT_EQ(mesh.m_submeshes.size(), source.m_submeshes.size());
+		for (UTsize s = 0; s < mesh.m_submeshes.size(); ++s)
+		{
+			gkSubMesh* a = source.m_submeshes[s];
+			gkSubMesh* b = mesh.m_submeshes[s];
+
+			EXPECT_EQ(b->getUvLayerCount(), 2);
+			EXPECT_EQ(b->hasVertexColors(), a->hasVertexColors());
+
+			ASSERT_EQ(b->getVertexBuffer().size(), a->getVertexBuffer().size());
+			ASSERT_EQ(b->getIndexBuffer().size(), a->getIndexBuffer().size());
+			ASSERT_EQ(b->getDeformVertexBuffer().size(), a->getDeformVertexBuffer().size());
+			EXPECT_EQ(memcmp(b->getVertexBuffer().ptr(), a->getVertexBuffer().ptr(), a->getVertexBuffer().size() * sizeof(gkVertex)), 0);
+			EXPECT_EQ(memcmp(b->getIndexBuffer().ptr(), a->getIndexBuffer().ptr(), a->getIndexBuffer().size() * sizeof(gkTriangle)), 0);
+			EXPECT_EQ(memcmp(b->getDeformVertexBuffer().ptr(), a->getDeformVertexBuffer().ptr(), a->getDeformVertexBuffer().size() * sizeof(gkDeformVertex)), 0);
+
+			gkMaterialProperties& ma = a->getMaterial();
+			gkMaterialProperties& mb = b->getMaterial();
+			EXPECT_EQ(mb.m_name, ma.m_name);
+			EXPECT_EQ(mb.m_mode, ma.m_mode);
+			EXPECT_TRUE(mb.m_diffuse == ma.m_diffuse);
+			EXPECT_EQ(mb.m_hardness, ma.m_hardness);
+			EXPECT_EQ(mb.m_totaltex, 1);
+			EXPECT_EQ(mb.m_textures[0].m_image, ma.m_textures[0].m_image);
+			EXPECT_EQ(mb.m_textures[0].m_layer, 1);
+			EXPECT_TRUE(mb.m_textures[0].m_scale == ma.m_textures[0].m_scale);
+		}
+	}
+
+	// a cache written for different converter options is stale
+	gkUserDefs& defs = gkEngine::getSingleton().getUserDefs();
+	defs.blendermat = !defs.blendermat;
+	{
+		gkBlendCache cache(BLEND_FILE, CACHE_DIR);
+		EXPECT_FALSE(cache.load());
+	}
+	defs.blendermat = !defs.blendermat;
+
+	// a truncated one never fills the mesh
+	utMemoryStream data;
+	data.open(cacheFile.c_str(), utStream::SM_READ);
+	ASSERT_TRUE(data.size() > 0);
+
+	utFileStream fs;
+	fs.open(cacheFile.c_str(), utStream::SM_WRITE);
+	fs.write(data.ptr(), data.size() / 2);
+	fs.close();
+	{
+		gkBlendCache cache(BLEND_FILE, CACHE_DIR);
+		gkMesh mesh(&creator, gkResourceName("Cube"), 4);
+		if (cache.load())
+			EXPECT_FALSE(cache.loadMesh(&mesh, "Cube", "OBCube"));
+		EXPECT_TRUE(mesh.m_submeshes.empty());
+	}
+
+	remove(cacheFile.c_str());
+	delete engine;
+}
+
+
+TEST(TEST_CASE_NAME, testAnimationsAndSkeletons)
+{
+	gkEngine* engine = gkEngine::getSingletonPtr() ? 0 : new gkEngine();
+	ObjectManager creator("CacheManager", "Mesh");
+
+	gkKeyedAnimation source(&creator, gkResourceName("Walk"), 0);
+	buildAnimation(&source);
+
+	gkSkeletonResource sourceSkel(&creator, gkResourceName("Armature"), 1);
+	buildSkeleton(&sourceSkel);
+
+	gkString cacheFile;
+	{
+		gkBlendCache cache(BLEND_FILE, CACHE_DIR);
+		cacheFile = cache.getCacheFile();
+		remove(cacheFile.c_str());
+		cache.load();
+
+		gkKeyedAnimation act(&creator, gkResourceName("Walk"), 2);
+		EXPECT_FALSE(cache.loadAnimation(&act, "Walk"));
+		cache.addAnimation(&source, "Walk");
+
+		gkSkeletonResource skel(&creator, gkResourceName("Armature"), 3);
+		EXPECT_FALSE(cache.loadSkeleton(&skel, "Armature"));
+		cache.addSkeleton(&sourceSkel, "Armature");
+		EXPECT_TRUE(cache.save());
+	}
+
+	{
+		gkBlendCache cache(BLEND_FILE, CACHE_DIR);
+		ASSERT_TRUE(cache.load());
+
+		gkKeyedAnimation act(&creator, gkResourceName("Walk"), 4);
+		EXPECT_FALSE(cache.loadAnimation(&act, "Run"));
+		ASSERT_TRUE(cache.loadAnimation(&act, "Walk"));
+		EXPECT_EQ(cache.getHits(gkBlendCache::BC_ANIMATION), 1);
+		EXPECT_EQ(cache.getMisses(gkBlendCache::BC_ANIMATION), 1);
+
+		EXPECT_EQ(act.getLength(), source.getLength());
+		ASSERT_EQ(act.getNumChannels(), source.getNumChannels());
+		for (int c = 0; c < act.getNumChannels(); ++c)
+		{
+			akAnimationChannel* a = source.getChannels()[c];
+			akAnimationChannel* b = act.getChannels()[c];
+
+			EXPECT_EQ(b->getName(), a->getName());
+			EXPECT_EQ(dynamic_cast<gkBoneChannel*>(b) != 0, dynamic_cast<gkBoneChannel*>(a) != 0);
+			EXPECT_EQ(static_cast<gkTransformChannel*>(b)->isEulerRotation(), static_cast<gkTransformChannel*>(a)->isEulerRotation());
+
+			ASSERT_EQ(b->getNumSplines(), a->getNumSplines());
+			for (int s = 0; s < a->getNumSplines(); ++s)
+			{
+				const akBezierSpline* sa = a->getSplines()[s];
+				const akBezierSpline* sb = b->getSplines()[s];
+
+				EXPECT_EQ(sb->getCode(), sa->getCode());
+				EXPECT_EQ(sb->getInterpolationMethod(), sa->getInterpolationMethod());
+				ASSERT_EQ(sb->getNumVerts(), sa->getNumVerts());
+				EXPECT_EQ(memcmp(sb->getVerts(), sa->getVerts(), sa->getNumVerts() * sizeof(akBezierVertex)), 0);
+			}
+		}
+
+		gkSkeletonResource skel(&creator, gkResourceName("Armature"), 5);
+		ASSERT_TRUE(cache.loadSkeleton(&skel, "Armature"));
+		EXPECT_EQ(cache.getHits(gkBlendCache::BC_SKELETON), 1);
+
+		ASSERT_EQ(skel.getBoneList().size(), 2);
+		gkBone* root = skel.getBoneList()[0];
+		gkBone* child = skel.getBoneList()[1];
+
+		EXPECT_STREQ(child->getName().c_str(), "Bone.001");
+		EXPECT_EQ(root->getParent(), (gkBone*)0);
+		EXPECT_EQ(child->getParent(), root);
+		EXPECT_TRUE(root->getRest().loc == sourceSkel.getBoneList()[0]->getRest().loc);
+		EXPECT_TRUE(child->getRest().rot == sourceSkel.getBoneList()[1]->getRest().rot);
+		EXPECT_TRUE(child->getRest().scl == sourceSkel.getBoneList()[1]->getRest().scl);
+	}
+
+	remove(cacheFile.c_str());
+	delete engine;
+}
+
+
+#if OGREKIT_USE_BPARSE == 0
+
+TEST(TEST_CASE_NAME, testDataImage)
+{
+	gkEngine* engine = gkEngine::getSingletonPtr() ? 0 : new gkEngine();
+
+	gkBlendCache cache(BLEND_FILE, CACHE_DIR);
+	gkString imageFile = cache.getImageFile();
+	remove(imageFile.c_str());
+
+	// the files map the image, they go before it is removed
+	{
+		gkBlendInternalFile parsed;
+		EXPECT_FALSE(cache.loadImage(&parsed));
+		ASSERT_TRUE(parsed.parse(BLEND_FILE));
+		ASSERT_TRUE(cache.saveImage(&parsed));
+
+		gkBlendInternalFile mapped;
+		ASSERT_TRUE(cache.loadImage(&mapped));
+		EXPECT_EQ(cache.getHits(gkBlendCache::BC_IMAGE), 1);
+		EXPECT_EQ(cache.getMisses(gkBlendCache::BC_IMAGE), 1);
+		EXPECT_EQ(mapped.getVersion(), parsed.getVersion());
+
+		ASSERT_TRUE(mapped.getFileGlobal() != 0);
+		EXPECT_STREQ(GKB_IDNAME(mapped.getFileGlobal()->curscene), GKB_IDNAME(parsed.getFileGlobal()->curscene));
+
+		// the same objects, with their data and logic bricks
+		gkBlendListIterator a = parsed.getObjectList(), b = mapped.getObjectList();
+		int objects = 0;
+		while (a.hasMoreElements())
+		{
+			ASSERT_TRUE(b.hasMoreElements());
+			Blender::Object* oa = (Blender::Object*)a.getNext();
+			Blender::Object* ob = (Blender::Object*)b.getNext();
+			++objects;
+
+			EXPECT_STREQ(GKB_IDNAME(ob), GKB_IDNAME(oa));
+			EXPECT_EQ(ob->type, oa->type);
+			EXPECT_EQ(memcmp(ob->loc, oa->loc, sizeof(oa->loc)), 0);
+
+			Blender::bSensor* sa = (Blender::bSensor*)oa->sensors.first;
+			Blender::bSensor* sb = (Blender::bSensor*)ob->sensors.first;
+			for (; sa && sb; sa = sa->next, sb = sb->next)
+				EXPECT_EQ(sb->type, sa->type);
+			EXPECT_TRUE(!sa && !sb);
+
+			if (oa->type == OB_MESH)
+			{
+				Blender::Mesh* ma = (Blender::Mesh*)oa->data;
+				Blender::Mesh* mb = (Blender::Mesh*)ob->data;
+				ASSERT_TRUE(ma && mb && ma != mb);
+				ASSERT_EQ(mb->totvert, ma->totvert);
+				for (int i = 0; i < ma->totvert; ++i)
+					EXPECT_EQ(memcmp(mb->mvert[i].co, ma->mvert[i].co, sizeof(ma->mvert[i].co)), 0);
+			}
+		}
+		EXPECT_FALSE(b.hasMoreElements());
+		EXPECT_GT(objects, 0);
+
+		// an image of another .blend, or of this one before it changed, is not used
+		gkBlendInternalFile other;
+		EXPECT_FALSE(other.parseImage(imageFile, "TestData/Other.blend"));
+	}
+
+	remove(imageFile.c_str());
+	delete engine;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#include "StdAfx.h"
+#include "Physics/gkContactStream.h"
+#include "Fixtures/ContactFixture.h"
+
+#define TEST_CASE_NAME testContactStream
+
+
+TEST(TEST_CASE_NAME, testSpans)
+{
+	Controllers cont(3);
+	gkContactStream stream;
+
+	btManifoldPoint p1 = makePoint(-0.1f), p2 = makePoint(-0.2f), p3 = makePoint(-0.3f);
+
+	EXPECT_EQ(stream.getNumContacts(cont[0]), 0U);
+
+	// in manifold order, owners interleaved
+	stream.begin();
+	stream.add(cont[0], cont[1], &p1);
+	stream.add(cont[1], cont[0], &p1);
+	stream.add(cont[2], cont[0], &p2);
+	stream.add(cont[0], cont[2], &p2);
+	stream.add(cont[0], cont[1], &p3);
+	stream.add(cont[1], cont[2], 0);
+	stream.end();
+
+	EXPECT_EQ(stream.size(), 6U);
+	ASSERT_EQ(stream.getNumContacts(cont[0]), 3U);
+	ASSERT_EQ(stream.getNumContacts(cont[1]), 2U);
+	ASSERT_EQ(stream.getNumContacts(cont[2]), 1U);
+
+	// contiguous per owner, in the order they were added
+	UTsize first = stream.getFirstContact(cont[0]);
+	EXPECT_TRUE(stream.getCollider(first) == cont[1]);
+	EXPECT_TRUE(stream.getCollider(first + 1) == cont[2]);
+	EXPECT_TRUE(stream.getCollider(first + 2) == cont[1]);
+	EXPECT_EQ(stream.getPoint(first + 1).getDistance(), btScalar(-0.2f));
+	EXPECT_EQ(stream.getPoint(first + 2).getDistance(), btScalar(-0.3f));
+
+	first = stream.getFirstContact(cont[1]);
+	EXPECT_TRUE(stream.getCollider(first) == cont[0]);
+	EXPECT_TRUE(stream.getCollider(first + 1) == cont[2]);
+	EXPECT_EQ(stream.getPoint(first + 1).getDistance(), btScalar(0.f));
+
+	UTsize scratch = stream.getScratchStats().used;
+	EXPECT_GT(scratch, 0U);
+
+	// the next build replaces everything, in the same scratch memory
+	stream.begin();
+	stream.add(cont[2], cont[1], &p1);
+	stream.end();
+
+	EXPECT_LT(stream.getScratchStats().used, scratch);
+	EXPECT_EQ(stream.getScratchStats().highWater, scratch);
+
+	EXPECT_EQ(stream.getNumContacts(cont[0]), 0U);
+	EXPECT_EQ(stream.getNumContacts(cont[1]), 0U);
+	ASSERT_EQ(stream.getNumContacts(cont[2]), 1U);
+	EXPECT_TRUE(stream.getCollider(stream.getFirstContact(cont[2])) == cont[1]);
+
+	stream.clear();
+	EXPECT_EQ(stream.getNumContacts(cont[2]), 0U);
+	EXPECT_EQ(stream.size(), 0U);
+}
+
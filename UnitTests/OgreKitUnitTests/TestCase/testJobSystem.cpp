@@ -0,0 +1,156 @@
+#include "StdAfx.h"
+#include "Thread/gkJobSystem.h"
+#include "LinearMath/btQuickprof.h"
+
+#ifndef WIN32
+#include <sched.h>
+#endif
+
+#define TEST_CASE_NAME testJobSystem
+
+namespace
+{
+
+void yieldThread(void)
+{
+#ifdef WIN32
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
+
+
+// records the thread it ran on, can be held until released
+class RecordJob : public gkJob
+{
+public:
+	RecordJob(gkAtomicInt& thread, gkAtomicInt* started = 0, gkAtomicInt* release = 0)
+		:	m_thread(thread), m_started(started), m_release(release) {}
+
+	void run(void)
+	{
+		m_thread.set(gkJobSystem::getSingleton().getThreadIndex());
+		if (m_started)
+			m_started->set(1);
+
+		// bounded, a broken system fails the test instead of hanging it
+		btClock clock;
+		while (m_release && !m_release->get() && clock.getTimeMilliseconds() < 2000)
+			yieldThread();
+	}
+
+private:
+	gkAtomicInt& m_thread;
+	gkAtomicInt* m_started;
+	gkAtomicInt* m_release;
+};
+
+
+// splits itself into sub jobs, like the tiled navmesh build
+class SplitJob : public gkJob
+{
+public:
+	SplitJob(gkAtomicInt* threads, int count) : m_threads(threads), m_count(count) {}
+
+	void run(void)
+	{
+		gkJobSystem& jobs = gkJobSystem::getSingleton();
+		gkJobCounter counter;
+		for (int i = 0; i < m_count; ++i)
+			jobs.submit(new RecordJob(m_threads[i]), &counter);
+		jobs.wait(counter);
+	}
+
+private:
+	gkAtomicInt* m_threads;
+	int          m_count;
+};
+
+}
+
+
+TEST(TEST_CASE_NAME, testCounter)
+{
+	const int count = 200;
+	gkJobSystem jobs(3);
+
+	gkAtomicInt threads[count];
+	gkJobCounter counter;
+	for (int i = 0; i < count; ++i)
+	{
+		threads[i].set(-1);
+		jobs.submit(new RecordJob(threads[i]), &counter);
+	}
+	jobs.wait(counter);
+
+	EXPECT_TRUE(counter.isDone());
+	int ran = 0;
+	for (int i = 0; i < count; ++i)
+		ran += threads[i].get() != -1 ? 1 : 0;
+	EXPECT_EQ(ran, count);
+}
+
+
+TEST(TEST_CASE_NAME, testBackground)
+{
+	const int count = 100, split = 16;
+	gkJobSystem jobs(1);
+
+	// the only worker is held by a background job
+	gkAtomicInt heldThread(-1), started, release;
+	gkJobCounter background;
+	jobs.submitBackground(new RecordJob(heldThread, &started, &release), &background);
+	while (!started.get())
+		yieldThread();
+
+	gkAtomicInt queuedThread(-1), splitThreads[split];
+	jobs.submitBackground(new RecordJob(queuedThread), &background);
+	jobs.submitBackground(new SplitJob(splitThreads, split), &background);
+
+	// a frame wait runs its own jobs, none of the queued background ones
+	gkAtomicInt threads[count];
+	gkJobCounter frame;
+	for (int i = 0; i < count; ++i)
+		jobs.submit(new RecordJob(threads[i]), &frame);
+	jobs.wait(frame);
+
+	EXPECT_EQ(queuedThread.get(), -1);
+	EXPECT_FALSE(background.isDone());
+
+	release.set(1);
+	jobs.wait(background);
+
+	EXPECT_EQ(heldThread.get(), 1);
+	EXPECT_EQ(queuedThread.get(), 1);
+
+	// sub jobs of background work stay off the waiting thread
+	for (int i = 0; i < split; ++i)
+		EXPECT_EQ(splitThreads[i].get(), 1);
+}
+
+
+TEST(TEST_CASE_NAME, testShutdown)
+{
+	// the wakeups are counted, a binary event would block the third wait
+	gkSyncObj sync;
+	sync.signal(2);
+	sync.signal();
+	for (int i = 0; i < 3; ++i)
+		EXPECT_TRUE(sync.wait());
+
+	// every worker is woken on shutdown, busy or idle
+	for (int round = 0; round < 10; ++round)
+	{
+		const int count = 64;
+		gkJobSystem jobs(8);
+
+		gkAtomicInt threads[count];
+		gkJobCounter counter;
+		for (int i = 0; i < count; ++i)
+			jobs.submit(new RecordJob(threads[i]), &counter);
+		jobs.wait(counter);
+
+		EXPECT_TRUE(counter.isDone());
+	}
+}
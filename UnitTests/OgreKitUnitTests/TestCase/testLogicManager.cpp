@@ -0,0 +1,82 @@
+#include "StdAfx.h"
+#include "Fixtures/LogicFixture.h"
+
+#define TEST_CASE_NAME testLogicManager
+
+
+TEST(TEST_CASE_NAME, testActivation)
+{
+	const int count = 64;
+	BenchScene bench(count);
+	UTsize i;
+
+	bench.tick();
+	for (i = 0; i < bench.m_actuators.size(); ++i)
+	{
+		EXPECT_TRUE(bench.m_actuators[i]->isActive());
+		EXPECT_EQ(bench.m_actuators[i]->m_count, 1);
+	}
+
+	// switched off, executed once more then popped
+	bench.tick();
+	for (i = 0; i < bench.m_actuators.size(); ++i)
+	{
+		EXPECT_FALSE(bench.m_actuators[i]->isActive());
+		EXPECT_EQ(bench.m_actuators[i]->m_count, 2);
+	}
+
+	bench.tick();
+	bench.tick();
+	for (i = 0; i < bench.m_actuators.size(); ++i)
+		EXPECT_EQ(bench.m_actuators[i]->m_count, 4);
+}
+
+
+TEST(TEST_CASE_NAME, testSensorSleep)
+{
+	BenchScene bench(1);
+	gkLogicLink* link = bench.m_link;
+	gkLogicController* cont = bench.m_controllers[0];
+
+	gkAlwaysSensor* always = new gkAlwaysSensor(bench.m_object, link, "Always");
+	always->setMask(1);
+	link->push(always);
+	always->link(cont);
+
+	EXPECT_FALSE(always->isSleeping());
+	always->execute();
+	EXPECT_TRUE(always->isSleeping());
+
+	// true pulse mode fires every tick
+	always->setMode(gkLogicSensor::PM_TRUE);
+	EXPECT_FALSE(always->isSleeping());
+
+
+	gkVariable* prop = bench.m_object->createVariable("prop", false);
+	prop->setValue(0);
+
+	gkPropertySensor* equal = new gkPropertySensor(bench.m_object, link, "Property");
+	equal->setMask(1);
+	equal->setType(gkPropertySensor::PS_EQUAL);
+	equal->setProperty("prop");
+	equal->setValue("1");
+	link->push(equal);
+	equal->link(cont);
+
+	equal->execute();
+	EXPECT_FALSE(equal->isPositive());
+	EXPECT_TRUE(equal->isSleeping());
+
+	prop->setValue(1);
+	EXPECT_FALSE(equal->isSleeping());
+	equal->execute();
+	EXPECT_TRUE(equal->isPositive());
+	EXPECT_TRUE(equal->isSleeping());
+
+	// leaving the state wakes it up once
+	link->setState(2);
+	EXPECT_FALSE(equal->isSleeping());
+	equal->execute();
+	EXPECT_TRUE(equal->isSleeping());
+}
+
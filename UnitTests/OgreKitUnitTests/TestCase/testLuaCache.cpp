@@ -0,0 +1,170 @@
+#include "StdAfx.h"
+
+#ifdef OGREKIT_USE_LUA
+
+#include "Script/Lua/gkLuaManager.h"
+#include "gkTextManager.h"
+#include "Fixtures/LuaFixture.h"
+
+#define TEST_CASE_NAME testLuaCache
+
+
+TEST(TEST_CASE_NAME, testRoundTrip)
+{
+	lua_State* L = luaL_newstate();
+	luaL_openlibs(L);
+
+	gkString script = makeScript(42);
+	gkString failing = "local a = 1\nerror('boom')\n";
+
+	gkString cacheFile;
+	{
+		gkLuaCache cache(CACHE_DIR);
+		cacheFile = cache.getCacheFile();
+		remove(cacheFile.c_str());
+
+		EXPECT_FALSE(cache.load());
+		ASSERT_TRUE(compile(L, &cache, script, "Script.lua"));
+		EXPECT_EQ(runNumber(L), 42);
+		ASSERT_TRUE(compile(L, &cache, failing, "Failing.lua"));
+		lua_pop(L, 1);
+
+		EXPECT_EQ(cache.getMisses(), 2);
+		EXPECT_TRUE(cache.save());
+	}
+
+	{
+		gkLuaCache cache(CACHE_DIR);
+		ASSERT_TRUE(cache.load());
+
+		EXPECT_TRUE(cache.loadChunk(L, script.c_str(), script.size(), "Script.lua"));
+		EXPECT_EQ(runNumber(L), 42);
+
+		// same text under another name reports that name
+		ASSERT_TRUE(cache.loadChunk(L, failing.c_str(), failing.size(), "Other.lua"));
+		ASSERT_TRUE(lua_pcall(L, 0, 0, 0) != 0);
+		gkString error = lua_tostring(L, -1);
+		lua_pop(L, 1);
+		EXPECT_TRUE(error.find("Other.lua\"]:2:") != gkString::npos);
+
+		// edited text is compiled again
+		gkString edited = makeScript(43);
+		EXPECT_FALSE(cache.loadChunk(L, edited.c_str(), edited.size(), "Script.lua"));
+		EXPECT_EQ(cache.getHits(), 2);
+		EXPECT_EQ(cache.getMisses(), 1);
+	}
+
+	// a damaged file is dropped
+	{
+		utFileStream fs;
+		fs.open(cacheFile.c_str(), utStream::SM_READ);
+		utArray<char> data;
+		data.resize(fs.size());
+		fs.read(data.ptr(), data.size());
+		fs.close();
+
+		data[data.size() - 3] ^= 0x55;
+		fs.open(cacheFile.c_str(), utStream::SM_WRITE);
+		fs.write(data.ptr(), data.size());
+		fs.close();
+
+		gkLuaCache cache(CACHE_DIR);
+		EXPECT_FALSE(cache.load());
+		EXPECT_FALSE(cache.loadChunk(L, script.c_str(), script.size(), "Script.lua"));
+	}
+
+	remove(cacheFile.c_str());
+	lua_close(L);
+}
+
+
+TEST(TEST_CASE_NAME, testScriptEnvironments)
+{
+	gkTextManager* text = gkTextManager::getSingletonPtr() ? 0 : new gkTextManager();
+	gkLuaManager* manager = gkLuaManager::getSingletonPtr() ? 0 : new gkLuaManager();
+	gkLuaManager& lua = gkLuaManager::getSingleton();
+	lua.setScriptEnvironments(true);
+
+	// the last character of a script is cut, like the zero of a text block
+	const char* counter = "value = (value or 0) + 1\nreturn math.floor(value)\n";
+	const char* other   = "value = (value or 100) + 1\nreturn value\n";
+
+	gkLuaScript* a = lua.createFromText(gkResourceName("EnvA.lua"), counter);
+	gkLuaScript* b = lua.createFromText(gkResourceName("EnvB.lua"), other);
+	ASSERT_TRUE(a && b);
+
+	// globals stay with their script between calls
+	EXPECT_TRUE(a->execute());
+	EXPECT_EQ(a->getReturnStrValue(), "1");
+	EXPECT_TRUE(b->execute());
+	EXPECT_EQ(b->getReturnStrValue(), "101");
+	EXPECT_TRUE(a->execute());
+	EXPECT_EQ(a->getReturnStrValue(), "2");
+
+	lua_State* L = lua.getLua();
+	lua_getglobal(L, "value");
+	EXPECT_TRUE(lua_isnil(L, -1));
+	lua_pop(L, 1);
+
+	lua.destroy(a);
+	lua.destroy(b);
+	lua.setScriptEnvironments(false);
+	delete manager;
+	delete text;
+}
+
+
+TEST(TEST_CASE_NAME, testImport)
+{
+	gkTextManager* text = gkTextManager::getSingletonPtr() ? 0 : new gkTextManager();
+	gkLuaManager* manager = gkLuaManager::getSingletonPtr() ? 0 : new gkLuaManager();
+	gkLuaManager& lua = gkLuaManager::getSingleton();
+	lua_State* L = lua.getLua();
+
+	const char* library = "imported = (imported or 0) + 1\n";
+	const char* caller  = "OgreKit.import('ImportLib.lua')\nreturn imported\n";
+
+	// shared globals, the imported ones land in _G
+	gkLuaScript* lib = lua.createFromText(gkResourceName("ImportLib.lua"), library);
+	gkLuaScript* a = lua.createFromText(gkResourceName("ImportA.lua"), caller);
+	ASSERT_TRUE(lib && a);
+
+	EXPECT_TRUE(a->execute());
+	EXPECT_EQ(a->getReturnStrValue(), "1");
+	lua_getglobal(L, "imported");
+	EXPECT_EQ(lua_tointeger(L, -1), 1);
+	lua_pop(L, 1);
+
+	lua.destroy(lib);
+	lua.destroy(a);
+	lua_pushnil(L);
+	lua_setglobal(L, "imported");
+
+	// with environments, in the environment of each importing script
+	lua.setScriptEnvironments(true);
+	lib = lua.createFromText(gkResourceName("ImportLib.lua"), library);
+	a = lua.createFromText(gkResourceName("ImportA.lua"), caller);
+	gkLuaScript* b = lua.createFromText(gkResourceName("ImportB.lua"), caller);
+	ASSERT_TRUE(lib && a && b);
+
+	EXPECT_TRUE(a->execute());
+	EXPECT_EQ(a->getReturnStrValue(), "1");
+	EXPECT_TRUE(a->execute());
+	EXPECT_EQ(a->getReturnStrValue(), "2");
+	EXPECT_TRUE(b->execute());
+	EXPECT_EQ(b->getReturnStrValue(), "1");
+
+	lua_getglobal(L, "imported");
+	EXPECT_TRUE(lua_isnil(L, -1));
+	lua_pop(L, 1);
+
+	lua.destroy(lib);
+	lua.destroy(a);
+	lua.destroy(b);
+	lua.setScriptEnvironments(false);
+	delete manager;
+	delete text;
+}
+
+
+#endif
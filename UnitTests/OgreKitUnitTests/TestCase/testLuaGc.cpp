@@ -0,0 +1,99 @@
+#include "StdAfx.h"
+
+#ifdef OGREKIT_USE_LUA
+
+#include "Script/Lua/gkLuaGc.h"
+#include "Fixtures/LuaFixture.h"
+
+#define TEST_CASE_NAME testLuaGc
+
+namespace
+{
+
+// a frame of script work: temporaries, and a table of live objects that is
+// partly replaced so the collector has to traverse something
+const char* FRAME_SCRIPT =
+	"objects = objects or {}\n"
+	"for i = 1, 400 do\n"
+	"\tlocal v = {x = i, y = i * 2, name = 'obj' .. i}\n"
+	"\tif i % 20 == 0 then objects[(i + frame) % 2000] = v end\n"
+	"end\n";
+
+
+void runFrame(lua_State* L, int frame)
+{
+	lua_pushnumber(L, frame);
+	lua_setglobal(L, "frame");
+	luaL_dostring(L, FRAME_SCRIPT);
+}
+
+}
+
+
+TEST(TEST_CASE_NAME, testCollect)
+{
+	lua_State* L = createState();
+	gkLuaGc gc(L);
+	gc.setBudget(500);
+	EXPECT_TRUE(gc.isScheduled());
+
+	// no collection inside allocations
+	int heap = gc.getHeapKb();
+	luaL_dostring(L, "for i = 1, 50000 do local t = {i} end");
+	EXPECT_GT(gc.getHeapKb(), heap + 1000);
+
+	gc.collect();
+	EXPECT_LT(gc.getHeapKb(), heap + 100);
+
+	// still stopped after the full collection
+	luaL_dostring(L, "for i = 1, 50000 do local t = {i} end");
+	EXPECT_GT(gc.getHeapKb(), heap + 1000);
+
+	// back to Lua
+	gc.setBudget(0);
+	gc.update();
+	EXPECT_EQ(gc.getLastSteps(), 0);
+	luaL_dostring(L, "for i = 1, 200000 do local t = {i} end");
+	EXPECT_LT(gc.getHeapKb(), heap + 5000);
+
+	lua_close(L);
+}
+
+
+TEST(TEST_CASE_NAME, testBudget)
+{
+	const unsigned long budget = 300;
+	lua_State* L = createState();
+	gkLuaGc gc(L);
+	gc.setBudget(budget);
+
+	const int frames = 500;
+	unsigned long steps = 0, overBudget = 0;
+	int maxHeap = 0;
+
+	for (int frame = 0; frame < frames; ++frame)
+	{
+		runFrame(L, frame);
+		gc.update();
+
+		steps += gc.getLastSteps();
+		maxHeap = gkMax<int>(maxHeap, gc.getHeapKb());
+
+		// a basic step may end a little past the budget, and the
+		// process can be preempted while stepping
+		if (gc.getLastMicroSeconds() > budget + 200)
+			++overBudget;
+	}
+
+	EXPECT_GT(steps, 0U);
+	EXPECT_GT(gc.getCycles(), 0U);
+	EXPECT_LT(overBudget, frames / 20U);
+
+	// the live set is about 2000 small tables
+	EXPECT_LT(maxHeap, 4000);
+
+	lua_close(L);
+}
+
+
+#endif
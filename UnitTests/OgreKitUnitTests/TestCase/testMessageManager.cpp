@@ -0,0 +1,241 @@
+#include "StdAfx.h"
+#include "Fixtures/ObjectFixture.h"
+#include "Fixtures/MessageFixture.h"
+
+#define TEST_CASE_NAME testMessageManager
+
+namespace
+{
+
+class CountingListener : public gkMessageManager::MessageListener
+{
+public:
+	int m_count;
+
+	CountingListener() : m_count(0) {}
+
+	void handleMessage(gkMessageManager::Message* message) { ++m_count; }
+};
+
+
+class NullController : public gkLogicController
+{
+public:
+	NullController(gkGameObject* object, gkLogicLink* link, const gkString& name)
+		:	gkLogicController(object, link, name) {}
+
+	gkLogicBrick* clone(gkLogicLink* link, gkGameObject* dest) { return 0; }
+	void execute(void) {}
+};
+
+
+// a message sensor on an object named Cube
+class SensorScene
+{
+public:
+	ObjectManager    m_creator;
+	gkEngine*        m_engine;
+	gkScene*         m_scene;
+	gkGameObject*    m_object;
+	gkLogicManager*  m_logic;
+	gkMessageSensor* m_sensor;
+
+	SensorScene()
+	{
+		// game objects use the engine singleton on destruction
+		m_engine = gkEngine::getSingletonPtr() ? 0 : new gkEngine();
+
+		m_scene  = new gkScene(&m_creator, gkResourceName("SensorScene"), 0);
+		m_object = new gkGameObject(&m_creator, gkResourceName("Cube"), 1);
+		m_object->setOwner(m_scene);
+		m_logic  = m_scene->getLogicBrickManager();
+
+		gkLogicLink* link = m_logic->createLink();
+		link->setState(1);
+
+		NullController* cont = new NullController(m_object, link, "Controller");
+		cont->setMask(1);
+		link->push(cont);
+
+		m_sensor = new gkMessageSensor(m_object, link, "Message");
+		m_sensor->setMask(1);
+		link->push(m_sensor);
+		m_sensor->link(cont);
+	}
+
+	~SensorScene()
+	{
+		// deletes the link and its bricks
+		delete m_logic;
+		delete m_object;
+		delete m_scene;
+		delete m_engine;
+	}
+};
+
+}
+
+
+TEST(TEST_CASE_NAME, testRouting)
+{
+	ScopedManager scoped;
+	gkMessageManager& mgr = scoped.get();
+
+	gkMessageManager::GenericMessageListener cube("", "Cube", "hit");
+	cube.setAcceptEmptyTo(true);
+	gkMessageManager::GenericMessageListener anyHit("Player", "", "hit");
+	gkMessageManager::GenericMessageListener anySubject;
+	CountingListener counter;
+
+	mgr.addListener(&cube);
+	mgr.addListener(&anyHit);
+	mgr.addListener(&anySubject);
+	mgr.addListener(&counter);
+
+	EXPECT_TRUE(mgr.find("hit") != (gkMessageManager::Id)gkMessageManager::UNKNOWN_ID);
+	EXPECT_TRUE(mgr.find("score") == (gkMessageManager::Id)gkMessageManager::UNKNOWN_ID);
+	EXPECT_EQ(mgr.intern("Cube"), mgr.find("Cube"));
+
+	mgr.sendMessage("Player", "Cube", "hit", "1");
+	mgr.sendMessage("Player", "", "hit", "2");
+	mgr.sendMessage("Player", "Sphere", "hit", "3");
+	mgr.sendMessage("Enemy", "Cube", "hit", "4");
+	mgr.sendMessage("Player", "Cube", "score", "5");
+
+	gkMessageManager::Id hit = mgr.find("hit");
+	mgr.sendMessage(mgr.intern("Enemy"), mgr.find("Cube"), hit, "6");
+
+	ASSERT_EQ(cube.m_messages.size(), 4U);
+	EXPECT_EQ(cube.m_messages[0]->m_body, "1");
+	EXPECT_EQ(cube.m_messages[1]->m_body, "2");
+	EXPECT_EQ(cube.m_messages[2]->m_body, "4");
+	EXPECT_EQ(cube.m_messages[3]->m_body, "6");
+	EXPECT_EQ(cube.m_messages[3]->m_from, "Enemy");
+
+	EXPECT_EQ(anyHit.m_messages.size(), 3U);
+	EXPECT_EQ(anySubject.m_messages.size(), 6U);
+	EXPECT_EQ(counter.m_count, 6);
+
+	// delivered by reference
+	EXPECT_TRUE(cube.m_messages[0] == anySubject.m_messages[0]);
+
+	// a new subject moves the listener
+	cube.setSubjectFilter("score");
+	cube.emptyMessages();
+	mgr.sendMessage("Player", "Cube", "hit", "7");
+	mgr.sendMessage("Player", "Cube", "score", "8");
+	ASSERT_EQ(cube.m_messages.size(), 1U);
+	EXPECT_EQ(cube.m_messages[0]->m_body, "8");
+
+	EXPECT_TRUE(mgr.removeListener(&cube));
+	EXPECT_FALSE(mgr.removeListener(&cube));
+	mgr.removeListener(&anyHit);
+	mgr.removeListener(&anySubject);
+	mgr.removeListener(&counter);
+}
+
+
+TEST(TEST_CASE_NAME, testExpiry)
+{
+	ScopedManager scoped;
+	gkMessageManager& mgr = scoped.get();
+
+	gkMessageManager::GenericMessageListener listener("", "", "tick");
+	mgr.addListener(&listener);
+
+	mgr.sendMessage("", "", "tick", "a");
+	mgr.nextTick();
+	mgr.sendMessage("", "", "tick", "b");
+
+	// the message of the last tick is still in its arena
+	ASSERT_EQ(listener.m_messages.size(), 2U);
+	EXPECT_EQ(listener.m_messages[0]->m_body, "a");
+
+	// messages not taken outlive their arena, "c" reuses the slot of "a"
+	mgr.nextTick();
+	mgr.sendMessage("", "", "tick", "c");
+	mgr.nextTick();
+	mgr.nextTick();
+	ASSERT_EQ(listener.m_messages.size(), 3U);
+	EXPECT_EQ(listener.m_messages[0]->m_body, "a");
+	EXPECT_EQ(listener.m_messages[1]->m_body, "b");
+	EXPECT_EQ(listener.m_messages[2]->m_body, "c");
+
+	listener.emptyMessages();
+	EXPECT_EQ(listener.m_messages.size(), 0U);
+
+	// slots are recycled, the arena does not grow
+	const gkMessageManager::Message* first = 0;
+	for (int t = 0; t < 4; ++t)
+	{
+		listener.emptyMessages();
+		mgr.nextTick();
+		for (int i = 0; i < 100; ++i)
+			mgr.sendMessage("", "", "tick", "x");
+		if (t == 0)
+			first = listener.m_messages[0];
+		if (t == 2)
+			EXPECT_TRUE(listener.m_messages[0] == first);
+	}
+
+	mgr.removeListener(&listener);
+}
+
+
+TEST(TEST_CASE_NAME, testSensorFrequency)
+{
+	ScopedManager scoped;
+	gkMessageManager& mgr = scoped.get();
+
+	SensorScene scene;
+	gkMessageSensor* sensor = scene.m_sensor;
+
+	// queried every fourth tick
+	sensor->setMode(gkLogicSensor::PM_TRUE);
+	sensor->setFrequency(6);
+	ASSERT_EQ(sensor->getFrequency(), 3);
+
+	sensor->execute();
+	EXPECT_FALSE(sensor->isPositive());
+
+	mgr.sendMessage("Player", "Cube", "hit", "1");
+	mgr.sendMessage("Player", "Sphere", "hit", "other");
+
+	int tick;
+	for (tick = 1; tick <= 3; ++tick)
+	{
+		mgr.nextTick();
+		if (tick == 2)
+			mgr.sendMessage("Player", "", "hit", "2");
+		sensor->execute();
+	}
+	EXPECT_FALSE(sensor->isPositive());
+
+	// both messages wait for the query, the first sent three ticks ago
+	mgr.nextTick();
+	sensor->execute();
+	EXPECT_TRUE(sensor->isPositive());
+	ASSERT_EQ(sensor->getMessageCount(), 2);
+	EXPECT_EQ(sensor->getMessage(0).m_body, "1");
+	EXPECT_EQ(sensor->getMessage(0).m_from, "Player");
+	EXPECT_EQ(sensor->getMessage(1).m_body, "2");
+
+	// a sensor in an inactive state keeps them as well
+	sensor->getLink()->setState(2);
+	mgr.sendMessage("Player", "Cube", "hit", "3");
+	for (tick = 0; tick < 3; ++tick)
+	{
+		mgr.nextTick();
+		sensor->execute();
+	}
+
+	sensor->getLink()->setState(1);
+	for (tick = 0; tick < 4 && sensor->getMessageCount() == 0; ++tick)
+	{
+		mgr.nextTick();
+		sensor->execute();
+	}
+	ASSERT_EQ(sensor->getMessageCount(), 1);
+	EXPECT_EQ(sensor->getMessage(0).m_body, "3");
+}
+
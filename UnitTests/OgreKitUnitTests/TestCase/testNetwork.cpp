@@ -0,0 +1,320 @@
+#include "StdAfx.h"
+
+#define TEST_CASE_NAME testNetwork
+
+#ifdef OGREKIT_COMPILE_ENET
+
+#include "Fixtures/NetworkFixture.h"
+
+namespace
+{
+
+// decodes every snapshot frame of the received packets
+struct SnapshotDecoder
+{
+	int m_count;
+	gkReplicationDecoder m_decoder;
+	gkReplicationInterpolator m_interpolator;
+	gkReplicationSnapshot m_snapshot;
+
+	SnapshotDecoder() : m_count(0) {}
+
+	void decode(const ENetPacket* packet)
+	{
+		gkNetworkPacketReader reader(packet->data, packet->dataLength);
+		UTuint8 type;
+		UTuint32 length;
+		const UTuint8* frame;
+		while (reader.readU8(type) && type == GK_NET_FRAME_SNAPSHOT && reader.readU32(length) && reader.readBlock(frame, length))
+		{
+			if (m_decoder.decode(frame, length, m_snapshot))
+				m_interpolator.push(m_snapshot);
+			++m_count;
+		}
+	}
+};
+
+
+// objects circling around the origin at different speeds
+void moveObjects(gkReplicationStates& states, int count, gkScalar time)
+{
+	states.resize(count);
+	for (int i = 0; i < count; ++i)
+	{
+		gkReplicationState& state = states[i];
+		gkScalar angle = time * (0.5f + 0.01f * i);
+		state.id = (UTuint16)i;
+		state.name = "Object." + gkToString(i);
+		state.position = gkVector3(gkMath::Cos(angle) * 20, gkMath::Sin(angle) * 20, 1 + i * 0.01f);
+		state.orientation = gkQuaternion(gkRadian(angle), gkVector3::UNIT_Z);
+		state.linearVelocity = gkVector3(-gkMath::Sin(angle), gkMath::Cos(angle), 0) * 20 * (0.5f + 0.01f * i);
+		state.angularVelocity = gkVector3(0, 0, 0.5f + 0.01f * i);
+
+		state.variables.resize(1);
+		state.variables[0].name = "health";
+		state.variables[0].type = gkVariable::VAR_INT;
+		state.variables[0].value = gkToString(100 - (int)(time) % 100);
+	}
+}
+
+}
+
+
+TEST(TEST_CASE_NAME, testPacketRoundTrip)
+{
+	gkNetworkPacketWriter writer;
+	EXPECT_TRUE(writer.empty());
+
+	EXPECT_TRUE(writer.writeMessage("Player", "Door", "open", "now"));
+	EXPECT_TRUE(writer.writeMessage("", "Door", "", gkString(70000, 'x')));
+	// a ';' in a part used to break the text protocol
+	EXPECT_TRUE(writer.writeMessage("a;b", "", "c;d", ";"));
+
+	gkNetworkPacketReader reader(writer.ptr(), writer.size());
+	gkString from, to, subject, body;
+	UTuint8 type = 0;
+
+	ASSERT_TRUE(reader.readU8(type));
+	EXPECT_EQ(type, GK_NET_FRAME_MESSAGE);
+	ASSERT_TRUE(reader.readMessage(from, to, subject, body));
+	EXPECT_EQ(from, "Player");
+	EXPECT_EQ(to, "Door");
+	EXPECT_EQ(subject, "open");
+	EXPECT_EQ(body, "now");
+
+	ASSERT_TRUE(reader.readU8(type));
+	ASSERT_TRUE(reader.readMessage(from, to, subject, body));
+	EXPECT_TRUE(from.empty());
+	EXPECT_EQ(body.size(), 70000U);
+
+	ASSERT_TRUE(reader.readU8(type));
+	ASSERT_TRUE(reader.readMessage(from, to, subject, body));
+	EXPECT_EQ(from, "a;b");
+	EXPECT_EQ(subject, "c;d");
+	EXPECT_EQ(body, ";");
+	EXPECT_TRUE(reader.atEnd());
+
+	// too long for the u16 length
+	EXPECT_FALSE(writer.writeMessage(gkString(70000, 'x'), "", "", ""));
+
+	// swapping hands the batch over, the other buffer is empty
+	gkNetworkPacketWriter sending;
+	UTsize size = writer.size();
+	writer.swap(sending);
+	EXPECT_TRUE(writer.empty());
+	EXPECT_EQ(sending.size(), size);
+}
+
+
+TEST(TEST_CASE_NAME, testTruncatedPacket)
+{
+	gkNetworkPacketWriter writer;
+	writer.writeMessage("Player", "Door", "open", "now");
+
+	gkString from, to, subject, body;
+	for (UTsize length = 1; length < writer.size(); ++length)
+	{
+		gkNetworkPacketReader reader(writer.ptr(), length);
+		UTuint8 type;
+		ASSERT_TRUE(reader.readU8(type));
+		EXPECT_FALSE(reader.readMessage(from, to, subject, body));
+	}
+
+	gkNetworkPacketReader reader(writer.ptr(), 0);
+	UTuint8 type;
+	EXPECT_FALSE(reader.readU8(type));
+	EXPECT_TRUE(reader.atEnd());
+}
+
+
+TEST(TEST_CASE_NAME, testSnapshotDelta)
+{
+	gkReplicationEncoder encoder;
+	gkReplicationDecoder decoder;
+	gkReplicationStates states;
+	gkReplicationSnapshot snapshot;
+	gkNetworkPacketWriter frame;
+	const int count = 100;
+
+	moveObjects(states, count, 0);
+	UTsize keyframe = encoder.encode(states, 0, true, frame);
+
+	gkNetworkPacketReader reader(frame.ptr(), frame.size());
+	UTuint8 type;
+	UTuint32 length;
+	const UTuint8* data;
+	ASSERT_TRUE(reader.readU8(type) && reader.readU32(length) && reader.readBlock(data, length));
+	EXPECT_EQ(type, GK_NET_FRAME_SNAPSHOT);
+	EXPECT_TRUE(reader.atEnd());
+
+	ASSERT_TRUE(decoder.decode(data, length, snapshot));
+	ASSERT_EQ(snapshot.states.size(), (UTsize)count);
+	for (int i = 0; i < count; ++i)
+	{
+		const gkReplicationState& a = states[i];
+		const gkReplicationState& b = snapshot.states[i];
+		EXPECT_EQ(a.id, b.id);
+		EXPECT_EQ(a.name, b.name);
+		EXPECT_TRUE(a.position.positionEquals(b.position, 1.0f / 1024));
+		EXPECT_TRUE(a.linearVelocity.positionEquals(b.linearVelocity, 1.0f / 256));
+		EXPECT_TRUE(a.orientation.equals(b.orientation, gkRadian(0.005f)));
+		EXPECT_EQ(a.variables[0].value, b.variables[0].value);
+	}
+
+	// one object moved, the others are left out
+	states[7].position.x += 1;
+	frame.clear();
+	UTsize delta = encoder.encode(states, 50, false, frame);
+	EXPECT_LT(delta, 32U);
+	ASSERT_TRUE(decoder.decode(frame.ptr() + 5, frame.size() - 5, snapshot));
+	EXPECT_TRUE(snapshot.states[7].position.positionEquals(states[7].position, 1.0f / 1024));
+	EXPECT_EQ(snapshot.states.size(), (UTsize)count);
+
+	// removed objects are dropped
+	states.resize(count - 1);
+	frame.clear();
+	encoder.encode(states, 100, false, frame);
+	ASSERT_TRUE(decoder.decode(frame.ptr() + 5, frame.size() - 5, snapshot));
+	EXPECT_EQ(snapshot.states.size(), (UTsize)count - 1);
+
+	// a late joiner waits for a keyframe
+	gkReplicationDecoder late;
+	moveObjects(states, count, 1);
+	frame.clear();
+	encoder.encode(states, 150, false, frame);
+	EXPECT_FALSE(late.decode(frame.ptr() + 5, frame.size() - 5, snapshot));
+	EXPECT_FALSE(late.isSynchronized());
+	ASSERT_TRUE(decoder.decode(frame.ptr() + 5, frame.size() - 5, snapshot));
+
+	frame.clear();
+	EXPECT_GT(encoder.encode(states, 200, true, frame), delta);
+	EXPECT_TRUE(late.decode(frame.ptr() + 5, frame.size() - 5, snapshot));
+	EXPECT_EQ(snapshot.states.size(), (UTsize)count);
+
+	EXPECT_LT(delta, keyframe);
+}
+
+
+TEST(TEST_CASE_NAME, testSnapshotRange)
+{
+	gkReplicationEncoder encoder;
+	gkReplicationDecoder decoder;
+	gkReplicationStates states;
+	gkReplicationSnapshot snapshot;
+	gkNetworkPacketWriter frame;
+
+	// far out of the quantized range, clamped instead of wrapping
+	moveObjects(states, 2, 0);
+	states[0].position = gkVector3(1e12f, -1e12f, 0);
+	states[1].linearVelocity = gkVector3(1e30f, -1e30f, 0);
+	encoder.encode(states, 0, true, frame);
+	ASSERT_TRUE(decoder.decode(frame.ptr() + 5, frame.size() - 5, snapshot));
+	EXPECT_GT(snapshot.states[0].position.x, 1e5f);
+	EXPECT_LT(snapshot.states[0].position.y, -1e5f);
+	EXPECT_GT(snapshot.states[1].linearVelocity.x, 1e5f);
+	EXPECT_LT(snapshot.states[1].linearVelocity.y, -1e5f);
+
+	// deltas from the clamped values back into range
+	moveObjects(states, 2, 0);
+	frame.clear();
+	encoder.encode(states, 50, false, frame);
+	ASSERT_TRUE(decoder.decode(frame.ptr() + 5, frame.size() - 5, snapshot));
+	EXPECT_TRUE(snapshot.states[0].position.positionEquals(states[0].position, 1.0f / 1024));
+	EXPECT_TRUE(snapshot.states[1].linearVelocity.positionEquals(states[1].linearVelocity, 1.0f / 256));
+}
+
+
+TEST(TEST_CASE_NAME, testInterpolation)
+{
+	gkReplicationInterpolator interpolator(4);
+	gkReplicationSnapshot snapshot;
+	gkReplicationStates states;
+
+	EXPECT_FALSE(interpolator.sample(0, states));
+
+	snapshot.states.resize(1);
+	for (int i = 0; i < 6; ++i)
+	{
+		snapshot.time = i * 100;
+		snapshot.states[0].position = gkVector3((gkScalar)i, 0, 0);
+		snapshot.states[0].orientation = gkQuaternion(gkDegree(i * 10.0f), gkVector3::UNIT_Z);
+		interpolator.push(snapshot);
+	}
+
+	// older than the latest, ignored
+	snapshot.time = 250;
+	interpolator.push(snapshot);
+	EXPECT_EQ(interpolator.getLatestTime(), 500U);
+
+	ASSERT_TRUE(interpolator.sample(450, states));
+	EXPECT_TRUE(states[0].position.positionEquals(gkVector3(4.5f, 0, 0), 1e-4f));
+	EXPECT_TRUE(states[0].orientation.equals(gkQuaternion(gkDegree(45), gkVector3::UNIT_Z), gkDegree(0.1f)));
+
+	// held at both ends, the first two were pushed out of the ring
+	interpolator.sample(600, states);
+	EXPECT_TRUE(states[0].position.positionEquals(gkVector3(5, 0, 0), 1e-4f));
+	interpolator.sample(0, states);
+	EXPECT_TRUE(states[0].position.positionEquals(gkVector3(2, 0, 0), 1e-4f));
+}
+
+
+TEST(TEST_CASE_NAME, testReplicationLoopback)
+{
+	const int count = 150, rate = 20, seconds = 3;
+	LoopbackHosts hosts(false);
+	if (!hosts.isConnected())
+	{
+		printf("loopback enet hosts unavailable, skipping replication\n");
+		return;
+	}
+
+	gkReplicationEncoder encoder;
+	gkReplicationStates states;
+	gkNetworkPacketWriter frame, text;
+	SnapshotDecoder client;
+	UTsize bytes = 0, textBytes = 0;
+
+	for (int i = 0; i < rate * seconds; ++i)
+	{
+		UTuint32 time = i * 1000 / rate;
+		moveObjects(states, count, time / 1000.0f);
+
+		frame.clear();
+		bytes += encoder.encode(states, time, i % 40 == 0, frame);
+
+		ENetPacket* packet = enet_packet_create(frame.ptr(), frame.size(), ENET_PACKET_FLAG_RELIABLE);
+		enet_peer_send(hosts.m_peer, 0, packet);
+		enet_host_flush(hosts.m_client);
+		ASSERT_TRUE(hosts.receive(i + 1, client));
+
+		// the same states as string messages
+		for (int o = 0; o < count; ++o)
+		{
+			const gkReplicationState& state = states[o];
+			text.writeMessage(state.name, state.name, "state",
+				gkToString(state.position) + " " + gkToString(state.orientation) + " " +
+				gkToString(state.linearVelocity) + " " + gkToString(state.angularVelocity) + " " + state.variables[0].value);
+		}
+		textBytes += text.size();
+		text.clear();
+	}
+
+	// played back between two snapshots
+	gkReplicationStates sampled;
+	UTuint32 time = (rate * seconds - 2) * 1000 / rate + 1000 / (2 * rate);
+	ASSERT_TRUE(client.m_interpolator.sample(time, sampled));
+	ASSERT_EQ(sampled.size(), (UTsize)count);
+
+	moveObjects(states, count, time / 1000.0f);
+	gkScalar maxError = 0;
+	for (int o = 0; o < count; ++o)
+		maxError = gkMax(maxError, sampled[o].position.distance(states[o].position));
+
+	// the chord of a circle, 20 units radius, about a fifth of a radian per snapshot
+	EXPECT_LT(maxError, 0.25f);
+
+	// well under the same states sent as string messages
+	EXPECT_LT(bytes, textBytes);
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include "StdAfx.h"
+#include "Fixtures/PhysicsFixture.h"
+
+#define TEST_CASE_NAME testParallelPhysics
+
+namespace
+{
+
+bool sameState(const utArray<btScalar>& a, const utArray<btScalar>& b)
+{
+	return a.size() == b.size() && memcmp(a.ptr(), b.ptr(), a.size() * sizeof(btScalar)) == 0;
+}
+
+}
+
+
+TEST(TEST_CASE_NAME, testDeterminism)
+{
+	const int frames = 150;
+	utArray<btScalar> serial, single, parallel, again;
+
+	{
+		Scene scene(false, 8);
+		scene.run(frames);
+		scene.getState(serial);
+
+		// the piles have to touch each other, the ground & the kinematic box
+		EXPECT_GT(scene.m_dispatcher->getNumManifolds(), 200);
+	}
+
+	{
+		gkJobSystem jobs(1);
+		Scene scene(true, 8);
+		scene.run(frames);
+		scene.getState(single);
+	}
+
+	{
+		gkJobSystem jobs(3);
+		Scene scene(true, 8);
+		scene.run(frames);
+		scene.getState(parallel);
+
+		Scene other(true, 8);
+		other.run(frames);
+		other.getState(again);
+	}
+
+	// nothing fell through the ground, skipping the ground itself
+	bool above = true;
+	for (UTsize i = 12; i < serial.size(); i += 12)
+		above = above && serial[i + 8] > -1.f;
+	EXPECT_TRUE(above);
+
+	EXPECT_TRUE(sameState(serial, single));
+	EXPECT_TRUE(sameState(serial, parallel));
+	EXPECT_TRUE(sameState(parallel, again));
+}
+
+
+TEST(TEST_CASE_NAME, testGImpact)
+{
+	const int frames = 100;
+	utArray<btScalar> serial, parallel;
+	int meshPairs = 0;
+
+	{
+		Scene scene(false, 4, true);
+		scene.run(frames);
+		scene.getState(serial);
+	}
+
+	{
+		gkJobSystem jobs(3);
+		Scene scene(true, 4, true);
+		scene.run(frames);
+		scene.getState(parallel);
+
+		// meshes touching meshes, so pairs share the shape
+		btDispatcher* dispatcher = scene.m_dispatcher;
+		for (int i = 0; i < dispatcher->getNumManifolds(); ++i)
+		{
+			btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+			if (manifold->getNumContacts() > 0 &&
+			        manifold->getBody0()->getCollisionShape()->getShapeType() == GIMPACT_SHAPE_PROXYTYPE &&
+			        manifold->getBody1()->getCollisionShape()->getShapeType() == GIMPACT_SHAPE_PROXYTYPE)
+				++meshPairs;
+		}
+	}
+
+	EXPECT_GT(meshPairs, 10);
+	EXPECT_TRUE(sameState(serial, parallel));
+}
+
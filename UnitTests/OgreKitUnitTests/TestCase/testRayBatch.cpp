@@ -0,0 +1,220 @@
+#include "StdAfx.h"
+#include "Fixtures/RayBatchFixture.h"
+
+#define TEST_CASE_NAME testRayBatch
+
+namespace
+{
+
+// skips one object, like notMeFilter
+struct SkipFilter : gkRayTest::gkRayTestFilter
+{
+	SkipFilter(btCollisionObject* skip) : m_skip(skip) {}
+
+	bool filterFunc(btCollisionObject* ob) const { return ob != m_skip; }
+
+	btCollisionObject* m_skip;
+};
+
+
+// what gkSweptTest does, without the avoid list
+struct SweepReference : btCollisionWorld::ClosestConvexResultCallback
+{
+	SweepReference(const btVector3& from, const btVector3& to)
+		:	btCollisionWorld::ClosestConvexResultCallback(from, to)
+	{
+		m_collisionFilterGroup = btBroadphaseProxy::AllFilter;
+		m_collisionFilterMask = btBroadphaseProxy::AllFilter;
+	}
+
+	btScalar addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace)
+	{
+		if (!convexResult.m_hitCollisionObject->hasContactResponse())
+			return 1.f;
+		if (convexResult.m_hitNormalLocal.dot(m_convexToWorld - m_convexFromWorld) >= 0.f)
+			return 1.f;
+		return ClosestConvexResultCallback::addSingleResult(convexResult, normalInWorldSpace);
+	}
+};
+
+
+// rays & sweeps across the field, every fourth one a sweep
+void addQueries(gkRayBatch& batch, int count, gkScalar size, const gkRayTest::gkRayTestFilter* filter)
+{
+	Random rnd;
+	for (int i = 0; i < count; ++i)
+	{
+		gkVector3 from = rnd.point(size), to = rnd.point(size);
+		if (i % 4 == 3)
+			batch.addSweep(from, to, rnd.next(0.05f, 0.5f), filter);
+		else
+			batch.addRay(from, to, filter);
+	}
+}
+
+
+bool sameResults(const gkRayBatch::Results& a, const gkRayBatch::Results& b)
+{
+	if (a.size() != b.size())
+		return false;
+
+	for (UTsize i = 0; i < a.size(); ++i)
+	{
+		if (a[i].collisionObject != b[i].collisionObject || a[i].hitFraction != b[i].hitFraction ||
+		        a[i].hitPoint != b[i].hitPoint || a[i].hitNormal != b[i].hitNormal)
+			return false;
+	}
+	return true;
+}
+
+}
+
+
+TEST(TEST_CASE_NAME, testMatchesWorld)
+{
+	const int size = 12, count = 2000;
+	World world(size);
+
+	SkipFilter filter(world.m_objects[size + 1]);
+	gkRayBatch batch(&world.m_world);
+	addQueries(batch, count, size * 3.f, &filter);
+	ASSERT_EQ(batch.size(), (UTsize)count);
+
+	gkRayBatch::Results results;
+	batch.cast(results);
+	ASSERT_EQ(results.size(), (UTsize)count);
+
+	int hits = 0, same = 0, close = 0;
+	bool hidden = false, skipped = false;
+	for (int i = 0; i < count; ++i)
+	{
+		const gkRayBatch::Query& query = batch.getQueries()[i];
+		const gkRayBatch::Result& result = results[i];
+		const btVector3 from = toBullet(query.from), to = toBullet(query.to);
+
+		const btCollisionObject* expected;
+		btScalar fraction;
+		if (query.radius > 0)
+		{
+			SweepReference ref(from, to);
+			btSphereShape sphere(query.radius);
+			btTransform start, end;
+			start.setIdentity();
+			start.setOrigin(from);
+			end.setIdentity();
+			end.setOrigin(to);
+
+			// the reference has no filter, the skipped object is out of the world meanwhile
+			world.m_world.removeCollisionObject(filter.m_skip);
+			world.m_world.convexSweepTest(&sphere, start, end, ref);
+			world.m_world.addCollisionObject(filter.m_skip, btBroadphaseProxy::StaticFilter, btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::StaticFilter);
+
+			expected = ref.m_hitCollisionObject;
+			fraction = ref.m_closestHitFraction;
+		}
+		else
+		{
+			SkipFilter ref(filter.m_skip);
+			world.m_world.rayTest(from, to, ref);
+
+			expected = ref.m_collisionObject;
+			fraction = ref.m_closestHitFraction;
+		}
+
+		if (result.hasHit())
+			++hits;
+		if (result.collisionObject == expected)
+			++same;
+		if (gkAbs(result.hitFraction - fraction) < 1e-4f)
+			++close;
+
+		hidden = hidden || result.collisionObject == world.m_objects.back();
+		skipped = skipped || result.collisionObject == filter.m_skip;
+	}
+
+	// ties between touching objects aside, the same hits
+	EXPECT_GT(hits, count / 4);
+	EXPECT_GT(same, count - count / 100);
+	EXPECT_EQ(close, count);
+	EXPECT_FALSE(hidden);
+	EXPECT_FALSE(skipped);
+
+	// no hit
+	batch.clear();
+	batch.addRay(gkVector3(-10, -10, 20), gkVector3(-10, -10, 30));
+	batch.cast(results);
+	ASSERT_EQ(results.size(), 1U);
+	EXPECT_FALSE(results[0].hasHit());
+	EXPECT_EQ(results[0].hitFraction, 1.f);
+}
+
+
+TEST(TEST_CASE_NAME, testThreads)
+{
+	const int size = 12, count = 3000;
+	World world(size);
+
+	SkipFilter filter(world.m_objects[2]);
+	gkRayBatch batch(&world.m_world);
+	addQueries(batch, count, size * 3.f, &filter);
+
+	gkRayBatch::Results serial, single, parallel;
+	batch.cast(serial);
+
+	{
+		gkJobSystem jobs(1);
+		batch.cast(single);
+	}
+
+	{
+		gkJobSystem jobs(3);
+		batch.cast(parallel);
+	}
+
+	EXPECT_TRUE(sameResults(serial, single));
+	EXPECT_TRUE(sameResults(serial, parallel));
+}
+
+
+TEST(TEST_CASE_NAME, testGImpact)
+{
+	const int size = 12, count = 2000;
+	World world(size, true);
+
+	gkRayBatch batch(&world.m_world);
+	addQueries(batch, count, size * 3.f, 0);
+
+	gkRayBatch::Results serial, parallel;
+	batch.cast(serial);
+	{
+		gkJobSystem jobs(3);
+		batch.cast(parallel);
+	}
+	EXPECT_TRUE(sameResults(serial, parallel));
+
+	int meshHits = 0, same = 0, rays = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		const gkRayBatch::Query& query = batch.getQueries()[i];
+		const btCollisionObject* hit = parallel[i].collisionObject;
+		if (hit && hit->getCollisionShape() == &world.m_gimpact)
+			++meshHits;
+
+		if (query.radius > 0)
+			continue;
+
+		gkRayTest::gkRayTestFilter ref;
+		ref.m_collisionFilterGroup = btBroadphaseProxy::AllFilter;
+		ref.m_collisionFilterMask = btBroadphaseProxy::AllFilter;
+		world.m_world.rayTest(toBullet(query.from), toBullet(query.to), ref);
+
+		++rays;
+		if (hit == ref.m_collisionObject && gkAbs(parallel[i].hitFraction - ref.m_closestHitFraction) < 1e-4f)
+			++same;
+	}
+
+	// meshes are hit by rays & sweeps, rays agree with the world
+	EXPECT_GT(meshHits, count / 20);
+	EXPECT_GT(same, rays - rays / 100);
+}
+
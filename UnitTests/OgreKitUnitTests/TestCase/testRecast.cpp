@@ -0,0 +1,199 @@
+#include "StdAfx.h"
+
+#define TEST_CASE_NAME testRecast
+
+#ifdef OGREKIT_COMPILE_RECAST
+
+namespace
+{
+
+// y up, both windings like gkNavMeshData::cloneData
+void addTriangle(gkMeshData& mesh, const gkVector3& v1, const gkVector3& v2, const gkVector3& v3)
+{
+	int a = mesh.verts.size();
+
+	mesh.verts.push_back(v1);
+	mesh.verts.push_back(v2);
+	mesh.verts.push_back(v3);
+
+	mesh.tris.push_back(a);
+	mesh.tris.push_back(a + 1);
+	mesh.tris.push_back(a + 2);
+	mesh.tris.push_back(a + 2);
+	mesh.tris.push_back(a + 1);
+	mesh.tris.push_back(a);
+}
+
+
+void addQuad(gkMeshData& mesh, const gkVector3& a, const gkVector3& b, const gkVector3& c, const gkVector3& d)
+{
+	addTriangle(mesh, a, b, c);
+	addTriangle(mesh, a, c, d);
+}
+
+
+gkMeshData* createGround(gkScalar size)
+{
+	gkMeshData* mesh = new gkMeshData;
+
+	for (gkScalar x = -size; x < size; x += 2)
+	{
+		for (gkScalar z = -size; z < size; z += 2)
+			addQuad(*mesh, gkVector3(x, 0, z), gkVector3(x + 2, 0, z), gkVector3(x + 2, 0, z + 2), gkVector3(x, 0, z + 2));
+	}
+
+	return mesh;
+}
+
+
+void addBox(gkMeshData& mesh, const gkVector3& mn, const gkVector3& mx)
+{
+	gkVector3 v[8];
+	for (int i = 0; i < 8; ++i)
+		v[i] = gkVector3(i & 1 ? mx.x : mn.x, i & 2 ? mx.y : mn.y, i & 4 ? mx.z : mn.z);
+
+	addQuad(mesh, v[2], v[3], v[7], v[6]);
+	addQuad(mesh, v[0], v[1], v[3], v[2]);
+	addQuad(mesh, v[4], v[5], v[7], v[6]);
+	addQuad(mesh, v[0], v[4], v[6], v[2]);
+	addQuad(mesh, v[1], v[5], v[7], v[3]);
+}
+
+}
+
+
+TEST(TEST_CASE_NAME, testTileCache)
+{
+	gkRecast::Config config;
+	config.CELL_SIZE = 0.3f;
+	config.TILE_SIZE = 32;
+
+	PRECAST_TILE_CACHE cache(new gkRecastTileCache);
+
+	PMESHDATA ground(createGround(20));
+
+	PDT_NAV_MESH navMesh = gkRecast::createNavMesh(ground, config, cache);
+	ASSERT_TRUE(navMesh.get() != 0);
+
+	gkRecast::BuildStats stats = cache->getStats();
+	EXPECT_GT(stats.tiles, 1);
+	EXPECT_EQ(stats.builtTiles, stats.tiles);
+	EXPECT_GT(stats.polys, 0);
+
+	// same input, every tile comes from the cache
+	navMesh = gkRecast::createNavMesh(ground, config, cache);
+	ASSERT_TRUE(navMesh.get() != 0);
+	EXPECT_EQ(cache->getStats().builtTiles, 0);
+	EXPECT_EQ(cache->getStats().tiles, stats.tiles);
+
+	PATH_POINTS path;
+	EXPECT_TRUE(gkRecast::findPath(navMesh, gkVector3(-15, -15, 0), gkVector3(15, 15, 0), gkVector3(2, 4, 2), 256, path));
+	EXPECT_GT(path.size(), 1U);
+
+	// an obstacle only touches the tiles around it
+	PMESHDATA blocked(createGround(20));
+	addBox(*blocked.get(), gkVector3(-1, 0, -1), gkVector3(1, 2, 1));
+
+	PDT_NAV_MESH blockedMesh = gkRecast::createNavMesh(blocked, config, cache);
+	ASSERT_TRUE(blockedMesh.get() != 0);
+	EXPECT_GT(cache->getStats().builtTiles, 0);
+	EXPECT_LT(cache->getStats().builtTiles, stats.tiles / 2);
+
+	EXPECT_TRUE(gkRecast::findPath(blockedMesh, gkVector3(-5, 0, 0), gkVector3(5, 0, 0), gkVector3(2, 4, 2), 256, path));
+	EXPECT_GT(path.size(), 2U);
+
+	// the previous mesh is still usable
+	EXPECT_TRUE(gkRecast::findPath(navMesh, gkVector3(-15, -15, 0), gkVector3(15, 15, 0), gkVector3(2, 4, 2), 256, path));
+
+	// changed settings rebuild everything
+	config.AGENT_RADIUS = 0.5f;
+	gkRecast::createNavMesh(blocked, config, cache);
+	EXPECT_EQ(cache->getStats().builtTiles, cache->getStats().tiles);
+}
+
+
+TEST(TEST_CASE_NAME, testParallelBuild)
+{
+	gkRecast::Config config;
+	config.CELL_SIZE = 0.3f;
+	config.TILE_SIZE = 32;
+
+	PMESHDATA ground(createGround(20));
+	addBox(*ground.get(), gkVector3(-1, 0, -1), gkVector3(1, 2, 1));
+
+	PRECAST_TILE_CACHE serial(new gkRecastTileCache);
+	gkRecast::createNavMesh(ground, config, serial);
+
+	PRECAST_TILE_CACHE parallel(new gkRecastTileCache);
+	{
+		gkJobSystem jobs(3);
+		EXPECT_TRUE(gkRecast::createNavMesh(ground, config, parallel).get() != 0);
+	}
+
+	// the threads that took a tile, at most the workers and the caller
+	EXPECT_GE(parallel->getStats().threads, 1);
+	EXPECT_LE(parallel->getStats().threads, 4);
+	EXPECT_EQ(parallel->getStats().tiles, serial->getStats().tiles);
+	EXPECT_EQ(parallel->getStats().polys, serial->getStats().polys);
+}
+
+
+TEST(TEST_CASE_NAME, testPathQueue)
+{
+	gkRecast::Config config;
+	config.CELL_SIZE = 0.3f;
+	config.TILE_SIZE = 32;
+
+	PMESHDATA ground(createGround(20));
+	PDT_NAV_MESH navMesh = gkRecast::createNavMesh(ground, config);
+	ASSERT_TRUE(navMesh.get() != 0);
+
+	gkNavPathQueue queue;
+	queue.setMaxQueriesPerUpdate(4);
+	queue.setUpdateBudget(1000);
+
+	const int count = 10;
+	gkNavPathQueue::Handle handles[count];
+	for (int i = 0; i < count; ++i)
+	{
+		handles[i] = queue.request(navMesh, gkVector3(-15, -15 + i, 0), gkVector3(15, 15 - i, 0), gkVector3(2, 4, 2), 64);
+		EXPECT_EQ(queue.getStatus(handles[i]), gkNavPathQueue::PS_QUEUED);
+	}
+
+	// spread over the updates
+	queue.update();
+	EXPECT_EQ(queue.getLastQueryCount(), 4);
+	EXPECT_EQ(queue.getQueuedCount(), 6U);
+	EXPECT_EQ(queue.getStatus(handles[3]), gkNavPathQueue::PS_FOUND);
+	EXPECT_EQ(queue.getStatus(handles[4]), gkNavPathQueue::PS_QUEUED);
+
+	// released before being answered
+	queue.release(handles[9]);
+
+	queue.update();
+	queue.update();
+	EXPECT_EQ(queue.getQueuedCount(), 0U);
+	EXPECT_EQ(queue.getLastQueryCount(), 1);
+
+	for (int i = 0; i < count - 1; ++i)
+	{
+		const gkVector3* points = 0;
+		EXPECT_EQ(queue.getStatus(handles[i]), gkNavPathQueue::PS_FOUND);
+		EXPECT_GE(queue.getPath(handles[i], points), 2);
+		ASSERT_TRUE(points != 0);
+		EXPECT_TRUE(points[0].positionEquals(gkVector3(-15, -15 + i, 0), 0.5f));
+	}
+
+	// slots are reused, stale handles do not match them
+	queue.release(handles[0]);
+	gkNavPathQueue::Handle handle = queue.request(navMesh, gkVector3(-15, 0, 0), gkVector3(-15, 0, 0), gkVector3(2, 4, 2), 64);
+	EXPECT_NE(handle, handles[0]);
+	EXPECT_EQ(queue.getStatus(handles[0]), gkNavPathQueue::PS_INVALID);
+
+	queue.update();
+	EXPECT_EQ(queue.getStatus(handle), gkNavPathQueue::PS_FAILED);
+	queue.update();
+	EXPECT_EQ(queue.getLastQueryCount(), 0);
+}
+
+#endif
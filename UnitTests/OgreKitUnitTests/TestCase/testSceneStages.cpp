@@ -0,0 +1,204 @@
+#include "StdAfx.h"
+#include "gkSceneStages.h"
+
+#define TEST_CASE_NAME testSceneStages
+
+namespace
+{
+
+enum Stage
+{
+	ST_PHYSICS,
+	ST_LOGIC,
+	ST_ANIMATIONS,
+	ST_SOUND,
+	ST_DBVT,
+	ST_END
+};
+
+
+// what ran on the calling thread, the order shared singletons see
+struct MainLog
+{
+	utArray<int> entries; // scene * 10 + stage
+	utArray<int> mailbox; // scenes a message is addressed to
+};
+
+
+// the stages of gkScene::update, logic sends a message to the next scene
+class FakeScene
+{
+public:
+	FakeScene(int id, int count, bool concurrent, MainLog& log)
+		:	m_syncs(0), m_id(id), m_count(count), m_concurrent(concurrent), m_log(log) {}
+
+	void update(gkScalar dt)
+	{
+		_stepPhysics(dt);
+		_updateLogic(dt);
+		_updateAnimations(dt);
+		_updateSound(dt);
+		_updateDbvt(dt);
+		_endUpdate(dt);
+	}
+
+	void _stepPhysics(gkScalar)      { record(ST_PHYSICS); }
+	void _updateAnimations(gkScalar) { record(ST_ANIMATIONS); }
+	void _updateSound(gkScalar)      { record(ST_SOUND); }
+	void _updateDbvt(gkScalar)       { record(ST_DBVT); }
+	void _endUpdate(gkScalar)        { record(ST_END); }
+
+	void _updateLogic(gkScalar)
+	{
+		record(ST_LOGIC);
+
+		int received = 0;
+		for (UTsize i = 0; i < m_log.mailbox.size(); )
+		{
+			if (m_log.mailbox[i] == m_id)
+			{
+				m_log.mailbox.erase(i);
+				++received;
+			}
+			else
+				++i;
+		}
+		m_received.push_back(received);
+		m_log.mailbox.push_back((m_id + 1) % m_count);
+	}
+
+	bool isInstanced(void)           { return true; }
+	void syncTransforms(void)        { ++m_syncs; }
+	bool _canUpdateConcurrently(void) { return m_concurrent; }
+
+	utArray<int> m_stages;
+	utArray<int> m_threads;
+	utArray<int> m_received; // messages per tick
+	int          m_syncs;
+
+private:
+
+	void record(int stage)
+	{
+		int thread = gkJobSystem::getSingleton().getThreadIndex();
+		m_stages.push_back(stage);
+		m_threads.push_back(thread);
+		if (thread == 0)
+			m_log.entries.push_back(m_id * 10 + stage);
+	}
+
+	int      m_id, m_count;
+	bool     m_concurrent;
+	MainLog& m_log;
+};
+
+
+typedef utArray<FakeScene*> FakeScenes;
+
+
+void createScenes(FakeScenes& scenes, MainLog& log, const bool* concurrent, int count)
+{
+	for (int i = 0; i < count; ++i)
+		scenes.push_back(new FakeScene(i, count, concurrent[i], log));
+}
+
+
+void destroyScenes(FakeScenes& scenes)
+{
+	for (UTsize i = 0; i < scenes.size(); ++i)
+		delete scenes[i];
+	scenes.clear();
+}
+
+}
+
+
+TEST(TEST_CASE_NAME, testOrder)
+{
+	const int count = 4, ticks = 3;
+	const bool concurrent[count] = {true, false, true, false};
+	const gkScalar dt = gkScalar(1) / 60;
+
+	gkJobSystem jobs(2);
+
+	MainLog serialLog, stagedLog;
+	FakeScenes serial, staged;
+	createScenes(serial, serialLog, concurrent, count);
+	createScenes(staged, stagedLog, concurrent, count);
+
+	gkSceneStages<FakeScene> stages;
+	FakeScene* current = 0;
+	for (int tick = 0; tick < ticks; ++tick)
+	{
+		for (int i = 0; i < count; ++i)
+			serial[i]->update(dt);
+		stages.update(staged, dt, &current);
+	}
+
+	EXPECT_EQ(stages.getConcurrentCount(), (UTsize)2);
+	EXPECT_EQ(current, staged.back());
+
+	for (int i = 0; i < count; ++i)
+	{
+		// per scene, the stages and the messages are the same as serial
+		FakeScene* a = serial[i], *b = staged[i];
+		ASSERT_EQ(a->m_stages.size(), b->m_stages.size());
+		for (UTsize j = 0; j < a->m_stages.size(); ++j)
+			EXPECT_EQ(a->m_stages[j], b->m_stages[j]);
+
+		ASSERT_EQ(a->m_received.size(), b->m_received.size());
+		for (UTsize j = 0; j < a->m_received.size(); ++j)
+			EXPECT_EQ(a->m_received[j], b->m_received[j]);
+
+		// synced before physics and before culling
+		EXPECT_EQ(b->m_syncs, 2 * ticks);
+
+		// only the concurrent stages of concurrent scenes leave this thread
+		for (UTsize j = 0; j < b->m_stages.size(); ++j)
+		{
+			int stage = b->m_stages[j];
+			if (!concurrent[i] || stage == ST_LOGIC || stage == ST_SOUND || stage == ST_END)
+				EXPECT_EQ(b->m_threads[j], 0);
+		}
+	}
+
+	// a message sent by a scene's logic is received by the next scene's logic
+	// in the same tick, the last scene's by the first in the next tick
+	for (int i = 0; i < count; ++i)
+	{
+		for (int tick = 0; tick < ticks; ++tick)
+			EXPECT_EQ(staged[i]->m_received[tick], (i == 0 && tick == 0) ? 0 : 1);
+	}
+
+	// the calling thread runs the passes in registration order
+	const int passes[3][2] = {{ST_PHYSICS, ST_LOGIC}, {ST_ANIMATIONS, ST_SOUND}, {ST_DBVT, ST_END}};
+	utArray<int> expected;
+	for (int tick = 0; tick < ticks; ++tick)
+	{
+		for (int pass = 0; pass < 3; ++pass)
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				if (!concurrent[i])
+					expected.push_back(i * 10 + passes[pass][0]);
+				expected.push_back(i * 10 + passes[pass][1]);
+			}
+		}
+	}
+
+	// with one worker, the concurrent stages may also run on the waiting thread
+	utArray<int> mainOnly;
+	for (UTsize j = 0; j < stagedLog.entries.size(); ++j)
+	{
+		int entry = stagedLog.entries[j], scene = entry / 10, stage = entry % 10;
+		if (!concurrent[scene] || stage == ST_LOGIC || stage == ST_SOUND || stage == ST_END)
+			mainOnly.push_back(entry);
+	}
+
+	ASSERT_EQ(mainOnly.size(), expected.size());
+	for (UTsize j = 0; j < expected.size(); ++j)
+		EXPECT_EQ(mainOnly[j], expected[j]);
+
+	destroyScenes(serial);
+	destroyScenes(staged);
+}
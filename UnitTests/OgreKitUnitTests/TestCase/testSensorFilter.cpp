@@ -0,0 +1,83 @@
+#include "StdAfx.h"
+#include "Physics/gkSensorFilter.h"
+#include "Fixtures/SensorFilterFixture.h"
+
+#define TEST_CASE_NAME testSensorFilter
+
+
+TEST(TEST_CASE_NAME, testProperties)
+{
+	Objects obs(4, 2);
+
+	gkSensorFilter any;
+	EXPECT_TRUE(any.isEmpty());
+	EXPECT_TRUE(any.test(obs[0]));
+
+	gkSensorFilter even("Prop.0");
+	EXPECT_TRUE(even.test(obs[0]));
+	EXPECT_FALSE(even.test(obs[1]));
+	EXPECT_TRUE(even.test(obs[2]));
+
+	// a property is matched before a material
+	gkSensorFilter both("Prop.1", "Material");
+	EXPECT_TRUE(both.test(obs[1]));
+	EXPECT_FALSE(both.test(obs[0]));
+
+	// masks follow new variables & new tags
+	gkSensorFilter late("Late");
+	EXPECT_FALSE(late.test(obs[3]));
+	obs[3]->createVariable("Late", false);
+	EXPECT_TRUE(late.test(obs[3]));
+
+	obs[0]->createVariable("Later", false);
+	EXPECT_TRUE(even.test(obs[0]));
+	gkSensorFilter later;
+	later.setProperty("Later");
+	EXPECT_TRUE(later.test(obs[0]));
+	EXPECT_FALSE(later.test(obs[1]));
+
+	// actors only
+	EXPECT_FALSE(even.test(obs[0], true));
+	obs[0]->getProperties().m_mode |= GK_ACTOR;
+	EXPECT_TRUE(even.test(obs[0], true));
+
+	// no mesh, no material
+	gkSensorFilter material("", "Material");
+	EXPECT_FALSE(material.test(obs[0]));
+	EXPECT_FALSE(material.test(obs[0], false, true));
+
+	// the string test agrees
+	for (int i = 0; i < 4; ++i)
+	{
+		EXPECT_EQ(even.test(obs[i]), gkPhysicsController::sensorTest(obs[i], "Prop.0"));
+		EXPECT_EQ(late.test(obs[i]), gkPhysicsController::sensorTest(obs[i], "Late"));
+	}
+}
+
+
+TEST(TEST_CASE_NAME, testOverflow)
+{
+	Objects obs(2, 2);
+	gkSensorFilter tagged("Prop.1");
+
+	// use up the bits, tags are never released
+	char buf[32];
+	int i = 0;
+	do
+		sprintf(buf, "Tag.%i", i++);
+	while (gkSensorFilter::intern(buf) != 0 && i < 2 * gkSensorFilter::MAX_TAGS);
+
+	EXPECT_LT(i, 2 * gkSensorFilter::MAX_TAGS);
+	EXPECT_EQ(gkSensorFilter::find(buf), gkSensorFilter::Mask(0));
+
+	// names without a bit compare strings
+	obs[1]->createVariable("Overflow", false);
+	gkSensorFilter overflow("Overflow");
+	EXPECT_FALSE(overflow.test(obs[0]));
+	EXPECT_TRUE(overflow.test(obs[1]));
+
+	// names with one still use it
+	EXPECT_TRUE(gkSensorFilter::find("Prop.1") != 0);
+	EXPECT_FALSE(tagged.test(obs[0]));
+	EXPECT_TRUE(tagged.test(obs[1]));
+}
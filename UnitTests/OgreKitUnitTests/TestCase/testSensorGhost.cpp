@@ -0,0 +1,146 @@
+#include "StdAfx.h"
+#include "Fixtures/SensorGhostFixture.h"
+
+#define TEST_CASE_NAME testSensorGhost
+
+namespace
+{
+
+bool sameObjects(const utArray<const btCollisionObject*>& a, const utArray<const btCollisionObject*>& b)
+{
+	if (a.size() != b.size())
+		return false;
+	for (UTsize i = 0; i < a.size(); ++i)
+	{
+		if (b.find(a[i]) == UT_NPOS)
+			return false;
+	}
+	return true;
+}
+
+}
+
+
+TEST(TEST_CASE_NAME, testOverlaps)
+{
+	World world(10, 3.f);
+	gkSensorGhost ghost(&world.m_world);
+
+	utArray<const btCollisionObject*> hits, expected;
+
+	// nothing is paired before there is a shape
+	EXPECT_FALSE(ghost.collides(hits));
+
+	ghost.setSphere(0.8f);
+	ghost.setTransform(makeTransform(0, 0));
+	ASSERT_TRUE(ghost.collides(hits));
+	EXPECT_EQ(hits.size(), 1U);
+	EXPECT_TRUE(hits[0] == world.m_bodies[0]);
+	EXPECT_FALSE(ghost.collides(hits, world.m_bodies[0]));
+
+	// between four boxes, then growing over them
+	ghost.setTransform(makeTransform(4.5f, 4.5f));
+	EXPECT_FALSE(ghost.collides(hits));
+	ghost.setSphere(2.f);
+	EXPECT_TRUE(ghost.collides(hits));
+	EXPECT_EQ(hits.size(), 4U);
+
+	// moved along a path, with & without steps in between
+	bool same = true;
+	btSphereShape sphere(2.f);
+	for (int i = 0; i < 60; ++i)
+	{
+		btTransform trans = makeTransform(btScalar(i) * 0.45f, btScalar(i % 7) * 0.9f);
+		ghost.setTransform(trans);
+		ghost.collides(hits);
+
+		world.contactTest(trans, &sphere, expected);
+		same = same && sameObjects(hits, expected);
+
+		if (i % 3 == 0)
+			world.m_world.stepSimulation(btScalar(1.) / 60);
+	}
+	EXPECT_TRUE(same);
+
+	btConeShapeZ cone(1.f, 4.f);
+	ghost.setCone(1.f, 4.f);
+	ghost.setTransform(makeTransform(9, 6));
+	ghost.collides(hits);
+	world.contactTest(makeTransform(9, 6), &cone, expected);
+	EXPECT_TRUE(sameObjects(hits, expected));
+	EXPECT_FALSE(hits.empty());
+
+	// an idle volume still sees objects moved into it
+	ghost.setSphere(1.f);
+	ghost.setTransform(makeTransform(40, 40));
+	EXPECT_FALSE(ghost.collides(hits));
+
+	world.m_bodies[0]->setWorldTransform(makeTransform(40.5f, 40));
+	world.m_world.updateSingleAabb(world.m_bodies[0]);
+	EXPECT_TRUE(ghost.collides(hits));
+
+	world.m_bodies[0]->setWorldTransform(makeTransform(0, 0));
+	world.m_world.updateSingleAabb(world.m_bodies[0]);
+	EXPECT_FALSE(ghost.collides(hits));
+
+	// and simulated ones, falling down the y axis
+	btRigidBody falling(1, 0, &world.m_box, btVector3(1, 1, 1));
+	falling.setWorldTransform(makeTransform(40, 43));
+	world.m_world.addRigidBody(&falling);
+
+	int frame = 0;
+	while (frame < 120 && !ghost.collides(hits))
+	{
+		world.m_world.stepSimulation(btScalar(1.) / 60);
+		++frame;
+	}
+	EXPECT_TRUE(frame > 10 && frame < 120);
+	EXPECT_TRUE(hits.size() == 1 && hits[0] == &falling);
+
+	world.m_world.removeRigidBody(&falling);
+}
+
+
+TEST(TEST_CASE_NAME, testHidden)
+{
+	World world(4, 3.f);
+	gkSensorGhost ghost(&world.m_world);
+	ghost.setSphere(2.f);
+	ghost.setTransform(makeTransform(1.5f, 0));
+
+	utArray<const btCollisionObject*> hits;
+	EXPECT_TRUE(ghost.collides(hits));
+
+	world.m_world.stepSimulation(btScalar(1.) / 60);
+
+	// the world has the pairs but never runs them
+	int pairs = 0;
+	bool dispatched = false;
+	btBroadphasePairArray& array = world.m_broadphase.getOverlappingPairCache()->getOverlappingPairArray();
+	for (int i = 0; i < array.size(); ++i)
+	{
+		btBroadphasePair& pair = array[i];
+		if (pair.m_pProxy0->m_clientObject == ghost.getGhostObject() || pair.m_pProxy1->m_clientObject == ghost.getGhostObject())
+		{
+			++pairs;
+			dispatched = dispatched || pair.m_algorithm != 0;
+		}
+	}
+	EXPECT_EQ(pairs, 2);
+	EXPECT_FALSE(dispatched);
+
+	// rays pass through
+	btCollisionWorld::ClosestRayResultCallback ray(btVector3(1.5f, 0, 5), btVector3(1.5f, 0, -5));
+	ray.m_collisionFilterGroup = btBroadphaseProxy::AllFilter;
+	ray.m_collisionFilterMask = btBroadphaseProxy::AllFilter;
+	world.m_world.rayTest(ray.m_rayFromWorld, ray.m_rayToWorld, ray);
+	EXPECT_FALSE(ray.hasHit());
+
+	// another volume at the same spot is not paired
+	gkSensorGhost other(&world.m_world);
+	other.setSphere(2.f);
+	other.setTransform(makeTransform(1.5f, 0));
+	EXPECT_EQ(ghost.getGhostObject()->getNumOverlappingObjects(), 2);
+	EXPECT_EQ(other.getGhostObject()->getNumOverlappingObjects(), 2);
+}
+
@@ -0,0 +1,125 @@
+#include "StdAfx.h"
+#include "Thread/gkSpscQueue.h"
+
+#ifndef WIN32
+#include <sched.h>
+#endif
+
+#define TEST_CASE_NAME testSpscQueue
+
+namespace
+{
+
+// lets the other side run when both share one core
+void yieldThread(void)
+{
+#ifdef WIN32
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
+
+
+struct Message
+{
+	int      m_id;
+	gkString m_subject;
+};
+
+
+class Producer : public gkCall
+{
+public:
+	gkSpscQueue<Message>& m_queue;
+	int m_count;
+	int m_full;
+
+	Producer(gkSpscQueue<Message>& queue, int count)
+		:	m_queue(queue), m_count(count), m_full(0) {}
+
+	void run(void)
+	{
+		for (int i = 0; i < m_count; )
+		{
+			Message* msg = m_queue.beginPush();
+			if (!msg)
+			{
+				++m_full;
+				yieldThread();
+				continue;
+			}
+
+			msg->m_id = i;
+			msg->m_subject = i & 1 ? "odd" : "even";
+			m_queue.endPush();
+			++i;
+		}
+	}
+};
+
+}
+
+
+TEST(TEST_CASE_NAME, testSingleThread)
+{
+	gkSpscQueue<Message> queue(5);
+	EXPECT_EQ(queue.capacity(), 8);
+	EXPECT_TRUE(queue.isEmpty());
+	EXPECT_TRUE(queue.front() == 0);
+
+	// wraps around several times
+	for (int r = 0; r < 5; ++r)
+	{
+		for (int i = 0; i < 8; ++i)
+		{
+			Message* msg = queue.beginPush();
+			ASSERT_TRUE(msg != 0);
+			msg->m_id = r * 8 + i;
+			queue.endPush();
+		}
+
+		EXPECT_TRUE(queue.beginPush() == 0);
+		EXPECT_EQ(queue.size(), 8);
+
+		for (int i = 0; i < 8; ++i)
+		{
+			ASSERT_TRUE(queue.front() != 0);
+			EXPECT_EQ(queue.front()->m_id, r * 8 + i);
+			queue.pop();
+		}
+
+		EXPECT_TRUE(queue.isEmpty());
+	}
+}
+
+
+TEST(TEST_CASE_NAME, testTwoThreads)
+{
+	const int count = 200000;
+	gkSpscQueue<Message> queue(64);
+	Producer producer(queue, count);
+
+	gkThread thread(&producer);
+
+	int next = 0;
+	bool ordered = true;
+	while (next < count)
+	{
+		Message* msg = queue.front();
+		if (!msg)
+		{
+			yieldThread();
+			continue;
+		}
+
+		ordered = ordered && msg->m_id == next && msg->m_subject == (next & 1 ? "odd" : "even");
+		queue.pop();
+		++next;
+	}
+
+	thread.join();
+
+	EXPECT_TRUE(ordered);
+	EXPECT_TRUE(queue.isEmpty());
+}
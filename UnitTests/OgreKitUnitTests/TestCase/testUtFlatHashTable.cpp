@@ -0,0 +1,79 @@
+#include "StdAfx.h"
+
+#define TEST_CASE_NAME testUtFlatHashTable
+
+TEST(TEST_CASE_NAME, testSize)
+{
+	utFlatHashTable<utIntHashKey, int> table1;
+
+	const int count = 1000;
+	for (int i = 0; i < count; i++)
+		table1.insert(i, i);
+
+	EXPECT_EQ(table1.size(), count);
+	EXPECT_FALSE(table1.insert(10, 10));
+	EXPECT_EQ(table1.size(), count);
+}
+
+TEST(TEST_CASE_NAME, testFindErase)
+{
+	utFlatHashTable<utIntHashKey, int> table1;
+
+	const int count = 1000;
+	for (int i = 0; i < count; i++)
+		table1.insert(i, i * 2);
+
+	for (int i = 0; i < count; i += 2)
+		table1.erase(i);
+
+	EXPECT_EQ(table1.size(), count / 2);
+
+	for (int i = 0; i < count; i++)
+	{
+		int* v = table1.get(i);
+		if (i & 1)
+		{
+			ASSERT_TRUE(v != 0);
+			EXPECT_EQ(*v, i * 2);
+		}
+		else
+			EXPECT_TRUE(v == 0);
+	}
+
+	// entries stay packed
+	for (UTsize i = 0; i < table1.size(); i++)
+		EXPECT_EQ(table1.at(i), table1.keyAt(i).key() * 2);
+}
+
+TEST(TEST_CASE_NAME, testCopy)
+{
+	utFlatHashTable<utHashedString, utString> table1, table2;
+
+	table1.insert("key1", "value1");
+	table1.insert("key2", "value2");
+
+	table2 = table1;
+	EXPECT_EQ(table2.size(), 2);
+	ASSERT_TRUE(table2.get("key2") != 0);
+	EXPECT_STREQ(table2.get("key2")->c_str(), "value2");
+
+	table1 = utFlatHashTable<utHashedString, utString>();
+	EXPECT_EQ(table1.size(), 0);
+	EXPECT_TRUE(table1.find("key1") == UT_NPOS);
+}
+
+TEST(TEST_CASE_NAME, testIterator)
+{
+	utFlatHashTable<utIntHashKey, int> table1;
+
+	const int count = 100;
+	for (int i = 0; i < count; i++)
+		table1.insert(i, i);
+
+	int sum = 0;
+	utFlatHashTable<utIntHashKey, int>::Iterator it = table1.iterator();
+	while (it.hasMoreElements())
+		sum += it.getNext().second;
+
+	EXPECT_EQ(sum, count * (count - 1) / 2);
+}
@@ -0,0 +1,148 @@
+#include "StdAfx.h"
+#include "Fixtures/MemoryPoolFixture.h"
+
+#define TEST_CASE_NAME testUtMemoryPool
+
+namespace
+{
+
+bool isAligned(void* p, UTsize align)
+{
+	return ((UTuintPtr)p & (align - 1)) == 0;
+}
+
+}
+
+
+TEST(TEST_CASE_NAME, testSlabReuse)
+{
+	utSlabAllocator slab(24, 16);
+	EXPECT_EQ(slab.getBlockSize(), 32);
+
+	utArray<void*> blocks;
+	for (int i = 0; i < 100; i++)
+	{
+		void* p = slab.alloc();
+		ASSERT_TRUE(p != 0);
+		EXPECT_TRUE(isAligned(p, UT_POOL_ALIGN));
+		blocks.push_back(p);
+	}
+
+	EXPECT_EQ(slab.getUsedCount(), 100);
+	EXPECT_EQ(slab.getCapacity(), 112);
+	EXPECT_EQ(slab.getStats().used, 100 * 32);
+
+	// freed blocks come back before the slab grows
+	for (int i = 0; i < 50; i++)
+		slab.dealloc(blocks[i]);
+
+	UTsize reserved = slab.getStats().reserved;
+	for (int i = 0; i < 50; i++)
+		EXPECT_TRUE(blocks.find(slab.alloc()) != UT_NPOS);
+
+	EXPECT_EQ(slab.getStats().reserved, reserved);
+	EXPECT_EQ(slab.getStats().highWater, 100 * 32);
+	EXPECT_EQ(slab.getStats().allocs, 150);
+}
+
+
+TEST(TEST_CASE_NAME, testSlabMax)
+{
+	utSlabAllocator slab(8, 4, 10);
+
+	for (int i = 0; i < 10; i++)
+		EXPECT_TRUE(slab.alloc() != 0);
+
+	EXPECT_TRUE(slab.alloc() == 0);
+	EXPECT_EQ(slab.getCapacity(), 10);
+}
+
+
+TEST(TEST_CASE_NAME, testPool)
+{
+	utMemoryPool<PoolItem, 0> pool(8);
+	EXPECT_EQ(pool.getAllocatedCount(), 8);
+	EXPECT_EQ(pool.getUsedCount(), 0);
+
+	utArray<PoolItem*> items;
+	for (int i = 0; i < 20; i++)
+	{
+		PoolItem* item = pool.alloc();
+		EXPECT_EQ(item->m_value, 7);
+		items.push_back(item);
+	}
+
+	EXPECT_EQ(PoolItem::m_alive, 20);
+	EXPECT_EQ(pool.getAllocatedCount(), 20);
+	EXPECT_EQ(pool.getUsedCount(), 20);
+
+	for (UTsize i = 0; i < items.size(); i++)
+		pool.dealloc(items[i]);
+
+	// freed objects stay in the pool
+	EXPECT_EQ(PoolItem::m_alive, 0);
+	EXPECT_EQ(pool.getAllocatedCount(), 20);
+	EXPECT_EQ(pool.getUsedCount(), 0);
+	EXPECT_EQ(pool.getPoolSize(), 20 * sizeof(PoolItem));
+	EXPECT_GE(pool.getStats().highWater, 20 * sizeof(PoolItem));
+}
+
+
+TEST(TEST_CASE_NAME, testSmallObject)
+{
+	utSmallObjectAllocator alloc(8);
+
+	const UTsize sizes[] = {1, 16, 17, 100, 512, 513, 4096};
+	void* ptrs[7];
+
+	for (int i = 0; i < 7; i++)
+	{
+		ptrs[i] = alloc.alloc(sizes[i]);
+		ASSERT_TRUE(ptrs[i] != 0);
+		memset(ptrs[i], 0xAB, sizes[i]);
+	}
+
+	utAllocStats stats = alloc.getStats();
+	EXPECT_EQ(stats.allocs, 7);
+	EXPECT_GE(stats.used, 1 + 16 + 17 + 100 + 512 + 513 + 4096);
+
+	for (int i = 0; i < 7; i++)
+		alloc.dealloc(ptrs[i], sizes[i]);
+
+	EXPECT_EQ(alloc.getStats().used, 0);
+}
+
+
+TEST(TEST_CASE_NAME, testFrameArena)
+{
+	utFrameArena arena(1024);
+
+	char* a = (char*)arena.alloc(3);
+	double* b = arena.allocArray<double>(4);
+	void* c = arena.alloc(10, 64);
+
+	EXPECT_TRUE(isAligned(a, UT_POOL_ALIGN));
+	EXPECT_TRUE(isAligned(b, UT_POOL_ALIGN));
+	EXPECT_TRUE(isAligned(c, 64));
+	EXPECT_EQ(arena.getStats().allocs, 3);
+
+	// spill over into new chunks
+	for (int i = 0; i < 10; i++)
+		memset(arena.alloc(500), i, 500);
+
+	UTsize peak = arena.getUsed();
+	EXPECT_GT(arena.getStats().reserved, 1024);
+
+	// the next frame fits in one chunk again
+	arena.reset();
+	EXPECT_EQ(arena.getUsed(), 0);
+	EXPECT_EQ(arena.getStats().highWater, peak);
+	UTsize reserved = arena.getStats().reserved;
+	EXPECT_GE(reserved, peak);
+
+	for (int i = 0; i < 10; i++)
+		arena.alloc(500);
+	arena.alloc(3);
+	EXPECT_EQ(arena.getStats().reserved, reserved);
+}
+
@@ -429,6 +429,28 @@ void	CProfileIterator::Enter_Parent( void )
 **
 ***************************************************************************************************/
 
+/*
+** The profile tree is not thread safe. Only the thread that initialized this
+** module (the main thread) records samples, worker threads stepping other
+** dynamics worlds at the same time are ignored.
+*/
+#ifdef BT_USE_WINDOWS_TIMERS
+typedef DWORD btProfileThreadId;
+static btProfileThreadId btGetProfileThreadId() { return GetCurrentThreadId(); }
+static bool btIsProfileThread(btProfileThreadId id) { return id == GetCurrentThreadId(); }
+#elif defined(__CELLOS_LV2__)
+typedef int btProfileThreadId;
+static btProfileThreadId btGetProfileThreadId() { return 0; }
+static bool btIsProfileThread(btProfileThreadId) { return true; }
+#else
+#include <pthread.h>
+typedef pthread_t btProfileThreadId;
+static btProfileThreadId btGetProfileThreadId() { return pthread_self(); }
+static bool btIsProfileThread(btProfileThreadId id) { return pthread_equal(id, pthread_self()) != 0; }
+#endif
+
+static btProfileThreadId gProfileThread = btGetProfileThreadId();
+
 CProfileNode	CProfileManager::Root( "Root", NULL );
 CProfileNode *	CProfileManager::CurrentNode = &CProfileManager::Root;
 int				CProfileManager::FrameCounter = 0;
@@ -450,6 +472,9 @@ unsigned long int			CProfileManager::ResetTime = 0;
  *=============================================================================================*/
 void	CProfileManager::Start_Profile( const char * name )
 {
+	if (!btIsProfileThread(gProfileThread))
+		return;
+
 	if (name != CurrentNode->Get_Name()) {
 		CurrentNode = CurrentNode->Get_Sub_Node( name );
 	} 
@@ -463,6 +488,9 @@ void	CProfileManager::Start_Profile( const char * name )
  *=============================================================================================*/
 void	CProfileManager::Stop_Profile( void )
 {
+	if (!btIsProfileThread(gProfileThread))
+		return;
+
 	// Return will indicate whether we should back up to our parent (we may
 	// be profiling a recursive function)
 	if (CurrentNode->Return()) {